@@ -0,0 +1,510 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Benchmark suite of the simulator. The scenarios are fixed: 1k, 10k and 50k nodes, with the STANDARD, SENDHEADERS
+ * and blockTorrent protocols, with and without the relay network, in a single process and with fixed seeds.
+ * Every scenario runs in its own child process, because the nodes of ns-3 can't be destroyed, and it reports
+ * one JSON object per line:
+ *   - setupSeconds: the wall time of the topology and the installation of the applications
+ *   - runSeconds: the wall time of Simulator::Run
+ *   - events: the events processed by the simulator, counted by the CountingScheduler. With fixed seeds it only
+ *     changes when the behaviour of the simulation changes
+ *   - eventsPerSecond and simSecondsPerWallSecond: the rates of the run
+ *   - profiledScopes and profiledScopesPerSecond: the outermost handlers of the nodes, counted by the SimulationProfiler.
+ *     They are a subset of the events, e.g. the events of the TCP/IP stack are not profiled, and they are not compared
+ *     against the baseline
+ *   - peakRssKB: the peak resident set size of the child process
+ * With --baseline, the results are compared against the records of a previous run, e.g. of the previous commit,
+ * and the program fails if a metric got worse by more than --tolerance.
+ *
+ * Example:
+ *   ./waf --run "bitcoin-benchmark --scenarios=1k-standard,1k-sendheaders --label=$(git rev-parse --short HEAD) --output=bench.jsonl"
+ */
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <algorithm>
+#include <time.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+double get_wall_time();
+
+NS_LOG_COMPONENT_DEFINE ("BitcoinBenchmark");
+
+
+/**
+ * A scenario of the suite
+ */
+typedef struct {
+  std::string         name;
+  int                 nodes;
+  std::string         protocol;           // standard, sendheaders or blocktorrent
+  bool                relayNetwork;
+} benchmarkScenario;
+
+
+/**
+ * The parameters shared by all the scenarios
+ */
+typedef struct {
+  int                 noBlocks;
+  uint32_t            seed;
+  uint64_t            run;
+  bool                fastLinks;
+  std::string         label;
+} benchmarkOptions;
+
+
+/**
+ * The metrics which are compared against the baseline. higherIsBetter tells in which direction a change is a regression.
+ */
+typedef struct {
+  const char         *name;
+  bool                higherIsBetter;
+} benchmarkMetric;
+
+static const benchmarkMetric benchmarkMetrics[] = {{"setupSeconds", false}, {"runSeconds", false}, {"eventsPerSecond", true},
+                                                   {"simSecondsPerWallSecond", true}, {"peakRssKB", false}};
+
+
+/**
+ * \return the scenarios of the suite
+ */
+std::vector<benchmarkScenario>
+GetScenarios (void)
+{
+  std::vector<benchmarkScenario>  scenarios;
+  const int                       sizes[] = {1000, 10000, 50000};
+  const char                     *sizeNames[] = {"1k", "10k", "50k"};
+  const char                     *protocols[] = {"standard", "sendheaders", "blocktorrent"};
+
+  for (int size = 0; size < 3; size++)
+  {
+    for (int protocol = 0; protocol < 3; protocol++)
+    {
+      for (int relay = 0; relay < 2; relay++)
+      {
+        benchmarkScenario scenario;
+
+        scenario.name = std::string (sizeNames[size]) + "-" + protocols[protocol] + (relay ? "-relay" : "");
+        scenario.nodes = sizes[size];
+        scenario.protocol = protocols[protocol];
+        scenario.relayNetwork = relay;
+        scenarios.push_back (scenario);
+      }
+    }
+  }
+  return scenarios;
+}
+
+
+/**
+ * \brief Sets up and runs a scenario, and writes its measurements as a JSON object to the file descriptor fd.
+ * It is called in the child process of the scenario.
+ */
+void
+RunScenario (const benchmarkScenario &scenario, const benchmarkOptions &options, int fd)
+{
+  const int secsPerMin = 60;
+  const uint16_t bitcoinPort = 8333;
+  const double averageBlockGenIntervalMinutes = 10;
+  const double averageBlockGenIntervalSeconds = averageBlockGenIntervalMinutes * secsPerMin;
+  const double stop = options.noBlocks * averageBlockGenIntervalMinutes;
+  const int noMiners = 16;
+  double bitcoinMinersHash[] = {0.289, 0.196, 0.159, 0.133, 0.066, 0.054,
+                                0.029, 0.016, 0.012, 0.012, 0.012, 0.009,
+                                0.005, 0.005, 0.002, 0.002};
+  enum BitcoinRegion bitcoinMinersRegions[] = {ASIA_PACIFIC, ASIA_PACIFIC, ASIA_PACIFIC, NORTH_AMERICA, ASIA_PACIFIC, NORTH_AMERICA,
+                                               EUROPE, EUROPE, NORTH_AMERICA, NORTH_AMERICA, NORTH_AMERICA, EUROPE,
+                                               NORTH_AMERICA, NORTH_AMERICA, NORTH_AMERICA, NORTH_AMERICA};
+  double tStart = get_wall_time ();
+
+  Time::SetResolution (Time::NS);
+  RngSeedManager::SetSeed (options.seed);
+  RngSeedManager::SetRun (options.run);
+
+  ObjectFactory scheduler;
+  scheduler.SetTypeId ("ns3::CountingScheduler");
+  Simulator::SetScheduler (scheduler);
+
+  Ptr<NodeStatsRegistry>   stats = Create<NodeStatsRegistry> (scenario.nodes);
+  Ptr<SimulationProfiler>  profiler = Create<SimulationProfiler> ();
+  BitcoinTopologyHelper    bitcoinTopologyHelper (1, scenario.nodes, noMiners, bitcoinMinersRegions, BITCOIN, -1, -1, 5, 0, options.fastLinks);
+
+  InternetStackHelper stack;
+  bitcoinTopologyHelper.InstallStack (stack);
+  bitcoinTopologyHelper.AssignIpv4Addresses (Ipv4AddressHelperCustom ("1.0.0.0", "255.255.255.0", false));
+
+  std::map<uint32_t, std::vector<Ipv4Address>>         nodesConnections = bitcoinTopologyHelper.GetNodesConnectionsIps();
+  std::vector<uint32_t>                                miners = bitcoinTopologyHelper.GetMiners();
+  std::map<uint32_t, std::map<Ipv4Address, double>>    peersDownloadSpeeds = bitcoinTopologyHelper.GetPeersDownloadSpeeds();
+  std::map<uint32_t, std::map<Ipv4Address, double>>    peersUploadSpeeds = bitcoinTopologyHelper.GetPeersUploadSpeeds();
+  std::map<uint32_t, nodeInternetSpeeds>               nodesInternetSpeeds = bitcoinTopologyHelper.GetNodesInternetSpeeds();
+
+  BitcoinMinerHelper bitcoinMinerHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), bitcoinPort),
+                                          nodesConnections[miners[0]], noMiners, peersDownloadSpeeds[0], peersUploadSpeeds[0],
+                                          nodesInternetSpeeds[0], stats, bitcoinMinersHash[0], averageBlockGenIntervalSeconds);
+  BitcoinNodeHelper bitcoinNodeHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), bitcoinPort),
+                                        nodesConnections[0], peersDownloadSpeeds[0],  peersUploadSpeeds[0], nodesInternetSpeeds[0], stats);
+  ApplicationContainer bitcoinMiners;
+  ApplicationContainer bitcoinNodes;
+
+  for (int i = 0; i < 2; i++)
+  {
+    BitcoinNodeHelper &helper = i == 0 ? bitcoinMinerHelper : bitcoinNodeHelper;
+
+    helper.SetAttribute ("InvTimeoutMinutes", TimeValue (Minutes (2*averageBlockGenIntervalMinutes)));
+    if (scenario.protocol == "sendheaders")
+      helper.SetProtocolType (SENDHEADERS);
+    else if (scenario.protocol == "blocktorrent")
+      helper.SetAttribute ("BlockTorrent", BooleanValue (true));
+    helper.SetFastLinkChannel (bitcoinTopologyHelper.GetFastLinkChannel ());
+    helper.SetSimulationProfiler (profiler);
+    helper.SetNodeStats (stats);
+  }
+  if (scenario.relayNetwork)
+    bitcoinMinerHelper.SetBlockBroadcastType (RELAY_NETWORK);
+
+  for (int count = 0; count < noMiners; count++)
+  {
+    uint32_t miner = miners[count];
+
+    bitcoinMinerHelper.SetAttribute ("HashRate", DoubleValue (bitcoinMinersHash[count]));
+    bitcoinMinerHelper.SetPeersAddresses (nodesConnections[miner]);
+    bitcoinMinerHelper.SetPeersDownloadSpeeds (peersDownloadSpeeds[miner]);
+    bitcoinMinerHelper.SetPeersUploadSpeeds (peersUploadSpeeds[miner]);
+    bitcoinMinerHelper.SetNodeInternetSpeeds (nodesInternetSpeeds[miner]);
+    bitcoinMiners.Add (bitcoinMinerHelper.Install (bitcoinTopologyHelper.GetNode (miner)));
+  }
+  bitcoinMiners.Start (Seconds (0));
+  bitcoinMiners.Stop (Minutes (stop));
+
+  for (auto &node : nodesConnections)
+  {
+    if (std::find (miners.begin (), miners.end (), node.first) != miners.end ())
+      continue;
+
+    bitcoinNodeHelper.SetPeersAddresses (node.second);
+    bitcoinNodeHelper.SetPeersDownloadSpeeds (peersDownloadSpeeds[node.first]);
+    bitcoinNodeHelper.SetPeersUploadSpeeds (peersUploadSpeeds[node.first]);
+    bitcoinNodeHelper.SetNodeInternetSpeeds (nodesInternetSpeeds[node.first]);
+    bitcoinNodes.Add (bitcoinNodeHelper.Install (bitcoinTopologyHelper.GetNode (node.first)));
+  }
+  bitcoinNodes.Start (Seconds (0));
+  bitcoinNodes.Stop (Minutes (stop));
+
+  double tStartSimulation = get_wall_time ();
+
+  Simulator::Stop (Minutes (stop + 0.1));
+  profiler->Start ();
+  Simulator::Run ();
+  profiler->Stop ();
+
+  double tFinish = get_wall_time ();
+  double simulatedSeconds = Simulator::Now ().GetSeconds ();
+
+  Simulator::Destroy ();
+
+  std::ostringstream result;
+  result.precision (10);
+  result << "{\"setupSeconds\":" << tStartSimulation - tStart << ",\"runSeconds\":" << tFinish - tStartSimulation
+         << ",\"events\":" << profiler->GetNoEvents () << ",\"profiledScopes\":" << profiler->GetNoProfiledScopes ()
+         << ",\"simulatedSeconds\":" << simulatedSeconds << "}";
+
+  std::string output = result.str ();
+  if (write (fd, output.data (), output.size ()) != static_cast<ssize_t>(output.size ()))
+    NS_FATAL_ERROR ("Could not report the result of " << scenario.name);
+}
+
+
+/**
+ * \brief Runs a scenario in a child process
+ * \param record the JSON object of the result, with the peak RSS of the child process
+ * \return false if the scenario failed
+ */
+bool
+RunChild (const benchmarkScenario &scenario, const benchmarkOptions &options, rapidjson::Document &record)
+{
+  int pipeFds[2];
+
+  std::cout.flush ();
+  if (pipe (pipeFds) != 0)
+    NS_FATAL_ERROR ("Could not create the pipe of " << scenario.name);
+
+  pid_t pid = fork ();
+  if (pid < 0)
+    NS_FATAL_ERROR ("Could not fork the process of " << scenario.name);
+
+  if (pid == 0)
+  {
+    /**
+     * The helpers print their progress to stdout, which is reserved for the records
+     */
+    close (pipeFds[0]);
+    dup2 (STDERR_FILENO, STDOUT_FILENO);
+    RunScenario (scenario, options, pipeFds[1]);
+    close (pipeFds[1]);
+    std::cout.flush ();
+    _exit (0);
+  }
+
+  std::string     output;
+  char            buffer[4096];
+  ssize_t         bytes;
+  int             status;
+  struct rusage   usage;
+
+  close (pipeFds[1]);
+  while ((bytes = read (pipeFds[0], buffer, sizeof(buffer))) > 0)
+    output.append (buffer, bytes);
+  close (pipeFds[0]);
+
+  if (wait4 (pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0
+      || record.Parse (output.c_str ()).HasParseError () || !record.IsObject ())
+    return false;
+
+  double runSeconds = record["runSeconds"].GetDouble ();
+  rapidjson::Value value;
+
+  value.SetDouble (record["events"].GetDouble () / runSeconds);
+  record.AddMember ("eventsPerSecond", value, record.GetAllocator ());
+  value.SetDouble (record["profiledScopes"].GetDouble () / runSeconds);
+  record.AddMember ("profiledScopesPerSecond", value, record.GetAllocator ());
+  value.SetDouble (record["simulatedSeconds"].GetDouble () / runSeconds);
+  record.AddMember ("simSecondsPerWallSecond", value, record.GetAllocator ());
+  value.SetDouble (usage.ru_maxrss);                                                  // in KBytes on Linux
+  record.AddMember ("peakRssKB", value, record.GetAllocator ());
+  return true;
+}
+
+
+/**
+ * \brief Adds the description of the scenario to a record
+ */
+void
+DescribeScenario (const benchmarkScenario &scenario, const benchmarkOptions &options, rapidjson::Document &record)
+{
+  rapidjson::Value value;
+
+  if (!record.IsObject ())
+    record.SetObject ();
+
+  value.SetString (scenario.name.c_str (), scenario.name.size (), record.GetAllocator ());
+  record.AddMember ("scenario", value, record.GetAllocator ());
+  value.SetString (options.label.c_str (), options.label.size (), record.GetAllocator ());
+  record.AddMember ("label", value, record.GetAllocator ());
+  value.SetInt (scenario.nodes);
+  record.AddMember ("nodes", value, record.GetAllocator ());
+  value.SetString (scenario.protocol.c_str (), scenario.protocol.size (), record.GetAllocator ());
+  record.AddMember ("protocol", value, record.GetAllocator ());
+  value.SetBool (scenario.relayNetwork);
+  record.AddMember ("relayNetwork", value, record.GetAllocator ());
+  value.SetBool (options.fastLinks);
+  record.AddMember ("fastLinks", value, record.GetAllocator ());
+  value.SetInt (options.noBlocks);
+  record.AddMember ("noBlocks", value, record.GetAllocator ());
+  value.SetUint (options.seed);
+  record.AddMember ("seed", value, record.GetAllocator ());
+  value.SetUint64 (options.run);
+  record.AddMember ("run", value, record.GetAllocator ());
+}
+
+
+/**
+ * \brief Reads the records of a previous run, one JSON object per line
+ * \return the records by scenario name
+ */
+std::map<std::string, std::string>
+ReadBaseline (const std::string &fileName)
+{
+  std::map<std::string, std::string>  baseline;
+  std::ifstream                       file (fileName.c_str ());
+  std::string                         line;
+
+  if (!file)
+    NS_FATAL_ERROR ("Could not open the baseline " << fileName);
+
+  while (std::getline (file, line))
+  {
+    rapidjson::Document record;
+
+    if (record.Parse (line.c_str ()).HasParseError () || !record.IsObject () || !record.HasMember ("scenario")
+        || record.HasMember ("failed"))
+      continue;
+    baseline[record["scenario"].GetString ()] = line;
+  }
+  return baseline;
+}
+
+
+/**
+ * \brief Compares a record against the record of the same scenario in the baseline and prints the changes to stderr
+ * \return false if a metric got worse by more than tolerance
+ */
+bool
+CompareWithBaseline (const rapidjson::Document &record, const std::map<std::string, std::string> &baseline, double tolerance)
+{
+  std::string  name = record["scenario"].GetString ();
+  auto         entry = baseline.find (name);
+  bool         passed = true;
+
+  if (entry == baseline.end ())
+  {
+    std::cerr << name << ": not in the baseline\n";
+    return true;
+  }
+
+  rapidjson::Document previous;
+  previous.Parse (entry->second.c_str ());
+
+  if (previous.HasMember ("events") && previous["events"].GetDouble () != record["events"].GetDouble ())
+    std::cerr << name << ": the simulator events changed from " << previous["events"].GetDouble () << " to "
+              << record["events"].GetDouble () << ", so the behaviour of the simulation changed\n";
+
+  for (auto const &metric : benchmarkMetrics)
+  {
+    if (!previous.HasMember (metric.name) || previous[metric.name].GetDouble () <= 0)
+      continue;
+
+    double before = previous[metric.name].GetDouble ();
+    double after = record[metric.name].GetDouble ();
+    double change = (after - before) / before;
+    bool   regression = metric.higherIsBetter ? change < -tolerance : change > tolerance;
+
+    std::cerr << name << ": " << metric.name << " " << before << " -> " << after << " ("
+              << (change >= 0 ? "+" : "") << 100 * change << "%)" << (regression ? " REGRESSION" : "") << "\n";
+    passed = passed && !regression;
+  }
+  return passed;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  std::string scenarioList = "all";
+  std::string outputFile;
+  std::string baselineFile;
+  double tolerance = 0.1;
+  bool list = false;
+  benchmarkOptions options = {10, 1, 1, false, ""};
+
+  CommandLine cmd;
+  cmd.AddValue ("scenarios", "A comma-separated list of scenarios, or all", scenarioList);
+  cmd.AddValue ("list", "Print the names of the scenarios", list);
+  cmd.AddValue ("noBlocks", "The number of generated blocks of every scenario", options.noBlocks);
+  cmd.AddValue ("seed", "The RngSeed of every scenario", options.seed);
+  cmd.AddValue ("run", "The RngRun of every scenario", options.run);
+  cmd.AddValue ("fastLinks", "Deliver the messages through the analytic fast link channel instead of the TCP/IP stack", options.fastLinks);
+  cmd.AddValue ("label", "A label stored in the records, e.g. the commit", options.label);
+  cmd.AddValue ("output", "Append the records to this file instead of printing them to stdout", outputFile);
+  cmd.AddValue ("baseline", "Compare the results against the records of this file", baselineFile);
+  cmd.AddValue ("tolerance", "The relative change of a metric which is reported as a regression", tolerance);
+  cmd.Parse (argc, argv);
+
+  std::vector<benchmarkScenario>  scenarios = GetScenarios ();
+  std::vector<benchmarkScenario>  selected;
+
+  if (list)
+  {
+    for (auto const &scenario : scenarios)
+      std::cout << scenario.name << "\n";
+    return 0;
+  }
+
+  std::stringstream   names (scenarioList);
+  std::string         name;
+
+  while (std::getline (names, name, ','))
+  {
+    bool found = false;
+
+    for (auto const &scenario : scenarios)
+    {
+      if (name == "all" || scenario.name == name)
+      {
+        selected.push_back (scenario);
+        found = true;
+      }
+    }
+    if (!found && !name.empty ())
+      NS_FATAL_ERROR ("Unknown scenario " << name << ". Use --list to print the scenarios");
+  }
+
+  std::map<std::string, std::string>  baseline;
+  std::ofstream                       file;
+  bool                                passed = true;
+
+  if (!baselineFile.empty ())
+    baseline = ReadBaseline (baselineFile);
+
+  if (!outputFile.empty ())
+  {
+    file.open (outputFile.c_str (), std::ios::out | std::ios::app);
+    if (!file)
+      NS_FATAL_ERROR ("Could not open " << outputFile);
+  }
+
+  std::ostream &output = outputFile.empty () ? std::cout : file;
+
+  for (auto const &scenario : selected)
+  {
+    rapidjson::Document                         record;
+    rapidjson::StringBuffer                     buffer;
+    rapidjson::Writer<rapidjson::StringBuffer>  writer (buffer);
+
+    std::cerr << "Running " << scenario.name << "...\n";
+
+    bool succeeded = RunChild (scenario, options, record);
+
+    DescribeScenario (scenario, options, record);
+    if (!succeeded)
+    {
+      record.AddMember ("failed", true, record.GetAllocator ());
+      std::cerr << scenario.name << ": FAILED\n";
+      passed = false;
+    }
+    else if (!baselineFile.empty ())
+      passed = CompareWithBaseline (record, baseline, tolerance) && passed;
+
+    record.Accept (writer);
+    output << buffer.GetString () << std::endl;
+  }
+
+  return passed ? 0 : 1;
+}
+
+
+double get_wall_time()
+{
+    struct timeval time;
+    if (gettimeofday(&time,NULL)){
+        //  Handle error
+        return 0;
+    }
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
@@ -15,6 +15,7 @@
  */
 
 #include <fstream>
+#include <sstream>
 #include <time.h>
 #include <sys/time.h>
 #include "ns3/core-module.h"
@@ -34,8 +35,9 @@ using namespace ns3;
 
 double get_wall_time();
 int GetNodeIdByIpv4 (Ipv4InterfaceContainer container, Ipv4Address addr);
-void PrintStatsForEachNode (nodeStatistics *stats, int totalNodes);
-void PrintTotalStats (nodeStatistics *stats, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes, bool relayNetwork);
+void PrintStatsForEachNode (Ptr<NodeStatsRegistry> stats, int totalNodes);
+void PrintTotalStats (const statsSummary &summary, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes, bool relayNetwork);
+void PrintSketch (const char *name, const quantileSketch &sketch, double scale);
 void PrintBitcoinRegionStats (uint32_t *bitcoinNodesRegions, uint32_t totalNodes);
 
 NS_LOG_COMPONENT_DEFINE ("MyMpiTest");
@@ -54,6 +56,23 @@ main (int argc, char *argv[])
   bool sendheaders = false;
   bool blockTorrent = false;
   bool spv = false;
+  bool binaryCodec = false;
+  std::string linkDiscipline = "Fifo";
+  std::string blockTimes = "Geometric";
+  std::string blockTimeTrace;
+  bool fastLinks = false;
+  bool summaryStats = false;
+  std::string statsFile;
+  std::string propagationTrace;
+  bool profile = false;
+  int profileTop = 10;
+  std::string networkSamples;
+  double sampleInterval = 60;
+  bool memoryReport = false;
+  double memoryInterval = 0;
+  bool miningOracle = false;
+  bool blockInjector = false;
+  std::string dataset;
   long blockSize = -1;
   int invTimeoutMins = -1;
   int chunkSize = -1;
@@ -70,6 +89,8 @@ main (int argc, char *argv[])
   int totalNoNodes = 16;
   int minConnectionsPerNode = -1;
   int maxConnectionsPerNode = -1;
+  int locationMinConnections = -1;
+  int locationMaxConnections = -1;
   double *minersHash;
   enum BitcoinRegion *minersRegions;
   int noMiners = 16;
@@ -118,7 +139,6 @@ main (int argc, char *argv[])
   std::map<uint32_t, std::map<Ipv4Address, double>>    peersUploadSpeeds;
   std::map<uint32_t, nodeInternetSpeeds>               nodesInternetSpeeds;
   std::vector<uint32_t>                                miners;
-  int                                                  nodesInSystemId0 = 0;
   
   Time::SetResolution (Time::NS);
   
@@ -142,6 +162,25 @@ main (int argc, char *argv[])
   cmd.AddValue ("dogecoin", "Imitate the litecoin network behaviour", dogecoin);
   cmd.AddValue ("blockTorrent", "Enable the BlockTorrent protocol", blockTorrent);
   cmd.AddValue ("spv", "Enable the spv mechanism", spv);
+  cmd.AddValue ("binaryCodec", "Encode the messages with the binary codec instead of JSON", binaryCodec);
+  cmd.AddValue ("linkDiscipline", "The discipline of the nodes' links: Fifo, RoundRobin or FairShare", linkDiscipline);
+  cmd.AddValue ("blockTimes", "The distribution of the block generation times: Exponential, Geometric or Trace", blockTimes);
+  cmd.AddValue ("blockTimeTrace", "The file of the block intervals replayed by the Trace distribution", blockTimeTrace);
+  cmd.AddValue ("fastLinks", "Deliver the messages through the analytic fast link channel instead of the TCP/IP stack", fastLinks);
+  cmd.AddValue ("summaryStats", "Only merge the summaries of the stats of each process, without gathering the stats of every node for the statsFile", summaryStats);
+  cmd.AddValue ("statsFile", "Export the stats of every node to this file, as JSON if it ends with .json and as CSV otherwise", statsFile);
+  cmd.AddValue ("propagationTrace", "Trace the blocks received by every node to <propagationTrace>-<systemId>.bin", propagationTrace);
+  cmd.AddValue ("profile", "Measure the wall time of the handlers of the nodes, count the simulator events and print the profile", profile);
+  cmd.AddValue ("profileTop", "The number of handlers in the profile", profileTop);
+  cmd.AddValue ("networkSamples", "Sample the state of the network to <networkSamples>-<systemId>.csv", networkSamples);
+  cmd.AddValue ("sampleInterval", "The simulated seconds between two samples of the network state", sampleInterval);
+  cmd.AddValue ("memoryReport", "Estimate the memory of the subsystems of the nodes at the end of the run and print the report", memoryReport);
+  cmd.AddValue ("memoryInterval", "The simulated seconds between two measurements of the memory during the run, 0 for none", memoryInterval);
+  cmd.AddValue ("miningOracle", "Draw the blocks of all the miners of a process from a single exponential race", miningOracle);
+  cmd.AddValue ("blockInjector", "Inject the blocks of the miners into ordinary nodes from a single source, without miner applications", blockInjector);
+  cmd.AddValue ("locationMinConnections", "The minimum connections of the locations of the block injector, those of the nodes by default", locationMinConnections);
+  cmd.AddValue ("locationMaxConnections", "The maximum connections of the locations of the block injector, those of the nodes by default", locationMaxConnections);
+  cmd.AddValue ("dataset", "The distribution dataset whose tables replace the built-in latencies, bandwidths and block sizes", dataset);
 
   cmd.Parse(argc, argv);
  
@@ -151,6 +190,30 @@ main (int argc, char *argv[])
 	return 0;
   }
   
+  if (miningOracle && testScalability)
+  {
+    std::cout << "The mining oracle can't be used with the fixed block intervals of the scalability test" << std::endl;
+	return 0;
+  }
+  
+  if (blockInjector && (testScalability || miningOracle || relayNetwork || unsolicitedRelayNetwork))
+  {
+    std::cout << "The block injector can't be used with the scalability test, the mining oracle or the relay network" << std::endl;
+	return 0;
+  }
+  
+  if ((locationMinConnections > 0 || locationMaxConnections > 0) && !blockInjector)
+  {
+    std::cout << "The connections of the locations can only be set with the block injector" << std::endl;
+	return 0;
+  }
+  
+  if ((locationMinConnections > 0) != (locationMaxConnections > 0) || locationMinConnections > locationMaxConnections)
+  {
+    std::cout << "Both locationMinConnections and locationMaxConnections must be set, with the minimum not above the maximum" << std::endl;
+	return 0;
+  }
+  
   if (litecoin && dogecoin)
   {
     std::cout << "You cannot select both litecoin and dogecoin behaviour" << std::endl;
@@ -207,7 +270,7 @@ main (int argc, char *argv[])
 
   averageBlockGenIntervalSeconds = averageBlockGenIntervalMinutes * secsPerMin;
   stop = targetNumberOfBlocks * averageBlockGenIntervalMinutes; //seconds
-  nodeStatistics *stats = new nodeStatistics[totalNoNodes];
+  Ptr<NodeStatsRegistry> stats = Create<NodeStatsRegistry> (totalNoNodes);
   averageBlockGenIntervalMinutes = averageBlockGenIntervalSeconds/secsPerMin;
 
   #ifdef MPI_TEST
@@ -244,10 +307,82 @@ main (int argc, char *argv[])
     std::cout << "You have set both the unsolicited/relayNetwork/unsolicitedRelayNetwork flag\n";
     return 0;
   }
+
+  if (fastLinks && systemCount > 1)
+  {
+    std::cout << "The fastLinks mode requires all the nodes to run in a single process\n";
+    return 0;
+  }
+
+  if (miningOracle && systemCount > 1)
+  {
+    std::cout << "The mining oracle requires all the miners to run in a single process\n";
+    return 0;
+  }
+
+  if (blockInjector && systemCount > 1)
+  {
+    std::cout << "The block injector requires all the nodes to run in a single process\n";
+    return 0;
+  }
   
+  if (dataset != "")
+    SetDistributionDataset (Create<DistributionDataset> (dataset));
+
+  //The locations of the block injector are ordinary nodes, so they don't get the 700-800 connections of the miners
+  int minConnectionsPerMiner = blockInjector ? locationMinConnections : 700;
+  int maxConnectionsPerMiner = blockInjector ? locationMaxConnections : 800;
+
   BitcoinTopologyHelper bitcoinTopologyHelper (systemCount, totalNoNodes, noMiners, minersRegions,
                                                cryptocurrency, minConnectionsPerNode, 
-                                               maxConnectionsPerNode, 5, systemId);
+                                               maxConnectionsPerNode, 5, systemId, fastLinks,
+                                               minConnectionsPerMiner, maxConnectionsPerMiner);
+
+  Ptr<PropagationTrace> blockTrace;
+  if (!propagationTrace.empty())
+  {
+    std::ostringstream traceFileName;
+    traceFileName << propagationTrace << "-" << systemId << ".bin";
+    blockTrace = Create<PropagationTrace> (traceFileName.str());
+  }
+
+  Ptr<SimulationProfiler> profiler;
+  if (profile)
+  {
+    ObjectFactory scheduler;
+
+    scheduler.SetTypeId ("ns3::CountingScheduler");
+    Simulator::SetScheduler (scheduler);
+    profiler = Create<SimulationProfiler> ();
+  }
+
+  Ptr<NetworkStateSampler> networkSampler;
+  if (!networkSamples.empty())
+  {
+    std::ostringstream samplesFileName;
+    samplesFileName << networkSamples << "-" << systemId << ".csv";
+    networkSampler = Create<NetworkStateSampler> (samplesFileName.str(), Seconds (sampleInterval));
+  }
+
+  Ptr<MemoryAccountant> memoryAccountant;
+  if (memoryReport || memoryInterval > 0)
+    memoryAccountant = Create<MemoryAccountant> ();
+
+  Ptr<MiningOracle> oracle;
+  if (miningOracle)
+    oracle = Create<MiningOracle> ();
+
+  Ptr<BlockInjector> injector;
+  if (blockInjector)
+  {
+    injector = Create<BlockInjector> ();
+    injector->SetAverageBlockGenInterval (averageBlockGenIntervalSeconds);
+    injector->SetCryptocurrency (cryptocurrency);
+    if (blockSize != -1)
+      injector->SetFixedBlockSize (blockSize);
+    if (unsolicited)
+      injector->SetBlockBroadcastType (UNSOLICITED);
+  }
 
   // Install stack on Grid
   InternetStackHelper stack;
@@ -279,7 +414,8 @@ main (int argc, char *argv[])
   {
 	Ptr<Node> targetNode = bitcoinTopologyHelper.GetNode (miner);
 	
-	if (systemId == targetNode->GetSystemId())
+	//With the block injector, the miners are ordinary nodes which are installed below
+	if (!injector && systemId == targetNode->GetSystemId())
 	{
       bitcoinMinerHelper.SetAttribute("HashRate", DoubleValue(minersHash[count]));
 	  
@@ -306,11 +442,22 @@ main (int argc, char *argv[])
         if (spv)
           bitcoinMinerHelper.SetAttribute("SPV", BooleanValue(true));
 	  }
+      if (binaryCodec)
+        bitcoinMinerHelper.SetAttribute("MessageCodec", EnumValue(BINARY_CODEC));
+      bitcoinMinerHelper.SetAttribute("LinkDiscipline", StringValue(linkDiscipline));
+      bitcoinMinerHelper.SetAttribute("BlockTimeDistribution", StringValue(blockTimes));
+      bitcoinMinerHelper.SetAttribute("BlockTimeTrace", StringValue(blockTimeTrace));
+      bitcoinMinerHelper.SetFastLinkChannel (bitcoinTopologyHelper.GetFastLinkChannel ());
+      bitcoinMinerHelper.SetPropagationTrace (blockTrace);
+      bitcoinMinerHelper.SetSimulationProfiler (profiler);
+      bitcoinMinerHelper.SetNetworkStateSampler (networkSampler);
+      bitcoinMinerHelper.SetMemoryAccountant (memoryAccountant);
+      bitcoinMinerHelper.SetMiningOracle (oracle);
       bitcoinMinerHelper.SetPeersAddresses (nodesConnections[miner]);
 	  bitcoinMinerHelper.SetPeersDownloadSpeeds (peersDownloadSpeeds[miner]);
 	  bitcoinMinerHelper.SetPeersUploadSpeeds (peersUploadSpeeds[miner]);
 	  bitcoinMinerHelper.SetNodeInternetSpeeds (nodesInternetSpeeds[miner]);
-	  bitcoinMinerHelper.SetNodeStats (&stats[miner]);
+	  bitcoinMinerHelper.SetNodeStats (stats);
       
 	  if(unsolicited)
 	    bitcoinMinerHelper.SetBlockBroadcastType (UNSOLICITED);
@@ -323,9 +470,6 @@ main (int argc, char *argv[])
 /*       std::cout << "SystemId " << systemId << ": Miner " << miner << " with hash power = " << minersHash[count] 
 	            << " and systemId = " << targetNode->GetSystemId() << " was installed in node " 
                 << targetNode->GetId () << std::endl;  */
-	  
-	  if (systemId == 0)
-        nodesInSystemId0++;
 	}				
 	count++;
 	if (testScalability == true)
@@ -349,7 +493,9 @@ main (int argc, char *argv[])
 	if (systemId == targetNode->GetSystemId())
 	{
   
-      if ( std::find(miners.begin(), miners.end(), node.first) == miners.end() )
+      std::vector<uint32_t>::iterator miner = std::find(miners.begin(), miners.end(), node.first);
+
+      if ( miner == miners.end() || injector )
 	  {
 	    if (invTimeoutMins != -1)	 
 	      bitcoinNodeHelper.SetAttribute("InvTimeoutMinutes", TimeValue (Minutes (invTimeoutMins)));
@@ -359,7 +505,7 @@ main (int argc, char *argv[])
 	    bitcoinNodeHelper.SetPeersDownloadSpeeds (peersDownloadSpeeds[node.first]);
 	    bitcoinNodeHelper.SetPeersUploadSpeeds (peersUploadSpeeds[node.first]);
 	    bitcoinNodeHelper.SetNodeInternetSpeeds (nodesInternetSpeeds[node.first]);
-		bitcoinNodeHelper.SetNodeStats (&stats[node.first]);
+		bitcoinNodeHelper.SetNodeStats (stats);
 		
         if (sendheaders)	  
           bitcoinNodeHelper.SetProtocolType(SENDHEADERS);	
@@ -371,17 +517,27 @@ main (int argc, char *argv[])
           if (spv)
             bitcoinNodeHelper.SetAttribute("SPV", BooleanValue(true));
 		}
-	    bitcoinNodes.Add(bitcoinNodeHelper.Install (targetNode));
+        if (binaryCodec)
+          bitcoinNodeHelper.SetAttribute("MessageCodec", EnumValue(BINARY_CODEC));
+        bitcoinNodeHelper.SetAttribute("LinkDiscipline", StringValue(linkDiscipline));
+        bitcoinNodeHelper.SetFastLinkChannel (bitcoinTopologyHelper.GetFastLinkChannel ());
+        bitcoinNodeHelper.SetPropagationTrace (blockTrace);
+        bitcoinNodeHelper.SetSimulationProfiler (profiler);
+        bitcoinNodeHelper.SetNetworkStateSampler (networkSampler);
+        bitcoinNodeHelper.SetMemoryAccountant (memoryAccountant);
+	    ApplicationContainer bitcoinNode = bitcoinNodeHelper.Install (targetNode);
+	    bitcoinNodes.Add(bitcoinNode);
+	    if (miner != miners.end())
+	      injector->AddLocation (DynamicCast<BitcoinNode> (bitcoinNode.Get (0)), minersHash[miner - miners.begin()]);
 /*         std::cout << "SystemId " << systemId << ": Node " << node.first << " with systemId = " << targetNode->GetSystemId() 
 		          << " was installed in node " << targetNode->GetId () <<  std::endl; */
-				  
-	    if (systemId == 0)
-          nodesInSystemId0++;
 	  }	
 	}	  
   }
   bitcoinNodes.Start (Seconds (start));
   bitcoinNodes.Stop (Minutes (stop));
+  if (injector)
+    injector->Start (Seconds (start), Minutes (stop));
   
   if (systemId == 0)
     std::cout << "The applications have been setup.\n";
@@ -392,141 +548,61 @@ main (int argc, char *argv[])
   if (systemId == 0)
     std::cout << "Setup time = " << tStartSimulation - tStart << "s\n";
   Simulator::Stop (Minutes (stop + 0.1));
+  if (profiler)
+    profiler->Start ();
+  if (networkSampler)
+    networkSampler->Start ();
+  if (memoryInterval > 0)
+    memoryAccountant->Start (Seconds (memoryInterval));
   Simulator::Run ();
+  if (profiler)
+    profiler->Stop ();
+  if (memoryAccountant)
+    memoryAccountant->Measure ();
+  if (oracle)
+    std::cout << "The mining oracle of process " << systemId << " dispatched " << oracle->GetNoBlocks () << " blocks with "
+              << oracle->GetNoScheduledEvents () << " mining events.\n";
+  if (injector)
+    std::cout << "The block injector injected " << injector->GetNoBlocks () << " blocks into "
+              << injector->GetNoLocations () << " locations.\n";
   Simulator::Destroy ();
 
-#ifdef MPI_TEST
+  if (blockTrace)
+    blockTrace->Close ();
+  if (networkSampler)
+    networkSampler->Close ();
 
-  int            blocklen[38] = {1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-                                 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
-                                 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1}; 
-  MPI_Aint       disp[38]; 
-  MPI_Datatype   dtypes[38] = {MPI_INT, MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE, MPI_INT, MPI_INT, MPI_INT, MPI_INT, MPI_DOUBLE, MPI_DOUBLE, MPI_DOUBLE, MPI_INT,
-                               MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG,
-                               MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_LONG, MPI_INT, MPI_INT, MPI_INT, MPI_LONG, MPI_LONG, MPI_INT}; 
-  MPI_Datatype   mpi_nodeStatisticsType;
-
-  disp[0] = offsetof(nodeStatistics, nodeId);
-  disp[1] = offsetof(nodeStatistics, meanBlockReceiveTime);
-  disp[2] = offsetof(nodeStatistics, meanBlockPropagationTime);
-  disp[3] = offsetof(nodeStatistics, meanBlockSize);
-  disp[4] = offsetof(nodeStatistics, totalBlocks);
-  disp[5] = offsetof(nodeStatistics, staleBlocks);
-  disp[6] = offsetof(nodeStatistics, miner);
-  disp[7] = offsetof(nodeStatistics, minerGeneratedBlocks);
-  disp[8] = offsetof(nodeStatistics, minerAverageBlockGenInterval);
-  disp[9] = offsetof(nodeStatistics, minerAverageBlockSize);
-  disp[10] = offsetof(nodeStatistics, hashRate);
-  disp[11] = offsetof(nodeStatistics, attackSuccess);
-  disp[12] = offsetof(nodeStatistics, invReceivedBytes);
-  disp[13] = offsetof(nodeStatistics, invSentBytes);
-  disp[14] = offsetof(nodeStatistics, getHeadersReceivedBytes);
-  disp[15] = offsetof(nodeStatistics, getHeadersSentBytes);
-  disp[16] = offsetof(nodeStatistics, headersReceivedBytes);
-  disp[17] = offsetof(nodeStatistics, headersSentBytes);
-  disp[18] = offsetof(nodeStatistics, getDataReceivedBytes);
-  disp[19] = offsetof(nodeStatistics, getDataSentBytes);
-  disp[20] = offsetof(nodeStatistics, blockReceivedBytes);
-  disp[21] = offsetof(nodeStatistics, blockSentBytes);
-  disp[22] = offsetof(nodeStatistics, extInvReceivedBytes);
-  disp[23] = offsetof(nodeStatistics, extInvSentBytes);
-  disp[24] = offsetof(nodeStatistics, extGetHeadersReceivedBytes);
-  disp[25] = offsetof(nodeStatistics, extGetHeadersSentBytes);
-  disp[26] = offsetof(nodeStatistics, extHeadersReceivedBytes);
-  disp[27] = offsetof(nodeStatistics, extHeadersSentBytes);
-  disp[28] = offsetof(nodeStatistics, extGetDataReceivedBytes);
-  disp[29] = offsetof(nodeStatistics, extGetDataSentBytes);
-  disp[30] = offsetof(nodeStatistics, chunkReceivedBytes);
-  disp[31] = offsetof(nodeStatistics, chunkSentBytes);
-  disp[32] = offsetof(nodeStatistics, longestFork);
-  disp[33] = offsetof(nodeStatistics, blocksInForks);
-  disp[34] = offsetof(nodeStatistics, connections);
-  disp[35] = offsetof(nodeStatistics, blockTimeouts);
-  disp[36] = offsetof(nodeStatistics, chunkTimeouts);
-  disp[37] = offsetof(nodeStatistics, minedBlocksInMainChain);
-
-  MPI_Type_create_struct (38, blocklen, disp, dtypes, &mpi_nodeStatisticsType);
-  MPI_Type_commit (&mpi_nodeStatisticsType);
-
-  if (systemId != 0 && systemCount > 1)
+  /**
+   * Each process summarizes the stats of its nodes and the summaries are merged in systemId == 0
+   */
+  StatsAggregator statsAggregator (stats);
+
+  for(int i = 0; i < totalNoNodes; i++)
   {
-    /**
-     * Sent all the systemId stats to systemId == 0
-	 */
-	/* std::cout << "SystemId = " << systemId << "\n"; */
+    Ptr<Node> targetNode = bitcoinTopologyHelper.GetNode (i);
 
-    for(int i = 0; i < totalNoNodes; i++)
-    {
-      Ptr<Node> targetNode = bitcoinTopologyHelper.GetNode (i);
-	
-	  if (systemId == targetNode->GetSystemId())
-	  {
-        MPI_Send(&stats[i], 1, mpi_nodeStatisticsType, 0, 8888, MPI_COMM_WORLD);
-	  }
-    }
+    if (systemId == targetNode->GetSystemId())
+      statsAggregator.AddLocalNode (i);
   }
-  else if (systemId == 0 && systemCount > 1)
-  {
-    int count = nodesInSystemId0;
-	
-	while (count < totalNoNodes)
-	{
-	  MPI_Status status;
-      nodeStatistics recv;
-	  
-	  /* std::cout << "SystemId = " << systemId << "\n"; */
-	  MPI_Recv(&recv, 1, mpi_nodeStatisticsType, MPI_ANY_SOURCE, 8888, MPI_COMM_WORLD, &status);
-    
-/* 	  std::cout << "SystemId 0 received: statistics for node " << recv.nodeId 
-                <<  " from systemId = " << status.MPI_SOURCE << "\n"; */
-      stats[recv.nodeId].nodeId = recv.nodeId;
-      stats[recv.nodeId].meanBlockReceiveTime = recv.meanBlockReceiveTime;
-      stats[recv.nodeId].meanBlockPropagationTime = recv.meanBlockPropagationTime;
-      stats[recv.nodeId].meanBlockSize = recv.meanBlockSize;
-      stats[recv.nodeId].totalBlocks = recv.totalBlocks;
-      stats[recv.nodeId].staleBlocks = recv.staleBlocks;
-      stats[recv.nodeId].miner = recv.miner;
-      stats[recv.nodeId].minerGeneratedBlocks = recv.minerGeneratedBlocks;
-      stats[recv.nodeId].minerAverageBlockGenInterval = recv.minerAverageBlockGenInterval;
-      stats[recv.nodeId].minerAverageBlockSize = recv.minerAverageBlockSize;
-      stats[recv.nodeId].hashRate = recv.hashRate;
-      stats[recv.nodeId].invReceivedBytes = recv.invReceivedBytes;
-      stats[recv.nodeId].invSentBytes = recv.invSentBytes;
-      stats[recv.nodeId].getHeadersReceivedBytes = recv.getHeadersReceivedBytes;
-      stats[recv.nodeId].getHeadersSentBytes = recv.getHeadersSentBytes;
-      stats[recv.nodeId].headersReceivedBytes = recv.headersReceivedBytes;
-      stats[recv.nodeId].headersSentBytes = recv.headersSentBytes;
-      stats[recv.nodeId].getDataReceivedBytes = recv.getDataReceivedBytes;
-      stats[recv.nodeId].getDataSentBytes = recv.getDataSentBytes;
-      stats[recv.nodeId].blockReceivedBytes = recv.blockReceivedBytes;
-      stats[recv.nodeId].blockSentBytes = recv.blockSentBytes;
-      stats[recv.nodeId].extInvReceivedBytes = recv.extInvReceivedBytes;
-      stats[recv.nodeId].extInvSentBytes = recv.extInvSentBytes;
-      stats[recv.nodeId].extGetHeadersReceivedBytes = recv.extGetHeadersReceivedBytes;
-      stats[recv.nodeId].extGetHeadersSentBytes = recv.extGetHeadersSentBytes;
-      stats[recv.nodeId].extHeadersReceivedBytes = recv.extHeadersReceivedBytes;
-      stats[recv.nodeId].extHeadersSentBytes = recv.extHeadersSentBytes;
-      stats[recv.nodeId].extGetDataReceivedBytes = recv.extGetDataReceivedBytes;
-      stats[recv.nodeId].extGetDataSentBytes = recv.extGetDataSentBytes;
-      stats[recv.nodeId].chunkReceivedBytes = recv.chunkReceivedBytes;
-      stats[recv.nodeId].chunkSentBytes = recv.chunkSentBytes;
-      stats[recv.nodeId].longestFork = recv.longestFork;
-      stats[recv.nodeId].blocksInForks = recv.blocksInForks;
-      stats[recv.nodeId].connections = recv.connections;
-      stats[recv.nodeId].blockTimeouts = recv.blockTimeouts;
-      stats[recv.nodeId].chunkTimeouts = recv.chunkTimeouts;
-      stats[recv.nodeId].minedBlocksInMainChain = recv.minedBlocksInMainChain;
-	  count++;
-    }
-  }	  
-#endif
+  statsAggregator.Aggregate (systemId, systemCount, !summaryStats);
+  if (profiler)
+    profiler->Merge (systemId, systemCount);
+  if (memoryAccountant)
+    memoryAccountant->Merge (systemId, systemCount);
 
   if (systemId == 0)
   {
     tFinish=get_wall_time();
 	
     //PrintStatsForEachNode(stats, totalNoNodes);
-    PrintTotalStats(stats, totalNoNodes, tStartSimulation, tFinish, averageBlockGenIntervalMinutes, relayNetwork);
+    if (!statsFile.empty() && (!summaryStats || systemCount == 1))
+      stats->Export (statsFile);
+
+    PrintTotalStats(statsAggregator.GetSummary(), totalNoNodes, tStartSimulation, tFinish, averageBlockGenIntervalMinutes, relayNetwork);
+    if (profiler)
+      profiler->PrintReport (std::cout, profileTop, (stop + 0.1) * secsPerMin);
+    if (memoryAccountant)
+      memoryAccountant->PrintReport (std::cout);
 	
     if(unsolicited)
       std::cout << "The broadcast type was UNSOLICITED.\n";
@@ -552,7 +628,6 @@ main (int argc, char *argv[])
   MpiInterface::Disable ();
 #endif
 
-  delete[] stats;
   return 0;
   
 #else
@@ -581,188 +656,104 @@ int GetNodeIdByIpv4 (Ipv4InterfaceContainer container, Ipv4Address addr)
   return -1; //if not found
 }
 
-void PrintStatsForEachNode (nodeStatistics *stats, int totalNodes)
+void PrintStatsForEachNode (Ptr<NodeStatsRegistry> stats, int totalNodes)
 {
   int secPerMin = 60;
   
   for (int it = 0; it < totalNodes; it++ )
   {
-    std::cout << "\nNode " << stats[it].nodeId << " statistics:\n";
-    std::cout << "Connections = " << stats[it].connections << "\n";
-    std::cout << "Mean Block Receive Time = " << stats[it].meanBlockReceiveTime << " or " 
-              << static_cast<int>(stats[it].meanBlockReceiveTime) / secPerMin << "min and " 
-			  << stats[it].meanBlockReceiveTime - static_cast<int>(stats[it].meanBlockReceiveTime) / secPerMin * secPerMin << "s\n";
-    std::cout << "Mean Block Propagation Time = " << stats[it].meanBlockPropagationTime << "s\n";
-    std::cout << "Mean Block Size = " << stats[it].meanBlockSize << " Bytes\n";
-    std::cout << "Total Blocks = " << stats[it].totalBlocks << "\n";
-    std::cout << "Stale Blocks = " << stats[it].staleBlocks << " (" 
-              << 100. * stats[it].staleBlocks / stats[it].totalBlocks << "%)\n";
-    std::cout << "The size of the longest fork was " << stats[it].longestFork << " blocks\n";
-    std::cout << "There were in total " << stats[it].blocksInForks << " blocks in forks\n";
-    std::cout << "The total received INV messages were " << stats[it].invReceivedBytes << " Bytes\n";
-    std::cout << "The total received GET_HEADERS messages were " << stats[it].getHeadersReceivedBytes << " Bytes\n";
-    std::cout << "The total received HEADERS messages were " << stats[it].headersReceivedBytes << " Bytes\n";
-    std::cout << "The total received GET_DATA messages were " << stats[it].getDataReceivedBytes << " Bytes\n";
-    std::cout << "The total received BLOCK messages were " << stats[it].blockReceivedBytes << " Bytes\n";
-    std::cout << "The total sent INV messages were " << stats[it].invSentBytes << " Bytes\n";
-    std::cout << "The total sent GET_HEADERS messages were " << stats[it].getHeadersSentBytes << " Bytes\n";
-    std::cout << "The total sent HEADERS messages were " << stats[it].headersSentBytes << " Bytes\n";
-    std::cout << "The total sent GET_DATA messages were " << stats[it].getDataSentBytes << " Bytes\n";
-    std::cout << "The total sent BLOCK messages were " << stats[it].blockSentBytes << " Bytes\n";
-    std::cout << "The total received EXT_INV messages were " << stats[it].extInvReceivedBytes << " Bytes\n";
-    std::cout << "The total received EXT_GET_HEADERS messages were " << stats[it].extGetHeadersReceivedBytes << " Bytes\n";
-    std::cout << "The total received EXT_HEADERS messages were " << stats[it].extHeadersReceivedBytes << " Bytes\n";
-    std::cout << "The total received EXT_GET_DATA messages were " << stats[it].extGetDataReceivedBytes << " Bytes\n";
-    std::cout << "The total received CHUNK messages were " << stats[it].chunkReceivedBytes << " Bytes\n";
-    std::cout << "The total sent EXT_INV messages were " << stats[it].extInvSentBytes << " Bytes\n";
-    std::cout << "The total sent EXT_GET_HEADERS messages were " << stats[it].extGetHeadersSentBytes << " Bytes\n";
-    std::cout << "The total sent EXT_HEADERS messages were " << stats[it].extHeadersSentBytes << " Bytes\n";
-    std::cout << "The total sent EXT_GET_DATA messages were " << stats[it].extGetDataSentBytes << " Bytes\n";
-    std::cout << "The total sent CHUNK messages were " << stats[it].chunkSentBytes << " Bytes\n";
-
-    if ( stats[it].miner == 1)
+    std::cout << "\nNode " << it << " statistics:\n";
+    std::cout << "Connections = " << stats->connections[it] << "\n";
+    std::cout << "Mean Block Receive Time = " << stats->meanBlockReceiveTime[it] << " or " 
+              << static_cast<int>(stats->meanBlockReceiveTime[it]) / secPerMin << "min and " 
+			  << stats->meanBlockReceiveTime[it] - static_cast<int>(stats->meanBlockReceiveTime[it]) / secPerMin * secPerMin << "s\n";
+    std::cout << "Mean Block Propagation Time = " << stats->meanBlockPropagationTime[it] << "s\n";
+    std::cout << "Mean Block Size = " << stats->meanBlockSize[it] << " Bytes\n";
+    std::cout << "Total Blocks = " << stats->totalBlocks[it] << "\n";
+    std::cout << "Stale Blocks = " << stats->staleBlocks[it] << " (" 
+              << 100. * stats->staleBlocks[it] / stats->totalBlocks[it] << "%)\n";
+    std::cout << "The size of the longest fork was " << stats->longestFork[it] << " blocks\n";
+    std::cout << "There were in total " << stats->blocksInForks[it] << " blocks in forks\n";
+    std::cout << "The total received INV messages were " << stats->invReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received GET_HEADERS messages were " << stats->getHeadersReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received HEADERS messages were " << stats->headersReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received GET_DATA messages were " << stats->getDataReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received BLOCK messages were " << stats->blockReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total sent INV messages were " << stats->invSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent GET_HEADERS messages were " << stats->getHeadersSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent HEADERS messages were " << stats->headersSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent GET_DATA messages were " << stats->getDataSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent BLOCK messages were " << stats->blockSentBytes[it] << " Bytes\n";
+    std::cout << "The total received EXT_INV messages were " << stats->extInvReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received EXT_GET_HEADERS messages were " << stats->extGetHeadersReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received EXT_HEADERS messages were " << stats->extHeadersReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received EXT_GET_DATA messages were " << stats->extGetDataReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received CHUNK messages were " << stats->chunkReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total sent EXT_INV messages were " << stats->extInvSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent EXT_GET_HEADERS messages were " << stats->extGetHeadersSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent EXT_HEADERS messages were " << stats->extHeadersSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent EXT_GET_DATA messages were " << stats->extGetDataSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent CHUNK messages were " << stats->chunkSentBytes[it] << " Bytes\n";
+
+    if ( stats->miner[it] == 1)
     {
-      std::cout << "The miner " << stats[it].nodeId << " with hash rate = " << stats[it].hashRate*100 << "% generated " << stats[it].minerGeneratedBlocks 
-                << " blocks "<< "(" << 100. * stats[it].minerGeneratedBlocks / (stats[it].totalBlocks - 1)
-                << "%) with average block generation time = " << stats[it].minerAverageBlockGenInterval
-                << "s or " << static_cast<int>(stats[it].minerAverageBlockGenInterval) / secPerMin << "min and " 
-                << stats[it].minerAverageBlockGenInterval - static_cast<int>(stats[it].minerAverageBlockGenInterval) / secPerMin * secPerMin << "s"
-                << " and average size " << stats[it].minerAverageBlockSize << " Bytes\n";
+      std::cout << "The miner " << it << " with hash rate = " << stats->hashRate[it]*100 << "% generated " << stats->minerGeneratedBlocks[it] 
+                << " blocks "<< "(" << 100. * stats->minerGeneratedBlocks[it] / (stats->totalBlocks[it] - 1)
+                << "%) with average block generation time = " << stats->minerAverageBlockGenInterval[it]
+                << "s or " << static_cast<int>(stats->minerAverageBlockGenInterval[it]) / secPerMin << "min and " 
+                << stats->minerAverageBlockGenInterval[it] - static_cast<int>(stats->minerAverageBlockGenInterval[it]) / secPerMin * secPerMin << "s"
+                << " and average size " << stats->minerAverageBlockSize[it] << " Bytes\n";
     }
   }
 }
 
 
-void PrintTotalStats (nodeStatistics *stats, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes, bool relayNetwork)
+void PrintTotalStats (const statsSummary &summary, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes, bool relayNetwork)
 {
   const int  secPerMin = 60;
-  double     meanBlockReceiveTime = 0;
-  double     meanBlockPropagationTime = 0;
-  double     meanMinersBlockPropagationTime = 0;
-  double     meanBlockSize = 0;
-  double     totalBlocks = 0;
-  double     staleBlocks = 0;
-  double     invReceivedBytes = 0;
-  double     invSentBytes = 0;
-  double     getHeadersReceivedBytes = 0;
-  double     getHeadersSentBytes = 0;
-  double     headersReceivedBytes = 0;
-  double     headersSentBytes = 0;
-  double     getDataReceivedBytes = 0;
-  double     getDataSentBytes = 0;
-  double     blockReceivedBytes = 0;
-  double     blockSentBytes = 0;
-  double     extInvReceivedBytes = 0;
-  double     extInvSentBytes = 0;
-  double     extGetHeadersReceivedBytes = 0;
-  double     extGetHeadersSentBytes = 0;
-  double     extHeadersReceivedBytes = 0;
-  double     extHeadersSentBytes = 0;
-  double     extGetDataReceivedBytes = 0;
-  double     extGetDataSentBytes = 0;
-  double     chunkReceivedBytes = 0;
-  double     chunkSentBytes = 0;
-  double     longestFork = 0;
-  double     blocksInForks = 0;
+  double     meanBlockReceiveTime = summary.blockReceiveTimes / summary.totalBlocks;
+  double     meanBlockPropagationTime = summary.blockPropagationTimes / summary.totalBlocks;
+  double     meanMinersBlockPropagationTime = StatsAggregator::GetMean (summary.minersPropagationTimes);
+  double     meanBlockSize = summary.blockSizes / summary.totalBlocks;
+  double     totalBlocks = summary.totalBlocks / totalNodes;
+  double     staleBlocks = summary.staleBlocks / totalNodes;
+  double     invReceivedBytes = summary.invReceivedBytes / totalNodes;
+  double     invSentBytes = summary.invSentBytes / totalNodes;
+  double     getHeadersReceivedBytes = summary.getHeadersReceivedBytes / totalNodes;
+  double     getHeadersSentBytes = summary.getHeadersSentBytes / totalNodes;
+  double     headersReceivedBytes = summary.headersReceivedBytes / totalNodes;
+  double     headersSentBytes = summary.headersSentBytes / totalNodes;
+  double     getDataReceivedBytes = summary.getDataReceivedBytes / totalNodes;
+  double     getDataSentBytes = summary.getDataSentBytes / totalNodes;
+  double     blockReceivedBytes = summary.blockReceivedBytes / totalNodes;
+  double     blockSentBytes = summary.blockSentBytes / totalNodes;
+  double     extInvReceivedBytes = summary.extInvReceivedBytes / totalNodes;
+  double     extInvSentBytes = summary.extInvSentBytes / totalNodes;
+  double     extGetHeadersReceivedBytes = summary.extGetHeadersReceivedBytes / totalNodes;
+  double     extGetHeadersSentBytes = summary.extGetHeadersSentBytes / totalNodes;
+  double     extHeadersReceivedBytes = summary.extHeadersReceivedBytes / totalNodes;
+  double     extHeadersSentBytes = summary.extHeadersSentBytes / totalNodes;
+  double     extGetDataReceivedBytes = summary.extGetDataReceivedBytes / totalNodes;
+  double     extGetDataSentBytes = summary.extGetDataSentBytes / totalNodes;
+  double     chunkReceivedBytes = summary.chunkReceivedBytes / totalNodes;
+  double     chunkSentBytes = summary.chunkSentBytes / totalNodes;
+  double     longestFork = summary.longestForks / totalNodes;
+  double     blocksInForks = summary.blocksInForks / totalNodes;
   double     averageBandwidthPerNode = 0;
-  double     connectionsPerNode = 0;
-  double     connectionsPerMiner = 0;
-  double     download = 0;
-  double     upload = 0;
-
-  uint32_t   nodes = 0;
-  uint32_t   miners = 0;
-  std::vector<double>    propagationTimes;
-  std::vector<double>    minersPropagationTimes;
-  std::vector<double>    downloadBandwidths;
-  std::vector<double>    uploadBandwidths;
-  std::vector<double>    totalBandwidths;
-  std::vector<long>      blockTimeouts;
-  std::vector<long>      chunkTimeouts;
-  
-  for (int it = 0; it < totalNodes; it++ )
-  {
-    meanBlockReceiveTime = meanBlockReceiveTime*totalBlocks/(totalBlocks + stats[it].totalBlocks)
-                         + stats[it].meanBlockReceiveTime*stats[it].totalBlocks/(totalBlocks + stats[it].totalBlocks);
-    meanBlockPropagationTime = meanBlockPropagationTime*totalBlocks/(totalBlocks + stats[it].totalBlocks)
-                         + stats[it].meanBlockPropagationTime*stats[it].totalBlocks/(totalBlocks + stats[it].totalBlocks);
-    meanBlockSize = meanBlockSize*totalBlocks/(totalBlocks + stats[it].totalBlocks)
-                  + stats[it].meanBlockSize*stats[it].totalBlocks/(totalBlocks + stats[it].totalBlocks);
-    totalBlocks += stats[it].totalBlocks;
-    staleBlocks += stats[it].staleBlocks;
-    invReceivedBytes = invReceivedBytes*it/static_cast<double>(it + 1) + stats[it].invReceivedBytes/static_cast<double>(it + 1);
-    invSentBytes = invSentBytes*it/static_cast<double>(it + 1) + stats[it].invSentBytes/static_cast<double>(it + 1);
-    getHeadersReceivedBytes = getHeadersReceivedBytes*it/static_cast<double>(it + 1) + stats[it].getHeadersReceivedBytes/static_cast<double>(it + 1);
-    getHeadersSentBytes = getHeadersSentBytes*it/static_cast<double>(it + 1) + stats[it].getHeadersSentBytes/static_cast<double>(it + 1);
-    headersReceivedBytes = headersReceivedBytes*it/static_cast<double>(it + 1) + stats[it].headersReceivedBytes/static_cast<double>(it + 1);
-    headersSentBytes = headersSentBytes*it/static_cast<double>(it + 1) + stats[it].headersSentBytes/static_cast<double>(it + 1);
-    getDataReceivedBytes = getDataReceivedBytes*it/static_cast<double>(it + 1) + stats[it].getDataReceivedBytes/static_cast<double>(it + 1);
-    getDataSentBytes = getDataSentBytes*it/static_cast<double>(it + 1) + stats[it].getDataSentBytes/static_cast<double>(it + 1);
-    blockReceivedBytes = blockReceivedBytes*it/static_cast<double>(it + 1) + stats[it].blockReceivedBytes/static_cast<double>(it + 1);
-    blockSentBytes = blockSentBytes*it/static_cast<double>(it + 1) + stats[it].blockSentBytes/static_cast<double>(it + 1);
-	extInvReceivedBytes = extInvReceivedBytes*it/static_cast<double>(it + 1) + stats[it].extInvReceivedBytes/static_cast<double>(it + 1);
-    extInvSentBytes = extInvSentBytes*it/static_cast<double>(it + 1) + stats[it].extInvSentBytes/static_cast<double>(it + 1);
-    extGetHeadersReceivedBytes = extGetHeadersReceivedBytes*it/static_cast<double>(it + 1) + stats[it].extGetHeadersReceivedBytes/static_cast<double>(it + 1);
-    extGetHeadersSentBytes = extGetHeadersSentBytes*it/static_cast<double>(it + 1) + stats[it].extGetHeadersSentBytes/static_cast<double>(it + 1);
-    extHeadersReceivedBytes = extHeadersReceivedBytes*it/static_cast<double>(it + 1) + stats[it].extHeadersReceivedBytes/static_cast<double>(it + 1);
-    extHeadersSentBytes = extHeadersSentBytes*it/static_cast<double>(it + 1) + stats[it].extHeadersSentBytes/static_cast<double>(it + 1);
-    extGetDataReceivedBytes = extGetDataReceivedBytes*it/static_cast<double>(it + 1) + stats[it].extGetDataReceivedBytes/static_cast<double>(it + 1);
-    extGetDataSentBytes = extGetDataSentBytes*it/static_cast<double>(it + 1) + stats[it].extGetDataSentBytes/static_cast<double>(it + 1);
-    chunkReceivedBytes = chunkReceivedBytes*it/static_cast<double>(it + 1) + stats[it].chunkReceivedBytes/static_cast<double>(it + 1);
-    chunkSentBytes = chunkSentBytes*it/static_cast<double>(it + 1) + stats[it].chunkSentBytes/static_cast<double>(it + 1);
-    longestFork = longestFork*it/static_cast<double>(it + 1) + stats[it].longestFork/static_cast<double>(it + 1);
-    blocksInForks = blocksInForks*it/static_cast<double>(it + 1) + stats[it].blocksInForks/static_cast<double>(it + 1);
-	
-	propagationTimes.push_back(stats[it].meanBlockPropagationTime);
-
-    download = stats[it].invReceivedBytes + stats[it].getHeadersReceivedBytes + stats[it].headersReceivedBytes
-             + stats[it].getDataReceivedBytes + stats[it].blockReceivedBytes
-             + stats[it].extInvReceivedBytes + stats[it].extGetHeadersReceivedBytes + stats[it].extHeadersReceivedBytes
-             + stats[it].extGetDataReceivedBytes + stats[it].chunkReceivedBytes;
-    upload = stats[it].invSentBytes + stats[it].getHeadersSentBytes + stats[it].headersSentBytes
-           + stats[it].getDataSentBytes + stats[it].blockSentBytes
-           + stats[it].extInvSentBytes + stats[it].extGetHeadersSentBytes + stats[it].extHeadersSentBytes
-           + stats[it].extGetDataSentBytes + stats[it].chunkSentBytes;;
-    download = download / (1000 *(stats[it].totalBlocks - 1) * averageBlockGenIntervalMinutes * secPerMin) * 8;
-    upload = upload / (1000 *(stats[it].totalBlocks - 1) * averageBlockGenIntervalMinutes * secPerMin) * 8;
-    downloadBandwidths.push_back(download);  
-    uploadBandwidths.push_back(upload);     	  
-    totalBandwidths.push_back(download + upload); 
-    blockTimeouts.push_back(stats[it].blockTimeouts);
-    chunkTimeouts.push_back(stats[it].chunkTimeouts);
-
-	if(stats[it].miner == 0)
-    {
-      connectionsPerNode = connectionsPerNode*nodes/static_cast<double>(nodes + 1) + stats[it].connections/static_cast<double>(nodes + 1);
-      nodes++;
-    }
-    else
-    {
-      connectionsPerMiner = connectionsPerMiner*miners/static_cast<double>(miners + 1) + stats[it].connections/static_cast<double>(miners + 1);
-      meanMinersBlockPropagationTime = meanMinersBlockPropagationTime*miners/static_cast<double>(miners + 1) + stats[it].meanBlockPropagationTime/static_cast<double>(miners + 1);
-      minersPropagationTimes.push_back(stats[it].meanBlockPropagationTime);
-      miners++;
-    }
-  }
+  double     connectionsPerNode = summary.nodesConnections / summary.nodes;
+  double     connectionsPerMiner = summary.minersConnections / summary.miners;
+  double     bandwidthScale = 8 / (1000 * averageBlockGenIntervalMinutes * secPerMin); //Bytes/block to Kbps
+  double     median = StatsAggregator::GetPercentile (summary.propagationTimes, .5);
+  double     p_10 = StatsAggregator::GetPercentile (summary.propagationTimes, .1);
+  double     p_25 = StatsAggregator::GetPercentile (summary.propagationTimes, .25);
+  double     p_75 = StatsAggregator::GetPercentile (summary.propagationTimes, .75);
+  double     p_90 = StatsAggregator::GetPercentile (summary.propagationTimes, .9);
+  double     minersMedian = StatsAggregator::GetPercentile (summary.minersPropagationTimes, .5);
   
   averageBandwidthPerNode = invReceivedBytes + invSentBytes + getHeadersReceivedBytes + getHeadersSentBytes + headersReceivedBytes
                           + headersSentBytes + getDataReceivedBytes + getDataSentBytes + blockReceivedBytes + blockSentBytes 
                           + extInvReceivedBytes + extInvSentBytes + extGetHeadersReceivedBytes + extGetHeadersSentBytes + extHeadersReceivedBytes
                           + extHeadersSentBytes + extGetDataReceivedBytes + extGetDataSentBytes + chunkReceivedBytes + chunkSentBytes ;
-				   
-  totalBlocks /= totalNodes;
-  staleBlocks /= totalNodes;
-  sort(propagationTimes.begin(), propagationTimes.end());
-  sort(minersPropagationTimes.begin(), minersPropagationTimes.end());
-  sort(blockTimeouts.begin(), blockTimeouts.end());
-  sort(chunkTimeouts.begin(), chunkTimeouts.end());
-  
-  double median = *(propagationTimes.begin()+propagationTimes.size()/2);
-  double p_10 = *(propagationTimes.begin()+int(propagationTimes.size()*.1));
-  double p_25 = *(propagationTimes.begin()+int(propagationTimes.size()*.25));
-  double p_75 = *(propagationTimes.begin()+int(propagationTimes.size()*.75));
-  double p_90 = *(propagationTimes.begin()+int(propagationTimes.size()*.90));
-  double minersMedian = *(minersPropagationTimes.begin()+int(minersPropagationTimes.size()/2));
   
   std::cout << "\nTotal Stats:\n";
   std::cout << "Average Connections/node = " << connectionsPerNode << "\n";
@@ -850,89 +841,29 @@ void PrintTotalStats (nodeStatistics *stats, int totalNodes, double start, doubl
   std::cout << (finish - start)/ (totalBlocks - 1)<< "s per generated block\n";
   
 
-  std::cout << "\nBlock Propagation Times = [";
-  for(auto it = propagationTimes.begin(); it != propagationTimes.end(); it++)
-  {
-    if (it == propagationTimes.begin())
-      std::cout << *it;
-    else
-      std::cout << ", " << *it ;
-  }
-  std::cout << "]\n" ;
-  
-  std::cout << "\nMiners Block Propagation Times = [";
-  for(auto it = minersPropagationTimes.begin(); it != minersPropagationTimes.end(); it++)
-  {
-    if (it == minersPropagationTimes.begin())
-      std::cout << *it;
-    else
-      std::cout << ", " << *it ;
-  }
-  std::cout << "]\n" ;
-  
-  std::cout << "\nDownload Bandwidths = [";
-  double average = 0;
-  for(auto it = downloadBandwidths.begin(); it != downloadBandwidths.end(); it++)
-  {
-    if (it == downloadBandwidths.begin())
-      std::cout << *it;
-    else
-      std::cout << ", " << *it ;
-    average += *it;
-  }
-  std::cout << "] average = " << average/totalBandwidths.size() << "\n" ;
-  
-  std::cout << "\nUpload Bandwidths = [";
-  average = 0;
-  for(auto it = uploadBandwidths.begin(); it != uploadBandwidths.end(); it++)
-  {
-    if (it == uploadBandwidths.begin())
-      std::cout << *it;
-    else
-      std::cout << ", " << *it ;
-    average += *it;
-  }
-  std::cout << "] average = " << average/totalBandwidths.size() << "\n" ;
-  
-  std::cout << "\nTotal Bandwidths = [";
-  average = 0;
-  for(auto it = totalBandwidths.begin(); it != totalBandwidths.end(); it++)
-  {
-    if (it == totalBandwidths.begin())
-      std::cout << *it;
-    else
-      std::cout << ", " << *it ;
-    average += *it;
-  }
-  std::cout << "] average = " << average/totalBandwidths.size() << "\n" ;
-  
-  std::cout << "\nBlock Timeouts = [";
-  average = 0;
-  for(auto it = blockTimeouts.begin(); it != blockTimeouts.end(); it++)
-  {
-    if (it == blockTimeouts.begin())
-      std::cout << *it;
-    else
-      std::cout << ", " << *it ;
-    average += *it;
-  }
-  std::cout << "] average = " << average/blockTimeouts.size() << "\n" ;
-
-  std::cout << "\nChunk Timeouts = [";
-  average = 0;
-  for(auto it = chunkTimeouts.begin(); it != chunkTimeouts.end(); it++)
-  {
-    if (it == chunkTimeouts.begin())
-      std::cout << *it;
-    else
-      std::cout << ", " << *it ;
-    average += *it;
-  }
-  std::cout << "] average = " << average/chunkTimeouts.size() << "\n" ;
+  std::cout << "\n";
+  PrintSketch ("Block Propagation Times", summary.propagationTimes, 1);
+  PrintSketch ("Miners Block Propagation Times", summary.minersPropagationTimes, 1);
+  PrintSketch ("Download Bandwidths", summary.downloadBytesPerBlock, bandwidthScale);
+  PrintSketch ("Upload Bandwidths", summary.uploadBytesPerBlock, bandwidthScale);
+  PrintSketch ("Total Bandwidths", summary.totalBytesPerBlock, bandwidthScale);
+  PrintSketch ("Block Timeouts", summary.blockTimeouts, 1);
+  PrintSketch ("Chunk Timeouts", summary.chunkTimeouts, 1);
   
   std::cout << "\n";
 }
 
+void PrintSketch (const char *name, const quantileSketch &sketch, double scale)
+{
+  std::cout << name << ": average = " << StatsAggregator::GetMean (sketch) * scale
+            << ", 10% = " << StatsAggregator::GetPercentile (sketch, .1) * scale
+            << ", 25% = " << StatsAggregator::GetPercentile (sketch, .25) * scale
+            << ", median = " << StatsAggregator::GetPercentile (sketch, .5) * scale
+            << ", 75% = " << StatsAggregator::GetPercentile (sketch, .75) * scale
+            << ", 90% = " << StatsAggregator::GetPercentile (sketch, .9) * scale
+            << ", 99% = " << StatsAggregator::GetPercentile (sketch, .99) * scale << "\n";
+}
+
 void PrintBitcoinRegionStats (uint32_t *bitcoinNodesRegions, uint32_t totalNodes)
 {
   uint32_t regions[7] = {0, 0, 0, 0, 0, 0, 0};
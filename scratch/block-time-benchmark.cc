@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Verification benchmark of the BlockTimeSampler. It draws --draws block generation times of a miner with hash rate
+ * --hashRate from each distribution, with the default geometric parameters of the miners, and reports their mean and
+ * standard deviation next to the expected ones, the z-score of the mean and the wall time per draw. All the distributions
+ * are expected to have the mean of the geometric.
+ * The legacy row is the expression which ScheduleNextMiningEvent evaluated before the sampler, as a baseline of the cost.
+ * The trace distribution is measured when --trace is set.
+ */
+
+#include <time.h>
+#include <sys/time.h>
+#include <iomanip>
+#include <cmath>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+double get_wall_time();
+
+NS_LOG_COMPONENT_DEFINE ("BlockTimeBenchmark");
+
+
+/**
+ * The moments of the draws, accumulated with Welford's algorithm
+ */
+typedef struct {
+  double   mean;
+  double   m2;
+  long     count;
+} drawMoments;
+
+void
+AddDraw (drawMoments &moments, double x)
+{
+  moments.count++;
+  double delta = x - moments.mean;
+  moments.mean += delta / moments.count;
+  moments.m2 += delta * (x - moments.mean);
+}
+
+void
+PrintRow (const std::string &name, const drawMoments &moments, double expectedMean, double expectedSd, double seconds)
+{
+  double sd = std::sqrt (moments.m2 / std::max (moments.count - 1, 1L));
+
+  std::cout << std::left << std::setw (14) << name << std::right << std::fixed << std::setprecision (2)
+            << std::setw (12) << moments.mean << std::setw (12) << expectedMean
+            << std::setw (12) << sd;
+
+  if (expectedSd > 0)
+    std::cout << std::setw (12) << expectedSd
+              << std::setw (10) << (moments.mean - expectedMean) / (expectedSd / std::sqrt (moments.count));
+  else
+    std::cout << std::setw (12) << "-" << std::setw (10) << "-";
+
+  std::cout << std::setw (12) << 1e9 * seconds / moments.count << "\n";
+  std::cout.unsetf (std::ios::fixed);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  long noDraws = 10000000;
+  double hashRate = 0.1;
+  double averageBlockGenIntervalSeconds = 10 * 60;
+  std::string trace;
+
+  CommandLine cmd;
+  cmd.AddValue ("draws", "The number of draws of each distribution", noDraws);
+  cmd.AddValue ("hashRate", "The hash rate of the miner", hashRate);
+  cmd.AddValue ("blockInterval", "The average block generation interval of the network in seconds", averageBlockGenIntervalSeconds);
+  cmd.AddValue ("trace", "The file of the block intervals of the trace distribution", trace);
+  cmd.Parse (argc, argv);
+
+  if (noDraws < 2 || !(hashRate > 0 && hashRate <= 1) || !(averageBlockGenIntervalSeconds > 0))
+  {
+    std::cout << "draws must be at least 2, hashRate in (0, 1] and blockInterval positive" << std::endl;
+    return 0;
+  }
+
+  //The defaults of BitcoinMiner::StartApplication and ScheduleNextMiningEvent
+  const double secondsPerMin = 60;
+  const double blockGenBinSize = 1. / secondsPerMin / 1000;
+  const double blockGenParameter = 0.19 * blockGenBinSize / 2;
+  const double binSeconds = blockGenBinSize * secondsPerMin * (averageBlockGenIntervalSeconds / (10 * secondsPerMin)) / hashRate;
+
+  std::cout << "bin = " << binSeconds << "s, parameter = " << blockGenParameter << ", " << noDraws << " draws\n"
+            << std::left << std::setw (14) << "distribution" << std::right << std::setw (12) << "mean (s)"
+            << std::setw (12) << "expected" << std::setw (12) << "sd (s)" << std::setw (12) << "expected"
+            << std::setw (10) << "z" << std::setw (12) << "ns/draw" << "\n";
+
+  //The legacy expression, with a stream and a distribution of its own
+  {
+    RandomStream                       generator (RNG_BLOCK_GENERATION, 0);
+    std::geometric_distribution<int>   distribution (blockGenParameter);
+    drawMoments                        moments = {0, 0, 0};
+    double                             start = get_wall_time ();
+
+    for (long i = 0; i < noDraws; i++)
+      AddDraw (moments, distribution (generator) * blockGenBinSize * secondsPerMin
+                        * (averageBlockGenIntervalSeconds / (10 * secondsPerMin)) / hashRate);
+
+    double elapsed = get_wall_time () - start;
+    double expectedMean = (1 - blockGenParameter) / blockGenParameter * binSeconds;
+    double expectedSd = std::sqrt (1 - blockGenParameter) / blockGenParameter * binSeconds;
+    PrintRow ("legacy", moments, expectedMean, expectedSd, elapsed);
+  }
+
+  enum BlockTimeDistribution distributions[] = {BLOCK_TIME_EXPONENTIAL, BLOCK_TIME_GEOMETRIC, BLOCK_TIME_TRACE};
+  const char                *names[] = {"exponential", "geometric", "trace"};
+
+  for (int d = 0; d < 3; d++)
+  {
+    if (distributions[d] == BLOCK_TIME_TRACE && trace.empty ())
+      continue;
+
+    BlockTimeSampler sampler;
+    sampler.SetStream (0);
+    sampler.SetDistribution (distributions[d]);
+    if (distributions[d] == BLOCK_TIME_TRACE)
+      sampler.SetTrace (trace);
+    sampler.SetParameters (binSeconds, blockGenParameter);
+
+    drawMoments moments = {0, 0, 0};
+    double      start = get_wall_time ();
+
+    for (long i = 0; i < noDraws; i++)
+      AddDraw (moments, sampler.Draw ());
+
+    double elapsed = get_wall_time () - start;
+    double expectedMean = (1 - blockGenParameter) / blockGenParameter * binSeconds;
+    double expectedSd = 0;
+
+    if (distributions[d] == BLOCK_TIME_EXPONENTIAL)
+      expectedSd = expectedMean;
+    else if (distributions[d] == BLOCK_TIME_GEOMETRIC)
+      expectedSd = std::sqrt (1 - blockGenParameter) / blockGenParameter * binSeconds;
+    PrintRow (names[d], moments, expectedMean, expectedSd, elapsed);
+  }
+
+  return 0;
+}
+
+
+double get_wall_time()
+{
+    struct timeval time;
+    if (gettimeofday(&time,NULL)){
+        //  Handle error
+        return 0;
+    }
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
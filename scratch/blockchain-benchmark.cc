@@ -0,0 +1,423 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Microbenchmark of the Blockchain lookups which run on every INV/HEADERS message.
+ * It compares the hash-indexed Blockchain against the previous vector-of-vectors layout
+ * (LegacyBlockchain below, which keeps the linear scans of the original implementation).
+ * Both are driven by the same sequence of operations, and the results are cross-checked.
+ *
+ * The fork rate is set by staleRate. The last phase extends the chain with blocks which arrive out of order
+ * with probability orphanRate, so they are stored as orphans until their parent arrives, as in ReceivedBlockMessage.
+ */
+
+#include <time.h>
+#include <sys/time.h>
+#include <iomanip>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+double get_wall_time();
+
+NS_LOG_COMPONENT_DEFINE ("BlockchainBenchmark");
+
+
+/**
+ * The Blockchain layout before the hash index: a row per height and a vector of orphans, searched linearly.
+ */
+class LegacyBlockchain
+{
+public:
+  LegacyBlockchain (void)
+  {
+    AddBlock (Block (0, -1, -2, 0, 0, 0, Ipv4Address("0.0.0.0")));
+  }
+
+  bool HasBlock (int height, int minerId) const
+  {
+    if (height >= static_cast<int>(m_blocks.size()))
+      return false;
+
+    for (auto const &block: m_blocks[height])
+    {
+      if (block.GetBlockHeight() == height && block.GetMinerId() == minerId)
+        return true;
+    }
+    return false;
+  }
+
+  bool IsOrphan (int height, int minerId) const
+  {
+    for (auto const &block: m_orphans)
+    {
+      if (block.GetBlockHeight() == height && block.GetMinerId() == minerId)
+        return true;
+    }
+    return false;
+  }
+
+  Block ReturnBlock (int height, int minerId)
+  {
+    if (height < static_cast<int>(m_blocks.size()) && height >= 0)
+    {
+      for (auto const &block: m_blocks[height])
+      {
+        if (block.GetBlockHeight() == height && block.GetMinerId() == minerId)
+          return block;
+      }
+    }
+
+    for (auto const &block: m_orphans)
+    {
+      if (block.GetBlockHeight() == height && block.GetMinerId() == minerId)
+        return block;
+    }
+    return Block(-1, -1, -1, -1, -1, -1, Ipv4Address("0.0.0.0"));
+  }
+
+  const Block* GetParent (const Block &block)
+  {
+    int parentHeight = block.GetBlockHeight() - 1;
+
+    if (parentHeight >= static_cast<int>(m_blocks.size()) || parentHeight < 0)
+      return nullptr;
+
+    for (auto const &parent: m_blocks[parentHeight])
+    {
+      if (block.IsChild(parent))
+        return &parent;
+    }
+    return nullptr;
+  }
+
+  const std::vector<const Block *> GetOrphanChildrenPointers (const Block &newBlock)
+  {
+    std::vector<const Block *> children;
+
+    for (auto const &orphan: m_orphans)
+    {
+      if (newBlock.IsParent(orphan))
+        children.push_back(&orphan);
+    }
+    return children;
+  }
+
+  void AddBlock (const Block &newBlock)
+  {
+    if (newBlock.GetBlockHeight() >= static_cast<int>(m_blocks.size()))
+      m_blocks.resize(newBlock.GetBlockHeight() + 1);
+    m_blocks[newBlock.GetBlockHeight()].push_back(newBlock);
+  }
+
+  void AddOrphan (const Block &newBlock)
+  {
+    m_orphans.push_back(newBlock);
+  }
+
+  void RemoveOrphan (const Block &newBlock)
+  {
+    for (auto block_it = m_orphans.begin(); block_it < m_orphans.end(); block_it++)
+    {
+      if (*block_it == newBlock)
+      {
+        m_orphans.erase(block_it);
+        return;
+      }
+    }
+  }
+
+private:
+  std::vector<std::vector<Block>>    m_blocks;
+  std::vector<Block>                 m_orphans;
+};
+
+
+/**
+ * The operations replayed on both layouts
+ */
+typedef struct {
+  std::vector<Block>    blocks;           //the blocks of the chain, in the order they are added
+  std::vector<Block>    orphans;          //the initial orphans
+  std::vector<Block>    churn;            //pairs (orphan to remove, orphan to add)
+  std::vector<BlockId>  lookups;          //INV lookups, half of them unknown
+  std::vector<Block>    parents;          //blocks whose parent is looked up
+  std::vector<Block>    validated;        //newly validated blocks, whose orphan children are looked up
+  std::vector<Block>    arrivals;         //blocks above the chain, in the order they arrive
+} benchmarkWorkload;
+
+
+benchmarkWorkload
+CreateWorkload (int noBlocks, double staleRate, int noOrphans, int noQueries, int noMiners, int noArrivals, double orphanRate)
+{
+  benchmarkWorkload  workload;
+  std::vector<int>   topMiner(1, -1);
+
+  for (int height = 1; height <= noBlocks; height++)
+  {
+    int minerId = rand() % noMiners;
+    workload.blocks.push_back(Block (height, minerId, topMiner.back(), 0, 0, 0, Ipv4Address("0.0.0.0")));
+
+    if (rand() / static_cast<double>(RAND_MAX) < staleRate)
+      workload.blocks.push_back(Block (height, (minerId + 1) % noMiners, topMiner.back(), 0, 0, 0, Ipv4Address("0.0.0.0")));
+    topMiner.push_back(minerId);
+  }
+
+  /**
+   * Orphans are blocks above the top of the chain, whose parents have not been received yet.
+   */
+  for (int i = 0; i < noOrphans + noQueries / 10; i++)
+  {
+    int height = noBlocks + 2 + rand() % (noOrphans + 1);
+    Block orphan (height, noMiners + i, rand() % noMiners, 0, 0, 0, Ipv4Address("0.0.0.0"));
+
+    if (i < noOrphans)
+      workload.orphans.push_back(orphan);
+    else
+    {
+      workload.churn.push_back(workload.orphans[rand() % workload.orphans.size()]);
+      workload.churn.push_back(orphan);
+    }
+  }
+
+  for (int i = 0; i < noQueries; i++)
+  {
+    const Block &block = workload.blocks[rand() % workload.blocks.size()];
+
+    if (i % 2 == 0)
+      workload.lookups.push_back(block.GetBlockId());
+    else
+      workload.lookups.push_back(BlockId (block.GetBlockHeight() + 2, noMiners + noOrphans + noQueries + i));
+
+    workload.parents.push_back(block);
+
+    if (i % 2 == 0)
+      workload.validated.push_back(block);
+    else
+    {
+      const Block &orphan = workload.orphans[rand() % workload.orphans.size()];
+      workload.validated.push_back(Block (orphan.GetBlockHeight() - 1, orphan.GetParentBlockMinerId(), 0, 0, 0, 0, Ipv4Address("0.0.0.0")));
+    }
+  }
+
+  /**
+   * The arrivals extend the chain in height order. A block arrives late with probability orphanRate,
+   * i.e. it is swapped with one of the next few blocks, which then arrive before their parent.
+   */
+  int arrivalsMiner = noMiners + noOrphans + 2*noQueries;
+  for (int height = noBlocks + 1; height <= noBlocks + noArrivals; height++)
+  {
+    int minerId = arrivalsMiner + height;
+    workload.arrivals.push_back(Block (height, minerId, topMiner.back(), 0, 0, 0, Ipv4Address("0.0.0.0")));
+
+    if (rand() / static_cast<double>(RAND_MAX) < staleRate)
+      workload.arrivals.push_back(Block (height, minerId + noArrivals + 1, topMiner.back(), 0, 0, 0, Ipv4Address("0.0.0.0")));
+    topMiner.push_back(minerId);
+  }
+
+  for (size_t i = 0; i + 1 < workload.arrivals.size(); i++)
+  {
+    if (rand() / static_cast<double>(RAND_MAX) < orphanRate)
+    {
+      size_t later = std::min(workload.arrivals.size() - 1, i + 1 + rand() % 4);
+      std::swap(workload.arrivals[i], workload.arrivals[later]);
+    }
+  }
+
+  return workload;
+}
+
+
+/**
+ * Replays the arrival of a block: it is added to the chain if its parent is known, together with the orphans
+ * it connects, otherwise it is stored as an orphan.
+ *
+ * eturns the number of orphans connected by the block
+ */
+template <typename Chain>
+long
+ReceiveBlock (Chain &chain, const Block &block)
+{
+  if (!chain.HasBlock(block.GetBlockHeight() - 1, block.GetParentBlockMinerId()))
+  {
+    chain.AddOrphan (block);
+    return 0;
+  }
+
+  std::vector<Block> validated (1, block);
+  long               connected = 0;
+
+  chain.AddBlock (block);
+  while (!validated.empty())
+  {
+    Block parent = validated.back();
+    validated.pop_back();
+
+    //Copy the children, since RemoveOrphan invalidates the pointers
+    std::vector<Block> children;
+    for (auto child : chain.GetOrphanChildrenPointers(parent))
+      children.push_back(*child);
+
+    for (auto const &child : children)
+    {
+      chain.RemoveOrphan (child);
+      chain.AddBlock (child);
+      validated.push_back(child);
+      connected++;
+    }
+  }
+  return connected;
+}
+
+
+template <typename Chain>
+void
+RunBenchmark (Chain &chain, const benchmarkWorkload &workload, std::vector<double> &timings, long &checksum)
+{
+  double start;
+
+  checksum = 0;
+
+  start = get_wall_time();
+  for (auto const &block : workload.blocks)
+    chain.AddBlock (block);
+  for (auto const &orphan : workload.orphans)
+    chain.AddOrphan (orphan);
+  timings.push_back(get_wall_time() - start);
+
+  start = get_wall_time();
+  for (auto const &id : workload.lookups)
+  {
+    if (chain.HasBlock(id.GetBlockHeight(), id.GetMinerId()) || chain.IsOrphan(id.GetBlockHeight(), id.GetMinerId()))
+      checksum++;
+  }
+  timings.push_back(get_wall_time() - start);
+
+  start = get_wall_time();
+  for (auto const &id : workload.lookups)
+    checksum += chain.ReturnBlock(id.GetBlockHeight(), id.GetMinerId()).GetParentBlockMinerId();
+  timings.push_back(get_wall_time() - start);
+
+  start = get_wall_time();
+  for (auto const &block : workload.parents)
+  {
+    const Block *parent = chain.GetParent(block);
+    if (parent != nullptr)
+      checksum += parent->GetMinerId();
+  }
+  timings.push_back(get_wall_time() - start);
+
+  start = get_wall_time();
+  for (auto const &block : workload.validated)
+    checksum += chain.GetOrphanChildrenPointers(block).size();
+  timings.push_back(get_wall_time() - start);
+
+  start = get_wall_time();
+  for (size_t i = 0; i < workload.churn.size(); i += 2)
+  {
+    chain.RemoveOrphan (workload.churn[i]);
+    chain.AddOrphan (workload.churn[i + 1]);
+  }
+  timings.push_back(get_wall_time() - start);
+
+  start = get_wall_time();
+  for (auto const &block : workload.arrivals)
+    checksum += ReceiveBlock (chain, block);
+  timings.push_back(get_wall_time() - start);
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int noBlocks = 10000;
+  double staleRate = 0.05;
+  int noOrphans = 1000;
+  int noQueries = 200000;
+  int noMiners = 16;
+  int noArrivals = 10000;
+  double orphanRate = 0.1;
+  int seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("noBlocks", "The height of the benchmark blockchain", noBlocks);
+  cmd.AddValue ("staleRate", "The probability that a height has a sibling block", staleRate);
+  cmd.AddValue ("orphans", "The number of orphan blocks", noOrphans);
+  cmd.AddValue ("queries", "The number of lookups of each kind", noQueries);
+  cmd.AddValue ("miners", "The number of miners", noMiners);
+  cmd.AddValue ("arrivals", "The number of blocks which extend the chain in the out-of-order phase", noArrivals);
+  cmd.AddValue ("orphanRate", "The probability that a block of the out-of-order phase arrives after its children", orphanRate);
+  cmd.AddValue ("seed", "The seed of the workload", seed);
+  cmd.Parse (argc, argv);
+
+  if (noOrphans < 1 || noBlocks < 1 || noQueries < 1 || noArrivals < 1 || noMiners < 2)
+  {
+    std::cout << "noBlocks, orphans, queries and arrivals must be positive and miners must be at least 2" << std::endl;
+    return 0;
+  }
+
+  srand (seed);
+  benchmarkWorkload workload = CreateWorkload (noBlocks, staleRate, noOrphans, noQueries, noMiners, noArrivals, orphanRate);
+
+  Blockchain          blockchain;
+  LegacyBlockchain    legacyBlockchain;
+  std::vector<double> timings;
+  std::vector<double> legacyTimings;
+  long                checksum;
+  long                legacyChecksum;
+
+  RunBenchmark (legacyBlockchain, workload, legacyTimings, legacyChecksum);
+  RunBenchmark (blockchain, workload, timings, checksum);
+
+  const char *phases[] = {"build", "HasBlock || IsOrphan", "ReturnBlock", "GetParent", "GetOrphanChildrenPointers", "orphan churn",
+                          "out-of-order arrivals"};
+  const long  operations[] = {static_cast<long>(workload.blocks.size() + workload.orphans.size()), noQueries, noQueries,
+                              noQueries, noQueries, static_cast<long>(workload.churn.size()),
+                              static_cast<long>(workload.arrivals.size())};
+
+  std::cout << "Blockchain with " << workload.blocks.size() << " blocks and " << noOrphans << " orphans\n"
+            << std::left << std::setw(28) << "phase" << std::right << std::setw(16) << "legacy (ns/op)"
+            << std::setw(16) << "indexed (ns/op)" << std::setw(10) << "speedup" << "\n";
+
+  for (size_t i = 0; i < timings.size(); i++)
+  {
+    std::cout << std::left << std::setw(28) << phases[i] << std::right << std::fixed << std::setprecision(1)
+              << std::setw(16) << legacyTimings[i] * 1e9 / operations[i]
+              << std::setw(16) << timings[i] * 1e9 / operations[i]
+              << std::setw(9) << legacyTimings[i] / std::max(timings[i], 1e-9) << "x\n";
+  }
+
+  if (checksum != legacyChecksum)
+  {
+    std::cout << "The results differ: checksum = " << checksum << ", legacy checksum = " << legacyChecksum << std::endl;
+    return 1;
+  }
+  std::cout << "The results match (checksum = " << checksum << ")" << std::endl;
+
+  return 0;
+}
+
+
+double get_wall_time()
+{
+    struct timeval time;
+    if (gettimeofday(&time,NULL)){
+        //  Handle error
+        return 0;
+    }
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
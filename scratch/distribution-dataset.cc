@@ -0,0 +1,97 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Builds the distribution datasets read by bitcoin-test --dataset. The built-in tables are exported to a CSV file
+ * with --builtin, the CSV file is edited (e.g. the weights of a new crawl replace the bandwidth weights of a region)
+ * and compiled with --compile and --output. The tables of a dataset are listed with --list.
+ */
+
+#include <iomanip>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("DistributionDatasetTool");
+
+
+int
+main (int argc, char *argv[])
+{
+  std::string builtin;
+  std::string compile;
+  std::string output;
+  std::string list;
+
+  CommandLine cmd;
+  cmd.AddValue ("builtin", "Export the built-in tables to this CSV file", builtin);
+  cmd.AddValue ("compile", "Compile this CSV file to the dataset --output", compile);
+  cmd.AddValue ("output", "The dataset file written by --compile", output);
+  cmd.AddValue ("list", "List the tables of this dataset file", list);
+  cmd.Parse (argc, argv);
+
+  if (builtin.empty () && compile.empty () && list.empty ())
+  {
+    std::cout << "Specify --builtin, --compile or --list" << std::endl;
+    return 0;
+  }
+
+  if (!builtin.empty ())
+  {
+    std::map<std::string, std::vector<double>> tables = GetBuiltinDistributionTables ();
+
+    DistributionDataset::WriteCsv (tables, builtin);
+    std::cout << "Exported " << tables.size () << " built-in tables to " << builtin << std::endl;
+  }
+
+  if (!compile.empty ())
+  {
+    if (output.empty ())
+    {
+      std::cout << "Specify the dataset file with --output" << std::endl;
+      return 0;
+    }
+
+    DistributionDataset::Compile (compile, output);
+    std::cout << "Compiled " << compile << " to " << output << std::endl;
+  }
+
+  if (!list.empty ())
+  {
+    Ptr<DistributionDataset> dataset = Create<DistributionDataset> (list);
+    std::map<std::string, std::vector<double>> builtinTables = GetBuiltinDistributionTables ();
+
+    std::cout << std::setw (34) << std::left << "table" << std::right << std::setw (8) << "values"
+              << std::setw (14) << "first" << std::setw (14) << "last" << "  " << "built-in" << std::endl;
+
+    for (auto const &name : dataset->GetTableNames ())
+    {
+      size_t         size;
+      const double  *values = dataset->GetTable (name, size);
+      auto           table = builtinTables.find (name);
+      std::string    status = "new";
+
+      if (table != builtinTables.end ())
+        status = (table->second == std::vector<double> (values, values + size)) ? "same" : "replaced";
+
+      std::cout << std::setw (34) << std::left << name << std::right << std::setw (8) << size
+                << std::setw (14) << values[0] << std::setw (14) << values[size - 1] << "  " << status << std::endl;
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Microbenchmark of the logs of the message path. Every message is decoded, as in HandleRead, and logged with:
+ *   - eager: the message is serialized with MessageToString before the log statement, regardless of the log level
+ *   - lazy: NS_LOG_INFO, which only serializes the message when the level of the component is enabled
+ *   - facade: BITCOIN_MESSAGE_LOG_INFO, which is lazy as well and compiled out with -DBITCOIN_NO_MESSAGE_LOGS
+ * The log component is disabled, as in the simulations. The variants run in turns for --rounds rounds and the fastest
+ * run of each one is reported. Run it from a build with and without -DBITCOIN_NO_MESSAGE_LOGS to compare the facade
+ * against the current logs.
+ */
+
+#include <time.h>
+#include <sys/time.h>
+#include <iomanip>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+double get_wall_time();
+
+NS_LOG_COMPONENT_DEFINE ("MessageLogBenchmark");
+
+
+/**
+ * \return the frames of the messages exchanged for the propagation of a block: INV, GET_HEADERS, HEADERS and GET_DATA
+ */
+std::vector<std::string>
+CreateFrames (enum MessageCodec codec)
+{
+  std::vector<std::string> frames;
+  std::string              blockHash = BlockId (1024, 7).ToString ();
+
+  for (int message : {INV, GET_HEADERS, GET_DATA})
+  {
+    rapidjson::Document d;
+    rapidjson::Value    value (message);
+    rapidjson::Value    array (rapidjson::kArrayType);
+
+    d.SetObject ();
+    d.AddMember ("message", value, d.GetAllocator ());
+    value.SetString ("block");
+    d.AddMember ("type", value, d.GetAllocator ());
+    value.SetString (blockHash.c_str (), blockHash.size (), d.GetAllocator ());
+    array.PushBack (value, d.GetAllocator ());
+    d.AddMember (rapidjson::StringRef (message == INV ? "inv" : "blocks"), array, d.GetAllocator ());
+    frames.push_back (EncodeMessage (d, codec));
+  }
+
+  rapidjson::Document d;
+  rapidjson::Value    value (HEADERS);
+  rapidjson::Value    array (rapidjson::kArrayType);
+  rapidjson::Value    blockInfo (rapidjson::kObjectType);
+
+  d.SetObject ();
+  d.AddMember ("message", value, d.GetAllocator ());
+  value.SetString ("block");
+  d.AddMember ("type", value, d.GetAllocator ());
+  blockInfo.AddMember ("height", 1024, d.GetAllocator ());
+  blockInfo.AddMember ("minerId", 7, d.GetAllocator ());
+  blockInfo.AddMember ("parentBlockMinerId", 3, d.GetAllocator ());
+  blockInfo.AddMember ("size", 458263, d.GetAllocator ());
+  blockInfo.AddMember ("timeCreated", 61234.5, d.GetAllocator ());
+  blockInfo.AddMember ("timeReceived", 61236.25, d.GetAllocator ());
+  array.PushBack (blockInfo, d.GetAllocator ());
+  d.AddMember ("blocks", array, d.GetAllocator ());
+  frames.push_back (EncodeMessage (d, codec));
+
+  return frames;
+}
+
+
+/**
+ * \brief Decodes noMessages frames and logs each one as the variant does
+ * \return the wall time in seconds
+ */
+double
+RunVariant (int variant, const std::vector<std::string> &frames, enum MessageCodec codec, int noMessages, long &checksum)
+{
+  double start = get_wall_time ();
+
+  for (int i = 0; i < noMessages; i++)
+  {
+    const std::string   &frame = frames[i % frames.size ()];
+    rapidjson::Document  d;
+
+    DecodeMessage (frame, codec, d);
+    checksum += d["message"].GetInt ();
+
+    switch (variant)
+    {
+      case 1:
+      {
+        std::string info = MessageToString (d);
+        checksum += info.size ();
+        NS_LOG_INFO ("At time " << i << "s bitcoin node 0 received " << frame.size () << " bytes with info = " << info);
+        break;
+      }
+      case 2:
+        NS_LOG_INFO ("At time " << i << "s bitcoin node 0 received " << frame.size () << " bytes with info = " << MessageToString (d));
+        break;
+      case 3:
+        BITCOIN_MESSAGE_LOG_INFO ("At time " << i << "s bitcoin node 0 received " << frame.size () << " bytes with info = " << MessageToString (d));
+        break;
+    }
+  }
+
+  return get_wall_time () - start;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int noMessages = 1000000;
+  int noRounds = 5;
+  bool binaryCodec = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("messages", "The number of decoded messages of each run", noMessages);
+  cmd.AddValue ("rounds", "The number of runs of every variant. The fastest run is reported", noRounds);
+  cmd.AddValue ("binaryCodec", "Encode the messages with the binary codec instead of JSON", binaryCodec);
+  cmd.Parse (argc, argv);
+
+  if (noMessages < 1 || noRounds < 1)
+    NS_FATAL_ERROR ("--messages and --rounds must be positive");
+
+  enum MessageCodec         codec = binaryCodec ? BINARY_CODEC : JSON_CODEC;
+  std::vector<std::string>  frames = CreateFrames (codec);
+  const char               *names[] = {"decode only", "eager", "lazy (NS_LOG_INFO)", "facade (BITCOIN_MESSAGE_LOG_INFO)"};
+  double                    best[4];
+  long                      checksum = 0;
+
+#ifdef BITCOIN_NO_MESSAGE_LOGS
+  std::cout << "The message logs are compiled out (BITCOIN_NO_MESSAGE_LOGS)\n";
+#else
+  std::cout << "The message logs are compiled in\n";
+#endif
+  std::cout << "Codec: " << getMessageCodec (codec) << ", " << noMessages << " messages per run, "
+            << noRounds << " rounds\n\n";
+
+  for (int round = 0; round < noRounds; round++)
+  {
+    for (int variant = 0; variant < 4; variant++)
+    {
+      double elapsed = RunVariant (variant, frames, codec, noMessages, checksum);
+
+      if (round == 0 || elapsed < best[variant])
+        best[variant] = elapsed;
+    }
+  }
+
+  for (int variant = 0; variant < 4; variant++)
+  {
+    std::cout << std::left << std::setw (36) << names[variant] << std::right << std::setw (10)
+              << std::fixed << std::setprecision (1) << 1e9 * best[variant] / noMessages << " ns/message ("
+              << std::setprecision (1) << 1e9 * (best[variant] - best[0]) / noMessages << " ns for the log)\n";
+  }
+
+  std::cout << "\nchecksum = " << checksum << std::endl;
+  return 0;
+}
+
+
+double get_wall_time()
+{
+    struct timeval time;
+    if (gettimeofday(&time,NULL)){
+        //  Handle error
+        return 0;
+    }
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
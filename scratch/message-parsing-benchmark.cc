@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Microbenchmark of the framing and the parsing of the received messages, without a simulation.
+ * Synthetic streams of INV, GET_DATA, BLOCK and CHUNK messages (and a mix of them) are encoded with EncodeMessage,
+ * split into packets of --packetSize Bytes and fed to a ReceiveBuffer. The frames are extracted and decoded
+ * as in BitcoinNode::HandleRead, i.e. Reserve/Commit for every packet, then NextFrame and DecodeMessage.
+ */
+
+#include <time.h>
+#include <sys/time.h>
+#include <cstring>
+#include <iomanip>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+double get_wall_time();
+
+NS_LOG_COMPONENT_DEFINE ("MessageParsingBenchmark");
+
+
+/**
+ * Adds the fields of a block to blockInfo, as in the BLOCK and CHUNK messages of BitcoinNode
+ */
+void
+AddBlockFields (rapidjson::Value &blockInfo, int height, int minerId, rapidjson::Document::AllocatorType &allocator)
+{
+  blockInfo.AddMember ("height", height, allocator);
+  blockInfo.AddMember ("minerId", minerId, allocator);
+  blockInfo.AddMember ("parentBlockMinerId", (minerId + 3) % 16, allocator);
+  blockInfo.AddMember ("size", 458263, allocator);
+  blockInfo.AddMember ("timeCreated", 61234.5 + height, allocator);
+  blockInfo.AddMember ("timeReceived", 61236.25 + height, allocator);
+}
+
+
+/**
+ * \return the frame of an INV or a GET_DATA message advertising or requesting noHashes blocks
+ */
+std::string
+CreateInventoryFrame (enum Messages message, int noHashes, enum MessageCodec codec)
+{
+  rapidjson::Document d;
+  rapidjson::Value    value (message);
+  rapidjson::Value    array (rapidjson::kArrayType);
+
+  d.SetObject ();
+  d.AddMember ("message", value, d.GetAllocator ());
+  value.SetString ("block");
+  d.AddMember ("type", value, d.GetAllocator ());
+
+  for (int i = 0; i < noHashes; i++)
+  {
+    std::string blockHash = BlockId (1024 + i, i % 16).ToString ();
+    value.SetString (blockHash.c_str (), blockHash.size (), d.GetAllocator ());
+    array.PushBack (value, d.GetAllocator ());
+  }
+  if (message == INV)
+    d.AddMember ("inv", array, d.GetAllocator ());
+  else
+    d.AddMember ("blocks", array, d.GetAllocator ());
+
+  return EncodeMessage (d, codec);
+}
+
+
+/**
+ * \return the frame of a BLOCK message with noBlocks blocks
+ */
+std::string
+CreateBlockFrame (int noBlocks, enum MessageCodec codec)
+{
+  rapidjson::Document d;
+  rapidjson::Value    value (BLOCK);
+  rapidjson::Value    array (rapidjson::kArrayType);
+
+  d.SetObject ();
+  d.AddMember ("message", value, d.GetAllocator ());
+  value.SetString ("block");
+  d.AddMember ("type", value, d.GetAllocator ());
+
+  for (int i = 0; i < noBlocks; i++)
+  {
+    rapidjson::Value blockInfo (rapidjson::kObjectType);
+    AddBlockFields (blockInfo, 1024 + i, i % 16, d.GetAllocator ());
+    array.PushBack (blockInfo, d.GetAllocator ());
+  }
+  d.AddMember ("blocks", array, d.GetAllocator ());
+
+  return EncodeMessage (d, codec);
+}
+
+
+/**
+ * \return the frame of a CHUNK message with noChunks chunks, half of them from nodes which have the full block
+ */
+std::string
+CreateChunkFrame (int noChunks, enum MessageCodec codec)
+{
+  rapidjson::Document d;
+  rapidjson::Value    value (CHUNK);
+  rapidjson::Value    array (rapidjson::kArrayType);
+
+  d.SetObject ();
+  d.AddMember ("message", value, d.GetAllocator ());
+  value.SetString ("chunk");
+  d.AddMember ("type", value, d.GetAllocator ());
+
+  for (int i = 0; i < noChunks; i++)
+  {
+    rapidjson::Value chunkInfo (rapidjson::kObjectType);
+    rapidjson::Value requestChunks (rapidjson::kArrayType);
+
+    AddBlockFields (chunkInfo, 1024, 7, d.GetAllocator ());
+    chunkInfo.AddMember ("chunk", i, d.GetAllocator ());
+
+    if (i % 2 == 0)
+    {
+      value = true;
+      chunkInfo.AddMember ("fullBlock", value, d.GetAllocator ());
+    }
+    else
+    {
+      rapidjson::Value availableChunks (rapidjson::kArrayType);
+
+      value = false;
+      chunkInfo.AddMember ("fullBlock", value, d.GetAllocator ());
+      for (int c = 0; c < i; c++)
+      {
+        value = c;
+        availableChunks.PushBack (value, d.GetAllocator ());
+      }
+      chunkInfo.AddMember ("availableChunks", availableChunks, d.GetAllocator ());
+    }
+
+    value = i + 1;
+    requestChunks.PushBack (value, d.GetAllocator ());
+    chunkInfo.AddMember ("requestChunks", requestChunks, d.GetAllocator ());
+    array.PushBack (chunkInfo, d.GetAllocator ());
+  }
+  d.AddMember ("chunks", array, d.GetAllocator ());
+
+  return EncodeMessage (d, codec);
+}
+
+
+/**
+ * Feeds a stream to a ReceiveBuffer in packets of packetSize Bytes and decodes every frame, as in HandleRead
+ *
+ * \returns the number of decoded messages
+ */
+long
+ParseStream (const std::string &stream, uint32_t packetSize, enum MessageCodec codec, long &checksum)
+{
+  ReceiveBuffer receiveBuffer;
+  long          noMessages = 0;
+
+  for (size_t offset = 0; offset < stream.size (); offset += packetSize)
+  {
+    uint32_t    size = std::min (static_cast<size_t>(packetSize), stream.size () - offset);
+    const char *frame;
+    size_t      frameSize;
+
+    memcpy (receiveBuffer.Reserve (size), stream.data () + offset, size);
+    receiveBuffer.Commit (size);
+
+    while (receiveBuffer.NextFrame (codec, frame, frameSize))
+    {
+      rapidjson::Document d;
+
+      if (!DecodeMessage (frame, frameSize, codec, d))
+        NS_FATAL_ERROR ("Corrupted frame at offset " << offset);
+
+      checksum += d["message"].GetInt ();
+      noMessages++;
+    }
+  }
+
+  if (receiveBuffer.GetSize () != 0)
+    NS_FATAL_ERROR ("The stream ends with an incomplete frame of " << receiveBuffer.GetSize () << " Bytes");
+
+  return noMessages;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  int noMessages = 200000;
+  int packetSize = 536;
+  int noEntries = 8;
+  bool binaryCodec = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("messages", "The number of messages of each stream", noMessages);
+  cmd.AddValue ("packetSize", "The size of the received packets in Bytes", packetSize);
+  cmd.AddValue ("entries", "The number of hashes, blocks or chunks per message", noEntries);
+  cmd.AddValue ("binaryCodec", "Encode the messages with the binary codec instead of JSON", binaryCodec);
+  cmd.Parse (argc, argv);
+
+  if (noMessages < 1 || packetSize < 1 || noEntries < 1)
+  {
+    std::cout << "messages, packetSize and entries must be positive" << std::endl;
+    return 0;
+  }
+
+  enum MessageCodec         codec = binaryCodec ? BINARY_CODEC : JSON_CODEC;
+  std::vector<std::string>  frames = {CreateInventoryFrame (INV, noEntries, codec), CreateInventoryFrame (GET_DATA, noEntries, codec),
+                                      CreateBlockFrame (noEntries, codec), CreateChunkFrame (noEntries, codec)};
+  const char               *names[] = {"INV", "GET_DATA", "BLOCK", "CHUNK", "mixed"};
+  long                      checksum = 0;
+
+  std::cout << "Codec: " << getMessageCodec (codec) << ", " << noMessages << " messages per stream, "
+            << packetSize << " Bytes per packet, " << noEntries << " entries per message\n\n"
+            << std::left << std::setw (12) << "stream" << std::right << std::setw (14) << "Bytes/message"
+            << std::setw (14) << "ns/message" << std::setw (10) << "MB/s" << "\n";
+
+  for (size_t type = 0; type <= frames.size (); type++)
+  {
+    std::string stream;
+
+    for (int i = 0; i < noMessages; i++)
+      stream += frames[type < frames.size () ? type : i % frames.size ()];
+
+    double start = get_wall_time ();
+    long   parsed = ParseStream (stream, packetSize, codec, checksum);
+    double elapsed = get_wall_time () - start;
+
+    if (parsed != noMessages)
+    {
+      std::cout << names[type] << ": " << parsed << " messages were parsed instead of " << noMessages << std::endl;
+      return 1;
+    }
+
+    std::cout << std::left << std::setw (12) << names[type] << std::right << std::fixed << std::setprecision (1)
+              << std::setw (14) << static_cast<double>(stream.size ()) / noMessages
+              << std::setw (14) << 1e9 * elapsed / noMessages
+              << std::setw (10) << stream.size () / std::max (elapsed, 1e-9) / 1e6 << "\n";
+  }
+
+  std::cout << "\nchecksum = " << checksum << std::endl;
+  return 0;
+}
+
+
+double get_wall_time()
+{
+    struct timeval time;
+    if (gettimeofday(&time,NULL)){
+        //  Handle error
+        return 0;
+    }
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
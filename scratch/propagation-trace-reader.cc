@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Reads the propagation traces written by bitcoin-test --propagationTrace and prints the time each block
+ * needed to be validated by 50% and 90% of the nodes. The times are measured from the earliest record
+ * of the block, which is the record of its miner when the miner is traced.
+ */
+
+#include <map>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("PropagationTraceReader");
+
+
+/**
+ * The records of a block
+ */
+typedef struct {
+  double                          origin;             // the earliest timeReceived of the block
+  std::map<uint32_t, double>      validated;          // the first validation time of every node
+} tracedBlock;
+
+
+/**
+ * \return the time after origin when a fraction of the nodes had validated the block, or -1 if it was never reached
+ */
+double
+GetCoverageTime (const tracedBlock &block, double fraction, uint32_t noNodes)
+{
+  std::vector<double> times;
+  uint32_t            needed = std::max<uint32_t> (1, static_cast<uint32_t> (std::ceil (fraction * noNodes)));
+
+  if (block.validated.size () < needed)
+    return -1;
+
+  times.reserve (block.validated.size ());
+  for (auto const &node: block.validated)
+    times.push_back (node.second);
+
+  std::nth_element (times.begin (), times.begin () + needed - 1, times.end ());
+  return times[needed - 1] - block.origin;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  std::string files;
+  std::string prefix;
+  int noRanks = 1;
+  int noNodes = 0;
+  bool perBlock = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("files", "A comma-separated list of trace files", files);
+  cmd.AddValue ("prefix", "The --propagationTrace of bitcoin-test, read as <prefix>-<systemId>.bin for every rank", prefix);
+  cmd.AddValue ("ranks", "The number of MPI processes which wrote traces under prefix", noRanks);
+  cmd.AddValue ("nodes", "The total number of nodes. By default, the number of distinct nodes in the traces", noNodes);
+  cmd.AddValue ("perBlock", "Print the coverage times of every block", perBlock);
+  cmd.Parse (argc, argv);
+
+  std::vector<std::string> fileNames;
+  std::stringstream        fileList (files);
+  std::string              fileName;
+
+  while (std::getline (fileList, fileName, ','))
+  {
+    if (!fileName.empty ())
+      fileNames.push_back (fileName);
+  }
+
+  if (!prefix.empty ())
+  {
+    for (int rank = 0; rank < noRanks; rank++)
+    {
+      std::ostringstream name;
+      name << prefix << "-" << rank << ".bin";
+      fileNames.push_back (name.str ());
+    }
+  }
+
+  if (fileNames.empty ())
+  {
+    std::cout << "Specify the traces with --files or --prefix" << std::endl;
+    return 0;
+  }
+
+  std::map<BlockId, tracedBlock>  blocks;
+  std::map<uint32_t, bool>        tracedNodes;
+  uint64_t                        noRecords = 0;
+
+  for (auto const &name: fileNames)
+  {
+    noRecords += PropagationTrace::ReadFile (name, [&blocks, &tracedNodes] (const propagationTraceRecord &record)
+    {
+      auto inserted = blocks.insert (std::make_pair (record.blockId, tracedBlock ()));
+      tracedBlock &block = inserted.first->second;
+
+      if (inserted.second || record.timeReceived < block.origin)
+        block.origin = record.timeReceived;
+      block.validated.insert (std::make_pair (record.nodeId, record.timeValidated));
+      tracedNodes[record.nodeId] = true;
+    });
+  }
+
+  if (noNodes <= 0)
+    noNodes = tracedNodes.size ();
+
+  std::cout << "Read " << noRecords << " records of " << blocks.size () << " blocks from "
+            << fileNames.size () << " files (" << tracedNodes.size () << " traced nodes)" << std::endl;
+
+  if (perBlock)
+    std::cout << std::setw (12) << "block" << std::setw (10) << "nodes" << std::setw (12) << "50% (s)" << std::setw (12) << "90% (s)" << std::endl;
+
+  double   sum50 = 0, sum90 = 0;
+  double   max50 = 0, max90 = 0;
+  int      reached50 = 0, reached90 = 0;
+
+  for (auto const &entry: blocks)
+  {
+    double time50 = GetCoverageTime (entry.second, 0.5, noNodes);
+    double time90 = GetCoverageTime (entry.second, 0.9, noNodes);
+
+    if (time50 >= 0)
+    {
+      sum50 += time50;
+      max50 = std::max (max50, time50);
+      reached50++;
+    }
+    if (time90 >= 0)
+    {
+      sum90 += time90;
+      max90 = std::max (max90, time90);
+      reached90++;
+    }
+
+    if (perBlock)
+      std::cout << std::setw (12) << entry.first.ToString () << std::setw (10) << entry.second.validated.size ()
+                << std::setw (12) << time50 << std::setw (12) << time90 << std::endl;
+  }
+
+  std::cout << "Blocks validated by 50% of the " << noNodes << " nodes: " << reached50 << "/" << blocks.size ();
+  if (reached50 > 0)
+    std::cout << ", mean time = " << sum50 / reached50 << "s, max time = " << max50 << "s";
+  std::cout << std::endl;
+
+  std::cout << "Blocks validated by 90% of the " << noNodes << " nodes: " << reached90 << "/" << blocks.size ();
+  if (reached90 > 0)
+    std::cout << ", mean time = " << sum90 / reached90 << "s, max time = " << max90 << "s";
+  std::cout << std::endl;
+
+  return 0;
+}
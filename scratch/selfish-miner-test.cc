@@ -33,10 +33,10 @@ using namespace ns3;
 
 double get_wall_time();
 int GetNodeIdByIpv4 (Ipv4InterfaceContainer container, Ipv4Address addr);
-void PrintStatsForEachNode (nodeStatistics *stats, int totalNodes);
-void PrintTotalStats (nodeStatistics *stats, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes);
+void PrintStatsForEachNode (Ptr<NodeStatsRegistry> stats, int totalNodes);
+void PrintTotalStats (Ptr<NodeStatsRegistry> stats, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes);
 void PrintBitcoinRegionStats (uint32_t *bitcoinNodesRegions, uint32_t totalNodes);
-void PrintAttackStats (nodeStatistics *stats, int attackerId, double ud, double r);
+void PrintAttackStats (Ptr<NodeStatsRegistry> stats, int attackerId, double ud, double r);
 
 NS_LOG_COMPONENT_DEFINE ("SelfishMinerTest");
 
@@ -89,7 +89,7 @@ main (int argc, char *argv[])
   int  nodesInSystemId0 = 0;
   
   
-  nodeStatistics *stats = new nodeStatistics[totalNoNodes];
+  Ptr<NodeStatsRegistry> stats = Create<NodeStatsRegistry> (totalNoNodes);
 
   srand (1000);
   Time::SetResolution (Time::NS);
@@ -195,7 +195,7 @@ main (int argc, char *argv[])
 		
         bitcoinMinerHelper.SetAttribute("HashRate", DoubleValue(minersHash[count]));
 	    bitcoinMinerHelper.SetPeersAddresses (nodesConnections[miner]);
-	    bitcoinMinerHelper.SetNodeStats (&stats[miner]);
+	    bitcoinMinerHelper.SetNodeStats (stats);
 	    bitcoinMinerHelper.SetPeersDownloadSpeeds (peersDownloadSpeeds[miner]);
 	    bitcoinMinerHelper.SetPeersUploadSpeeds (peersUploadSpeeds[miner]);
 
@@ -262,8 +262,6 @@ main (int argc, char *argv[])
                 << "The number of iterations was " << iterations << ".\n\n";
     }
   }  
-  
-  delete[] stats;  
 
   return 0;
   
@@ -293,85 +291,85 @@ int GetNodeIdByIpv4 (Ipv4InterfaceContainer container, Ipv4Address addr)
   return -1; //if not found
 }
 
-void PrintStatsForEachNode (nodeStatistics *stats, int totalNodes)
+void PrintStatsForEachNode (Ptr<NodeStatsRegistry> stats, int totalNodes)
 {
   int secPerMin = 60;
   
   for (int it = 0; it < totalNodes; it++ )
   {
-    std::cout << "\nNode " << stats[it].nodeId << " statistics:\n";
-    std::cout << "Connections = " << stats[it].connections << "\n";
-    std::cout << "Mean Block Receive Time = " << stats[it].meanBlockReceiveTime << " or " 
-              << static_cast<int>(stats[it].meanBlockReceiveTime) / secPerMin << "min and " 
-			  << stats[it].meanBlockReceiveTime - static_cast<int>(stats[it].meanBlockReceiveTime) / secPerMin * secPerMin << "s\n";
-    std::cout << "Mean Block Propagation Time = " << stats[it].meanBlockPropagationTime << "s\n";
-    std::cout << "Mean Block Size = " << stats[it].meanBlockSize << " Bytes\n";
-    std::cout << "Total Blocks = " << stats[it].totalBlocks << "\n";
-    std::cout << "Stale Blocks = " << stats[it].staleBlocks << " (" 
-              << 100. * stats[it].staleBlocks / stats[it].totalBlocks << "%)\n";
-    std::cout << "The size of the longest fork was " << stats[it].longestFork << " blocks\n";
-    std::cout << "There were in total " << stats[it].blocksInForks << " blocks in forks\n";
-    std::cout << "The total received INV messages were " << stats[it].invReceivedBytes << " Bytes\n";
-    std::cout << "The total received GET_HEADERS messages were " << stats[it].getHeadersReceivedBytes << " Bytes\n";
-    std::cout << "The total received HEADERS messages were " << stats[it].headersReceivedBytes << " Bytes\n";
-    std::cout << "The total received GET_DATA messages were " << stats[it].getDataReceivedBytes << " Bytes\n";
-    std::cout << "The total received BLOCK messages were " << stats[it].blockReceivedBytes << " Bytes\n";
-    std::cout << "The total sent INV messages were " << stats[it].invSentBytes << " Bytes\n";
-    std::cout << "The total sent GET_HEADERS messages were " << stats[it].getHeadersSentBytes << " Bytes\n";
-    std::cout << "The total sent HEADERS messages were " << stats[it].headersSentBytes << " Bytes\n";
-    std::cout << "The total sent GET_DATA messages were " << stats[it].getDataSentBytes << " Bytes\n";
-    std::cout << "The total sent BLOCK messages were " << stats[it].blockSentBytes << " Bytes\n";
-
-
-    if ( stats[it].miner == 1)
+    std::cout << "\nNode " << it << " statistics:\n";
+    std::cout << "Connections = " << stats->connections[it] << "\n";
+    std::cout << "Mean Block Receive Time = " << stats->meanBlockReceiveTime[it] << " or " 
+              << static_cast<int>(stats->meanBlockReceiveTime[it]) / secPerMin << "min and " 
+			  << stats->meanBlockReceiveTime[it] - static_cast<int>(stats->meanBlockReceiveTime[it]) / secPerMin * secPerMin << "s\n";
+    std::cout << "Mean Block Propagation Time = " << stats->meanBlockPropagationTime[it] << "s\n";
+    std::cout << "Mean Block Size = " << stats->meanBlockSize[it] << " Bytes\n";
+    std::cout << "Total Blocks = " << stats->totalBlocks[it] << "\n";
+    std::cout << "Stale Blocks = " << stats->staleBlocks[it] << " (" 
+              << 100. * stats->staleBlocks[it] / stats->totalBlocks[it] << "%)\n";
+    std::cout << "The size of the longest fork was " << stats->longestFork[it] << " blocks\n";
+    std::cout << "There were in total " << stats->blocksInForks[it] << " blocks in forks\n";
+    std::cout << "The total received INV messages were " << stats->invReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received GET_HEADERS messages were " << stats->getHeadersReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received HEADERS messages were " << stats->headersReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received GET_DATA messages were " << stats->getDataReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total received BLOCK messages were " << stats->blockReceivedBytes[it] << " Bytes\n";
+    std::cout << "The total sent INV messages were " << stats->invSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent GET_HEADERS messages were " << stats->getHeadersSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent HEADERS messages were " << stats->headersSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent GET_DATA messages were " << stats->getDataSentBytes[it] << " Bytes\n";
+    std::cout << "The total sent BLOCK messages were " << stats->blockSentBytes[it] << " Bytes\n";
+
+
+    if ( stats->miner[it] == 1)
     {
-      std::cout << "The miner " << stats[it].nodeId << " with hash rate = " << stats[it].hashRate*100 << "% generated " << stats[it].minerGeneratedBlocks 
-                << " blocks "<< "(" << 100. * stats[it].minerGeneratedBlocks / (stats[it].totalBlocks - 1)
-                << "%) with average block generation time = " << stats[it].minerAverageBlockGenInterval
-                << "s or " << static_cast<int>(stats[it].minerAverageBlockGenInterval) / secPerMin << "min and " 
-                << stats[it].minerAverageBlockGenInterval - static_cast<int>(stats[it].minerAverageBlockGenInterval) / secPerMin * secPerMin << "s"
-                << " and average size " << stats[it].minerAverageBlockSize << " Bytes\n";
+      std::cout << "The miner " << it << " with hash rate = " << stats->hashRate[it]*100 << "% generated " << stats->minerGeneratedBlocks[it] 
+                << " blocks "<< "(" << 100. * stats->minerGeneratedBlocks[it] / (stats->totalBlocks[it] - 1)
+                << "%) with average block generation time = " << stats->minerAverageBlockGenInterval[it]
+                << "s or " << static_cast<int>(stats->minerAverageBlockGenInterval[it]) / secPerMin << "min and " 
+                << stats->minerAverageBlockGenInterval[it] - static_cast<int>(stats->minerAverageBlockGenInterval[it]) / secPerMin * secPerMin << "s"
+                << " and average size " << stats->minerAverageBlockSize[it] << " Bytes\n";
     }
   }
 }
 
 
-void PrintAttackStats (nodeStatistics *stats, int attackerId, double ud, double r)
+void PrintAttackStats (Ptr<NodeStatsRegistry> stats, int attackerId, double ud, double r)
 {
   int secPerMin = 60;
 
-  std::cout << "\nNode " << stats[attackerId].nodeId << " statistics:\n";
-  std::cout << "Connections = " << stats[attackerId].connections << "\n";
-  std::cout << "Mean Block Receive Time = " << stats[attackerId].meanBlockReceiveTime << " or " 
-            << static_cast<int>(stats[attackerId].meanBlockReceiveTime) / secPerMin << "min and " 
-			<< stats[attackerId].meanBlockReceiveTime - static_cast<int>(stats[attackerId].meanBlockReceiveTime) / secPerMin * secPerMin << "s\n";
-  std::cout << "Mean Block Propagation Time = " << stats[attackerId].meanBlockPropagationTime << "s\n";
-  std::cout << "Mean Block Size = " << stats[attackerId].meanBlockSize << " Bytes\n";
-  std::cout << "Total Blocks = " << stats[attackerId].totalBlocks << "\n";
-  std::cout << "Stale Blocks = " << stats[attackerId].staleBlocks << " (" 
-            << 100. * stats[attackerId].staleBlocks / stats[attackerId].totalBlocks << "%)\n";
-  std::cout << "The size of the longest fork was " << stats[attackerId].longestFork << " blocks\n";
-  std::cout << "There were in total " << stats[attackerId].blocksInForks << " blocks in forks\n";
-  std::cout << "There were " << stats[attackerId].attackSuccess << " successful double-spending attacks.\n";
+  std::cout << "\nNode " << attackerId << " statistics:\n";
+  std::cout << "Connections = " << stats->connections[attackerId] << "\n";
+  std::cout << "Mean Block Receive Time = " << stats->meanBlockReceiveTime[attackerId] << " or " 
+            << static_cast<int>(stats->meanBlockReceiveTime[attackerId]) / secPerMin << "min and " 
+			<< stats->meanBlockReceiveTime[attackerId] - static_cast<int>(stats->meanBlockReceiveTime[attackerId]) / secPerMin * secPerMin << "s\n";
+  std::cout << "Mean Block Propagation Time = " << stats->meanBlockPropagationTime[attackerId] << "s\n";
+  std::cout << "Mean Block Size = " << stats->meanBlockSize[attackerId] << " Bytes\n";
+  std::cout << "Total Blocks = " << stats->totalBlocks[attackerId] << "\n";
+  std::cout << "Stale Blocks = " << stats->staleBlocks[attackerId] << " (" 
+            << 100. * stats->staleBlocks[attackerId] / stats->totalBlocks[attackerId] << "%)\n";
+  std::cout << "The size of the longest fork was " << stats->longestFork[attackerId] << " blocks\n";
+  std::cout << "There were in total " << stats->blocksInForks[attackerId] << " blocks in forks\n";
+  std::cout << "There were " << stats->attackSuccess[attackerId] << " successful double-spending attacks.\n";
 
 
 
-  if (stats[attackerId].miner == 1)
+  if (stats->miner[attackerId] == 1)
   {
-    std::cout << "The miner " << stats[attackerId].nodeId << " with hash rate = " << stats[attackerId].hashRate*100 << "% generated " << stats[attackerId].minerGeneratedBlocks 
-              << " blocks "<< "(" << 100. * stats[attackerId].minerGeneratedBlocks / (stats[attackerId].totalBlocks - 1)
-              << "%) with average block generation time = " << stats[attackerId].minerAverageBlockGenInterval
-              << "s or " << static_cast<int>(stats[attackerId].minerAverageBlockGenInterval) / secPerMin << "min and " 
-              << stats[attackerId].minerAverageBlockGenInterval - static_cast<int>(stats[attackerId].minerAverageBlockGenInterval) / secPerMin * secPerMin << "s"
-              << " and average size " << stats[attackerId].minerAverageBlockSize << " Bytes\n";
+    std::cout << "The miner " << attackerId << " with hash rate = " << stats->hashRate[attackerId]*100 << "% generated " << stats->minerGeneratedBlocks[attackerId] 
+              << " blocks "<< "(" << 100. * stats->minerGeneratedBlocks[attackerId] / (stats->totalBlocks[attackerId] - 1)
+              << "%) with average block generation time = " << stats->minerAverageBlockGenInterval[attackerId]
+              << "s or " << static_cast<int>(stats->minerAverageBlockGenInterval[attackerId]) / secPerMin << "min and " 
+              << stats->minerAverageBlockGenInterval[attackerId] - static_cast<int>(stats->minerAverageBlockGenInterval[attackerId]) / secPerMin * secPerMin << "s"
+              << " and average size " << stats->minerAverageBlockSize[attackerId] << " Bytes\n";
   }
   
-  double increase = (stats[attackerId].attackSuccess * ud + stats[attackerId].minedBlocksInMainChain) /
-                    (stats[attackerId].minerGeneratedBlocks * (1-r));
-  std::cout << "Total Blocks = " << stats[attackerId].totalBlocks << "\n";
-  std::cout << "Mined Blocks in main blockchain = " << stats[attackerId].minedBlocksInMainChain << "\n";
-  std::cout << "Honest Mining Income = " << stats[attackerId].minerGeneratedBlocks * (1-r) << "\n";
-  std::cout << "Attacker Income = " << stats[attackerId].attackSuccess * ud + stats[attackerId].minedBlocksInMainChain << "(";
+  double increase = (stats->attackSuccess[attackerId] * ud + stats->minedBlocksInMainChain[attackerId]) /
+                    (stats->minerGeneratedBlocks[attackerId] * (1-r));
+  std::cout << "Total Blocks = " << stats->totalBlocks[attackerId] << "\n";
+  std::cout << "Mined Blocks in main blockchain = " << stats->minedBlocksInMainChain[attackerId] << "\n";
+  std::cout << "Honest Mining Income = " << stats->minerGeneratedBlocks[attackerId] * (1-r) << "\n";
+  std::cout << "Attacker Income = " << stats->attackSuccess[attackerId] * ud + stats->minedBlocksInMainChain[attackerId] << "(";
   
   if (increase >= 1)
    std::cout << "+" << (increase - 1) * 100 << "%)\n";
@@ -383,7 +381,7 @@ void PrintAttackStats (nodeStatistics *stats, int attackerId, double ud, double
 }
 
 
-void PrintTotalStats (nodeStatistics *stats, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes)
+void PrintTotalStats (Ptr<NodeStatsRegistry> stats, int totalNodes, double start, double finish, double averageBlockGenIntervalMinutes)
 {
   const int  secPerMin = 60;
   double     meanBlockReceiveTime = 0;
@@ -414,39 +412,39 @@ void PrintTotalStats (nodeStatistics *stats, int totalNodes, double start, doubl
 
   for (int it = 0; it < totalNodes; it++ )
   {
-    meanBlockReceiveTime = meanBlockReceiveTime*totalBlocks/(totalBlocks + stats[it].totalBlocks)
-                         + stats[it].meanBlockReceiveTime*stats[it].totalBlocks/(totalBlocks + stats[it].totalBlocks);
-    meanBlockPropagationTime = meanBlockPropagationTime*totalBlocks/(totalBlocks + stats[it].totalBlocks)
-                         + stats[it].meanBlockPropagationTime*stats[it].totalBlocks/(totalBlocks + stats[it].totalBlocks);
-    meanBlockSize = meanBlockSize*totalBlocks/(totalBlocks + stats[it].totalBlocks)
-                  + stats[it].meanBlockSize*stats[it].totalBlocks/(totalBlocks + stats[it].totalBlocks);
-    totalBlocks += stats[it].totalBlocks;
-    staleBlocks += stats[it].staleBlocks;
-    invReceivedBytes = invReceivedBytes*it/static_cast<double>(it + 1) + stats[it].invReceivedBytes/static_cast<double>(it + 1);
-    invSentBytes = invSentBytes*it/static_cast<double>(it + 1) + stats[it].invSentBytes/static_cast<double>(it + 1);
-    getHeadersReceivedBytes = getHeadersReceivedBytes*it/static_cast<double>(it + 1) + stats[it].getHeadersReceivedBytes/static_cast<double>(it + 1);
-    getHeadersSentBytes = getHeadersSentBytes*it/static_cast<double>(it + 1) + stats[it].getHeadersSentBytes/static_cast<double>(it + 1);
-    headersReceivedBytes = headersReceivedBytes*it/static_cast<double>(it + 1) + stats[it].headersReceivedBytes/static_cast<double>(it + 1);
-    headersSentBytes = headersSentBytes*it/static_cast<double>(it + 1) + stats[it].headersSentBytes/static_cast<double>(it + 1);
-    getDataReceivedBytes = getDataReceivedBytes*it/static_cast<double>(it + 1) + stats[it].getDataReceivedBytes/static_cast<double>(it + 1);
-    getDataSentBytes = getDataSentBytes*it/static_cast<double>(it + 1) + stats[it].getDataSentBytes/static_cast<double>(it + 1);
-    blockReceivedBytes = blockReceivedBytes*it/static_cast<double>(it + 1) + stats[it].blockReceivedBytes/static_cast<double>(it + 1);
-    blockSentBytes = blockSentBytes*it/static_cast<double>(it + 1) + stats[it].blockSentBytes/static_cast<double>(it + 1);
-    longestFork = longestFork*it/static_cast<double>(it + 1) + stats[it].longestFork/static_cast<double>(it + 1);
-    blocksInForks = blocksInForks*it/static_cast<double>(it + 1) + stats[it].blocksInForks/static_cast<double>(it + 1);
+    meanBlockReceiveTime = meanBlockReceiveTime*totalBlocks/(totalBlocks + stats->totalBlocks[it])
+                         + stats->meanBlockReceiveTime[it]*stats->totalBlocks[it]/(totalBlocks + stats->totalBlocks[it]);
+    meanBlockPropagationTime = meanBlockPropagationTime*totalBlocks/(totalBlocks + stats->totalBlocks[it])
+                         + stats->meanBlockPropagationTime[it]*stats->totalBlocks[it]/(totalBlocks + stats->totalBlocks[it]);
+    meanBlockSize = meanBlockSize*totalBlocks/(totalBlocks + stats->totalBlocks[it])
+                  + stats->meanBlockSize[it]*stats->totalBlocks[it]/(totalBlocks + stats->totalBlocks[it]);
+    totalBlocks += stats->totalBlocks[it];
+    staleBlocks += stats->staleBlocks[it];
+    invReceivedBytes = invReceivedBytes*it/static_cast<double>(it + 1) + stats->invReceivedBytes[it]/static_cast<double>(it + 1);
+    invSentBytes = invSentBytes*it/static_cast<double>(it + 1) + stats->invSentBytes[it]/static_cast<double>(it + 1);
+    getHeadersReceivedBytes = getHeadersReceivedBytes*it/static_cast<double>(it + 1) + stats->getHeadersReceivedBytes[it]/static_cast<double>(it + 1);
+    getHeadersSentBytes = getHeadersSentBytes*it/static_cast<double>(it + 1) + stats->getHeadersSentBytes[it]/static_cast<double>(it + 1);
+    headersReceivedBytes = headersReceivedBytes*it/static_cast<double>(it + 1) + stats->headersReceivedBytes[it]/static_cast<double>(it + 1);
+    headersSentBytes = headersSentBytes*it/static_cast<double>(it + 1) + stats->headersSentBytes[it]/static_cast<double>(it + 1);
+    getDataReceivedBytes = getDataReceivedBytes*it/static_cast<double>(it + 1) + stats->getDataReceivedBytes[it]/static_cast<double>(it + 1);
+    getDataSentBytes = getDataSentBytes*it/static_cast<double>(it + 1) + stats->getDataSentBytes[it]/static_cast<double>(it + 1);
+    blockReceivedBytes = blockReceivedBytes*it/static_cast<double>(it + 1) + stats->blockReceivedBytes[it]/static_cast<double>(it + 1);
+    blockSentBytes = blockSentBytes*it/static_cast<double>(it + 1) + stats->blockSentBytes[it]/static_cast<double>(it + 1);
+    longestFork = longestFork*it/static_cast<double>(it + 1) + stats->longestFork[it]/static_cast<double>(it + 1);
+    blocksInForks = blocksInForks*it/static_cast<double>(it + 1) + stats->blocksInForks[it]/static_cast<double>(it + 1);
 	
-	propagationTimes.push_back(stats[it].meanBlockPropagationTime);
+	propagationTimes.push_back(stats->meanBlockPropagationTime[it]);
 	
-	if(stats[it].miner == 0)
+	if(stats->miner[it] == 0)
     {
-      connectionsPerNode = connectionsPerNode*nodes/static_cast<double>(nodes + 1) + stats[it].connections/static_cast<double>(nodes + 1);
+      connectionsPerNode = connectionsPerNode*nodes/static_cast<double>(nodes + 1) + stats->connections[it]/static_cast<double>(nodes + 1);
       nodes++;
     }
     else
     {
-      connectionsPerMiner = connectionsPerMiner*miners/static_cast<double>(miners + 1) + stats[it].connections/static_cast<double>(miners + 1);
-      meanMinersBlockPropagationTime = meanMinersBlockPropagationTime*miners/static_cast<double>(miners + 1) + stats[it].meanBlockPropagationTime/static_cast<double>(miners + 1);
-      minersPropagationTimes.push_back(stats[it].meanBlockPropagationTime);
+      connectionsPerMiner = connectionsPerMiner*miners/static_cast<double>(miners + 1) + stats->connections[it]/static_cast<double>(miners + 1);
+      meanMinersBlockPropagationTime = meanMinersBlockPropagationTime*miners/static_cast<double>(miners + 1) + stats->meanBlockPropagationTime[it]/static_cast<double>(miners + 1);
+      minersPropagationTimes.push_back(stats->meanBlockPropagationTime[it]);
       miners++;
     }
   }
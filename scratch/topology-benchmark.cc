@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * Microbenchmark of the peer selection of the BitcoinTopologyHelper. It runs BitcoinTopologyHelper::BuildConnectionsGraph,
+ * the loop which builds the connections graph, for every combination of the node counts of --nodes and the
+ * connection limits of --limits, without creating the ns-3 nodes and links. The miners are chosen randomly and
+ * have the connection limits of the helper (700 - 800 connections).
+ * For each combination it reports the best wall time of --runs runs, the number of edges, the mean degree and
+ * the number of nodes which did not reach their minimum number of connections.
+ */
+
+#include <time.h>
+#include <sys/time.h>
+#include <iomanip>
+#include <algorithm>
+#include <sstream>
+#include "ns3/core-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/point-to-point-layout-module.h"
+
+using namespace ns3;
+
+double get_wall_time();
+
+NS_LOG_COMPONENT_DEFINE ("TopologyBenchmark");
+
+
+/**
+ * \return the values of a comma-separated list, e.g. "1000,10000"
+ */
+std::vector<std::string>
+SplitList (const std::string &list)
+{
+  std::vector<std::string> values;
+  std::istringstream       stream (list);
+  std::string              value;
+
+  while (std::getline (stream, value, ','))
+  {
+    if (!value.empty ())
+      values.push_back (value);
+  }
+  return values;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+  std::string nodesList = "1000,10000,50000";
+  std::string limitsList = "8:125,8:16,4:8";
+  int noMiners = 16;
+  int noRuns = 3;
+  int seed = 1;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "The comma-separated node counts", nodesList);
+  cmd.AddValue ("limits", "The comma-separated connection limits of the nodes, as min:max", limitsList);
+  cmd.AddValue ("miners", "The number of miners", noMiners);
+  cmd.AddValue ("runs", "The number of runs of each combination", noRuns);
+  cmd.AddValue ("seed", "The seed of the random streams", seed);
+  cmd.Parse (argc, argv);
+
+  if (noMiners < 1 || noRuns < 1 || seed < 1)
+  {
+    std::cout << "miners, runs and seed must be positive" << std::endl;
+    return 0;
+  }
+
+  RngSeedManager::SetSeed (seed);
+
+  std::cout << std::left << std::setw (10) << "nodes" << std::setw (10) << "limits" << std::right
+            << std::setw (12) << "edges" << std::setw (12) << "mean degree" << std::setw (12) << "under min"
+            << std::setw (12) << "time (s)" << std::setw (14) << "ns/edge" << "\n";
+
+  for (auto const &nodes : SplitList (nodesList))
+  {
+    uint32_t totalNoNodes = std::stoul (nodes);
+
+    if (totalNoNodes <= static_cast<uint32_t>(noMiners))
+    {
+      std::cout << "The number of nodes (" << totalNoNodes << ") must be greater than the number of miners" << std::endl;
+      return 1;
+    }
+
+    //The miners are chosen once per node count, so all the limits are measured on the same miners
+    std::vector<uint32_t> miners;
+    std::vector<bool>     minerBitmap (totalNoNodes, false);
+    RandomStream          minersStream (RNG_TOPOLOGY_MINERS, 0);
+
+    while (miners.size () < static_cast<size_t>(noMiners))
+    {
+      uint32_t miner = minersStream.GetInteger (totalNoNodes);
+      if (!minerBitmap[miner])
+      {
+        minerBitmap[miner] = true;
+        miners.push_back (miner);
+      }
+    }
+    sort (miners.begin (), miners.end ());
+
+    for (auto const &limits : SplitList (limitsList))
+    {
+      size_t separator = limits.find (':');
+      if (separator == std::string::npos)
+      {
+        std::cout << "The connection limits " << limits << " are not of the form min:max" << std::endl;
+        return 1;
+      }
+
+      int               minConnectionsPerNode = std::stoi (limits.substr (0, separator));
+      int               maxConnectionsPerNode = std::stoi (limits.substr (separator + 1));
+      std::vector<int>  minConnections (totalNoNodes);
+      std::vector<int>  maxConnections (totalNoNodes);
+
+      for (uint32_t i = 0; i < totalNoNodes; i++)
+      {
+        minConnections[i] = minerBitmap[i] ? 700 : minConnectionsPerNode;
+        maxConnections[i] = minerBitmap[i] ? 800 : maxConnectionsPerNode;
+      }
+
+      std::vector<uint32_t> connectionsOffsets;
+      std::vector<uint32_t> connections;
+      uint32_t              noEdges = 0;
+      double                bestTime = 0;
+
+      for (int run = 0; run < noRuns; run++)
+      {
+        RandomStream connectionsStream (RNG_TOPOLOGY_CONNECTIONS, 0);
+        double       start = get_wall_time ();
+
+        noEdges = BitcoinTopologyHelper::BuildConnectionsGraph (miners, minerBitmap, minConnections, maxConnections,
+                                                                connectionsStream, connectionsOffsets, connections);
+
+        double elapsed = get_wall_time () - start;
+        if (run == 0 || elapsed < bestTime)
+          bestTime = elapsed;
+      }
+
+      uint32_t underMin = 0;
+      for (uint32_t i = 0; i < totalNoNodes; i++)
+      {
+        if (static_cast<int>(connectionsOffsets[i + 1] - connectionsOffsets[i]) < minConnections[i])
+          underMin++;
+      }
+
+      std::cout << std::left << std::setw (10) << totalNoNodes << std::setw (10) << limits << std::right
+                << std::setw (12) << noEdges << std::fixed << std::setprecision (2)
+                << std::setw (12) << 2.0 * noEdges / totalNoNodes << std::setw (12) << underMin
+                << std::setprecision (4) << std::setw (12) << bestTime
+                << std::setprecision (1) << std::setw (14) << 1e9 * bestTime / std::max (noEdges, 1u) << "\n";
+    }
+  }
+
+  return 0;
+}
+
+
+double get_wall_time()
+{
+    struct timeval time;
+    if (gettimeofday(&time,NULL)){
+        //  Handle error
+        return 0;
+    }
+    return (double)time.tv_sec + (double)time.tv_usec * .000001;
+}
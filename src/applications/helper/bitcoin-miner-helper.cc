@@ -15,7 +15,7 @@ namespace ns3 {
 
 BitcoinMinerHelper::BitcoinMinerHelper (std::string protocol, Address address, std::vector<Ipv4Address> peers, int noMiners,
                                         std::map<Ipv4Address, double> &peersDownloadSpeeds, std::map<Ipv4Address, double> &peersUploadSpeeds, 
-                                        nodeInternetSpeeds &internetSpeeds, nodeStatistics *stats, double hashRate, double averageBlockGenIntervalSeconds) : 
+                                        nodeInternetSpeeds &internetSpeeds, Ptr<NodeStatsRegistry> stats, double hashRate, double averageBlockGenIntervalSeconds) : 
                                         BitcoinNodeHelper (),  m_minerType (NORMAL_MINER), m_blockBroadcastType (STANDARD),
                                         m_secureBlocks (6), m_blockGenBinSize (-1), m_blockGenParameter (-1)
 {
@@ -48,6 +48,12 @@ BitcoinMinerHelper::InstallPriv (Ptr<Node> node) //FIX ME
         app->SetNodeStats(m_nodeStats);
         app->SetBlockBroadcastType(m_blockBroadcastType);
         app->SetProtocolType(m_protocolType);
+        app->SetFastLinkChannel(m_fastLinkChannel);
+        app->SetPropagationTrace(m_propagationTrace);
+        app->SetSimulationProfiler(m_profiler);
+        app->SetNetworkStateSampler(m_networkSampler);
+        app->SetMemoryAccountant(m_memoryAccountant);
+        app->SetMiningOracle(m_miningOracle);
 
         node->AddApplication (app);
         return app;
@@ -62,6 +68,12 @@ BitcoinMinerHelper::InstallPriv (Ptr<Node> node) //FIX ME
         app->SetNodeStats(m_nodeStats);
         app->SetBlockBroadcastType(m_blockBroadcastType);
         app->SetProtocolType(m_protocolType);
+        app->SetFastLinkChannel(m_fastLinkChannel);
+        app->SetPropagationTrace(m_propagationTrace);
+        app->SetSimulationProfiler(m_profiler);
+        app->SetNetworkStateSampler(m_networkSampler);
+        app->SetMemoryAccountant(m_memoryAccountant);
+        app->SetMiningOracle(m_miningOracle);
 
         node->AddApplication (app);
         return app;
@@ -76,6 +88,12 @@ BitcoinMinerHelper::InstallPriv (Ptr<Node> node) //FIX ME
         app->SetNodeStats(m_nodeStats);
         app->SetBlockBroadcastType(m_blockBroadcastType);
         app->SetProtocolType(m_protocolType);
+        app->SetFastLinkChannel(m_fastLinkChannel);
+        app->SetPropagationTrace(m_propagationTrace);
+        app->SetSimulationProfiler(m_profiler);
+        app->SetNetworkStateSampler(m_networkSampler);
+        app->SetMemoryAccountant(m_memoryAccountant);
+        app->SetMiningOracle(m_miningOracle);
 
         node->AddApplication (app);
         return app;
@@ -90,6 +108,12 @@ BitcoinMinerHelper::InstallPriv (Ptr<Node> node) //FIX ME
         app->SetNodeStats(m_nodeStats);
         app->SetBlockBroadcastType(m_blockBroadcastType);
         app->SetProtocolType(m_protocolType);
+        app->SetFastLinkChannel(m_fastLinkChannel);
+        app->SetPropagationTrace(m_propagationTrace);
+        app->SetSimulationProfiler(m_profiler);
+        app->SetNetworkStateSampler(m_networkSampler);
+        app->SetMemoryAccountant(m_memoryAccountant);
+        app->SetMiningOracle(m_miningOracle);
 
         node->AddApplication (app);
         return app;
@@ -150,6 +174,12 @@ BitcoinMinerHelper::SetBlockBroadcastType (enum BlockBroadcastType m)
   m_blockBroadcastType = m;
 }
 
+void
+BitcoinMinerHelper::SetMiningOracle (Ptr<MiningOracle> miningOracle)
+{
+  m_miningOracle = miningOracle;
+}
+
 
 void 
 BitcoinMinerHelper::SetFactoryAttributes (void)
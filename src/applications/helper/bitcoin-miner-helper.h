@@ -33,18 +33,23 @@ class BitcoinMinerHelper : public BitcoinNodeHelper
    * \param peersDownloadSpeeds a map containing the download speeds of the peers of the node
    * \param peersUploadSpeeds a map containing the upload speeds of the peers of the node
    * \param internetSpeeds a reference to a struct containing the internet speeds of the node
-   * \param stats a pointer to struct holding the node statistics
+   * \param stats the registry holding the statistics of all the nodes
    * \param hashRate the hash rate of the miner
    * \param averageBlockGenIntervalSeconds the average block generation interval in seconds
    */
   BitcoinMinerHelper (std::string protocol, Address address, std::vector<Ipv4Address> peers, int noMiners,
                       std::map<Ipv4Address, double> &peersDownloadSpeeds, std::map<Ipv4Address, double> &peersUploadSpeeds,
-                      nodeInternetSpeeds &internetSpeeds, nodeStatistics *stats, double hashRate, double averageBlockGenIntervalSeconds);
+                      nodeInternetSpeeds &internetSpeeds, Ptr<NodeStatsRegistry> stats, double hashRate, double averageBlockGenIntervalSeconds);
 					  
   enum MinerType GetMinerType(void);
   void SetMinerType (enum MinerType m);
   void SetBlockBroadcastType (enum BlockBroadcastType m);
 
+  /**
+   * \brief Sets the oracle which draws the blocks of the miners, instead of their own mining events
+   */
+  void SetMiningOracle (Ptr<MiningOracle> miningOracle);
+
 protected:
   /**
    * Install an ns3::PacketSink on the node configured with all the
@@ -69,6 +74,7 @@ protected:
   double                    m_blockGenParameter;
   double                    m_averageBlockGenIntervalSeconds;
   uint32_t                  m_secureBlocks;
+  Ptr<MiningOracle>         m_miningOracle;
 };
 
 } // namespace ns3
@@ -12,7 +12,7 @@ namespace ns3 {
 
 BitcoinNodeHelper::BitcoinNodeHelper (std::string protocol, Address address, std::vector<Ipv4Address> &peers, 
                                       std::map<Ipv4Address, double> &peersDownloadSpeeds, std::map<Ipv4Address, double> &peersUploadSpeeds,
-                                      nodeInternetSpeeds &internetSpeeds, nodeStatistics *stats) 
+                                      nodeInternetSpeeds &internetSpeeds, Ptr<NodeStatsRegistry> stats) 
 {
   m_factory.SetTypeId ("ns3::BitcoinNode");
   commonConstructor (protocol, address, peers, peersDownloadSpeeds, peersUploadSpeeds, internetSpeeds, stats);
@@ -25,7 +25,7 @@ BitcoinNodeHelper::BitcoinNodeHelper (void)
 void 
 BitcoinNodeHelper::commonConstructor(std::string protocol, Address address, std::vector<Ipv4Address> &peers, 
                                      std::map<Ipv4Address, double> &peersDownloadSpeeds, std::map<Ipv4Address, double> &peersUploadSpeeds,
-                                     nodeInternetSpeeds &internetSpeeds, nodeStatistics *stats) 
+                                     nodeInternetSpeeds &internetSpeeds, Ptr<NodeStatsRegistry> stats) 
 {
   m_protocol = protocol;
   m_address = address;
@@ -83,6 +83,11 @@ BitcoinNodeHelper::InstallPriv (Ptr<Node> node)
   app->SetNodeInternetSpeeds(m_internetSpeeds);
   app->SetNodeStats(m_nodeStats);
   app->SetProtocolType(m_protocolType);
+  app->SetFastLinkChannel(m_fastLinkChannel);
+  app->SetPropagationTrace(m_propagationTrace);
+  app->SetSimulationProfiler(m_profiler);
+  app->SetNetworkStateSampler(m_networkSampler);
+  app->SetMemoryAccountant(m_memoryAccountant);
 
   node->AddApplication (app);
 
@@ -115,7 +120,7 @@ BitcoinNodeHelper::SetNodeInternetSpeeds (nodeInternetSpeeds &internetSpeeds)
 }
 
 void 
-BitcoinNodeHelper::SetNodeStats (nodeStatistics *nodeStats)
+BitcoinNodeHelper::SetNodeStats (Ptr<NodeStatsRegistry> nodeStats)
 {
   m_nodeStats = nodeStats;
 }
@@ -125,4 +130,34 @@ BitcoinNodeHelper::SetProtocolType (enum ProtocolType protocolType)
 {
   m_protocolType = protocolType;
 }
+
+void 
+BitcoinNodeHelper::SetFastLinkChannel (Ptr<FastLinkChannel> fastLinkChannel)
+{
+  m_fastLinkChannel = fastLinkChannel;
+}
+
+void 
+BitcoinNodeHelper::SetPropagationTrace (Ptr<PropagationTrace> propagationTrace)
+{
+  m_propagationTrace = propagationTrace;
+}
+
+void 
+BitcoinNodeHelper::SetSimulationProfiler (Ptr<SimulationProfiler> profiler)
+{
+  m_profiler = profiler;
+}
+
+void 
+BitcoinNodeHelper::SetNetworkStateSampler (Ptr<NetworkStateSampler> sampler)
+{
+  m_networkSampler = sampler;
+}
+
+void 
+BitcoinNodeHelper::SetMemoryAccountant (Ptr<MemoryAccountant> accountant)
+{
+  m_memoryAccountant = accountant;
+}
 } // namespace ns3
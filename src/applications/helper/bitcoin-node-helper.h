@@ -11,6 +11,12 @@
 #include "ns3/application-container.h"
 #include "ns3/uinteger.h"
 #include "ns3/bitcoin.h"
+#include "ns3/bitcoin-fast-link-channel.h"
+#include "ns3/bitcoin-node-stats.h"
+#include "ns3/bitcoin-propagation-trace.h"
+#include "ns3/bitcoin-profiler.h"
+#include "ns3/bitcoin-network-sampler.h"
+#include "ns3/bitcoin-memory-accountant.h"
 
 namespace ns3 {
 
@@ -33,11 +39,11 @@ public:
    * \param peersDownloadSpeeds a map containing the download speeds of the peers of the node
    * \param peersUploadSpeeds a map containing the upload speeds of the peers of the node
    * \param internetSpeeds a reference to a struct containing the internet speeds of the node
-   * \param stats a pointer to struct holding the node statistics
+   * \param stats the registry holding the statistics of all the nodes
    */
   BitcoinNodeHelper (std::string protocol, Address address, std::vector<Ipv4Address> &peers, 
                      std::map<Ipv4Address, double> &peersDownloadSpeeds, std::map<Ipv4Address, double> &peersUploadSpeeds,
-                     nodeInternetSpeeds &internetSpeeds, nodeStatistics *stats);
+                     nodeInternetSpeeds &internetSpeeds, Ptr<NodeStatsRegistry> stats);
   
   /**
    * Called by subclasses to set a different factory TypeId
@@ -55,11 +61,11 @@ public:
    * \param peersDownloadSpeeds a map containing the download speeds of the peers of the node
    * \param peersUploadSpeeds a map containing the upload speeds of the peers of the node
    * \param internetSpeeds a reference to a struct containing the internet speeds of the node
-   * \param stats a pointer to struct holding the node statistics
+   * \param stats the registry holding the statistics of all the nodes
    */
    void commonConstructor(std::string protocol, Address address, std::vector<Ipv4Address> &peers, 
                           std::map<Ipv4Address, double> &peersDownloadSpeeds, std::map<Ipv4Address, double> &peersUploadSpeeds,
-                          nodeInternetSpeeds &internetSpeeds, nodeStatistics *stats);
+                          nodeInternetSpeeds &internetSpeeds, Ptr<NodeStatsRegistry> stats);
   
   /**
    * Helper function used to set the underlying application attributes.
@@ -104,9 +110,19 @@ public:
   
   void SetNodeInternetSpeeds (nodeInternetSpeeds &internetSpeeds);
 
-  void SetNodeStats (nodeStatistics *nodeStats);
+  void SetNodeStats (Ptr<NodeStatsRegistry> nodeStats);
 
   void SetProtocolType (enum ProtocolType protocolType);
+
+  void SetFastLinkChannel (Ptr<FastLinkChannel> fastLinkChannel);
+
+  void SetPropagationTrace (Ptr<PropagationTrace> propagationTrace);
+
+  void SetSimulationProfiler (Ptr<SimulationProfiler> profiler);
+
+  void SetNetworkStateSampler (Ptr<NetworkStateSampler> sampler);
+
+  void SetMemoryAccountant (Ptr<MemoryAccountant> accountant);
   
 protected:
   /**
@@ -125,8 +141,13 @@ protected:
   std::map<Ipv4Address, double>                       m_peersDownloadSpeeds;  //!< The download speeds of the peers
   std::map<Ipv4Address, double>                       m_peersUploadSpeeds;    //!< The upload speeds of the peers
   nodeInternetSpeeds                                  m_internetSpeeds;       //!< The internet speeds of the node
-  nodeStatistics                                      *m_nodeStats;           //!< The struct holding the node statistics
+  Ptr<NodeStatsRegistry>                              m_nodeStats;            //!< The registry holding the node statistics
   enum ProtocolType									  m_protocolType;         //!< The protocol that the nodes use to advertise new blocks (DEFAULT: STANDARD)
+  Ptr<FastLinkChannel>                                m_fastLinkChannel;      //!< The channel of the fast link mode, null when the TCP/IP stack is used
+  Ptr<PropagationTrace>                               m_propagationTrace;     //!< The trace of the received blocks, null when disabled
+  Ptr<SimulationProfiler>                             m_profiler;             //!< The profiler of the handlers, null when disabled
+  Ptr<NetworkStateSampler>                            m_networkSampler;       //!< The sampler of the network state, null when disabled
+  Ptr<MemoryAccountant>                               m_memoryAccountant;     //!< The accountant of the memory of the nodes, null when disabled
 
 };
 
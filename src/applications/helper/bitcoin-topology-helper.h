@@ -30,10 +30,22 @@
 #include "net-device-container.h"
 #include "ipv4-address-helper-custom.h"
 #include "ns3/bitcoin.h"
+#include "ns3/bitcoin-fast-link-channel.h"
+#include "ns3/bitcoin-random-stream.h"
 #include <random>
 
 namespace ns3 {
 
+/**
+ * The parameters of a link in the fast link mode
+ */
+typedef struct {
+  uint32_t  node1;
+  uint32_t  node2;
+  double    latency;      // in ms
+  double    bandwidth;    // in Mbps
+} fastLinkParameters;
+
 /**
  * \ingroup point-to-point-layout
  *
@@ -54,10 +66,15 @@ public:
    * \param pointToPoint the PointToPointHelper which is used 
    *                     to connect all of the nodes together 
    *                     in the grid
+   *
+   * \param minConnectionsPerMiner the minimum connections of the miners. If it or maxConnectionsPerMiner
+   *                               is not positive, the miners are connected as the other nodes, without
+   *                               the links between the miners
    */
   BitcoinTopologyHelper (uint32_t noCpus, uint32_t totalNoNodes, uint32_t noMiners, enum BitcoinRegion *minersRegions,
                          enum Cryptocurrency cryptocurrency, int minConnectionsPerNode, int maxConnectionsPerNode, 
-                         double latencyParetoShapeDivider, uint32_t systemId);
+                         double latencyParetoShapeDivider, uint32_t systemId, bool fastLinks = false,
+                         int minConnectionsPerMiner = 700, int maxConnectionsPerMiner = 800);
 
   ~BitcoinTopologyHelper ();
 
@@ -135,10 +152,34 @@ public:
 
    std::map<uint32_t, nodeInternetSpeeds> GetNodesInternetSpeeds (void) const;
 
+   /**
+    * Get the channel of the fast link mode. It is created by AssignIpv4Addresses and it is null when the point-to-point links are used
+    */
+   Ptr<FastLinkChannel> GetFastLinkChannel (void) const;
+
+   /**
+    * Builds the connections graph: the miners are fully interconnected and then every node, the miners first,
+    * picks random peers until it has minConnections[i] connections, without exceeding the maxConnections of its peers.
+    * It is the peer selection of the constructor, without the rest of the topology, so it can be benchmarked on its own.
+    *
+    * \param connectionsOffsets the offsets of the peers of each node in connections (CSR), of size totalNoNodes + 1
+    * \param connections the peers of all the nodes
+    * \returns the number of edges
+    */
+   static uint32_t BuildConnectionsGraph (const std::vector<uint32_t> &miners, const std::vector<bool> &minerBitmap,
+                                          const std::vector<int> &minConnections, const std::vector<int> &maxConnections,
+                                          RandomStream &stream, std::vector<uint32_t> &connectionsOffsets,
+                                          std::vector<uint32_t> &connections);
+
 private:
 
   void AssignRegion (uint32_t id);
   void AssignInternetSpeeds(uint32_t id);
+
+  /**
+   * \returns the latency of the link between two nodes in ms, according to their regions
+   */
+  double GetLinkLatency (uint32_t node1, uint32_t node2);
   
   uint32_t     m_totalNoNodes;                  //!< The total number of nodes
   uint32_t     m_noMiners;                      //!< The total number of miners
@@ -146,17 +187,20 @@ private:
   double       m_latencyParetoShapeDivider;     //!<  The pareto shape for the latency of the point-to-point links
   int          m_minConnectionsPerNode;         //!<  The minimum connections per node
   int          m_maxConnectionsPerNode;         //!<  The maximum connections per node
-  int          m_minConnectionsPerMiner;        //!<  The minimum connections per node
-  int          m_maxConnectionsPerMiner;        //!<  The maximum connections per node
+  int          m_minConnectionsPerMiner;        //!<  The minimum connections per miner, not positive for those of the nodes
+  int          m_maxConnectionsPerMiner;        //!<  The maximum connections per miner, not positive for those of the nodes
   double       m_minerDownloadSpeed;            //!<  The download speed of miners
   double       m_minerUploadSpeed;              //!<  The upload speed of miners
   uint32_t     m_totalNoLinks;                  //!<  Total number of links
   uint32_t     m_systemId;
+  bool         m_fastLinks;                     //!<  True if the links are modelled by the FastLinkChannel instead of point-to-point devices
   
   enum BitcoinRegion                             *m_minersRegions;
   enum Cryptocurrency                             m_cryptocurrency;
   std::vector<uint32_t>                           m_miners;                  //!< The ids of the miners
-  std::map<uint32_t, std::vector<uint32_t>>       m_nodesConnections;        //!< key = nodeId
+  std::vector<bool>                               m_minerBitmap;             //!< m_minerBitmap[nodeId] is true if the node is a miner
+  std::vector<uint32_t>                           m_connectionsOffsets;      //!< The peers of node i are m_connections[m_connectionsOffsets[i]] to m_connections[m_connectionsOffsets[i+1] - 1]
+  std::vector<uint32_t>                           m_connections;             //!< The peers of all the nodes in CSR format, node by node
   std::map<uint32_t, std::vector<Ipv4Address>>    m_nodesConnectionsIps;     //!< key = nodeId
   std::vector<NodeContainer>                      m_nodes;                   //!< all the nodes in the network
   std::vector<NetDeviceContainer>                 m_devices;                 //!< NetDevices in the network
@@ -170,24 +214,16 @@ private:
   std::map<uint32_t, std::map<Ipv4Address, double>>    m_peersDownloadSpeeds;     //!< key1 = nodeId, key2 = Ipv4Address of peer
   std::map<uint32_t, std::map<Ipv4Address, double>>    m_peersUploadSpeeds;       //!< key1 = nodeId, key2 = Ipv4Address of peer
   std::map<uint32_t, nodeInternetSpeeds>               m_nodesInternetSpeeds;     //!< key = nodeId
-  std::map<uint32_t, int>                              m_minConnections;          //!< key = nodeId
-  std::map<uint32_t, int>                              m_maxConnections;          //!< key = nodeId
-
-  std::default_random_engine                     m_generator;
+  std::vector<int>                                     m_minConnections;          //!< indexed by nodeId
+  std::vector<int>                                     m_maxConnections;          //!< indexed by nodeId
+  std::vector<fastLinkParameters>                      m_fastLinkParameters;      //!< The links of the fast link mode, in the order they were created
+  Ptr<FastLinkChannel>                                 m_fastLinkChannel;         //!< The channel of the fast link mode
+
+  RandomStream                                   m_minersStream;            //!< Chooses the miners
+  RandomStream                                   m_connectionsStream;       //!< Draws the number of connections of the nodes and chooses their peers
+  RandomStream                                   m_latenciesStream;         //!< Draws the Pareto latencies of the links
   std::piecewise_constant_distribution<double>   m_nodesDistribution;
   std::piecewise_constant_distribution<double>   m_connectionsDistribution;
-  std::piecewise_constant_distribution<double>   m_europeDownloadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_europeUploadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_northAmericaDownloadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_northAmericaUploadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_asiaPacificDownloadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_asiaPacificUploadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_japanDownloadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_japanUploadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_southAmericaDownloadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_southAmericaUploadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_australiaDownloadBandwidthDistribution;
-  std::piecewise_constant_distribution<double>   m_australiaUploadBandwidthDistribution;
 };
 
 
@@ -5,7 +5,7 @@
 
 namespace ns3 {
 
-std::array<double,1001> downloadBandwitdhIntervals {
+const std::array<double,1001> downloadBandwitdhIntervals {
    0.1, 0.6, 1.1, 1.6, 2.1, 2.6, 3.1, 3.6, 4.1, 4.6, 5.1, 5.6, 6.1, 6.6,
    7.1, 7.6, 8.1, 8.6, 9.1, 9.6, 10.1, 10.6, 11.1, 11.6, 12.1, 12.6, 13.1,
    13.6, 14.1, 14.6, 15.1, 15.6, 16.1, 16.6, 17.1, 17.6, 18.1, 18.6, 19.1,
@@ -104,7 +104,7 @@ std::array<double,1001> downloadBandwitdhIntervals {
    493.1, 493.6, 494.1, 494.6, 495.1, 495.6, 496.1, 496.6, 497.1, 497.6,
    498.1, 498.6, 499.1, 499.6, 500};
    
-std::array<double,1000> uploadBandwitdhIntervals {
+const std::array<double,1000> uploadBandwitdhIntervals {
    0.1, 0.2, 0.3, 0.4, 0.5, 0.6, 0.7, 0.8, 0.9, 1.0, 1.1, 1.2, 1.3, 1.4,
    1.5, 1.6, 1.7, 1.8, 1.9, 2.0, 2.1, 2.2, 2.3, 2.4, 2.5, 2.6, 2.7, 2.8,
    2.9, 3.0, 3.1, 3.2, 3.3, 3.4, 3.5, 3.6, 3.7, 3.8, 3.9, 4.0, 4.1, 4.2,
@@ -232,7 +232,7 @@ std::array<double,1000> uploadBandwitdhIntervals {
   0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
   0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 39};
 
-std::array<double,999> EuropeUploadWeights {
+const std::array<double,999> EuropeUploadWeights {
     3502, 2126, 3354, 2487, 2810, 2627, 2964, 1633, 1246, 710, 595, 481, 579, 658, 549, 723,
 	751, 816, 770, 550, 482, 513, 437, 367, 297, 366, 469, 368, 343, 269, 311, 316, 281, 294,
 	259, 325, 380, 353, 333, 329, 319, 361, 329, 394, 434, 452, 434, 369, 318, 347, 288, 318,
@@ -275,7 +275,7 @@ std::array<double,999> EuropeUploadWeights {
 	0, 1, 0, 0, 1, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 0, 0, 1, 0, 1, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 0, 152};
 
-std::array<double,1000> AustraliaDownloadWeights {
+const std::array<double,1000> AustraliaDownloadWeights {
     454, 254, 224, 178, 125, 175, 94, 93, 96, 98, 101, 89, 125, 87, 96, 63, 59, 65, 67, 68,
 	62, 55, 46, 51, 55, 51, 34, 44, 24, 31, 27, 16, 17, 20, 22, 24, 17, 13, 19, 26, 18, 11,
 	15, 8, 16, 10, 17, 19, 18, 9, 16, 5, 12, 27, 31, 21, 23, 18, 23, 22, 9, 8, 10, 6, 7, 3,
@@ -312,7 +312,7 @@ std::array<double,1000> AustraliaDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0};
 
-std::array<double,999> AustraliaUploadWeights {
+const std::array<double,999> AustraliaUploadWeights {
     99, 163, 124, 96, 136, 358, 435, 315, 119, 43, 66, 15, 22, 24, 38, 28, 30, 36, 32, 77, 40,
 	43, 34, 20, 24, 18, 22, 19, 17, 15, 16, 30, 30, 31, 14, 17, 21, 19, 16, 16, 18, 14, 12, 14,
 	18, 17, 13, 7, 11, 9, 5, 9, 6, 9, 5, 9, 8, 11, 9, 9, 8, 17, 9, 11, 5, 9, 5, 6, 10, 5, 4, 8,
@@ -349,7 +349,7 @@ std::array<double,999> AustraliaUploadWeights {
 	0, 5};
 
 	
-std::array<double,1000> NorthAmericaDownloadWeights {
+const std::array<double,1000> NorthAmericaDownloadWeights {
     573, 331, 252, 155, 215, 168, 134, 116, 171, 192, 145, 116, 95, 117, 95, 97, 78, 85, 71, 114,
 	72, 58, 48, 55, 47, 39, 36, 47, 39, 47, 28, 42, 33, 44, 55, 50, 47, 41, 104, 146, 94, 60, 33,
 	33, 34, 34, 23, 32, 19, 20, 27, 18, 20, 22, 33, 32, 22, 26, 28, 21, 15, 16, 14, 22, 16, 12, 8,
@@ -384,7 +384,7 @@ std::array<double,1000> NorthAmericaDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4};
 
-std::array<double,999> NorthAmericaUploadWeights {
+const std::array<double,999> NorthAmericaUploadWeights {
     345, 246, 399, 429, 445, 244, 159, 158, 180, 81, 110, 83, 53, 48, 66, 106, 112, 88, 47, 53, 58,
 	59, 49, 37, 29, 35, 44, 34, 25, 32, 21, 23, 22, 31, 24, 38, 29, 28, 43, 66, 41, 28, 41, 41, 35,
 	51, 62, 35, 48, 22, 26, 27, 21, 31, 39, 40, 25, 25, 27, 77, 20, 17, 15, 19, 11, 13, 15, 14, 15,
@@ -419,7 +419,7 @@ std::array<double,999> NorthAmericaUploadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 7};
 
-std::array<double,1000> SouthAmericaDownloadWeights {
+const std::array<double,1000> SouthAmericaDownloadWeights {
     1951, 995, 886, 712, 567, 494, 443, 400, 388, 366, 419, 328, 212, 202, 214, 198, 224, 233, 174,
 	218, 217, 144, 159, 123, 74, 66, 59, 63, 46, 49, 40, 41, 44, 39, 34, 34, 26, 19, 27, 20, 24, 31,
 	22, 25, 27, 19, 23, 20, 21, 17, 18, 11, 17, 12, 10, 16, 10, 10, 14, 12, 17, 9, 15, 13, 18, 11,
@@ -453,7 +453,7 @@ std::array<double,1000> SouthAmericaDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0};
 	
-std::array<double,999> SouthAmericaUploadWeights {
+const std::array<double,999> SouthAmericaUploadWeights {
     1065, 844, 1275, 668, 483, 494, 531, 387, 336, 245, 210, 188, 218, 242, 235, 389, 322, 272, 226,
 	198, 136, 144, 101, 69, 64, 73, 84, 63, 68, 55, 65, 51, 56, 58, 49, 49, 67, 65, 59, 80, 80, 68,
 	99, 59, 39, 42, 39, 25, 29, 18, 21, 18, 22, 23, 14, 15, 14, 24, 13, 16, 16, 16, 17, 15, 23, 11,
@@ -488,7 +488,7 @@ std::array<double,999> SouthAmericaUploadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-std::array<double,1000> AsiaPacificDownloadWeights {
+const std::array<double,1000> AsiaPacificDownloadWeights {
     7117, 3202, 2382, 1804, 1284, 998, 827, 770, 683, 661, 610, 600, 577, 502, 418, 422, 386, 352,
 	368, 380, 310, 344, 263, 202, 235, 235, 180, 182, 159, 151, 162, 110, 168, 111, 124, 117, 144,
 	95, 115, 93, 107, 87, 90, 89, 84, 93, 89, 81, 85, 71, 66, 74, 69, 66, 62, 74, 79, 68, 68, 60,
@@ -524,7 +524,7 @@ std::array<double,1000> AsiaPacificDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 23};
 
-std::array<double,999> AsiaPacificUploadWeights {
+const std::array<double,999> AsiaPacificUploadWeights {
     4307, 2524, 2825, 1689, 1173, 1246, 1246, 845, 665, 470, 447, 415, 446, 435, 375, 402, 341, 370,
 	284, 273, 257, 275, 218, 187, 189, 192, 222, 179, 180, 117, 120, 141, 104, 130, 88, 115, 137, 115,
 	97, 100, 121, 100, 103, 114, 108, 108, 118, 108, 100, 75, 77, 86, 67, 56, 71, 72, 76, 77, 65, 49,
@@ -560,7 +560,7 @@ std::array<double,999> AsiaPacificUploadWeights {
 	0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 4, 0, 0, 0, 0, 1, 1, 1, 0, 0, 0, 1, 0, 0, 0, 1, 3, 1,
 	0, 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 89};
 
-std::array<double,1000> JapanDownloadWeights {
+const std::array<double,1000> JapanDownloadWeights {
     344, 157, 125, 92, 68, 62, 105, 52, 32, 47, 27, 30, 27, 29, 18, 24, 19, 20, 15, 20, 11, 14, 15,
 	9, 9, 5, 8, 11, 9, 9, 7, 7, 5, 8, 4, 7, 8, 4, 5, 6, 10, 6, 7, 8, 7, 9, 15, 4, 7, 10, 14, 7, 5,
 	10, 9, 14, 9, 7, 5, 3, 3, 7, 2, 2, 7, 3, 0, 2, 2, 3, 3, 3, 1, 1, 3, 6, 3, 2, 6, 2, 1, 4, 3, 2,
@@ -594,7 +594,7 @@ std::array<double,1000> JapanDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-std::array<double,999> JapanUploadWeights {
+const std::array<double,999> JapanUploadWeights {
     135, 89, 82, 67, 45, 40, 37, 47, 46, 40, 37, 39, 42, 33, 26, 35, 40, 36, 38, 30, 29, 39, 31, 31,
 	25, 17, 25, 18, 20, 14, 19, 20, 9, 11, 9, 9, 16, 5, 17, 15, 14, 22, 17, 24, 14, 10, 14, 14, 9,
 	13, 10, 17, 16, 18, 17, 20, 16, 17, 15, 18, 18, 15, 14, 9, 12, 7, 14, 13, 10, 7, 4, 2, 5, 6, 5,
@@ -630,7 +630,7 @@ std::array<double,999> JapanUploadWeights {
 } */
 
 
-std::array<double,1000> EuropeDownloadWeights {
+const std::array<double,1000> EuropeDownloadWeights {
     134, 77, 65, 58, 43, 44, 48, 42, 34, 41, 42, 41, 33, 35, 35, 38, 37, 30, 36, 37, 34, 24, 21, 23,
 	22, 21, 20, 19, 17, 16, 13, 18, 20, 15, 18, 17, 15, 11, 15, 10, 13, 12, 11, 11, 11, 13, 11, 12,
 	9, 12, 13, 10, 10, 9, 10, 10, 9, 7, 8, 7, 7, 7, 6, 10, 6, 5, 6, 9, 6, 5, 7, 4, 6, 6, 4, 5, 4, 6,
@@ -664,7 +664,7 @@ std::array<double,1000> EuropeDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2};
 
-std::array<double,999> EuropeUploadWeights {
+const std::array<double,999> EuropeUploadWeights {
     99, 51, 48, 70, 58, 44, 43, 31, 27, 27, 24, 24, 25, 24, 21, 18, 20, 21, 19, 18, 16, 15, 19, 18,
 	15, 18, 21, 26, 23, 17, 17, 14, 15, 15, 14, 16, 19, 20, 17, 13, 17, 11, 11, 11, 11, 10, 13, 11,
 	10, 12, 12, 12, 13, 9, 11, 10, 10, 9, 9, 7, 7, 7, 8, 8, 9, 5, 7, 5, 6, 8, 7, 6, 6, 8, 8, 8, 8,
@@ -698,7 +698,7 @@ std::array<double,999> EuropeUploadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8};
 
-std::array<double,1000> AustraliaDownloadWeights {
+const std::array<double,1000> AustraliaDownloadWeights {
     234, 143, 130, 80, 69, 73, 48, 56, 52, 45, 62, 52, 48, 37, 43, 25, 24, 29, 23, 28, 25, 28, 17, 27,
 	23, 24, 12, 18, 17, 13, 12, 8, 9, 12, 15, 11, 7, 9, 13, 8, 3, 6, 3, 3, 6, 12, 5, 5, 2, 4, 1, 14, 12,
 	12, 9, 10, 17, 12, 16, 4, 7, 3, 1, 4, 2, 5, 3, 6, 6, 5, 7, 1, 1, 0, 1, 1, 0, 0, 2, 0, 3, 2, 1, 0, 2,
@@ -730,7 +730,7 @@ std::array<double,1000> AustraliaDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-std::array<double,999> AustraliaUploadWeights {
+const std::array<double,999> AustraliaUploadWeights {
     105, 88, 81, 58, 71, 155, 233, 161, 45, 20, 18, 61, 8, 12, 9, 18, 14, 13, 16, 19, 15, 16, 22, 19, 18,
 	22, 20, 10, 9, 16, 10, 13, 12, 11, 11, 8, 13, 14, 12, 19, 14, 9, 11, 9, 5, 9, 7, 11, 6, 6, 10, 14, 8,
 	6, 2, 2, 3, 4, 4, 2, 2, 1, 6, 2, 3, 1, 1, 1, 2, 2, 1, 2, 2, 1, 1, 0, 2, 0, 1, 0, 1, 0, 2, 0, 1, 0, 0,
@@ -762,7 +762,7 @@ std::array<double,999> AustraliaUploadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4};
 
-std::array<double,1000> NorthAmericaDownloadWeights {
+const std::array<double,1000> NorthAmericaDownloadWeights {
     170, 107, 73, 46, 77, 49, 26, 35, 34, 38, 31, 35, 26, 32, 29, 18, 20, 22, 25, 21, 20, 17, 20, 23, 15,
 	12, 14, 13, 16, 15, 19, 11, 19, 27, 21, 20, 17, 12, 21, 23, 32, 26, 18, 13, 19, 16, 9, 16, 6, 10, 6,
 	9, 8, 5, 11, 8, 7, 5, 6, 5, 8, 6, 2, 6, 8, 4, 4, 4, 4, 7, 5, 7, 3, 2, 3, 4, 7, 7, 8, 12, 7, 2, 4, 2,
@@ -794,7 +794,7 @@ std::array<double,1000> NorthAmericaDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2};
 
-std::array<double,999> NorthAmericaUploadWeights {
+const std::array<double,999> NorthAmericaUploadWeights {
     120, 75, 83, 64, 62, 59, 50, 60, 48, 82, 45, 22, 30, 34, 34, 20, 18, 13, 21, 16, 10, 15, 24, 22, 14, 21,
 	10, 9, 9, 10, 15, 17, 16, 21, 27, 37, 12, 13, 7, 10, 16, 16, 16, 14, 13, 9, 11, 12, 9, 15, 16, 20, 16,
 	20, 18, 18, 40, 32, 4, 6, 3, 4, 4, 5, 6, 4, 6, 5, 4, 4, 3, 4, 3, 3, 5, 3, 10, 7, 6, 9, 5, 6, 10, 7, 5,
@@ -826,7 +826,7 @@ std::array<double,999> NorthAmericaUploadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 6};
 
-std::array<double,1000> SouthAmericaDownloadWeights {
+const std::array<double,1000> SouthAmericaDownloadWeights {
     383, 210, 163, 105, 85, 90, 71, 61, 63, 60, 54, 41, 48, 40, 35, 33, 33, 26, 21, 28, 20, 20, 17, 16, 14,
 	12, 11, 12, 12, 6, 15, 11, 11, 7, 7, 3, 2, 6, 5, 4, 7, 5, 4, 5, 2, 5, 6, 3, 0, 4, 1, 5, 2, 2, 2, 3, 1,
 	2, 3, 1, 3, 1, 2, 2, 1, 1, 1, 0, 0, 0, 3, 1, 3, 1, 1, 1, 2, 0, 0, 1, 0, 1, 1, 1, 1, 1, 1, 1, 2, 1, 1,
@@ -858,7 +858,7 @@ std::array<double,1000> SouthAmericaDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 	
-std::array<double,999> SouthAmericaUploadWeights {
+const std::array<double,999> SouthAmericaUploadWeights {
     260, 178, 201, 146, 93, 72, 84, 74, 61, 28, 20, 23, 21, 23, 22, 11, 14, 30, 47, 30, 14, 24, 19, 26, 23,
 	20, 21, 19, 25, 18, 24, 21, 16, 19, 16, 13, 16, 12, 14, 12, 8, 7, 7, 5, 9, 4, 8, 3, 7, 5, 11, 5, 6, 7,
 	6, 3, 4, 3, 4, 4, 1, 3, 2, 0, 1, 1, 1, 1, 1, 2, 2, 1, 3, 0, 1, 2, 1, 0, 0, 1, 2, 0, 2, 0, 2, 2, 1, 1,
@@ -890,7 +890,7 @@ std::array<double,999> SouthAmericaUploadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-std::array<double,1000> AsiaPacificDownloadWeights {
+const std::array<double,1000> AsiaPacificDownloadWeights {
     251, 140, 133, 122, 103, 95, 91, 69, 73, 58, 47, 39, 34, 36, 34, 39, 27, 27, 32, 23, 23, 23, 23, 22,
 	20, 15, 16, 14, 12, 13, 9, 15, 10, 12, 8, 12, 9, 7, 6, 9, 7, 8, 4, 3, 5, 5, 7, 4, 6, 4, 3, 6, 6, 4, 4,
 	3, 3, 4, 5, 2, 3, 4, 3, 2, 2, 4, 2, 2, 4, 3, 5, 4, 3, 1, 5, 2, 1, 3, 2, 1, 1, 2, 2, 2, 3, 1, 2, 2, 2,
@@ -922,7 +922,7 @@ std::array<double,1000> AsiaPacificDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
 
-std::array<double,999> AsiaPacificUploadWeights {
+const std::array<double,999> AsiaPacificUploadWeights {
     210, 77, 77, 60, 71, 54, 53, 45, 39, 38, 29, 32, 26, 27, 21, 24, 23, 27, 21, 24, 21, 18, 24, 17, 26,
 	29, 26, 19, 19, 17, 17, 13, 9, 7, 14, 8, 9, 8, 9, 10, 12, 7, 7, 10, 8, 10, 5, 6, 10, 7, 5, 10, 7, 7,
 	6, 6, 6, 9, 9, 6, 5, 5, 7, 6, 6, 5, 11, 11, 11, 12, 10, 8, 11, 6, 8, 7, 10, 8, 7, 5, 5, 5, 4, 3, 3,
@@ -955,7 +955,7 @@ std::array<double,999> AsiaPacificUploadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-std::array<double,1000> JapanDownloadWeights {
+const std::array<double,1000> JapanDownloadWeights {
     344, 157, 125, 92, 68, 62, 105, 52, 32, 47, 27, 30, 27, 29, 18, 24, 19, 20, 15, 20, 11, 14, 15,
 	9, 9, 5, 8, 11, 9, 9, 7, 7, 5, 8, 4, 7, 8, 4, 5, 6, 10, 6, 7, 8, 7, 9, 15, 4, 7, 10, 14, 7, 5,
 	10, 9, 14, 9, 7, 5, 3, 3, 7, 2, 2, 7, 3, 0, 2, 2, 3, 3, 3, 1, 1, 3, 6, 3, 2, 6, 2, 1, 4, 3, 2,
@@ -989,7 +989,7 @@ std::array<double,1000> JapanDownloadWeights {
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
-std::array<double,999> JapanUploadWeights {
+const std::array<double,999> JapanUploadWeights {
     135, 89, 82, 67, 45, 40, 37, 47, 46, 40, 37, 39, 42, 33, 26, 35, 40, 36, 38, 30, 29, 39, 31, 31,
 	25, 17, 25, 18, 20, 14, 19, 20, 9, 11, 9, 9, 16, 5, 17, 15, 14, 22, 17, 24, 14, 10, 14, 14, 9,
 	13, 10, 17, 16, 18, 17, 20, 16, 17, 15, 18, 18, 15, 14, 9, 12, 7, 14, 13, 10, 7, 4, 2, 5, 6, 5,
@@ -0,0 +1,246 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-alias-sampler.h
+ */
+
+#include "ns3/log.h"
+#include "bitcoin-alias-sampler.h"
+#include "bitcoin-distribution-dataset.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AliasSampler");
+
+AliasSampler::AliasSampler (const double *intervals, const double *weights, size_t noBins)
+  : m_columns (noBins), m_intervals (intervals, intervals + noBins + 1), m_mean (0)
+{
+  NS_LOG_FUNCTION (this << noBins);
+
+  double sum = 0;
+  for (size_t i = 0; i < noBins; i++)
+  {
+    if (!(weights[i] >= 0) || !(intervals[i + 1] > intervals[i]))
+      NS_FATAL_ERROR ("Bin " << i << " of the distribution has a negative weight or an empty interval");
+    sum += weights[i];
+  }
+
+  if (!(sum > 0))
+    NS_FATAL_ERROR ("The weights of the distribution are all 0");
+
+  /**
+   * Vose's construction: the weights are scaled to a mean of 1, and each column of a bin under 1
+   * is filled up with an alias bin over 1, until all the columns are full
+   */
+  std::vector<double>     scaled (noBins);
+  std::vector<uint32_t>   small;
+  std::vector<uint32_t>   large;
+
+  for (size_t i = 0; i < noBins; i++)
+  {
+    scaled[i] = weights[i] * noBins / sum;
+    if (scaled[i] < 1)
+      small.push_back (i);
+    else
+      large.push_back (i);
+
+    m_mean += weights[i] / sum * (intervals[i] + intervals[i + 1]) / 2;
+  }
+
+  while (!small.empty () && !large.empty ())
+  {
+    uint32_t under = small.back ();
+    uint32_t over = large.back ();
+
+    small.pop_back ();
+    m_columns[under].threshold = scaled[under];
+    m_columns[under].alias = over;
+
+    scaled[over] += scaled[under] - 1;
+    if (scaled[over] < 1)
+    {
+      large.pop_back ();
+      small.push_back (over);
+    }
+  }
+
+  //The columns which are left are full, up to the rounding errors
+  for (auto bin : small)
+    m_columns[bin] = {1, bin};
+  for (auto bin : large)
+    m_columns[bin] = {1, bin};
+}
+
+AliasSampler::~AliasSampler (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+double
+AliasSampler::Draw (RandomStream &stream) const
+{
+  //The upper 32 bits pick the column and the coin of its threshold, and the lower 32 bits the position in the bin
+  uint64_t   bits = stream ();
+  double     column = (bits >> 32) * (m_columns.size () / 4294967296.0);
+  uint32_t   bin = static_cast<uint32_t> (column);
+
+  if (column - bin >= m_columns[bin].threshold)
+    bin = m_columns[bin].alias;
+
+  double position = (bits & 0xffffffff) / 4294967296.0;
+  return m_intervals[bin] + position * (m_intervals[bin + 1] - m_intervals[bin]);
+}
+
+size_t
+AliasSampler::GetNoBins (void) const
+{
+  return m_columns.size ();
+}
+
+double
+AliasSampler::GetMean (void) const
+{
+  return m_mean;
+}
+
+
+namespace {
+
+/**
+ * Builds the sampler of the distribution with the given tables of the boundaries and of the weights of the bins
+ */
+Ptr<const AliasSampler>
+CreateSampler (const std::string &intervalsTable, const std::string &weightsTable)
+{
+  size_t          noIntervals;
+  size_t          noWeights;
+  const double   *intervals = GetDistributionTable (intervalsTable, noIntervals);
+  const double   *weights = GetDistributionTable (weightsTable, noWeights);
+
+  if (noIntervals < 2 || noWeights != noIntervals - 1)
+    NS_FATAL_ERROR ("The table " << weightsTable << " has " << noWeights << " weights for the "
+                    << noIntervals << " boundaries of " << intervalsTable);
+
+  return Create<AliasSampler> (intervals, weights, noIntervals - 1);
+}
+
+/**
+ * The shared samplers, built on their first use from the tables of the current dataset
+ */
+typedef struct {
+  uint32_t                  version;                    //!< the version of the dataset the samplers were built from
+  Ptr<const AliasSampler>   blockSize[DOGECOIN + 1];
+  Ptr<const AliasSampler>   attackerBlockSize;
+  Ptr<const AliasSampler>   bandwidth[OTHER][2];
+} samplerCache;
+
+/**
+ * \return the shared samplers, emptied if the dataset has changed since they were built
+ */
+samplerCache&
+GetSamplers (void)
+{
+  static samplerCache samplers;
+
+  if (samplers.version != GetDistributionDatasetVersion ())
+  {
+    samplers = samplerCache ();
+    samplers.version = GetDistributionDatasetVersion ();
+  }
+  return samplers;
+}
+
+} // namespace
+
+
+Ptr<const AliasSampler>
+GetBlockSizeSampler (enum Cryptocurrency cryptocurrency)
+{
+  Ptr<const AliasSampler> &sampler = GetSamplers ().blockSize[cryptocurrency];
+
+  if (!sampler)
+  {
+    switch (cryptocurrency)
+    {
+      case BITCOIN:
+        sampler = CreateSampler ("bitcoin-block-size-intervals", "bitcoin-block-size-weights");
+        break;
+      case LITECOIN:
+        sampler = CreateSampler ("altcoin-block-size-intervals", "litecoin-block-size-weights");
+        break;
+      case DOGECOIN:
+        sampler = CreateSampler ("altcoin-block-size-intervals", "dogecoin-block-size-weights");
+        break;
+    }
+  }
+  return sampler;
+}
+
+Ptr<const AliasSampler>
+GetAttackerBlockSizeSampler (void)
+{
+  Ptr<const AliasSampler> &sampler = GetSamplers ().attackerBlockSize;
+
+  if (!sampler)
+    sampler = CreateSampler ("bitcoin-block-size-intervals", "attacker-block-size-weights");
+  return sampler;
+}
+
+Ptr<const AliasSampler>
+GetBandwidthSampler (enum BitcoinRegion region, bool upload)
+{
+  if (region == OTHER)
+    NS_FATAL_ERROR ("There is no bandwidth distribution for the region " << getBitcoinRegion (region));
+
+  Ptr<const AliasSampler> &sampler = GetSamplers ().bandwidth[region][upload ? 1 : 0];
+
+  if (!sampler)
+  {
+    const char *prefix = nullptr;
+
+    switch (region)
+    {
+      case NORTH_AMERICA: prefix = "north-america"; break;
+      case EUROPE: prefix = "europe"; break;
+      case SOUTH_AMERICA: prefix = "south-america"; break;
+      case ASIA_PACIFIC: prefix = "asia-pacific"; break;
+      case JAPAN: prefix = "japan"; break;
+      case AUSTRALIA: prefix = "australia"; break;
+      case OTHER: break;
+    }
+
+    if (upload)
+      sampler = CreateSampler ("upload-bandwidth-intervals", std::string (prefix) + "-upload-weights");
+    else
+      sampler = CreateSampler ("download-bandwidth-intervals", std::string (prefix) + "-download-weights");
+  }
+  return sampler;
+}
+
+int
+DrawBlockSize (int fixedBlockSize, const Ptr<const AliasSampler> &sampler, RandomStream &stream,
+               enum Cryptocurrency cryptocurrency, double averageBlockGenIntervalSeconds, int maxBlockSize)
+{
+  int blockSize;
+
+  if (fixedBlockSize > 0)
+    blockSize = fixedBlockSize;
+  else
+  {
+    blockSize = sampler->Draw (stream) * 1000;	// *1000 because the sampler returns KBytes
+
+    if (cryptocurrency == BITCOIN)
+    {
+      // The block size is linearly dependent on the averageBlockGenIntervalSeconds
+      if (blockSize < maxBlockSize - HEADERS_SIZE_BYTES)
+        blockSize = blockSize*averageBlockGenIntervalSeconds / BITCOIN_BLOCK_GEN_INTERVAL_SECONDS + HEADERS_SIZE_BYTES;
+      else
+        blockSize = blockSize*averageBlockGenIntervalSeconds / BITCOIN_BLOCK_GEN_INTERVAL_SECONDS;
+    }
+  }
+
+  if (blockSize < AVERAGE_TRANSACTION_SIZE_BYTES)
+    blockSize = AVERAGE_TRANSACTION_SIZE_BYTES + HEADERS_SIZE_BYTES;
+
+  return blockSize;
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+/**
+ * This file contains the declaration of the AliasSampler, which draws from a piecewise constant distribution in constant time,
+ * and the shared samplers of the block sizes and the bandwidths of the nodes.
+ */
+
+#ifndef BITCOIN_ALIAS_SAMPLER_H
+#define BITCOIN_ALIAS_SAMPLER_H
+
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "bitcoin.h"
+#include "bitcoin-random-stream.h"
+
+namespace ns3 {
+
+/**
+ * An immutable sampler of a piecewise constant distribution, the distribution of std::piecewise_constant_distribution:
+ * a bin is chosen with a probability proportional to its weight and the value is uniform within the bin.
+ * The bin is chosen with Walker's alias method, which replaces the binary search over the cumulative weights with
+ * a single table lookup, so each draw takes constant time and a single 64-bit number of the stream.
+ *
+ * The samplers of the tables are built once per process and shared by all the nodes which draw from them. They are rebuilt
+ * on their next use when the distribution dataset of the process is changed.
+ */
+class AliasSampler : public SimpleRefCount<AliasSampler>
+{
+public:
+  /**
+   * \param intervals the noBins + 1 boundaries of the bins, in increasing order
+   * \param weights the noBins non-negative weights of the bins, which must not all be 0
+   * \param noBins the number of bins
+   */
+  AliasSampler (const double *intervals, const double *weights, size_t noBins);
+  ~AliasSampler (void);
+
+  /**
+   * \return a value of the distribution
+   */
+  double Draw (RandomStream &stream) const;
+
+  /**
+   * \return the number of bins
+   */
+  size_t GetNoBins (void) const;
+
+  /**
+   * \return the mean of the distribution
+   */
+  double GetMean (void) const;
+
+private:
+  /**
+   * A column of the alias table. A uniform column is picked and the bin of the column is kept with probability
+   * threshold, or replaced with the alias bin.
+   */
+  typedef struct {
+    double     threshold;
+    uint32_t   alias;
+  } aliasColumn;
+
+  std::vector<aliasColumn>   m_columns;
+  std::vector<double>        m_intervals;     // the boundaries of the bins
+  double                     m_mean;
+};
+
+
+/**
+ * \return the shared sampler of the block sizes of a cryptocurrency in KB
+ */
+Ptr<const AliasSampler> GetBlockSizeSampler (enum Cryptocurrency cryptocurrency);
+
+/**
+ * \return the shared sampler of the block sizes of the attacking miners in KB, an earlier Bitcoin snapshot
+ */
+Ptr<const AliasSampler> GetAttackerBlockSizeSampler (void);
+
+/**
+ * \return the shared sampler of the download or upload bandwidths of the nodes of a region in Mbps. The region must not be OTHER.
+ */
+Ptr<const AliasSampler> GetBandwidthSampler (enum BitcoinRegion region, bool upload);
+
+/**
+ * \brief Draws the size of a new block, as all the miners do. The Bitcoin sizes are scaled linearly with the average block
+ * generation interval, and a block holds at least a transaction.
+ * \param fixedBlockSize a fixed size in Bytes, which replaces the draw if it is positive
+ * \param sampler the sampler of the block sizes in KB, unused with a fixed size
+ * \param stream the stream of the draw
+ * \param cryptocurrency the cryptocurrency of the sampler
+ * \param averageBlockGenIntervalSeconds the average block generation interval of the network
+ * \param maxBlockSize the maximum block size in Bytes. The headers are only added to the scaled Bitcoin blocks below it
+ * \return the size of the block in Bytes
+ */
+int DrawBlockSize (int fixedBlockSize, const Ptr<const AliasSampler> &sampler, RandomStream &stream,
+                   enum Cryptocurrency cryptocurrency, double averageBlockGenIntervalSeconds, int maxBlockSize);
+
+} // namespace ns3
+
+#endif /* BITCOIN_ALIAS_SAMPLER_H */
@@ -0,0 +1,159 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-block-injector.h
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "bitcoin-block-injector.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BlockInjector");
+
+BlockInjector::BlockInjector (void)
+  : m_totalRate (0), m_averageBlockGenIntervalSeconds (10*60), m_cryptocurrency (BITCOIN), m_fixedBlockSize (0),
+    m_blockBroadcastType (STANDARD), m_stream (RNG_BLOCK_INJECTOR, 0), m_noBlocks (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BlockInjector::~BlockInjector (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BlockInjector::SetAverageBlockGenInterval (double averageBlockGenIntervalSeconds)
+{
+  if (!(averageBlockGenIntervalSeconds > 0))
+    NS_FATAL_ERROR ("The average block generation interval must be positive");
+
+  m_averageBlockGenIntervalSeconds = averageBlockGenIntervalSeconds;
+}
+
+void
+BlockInjector::SetCryptocurrency (enum Cryptocurrency cryptocurrency)
+{
+  m_cryptocurrency = cryptocurrency;
+}
+
+void
+BlockInjector::SetFixedBlockSize (int blockSizeBytes)
+{
+  m_fixedBlockSize = blockSizeBytes;
+}
+
+void
+BlockInjector::SetBlockBroadcastType (enum BlockBroadcastType blockBroadcastType)
+{
+  if (blockBroadcastType != STANDARD && blockBroadcastType != UNSOLICITED)
+    NS_FATAL_ERROR ("The block injector only supports the STANDARD and UNSOLICITED broadcast types, not "
+                    << getBlockBroadcastType (blockBroadcastType));
+
+  m_blockBroadcastType = blockBroadcastType;
+}
+
+void
+BlockInjector::AddLocation (Ptr<BitcoinNode> node, double hashRate)
+{
+  if (!(hashRate > 0))
+    NS_FATAL_ERROR ("The hash rate of the location " << node->GetNode ()->GetId () << " must be positive");
+
+  NS_LOG_INFO ("Node " << node->GetNode ()->GetId () << " mines injected blocks with hash rate = " << hashRate);
+
+  m_locations.push_back ({node, hashRate, 0});
+}
+
+void
+BlockInjector::Start (Time start, Time stop)
+{
+  Simulator::Schedule (start, &BlockInjector::StartRace, this);
+  Simulator::Schedule (stop, &BlockInjector::StopRace, this);
+}
+
+size_t
+BlockInjector::GetNoLocations (void) const
+{
+  return m_locations.size ();
+}
+
+uint64_t
+BlockInjector::GetNoBlocks (void) const
+{
+  return m_noBlocks;
+}
+
+void
+BlockInjector::StartRace (void)
+{
+  if (m_locations.empty ())
+    return;
+
+  /**
+   * The location is drawn as a value of [0, noLocations) whose bins are weighted by the hash rates,
+   * so its integer part is the index of the winner
+   */
+  std::vector<double> intervals;
+  std::vector<double> hashRates;
+
+  m_totalRate = 0;
+  for (size_t i = 0; i < m_locations.size (); i++)
+  {
+    intervals.push_back (i);
+    hashRates.push_back (m_locations[i].hashRate);
+    m_totalRate += m_locations[i].hashRate / m_averageBlockGenIntervalSeconds;
+  }
+  intervals.push_back (m_locations.size ());
+
+  m_locationSampler = Create<AliasSampler> (intervals.data (), hashRates.data (), m_locations.size ());
+  if (m_fixedBlockSize <= 0)
+    m_blockSizeSampler = GetBlockSizeSampler (m_cryptocurrency);
+
+  NS_LOG_INFO ("The race of the " << m_locations.size () << " locations starts with rate = " << m_totalRate << " blocks/s");
+
+  ScheduleNextBlock ();
+}
+
+void
+BlockInjector::StopRace (void)
+{
+  Simulator::Cancel (m_nextBlockEvent);
+
+  for (auto const &location : m_locations)
+    NS_LOG_INFO ("Location " << location.node->GetNode ()->GetId () << " with hash rate = " << location.hashRate
+                 << " mined " << location.noBlocks << " of the " << m_noBlocks << " injected blocks");
+}
+
+void
+BlockInjector::ScheduleNextBlock (void)
+{
+  double nextBlockTime = -std::log1p (-m_stream.GetDouble ()) / m_totalRate;
+
+  m_nextBlockEvent = Simulator::Schedule (Seconds (nextBlockTime), &BlockInjector::InjectBlock, this);
+
+  NS_LOG_DEBUG ("Time " << Simulator::Now ().GetSeconds () << ": the next block of the " << m_locations.size ()
+                << " locations will be injected in " << nextBlockTime << "s");
+}
+
+void
+BlockInjector::InjectBlock (void)
+{
+  size_t             winner = std::min<size_t> (m_locationSampler->Draw (m_stream), m_locations.size () - 1);
+  injectorLocation  &location = m_locations[winner];
+  int                blockSize = DrawBlockSize (m_fixedBlockSize, m_blockSizeSampler, m_stream,
+                                                m_cryptocurrency, m_averageBlockGenIntervalSeconds, MAX_BLOCK_SIZE_BYTES);
+
+  NS_LOG_INFO ("Time " << Simulator::Now ().GetSeconds () << ": location " << location.node->GetNode ()->GetId ()
+               << " won the race with a block of " << blockSize << " Bytes");
+
+  location.noBlocks++;
+  m_noBlocks++;
+
+  ScheduleNextBlock ();
+  location.node->InjectBlock (blockSize, m_blockBroadcastType);
+}
+
+} // namespace ns3
@@ -0,0 +1,129 @@
+/**
+ * This file contains the declaration of the BlockInjector, which generates the blocks of all the miners of the network
+ * without a miner application per miner.
+ */
+
+#ifndef BITCOIN_BLOCK_INJECTOR_H
+#define BITCOIN_BLOCK_INJECTOR_H
+
+#include <vector>
+#include "ns3/event-id.h"
+#include "ns3/nstime.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "bitcoin.h"
+#include "bitcoin-node.h"
+#include "bitcoin-alias-sampler.h"
+#include "bitcoin-random-stream.h"
+
+namespace ns3 {
+
+/**
+ * A lightweight source of blocks for the runs which only study the propagation of the blocks.
+ *
+ * Instead of a BitcoinMiner per miner, each with its own distributions and mining events, the miners are locations:
+ * ordinary BitcoinNodes with a hash rate. The injector runs a single exponential race: the next block of the network is
+ * exponential with the sum of the rates of its locations, and it is won by each location with a probability proportional
+ * to its hash rate, drawn with an alias table. The winner adds the block on top of its tip and broadcasts it with
+ * BitcoinNode::InjectBlock, as if it had mined it. So each block costs a single simulator event whatever the number of
+ * locations, and the locations cost no events at all between their blocks.
+ *
+ * The injector requires all the locations to run in a single process. A race per MPI process would depend on how the
+ * locations are split between the processes, so the same seed would give different blocks for different numbers of processes.
+ */
+class BlockInjector : public SimpleRefCount<BlockInjector>
+{
+public:
+  BlockInjector (void);
+  ~BlockInjector (void);
+
+  /**
+   * \brief Sets the average block generation interval of the whole network (default: 600s)
+   */
+  void SetAverageBlockGenInterval (double averageBlockGenIntervalSeconds);
+
+  /**
+   * \brief Sets the cryptocurrency, whose distribution the block sizes are drawn from (default: BITCOIN)
+   */
+  void SetCryptocurrency (enum Cryptocurrency cryptocurrency);
+
+  /**
+   * \brief Sets a fixed size for all the blocks. A size of 0 draws the sizes from the distribution of the cryptocurrency (default)
+   */
+  void SetFixedBlockSize (int blockSizeBytes);
+
+  /**
+   * \brief Sets the broadcast type of the blocks, STANDARD (default) or UNSOLICITED
+   */
+  void SetBlockBroadcastType (enum BlockBroadcastType blockBroadcastType);
+
+  /**
+   * \brief Adds a location which mines blocks. The locations must be added before Start.
+   * \param node the application of the node which mines the blocks of the location
+   * \param hashRate the fraction of the total hash rate of the network owned by the location, which must be positive
+   */
+  void AddLocation (Ptr<BitcoinNode> node, double hashRate);
+
+  /**
+   * \brief Schedules the start and the stop of the race
+   * \param start the time the locations start mining, which must not precede the start of their applications
+   * \param stop the time the locations stop mining
+   */
+  void Start (Time start, Time stop);
+
+  /**
+   * \return the number of locations
+   */
+  size_t GetNoLocations (void) const;
+
+  /**
+   * \return the number of blocks injected
+   */
+  uint64_t GetNoBlocks (void) const;
+
+private:
+  /**
+   * A location of the race
+   */
+  typedef struct {
+    Ptr<BitcoinNode>   node;
+    double             hashRate;
+    uint64_t           noBlocks;
+  } injectorLocation;
+
+  /**
+   * \brief Builds the alias table of the locations and schedules the first block
+   */
+  void StartRace (void);
+
+  /**
+   * \brief Cancels the pending block
+   */
+  void StopRace (void);
+
+  /**
+   * \brief Draws the time of the next block from the total rate
+   */
+  void ScheduleNextBlock (void);
+
+  /**
+   * \brief Draws the winner and the size of the block, schedules the next block and injects the block into the winner
+   */
+  void InjectBlock (void);
+
+  std::vector<injectorLocation>   m_locations;
+  Ptr<const AliasSampler>         m_locationSampler;              //!< draws the index of the winning location
+  Ptr<const AliasSampler>         m_blockSizeSampler;
+  double                          m_totalRate;                    //!< blocks per second
+  double                          m_averageBlockGenIntervalSeconds;
+  enum Cryptocurrency             m_cryptocurrency;
+  int                             m_fixedBlockSize;
+  enum BlockBroadcastType         m_blockBroadcastType;
+  RandomStream                    m_stream;                       //!< draws the times, the winners and the sizes of the blocks
+  EventId                         m_nextBlockEvent;
+  uint64_t                        m_noBlocks;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_BLOCK_INJECTOR_H */
@@ -0,0 +1,153 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-block-time-sampler.h
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include "ns3/log.h"
+#include "bitcoin-block-time-sampler.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BlockTimeSampler");
+
+BlockTimeSampler::BlockTimeSampler (void)
+  : m_distribution (BLOCK_TIME_GEOMETRIC), m_stream (RNG_BLOCK_GENERATION, 0), m_binSeconds (0), m_meanSeconds (0), m_traceIndex (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BlockTimeSampler::~BlockTimeSampler (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+BlockTimeSampler::SetStream (uint32_t id)
+{
+  m_stream.SetStream (RNG_BLOCK_GENERATION, id);
+}
+
+void
+BlockTimeSampler::SetDistribution (enum BlockTimeDistribution distribution)
+{
+  m_distribution = distribution;
+}
+
+void
+BlockTimeSampler::SetTrace (const std::string &fileName)
+{
+  NS_LOG_FUNCTION (this << fileName);
+
+  m_trace = LoadTrace (fileName);
+  m_traceIndex = m_stream.GetInteger (m_trace->size ());
+}
+
+void
+BlockTimeSampler::SetParameters (double binSeconds, double blockGenParameter)
+{
+  NS_LOG_FUNCTION (this << binSeconds << blockGenParameter);
+
+  if (!(blockGenParameter > 0 && blockGenParameter < 1))
+    NS_FATAL_ERROR ("The block generation parameter must be in (0, 1), not " << blockGenParameter);
+
+  if (m_distribution == BLOCK_TIME_TRACE && !m_trace)
+    NS_FATAL_ERROR ("The trace of the block generation times has not been set");
+
+  m_binSeconds = binSeconds;
+  m_meanSeconds = (1 - blockGenParameter) / blockGenParameter * binSeconds;
+  m_geometric.param (std::geometric_distribution<int>::param_type (blockGenParameter));
+}
+
+enum BlockTimeDistribution
+BlockTimeSampler::GetDistribution (void) const
+{
+  return m_distribution;
+}
+
+double
+BlockTimeSampler::GetMean (void) const
+{
+  return m_meanSeconds;
+}
+
+double
+BlockTimeSampler::GetRate (void) const
+{
+  return 1 / m_meanSeconds;
+}
+
+double
+BlockTimeSampler::Draw (void)
+{
+  switch (m_distribution)
+  {
+    case BLOCK_TIME_EXPONENTIAL:
+      //1 - u is exact for the 53-bit uniforms, and log is about twice as fast as log1p
+      return -std::log (1 - m_stream.GetDouble ()) * m_meanSeconds;
+    case BLOCK_TIME_GEOMETRIC:
+      return m_geometric (m_stream) * m_binSeconds;
+    case BLOCK_TIME_TRACE:
+    {
+      double interval = (*m_trace)[m_traceIndex];
+
+      if (++m_traceIndex == m_trace->size ())
+        m_traceIndex = 0;
+      return interval * m_meanSeconds;
+    }
+  }
+  return 0;
+}
+
+std::shared_ptr<const std::vector<double>>
+BlockTimeSampler::LoadTrace (const std::string &fileName)
+{
+  static std::map<std::string, std::shared_ptr<const std::vector<double>>> traces;
+
+  auto loaded = traces.find (fileName);
+  if (loaded != traces.end ())
+    return loaded->second;
+
+  std::ifstream file (fileName.c_str ());
+  if (!file.is_open ())
+    NS_FATAL_ERROR ("Can't open the trace of the block generation times " << fileName);
+
+  std::shared_ptr<std::vector<double>>   intervals = std::make_shared<std::vector<double>> ();
+  std::string                            line;
+  double                                 sum = 0;
+  int                                    lineNumber = 0;
+
+  while (std::getline (file, line))
+  {
+    lineNumber++;
+
+    size_t start = line.find_first_not_of (" \t\r");
+    if (start == std::string::npos || line[start] == '#')
+      continue;
+
+    char    *end;
+    double   interval = strtod (line.c_str () + start, &end);
+
+    if (end == line.c_str () + start || !(interval >= 0))
+      NS_FATAL_ERROR ("Line " << lineNumber << " of " << fileName << " is not a non-negative interval: " << line);
+
+    intervals->push_back (interval);
+    sum += interval;
+  }
+
+  if (!(sum > 0))
+    NS_FATAL_ERROR ("The trace of the block generation times " << fileName << " has no positive interval");
+
+  double mean = sum / intervals->size ();
+  for (auto &interval : *intervals)
+    interval /= mean;
+
+  NS_LOG_INFO ("Loaded " << intervals->size () << " block intervals from " << fileName << " with mean = " << mean);
+
+  traces[fileName] = intervals;
+  return intervals;
+}
+
+} // namespace ns3
@@ -0,0 +1,98 @@
+/**
+ * This file contains the declaration of the BlockTimeSampler, which draws the block generation times of a miner.
+ */
+
+#ifndef BITCOIN_BLOCK_TIME_SAMPLER_H
+#define BITCOIN_BLOCK_TIME_SAMPLER_H
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "bitcoin.h"
+#include "bitcoin-random-stream.h"
+
+namespace ns3 {
+
+/**
+ * The sampler of the block generation times of a miner. The times are drawn according to the distribution:
+ *   - BLOCK_TIME_GEOMETRIC: the legacy draw, the number of bins of a std::geometric_distribution. It gives the same times
+ *     as the miners did before the sampler, and it is quantized by the bin
+ *   - BLOCK_TIME_EXPONENTIAL: the inverse CDF of the exponential, with the mean of the miner precomputed,
+ *     so each draw costs a single uniform and a logarithm
+ *   - BLOCK_TIME_TRACE: the intervals of a trace, e.g. the intervals between real blocks, scaled to the mean of the miner.
+ *     Each miner replays the trace from its own random offset, so the miners don't generate their blocks in lockstep
+ * The exponential and the trace are scaled to the mean of the geometric, (1 - p)/p bins of b seconds for the parameter p,
+ * so the three distributions have the same mean.
+ *
+ * The sampler is configured with SetStream, SetDistribution, SetTrace (for BLOCK_TIME_TRACE) and SetParameters, in this order.
+ */
+class BlockTimeSampler
+{
+public:
+  BlockTimeSampler (void);
+  ~BlockTimeSampler (void);
+
+  /**
+   * \brief Sets the stream of the draws to the RNG_BLOCK_GENERATION stream of the miner
+   * \param id the id of the miner
+   */
+  void SetStream (uint32_t id);
+
+  /**
+   * \brief Sets the distribution of the block generation times
+   */
+  void SetDistribution (enum BlockTimeDistribution distribution);
+
+  /**
+   * \brief Loads the intervals of a trace and draws the offset of the miner in the trace. The traces are loaded once per process.
+   * \param fileName a text file with an interval between two blocks per line, in any unit. Empty lines and lines
+   * starting with # are skipped
+   */
+  void SetTrace (const std::string &fileName);
+
+  /**
+   * \brief Sets the parameters of the geometric distribution of the miner, whose mean scales the exponential and the trace
+   * \param binSeconds the bin of the geometric distribution in seconds, already divided by the hash rate of the miner
+   * \param blockGenParameter the probability that a block is generated in a bin
+   */
+  void SetParameters (double binSeconds, double blockGenParameter);
+
+  /**
+   * \return the distribution of the block generation times
+   */
+  enum BlockTimeDistribution GetDistribution (void) const;
+
+  /**
+   * \return the mean block generation time of the miner in seconds
+   */
+  double GetMean (void) const;
+
+  /**
+   * \return the rate of the exponential race of the miner, in blocks per second. It is the inverse of the mean.
+   */
+  double GetRate (void) const;
+
+  /**
+   * \return the time until the next block of the miner in seconds
+   */
+  double Draw (void);
+
+private:
+  /**
+   * \return the intervals of a trace normalized to a mean of 1, loaded on the first use of the trace
+   */
+  static std::shared_ptr<const std::vector<double>> LoadTrace (const std::string &fileName);
+
+  enum BlockTimeDistribution                   m_distribution;
+  RandomStream                                 m_stream;
+  double                                       m_binSeconds;          // the bin of the geometric distribution
+  double                                       m_meanSeconds;         // the mean of the geometric, which scales the exponential and the trace
+  std::geometric_distribution<int>             m_geometric;
+  std::shared_ptr<const std::vector<double>>   m_trace;               // the normalized intervals, null unless BLOCK_TIME_TRACE
+  size_t                                       m_traceIndex;          // the next interval of the miner in the trace
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_BLOCK_TIME_SAMPLER_H */
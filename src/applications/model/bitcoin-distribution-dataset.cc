@@ -0,0 +1,313 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-distribution-dataset.h
+ */
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ns3/log.h"
+#include "bitcoin-distribution-dataset.h"
+#include "bandwidth-distributions.h"
+#include "block-size-distributions.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DistributionDataset");
+
+namespace {
+
+const char DATASET_MAGIC[8] = {'B', 'T', 'C', 'D', 'I', 'S', 'T', '1'};
+
+/**
+ * The mean latencies between the regions in ms, by BitcoinRegion (without OTHER)
+ */
+const std::array<double,36> regionLatencies {
+  35.5, 119.49, 254.79, 310.11, 154.36, 207.91,
+  119.49, 11.61, 221.08, 241.9, 266.45, 350.07,
+  254.79, 221.08, 137.09, 346.65, 255.95, 268.91,
+  310.11, 241.9, 346.65, 99.46, 172.24, 277.8,
+  154.36, 266.45, 255.95, 172.24, 8.76, 162.59,
+  207.91, 350.07, 268.91, 277.8, 162.59, 21.72};
+
+typedef struct {
+  const double   *values;
+  size_t          size;
+} builtinTable;
+
+template <size_t N>
+builtinTable
+MakeTable (const std::array<double,N> &table)
+{
+  return {table.data (), N};
+}
+
+const std::map<std::string, builtinTable>&
+GetBuiltinTables (void)
+{
+  static const std::map<std::string, builtinTable> tables {
+    {"region-latencies", MakeTable (regionLatencies)},
+    {"bitcoin-block-size-intervals", MakeTable (bitcoinBlockSizeIntervals)},
+    {"bitcoin-block-size-weights", MakeTable (bitcoinBlockSizeWeights)},
+    {"attacker-block-size-weights", MakeTable (attackerBlockSizeWeights)},
+    {"altcoin-block-size-intervals", MakeTable (altcoinBlockSizeIntervals)},
+    {"litecoin-block-size-weights", MakeTable (litecoinBlockSizeWeights)},
+    {"dogecoin-block-size-weights", MakeTable (dogecoinBlockSizeWeights)},
+    {"download-bandwidth-intervals", MakeTable (downloadBandwitdhIntervals)},
+    {"upload-bandwidth-intervals", MakeTable (uploadBandwitdhIntervals)},
+    {"north-america-download-weights", MakeTable (NorthAmericaDownloadWeights)},
+    {"north-america-upload-weights", MakeTable (NorthAmericaUploadWeights)},
+    {"europe-download-weights", MakeTable (EuropeDownloadWeights)},
+    {"europe-upload-weights", MakeTable (EuropeUploadWeights)},
+    {"south-america-download-weights", MakeTable (SouthAmericaDownloadWeights)},
+    {"south-america-upload-weights", MakeTable (SouthAmericaUploadWeights)},
+    {"asia-pacific-download-weights", MakeTable (AsiaPacificDownloadWeights)},
+    {"asia-pacific-upload-weights", MakeTable (AsiaPacificUploadWeights)},
+    {"japan-download-weights", MakeTable (JapanDownloadWeights)},
+    {"japan-upload-weights", MakeTable (JapanUploadWeights)},
+    {"australia-download-weights", MakeTable (AustraliaDownloadWeights)},
+    {"australia-upload-weights", MakeTable (AustraliaUploadWeights)}
+  };
+  return tables;
+}
+
+Ptr<const DistributionDataset>&
+GetDataset (void)
+{
+  static Ptr<const DistributionDataset> dataset;
+  return dataset;
+}
+
+uint32_t&
+GetDatasetVersion (void)
+{
+  static uint32_t version = 0;
+  return version;
+}
+
+} // namespace
+
+
+DistributionDataset::DistributionDataset (const std::string &fileName)
+  : m_fileName (fileName), m_data (nullptr), m_length (0)
+{
+  NS_LOG_FUNCTION (this << fileName);
+
+  int file = open (fileName.c_str (), O_RDONLY);
+  if (file < 0)
+    NS_FATAL_ERROR ("Can't open the distribution dataset " << fileName);
+
+  struct stat status;
+  if (fstat (file, &status) != 0 || status.st_size < static_cast<off_t> (sizeof(DATASET_MAGIC) + sizeof(uint64_t)))
+    NS_FATAL_ERROR ("The distribution dataset " << fileName << " is too short");
+
+  m_length = status.st_size;
+  void *data = mmap (nullptr, m_length, PROT_READ, MAP_SHARED, file, 0);
+  close (file);
+
+  if (data == MAP_FAILED)
+    NS_FATAL_ERROR ("Can't map the distribution dataset " << fileName);
+  m_data = static_cast<const char *> (data);
+
+  if (memcmp (m_data, DATASET_MAGIC, sizeof(DATASET_MAGIC)) != 0)
+    NS_FATAL_ERROR (fileName << " is not a distribution dataset");
+
+  uint64_t noTables;
+  memcpy (&noTables, m_data + sizeof(DATASET_MAGIC), sizeof(noTables));
+
+  size_t indexOffset = sizeof(DATASET_MAGIC) + sizeof(noTables);
+  if (noTables > (m_length - indexOffset) / sizeof(tableEntry))
+    NS_FATAL_ERROR ("The index of the distribution dataset " << fileName << " is truncated");
+
+  const tableEntry *entries = reinterpret_cast<const tableEntry *> (m_data + indexOffset);
+  for (uint64_t i = 0; i < noTables; i++)
+  {
+    const tableEntry &entry = entries[i];
+    std::string       name (entry.name, strnlen (entry.name, sizeof(entry.name)));
+
+    if (entry.offset % sizeof(double) != 0 || entry.offset > m_length || entry.size > (m_length - entry.offset) / sizeof(double))
+      NS_FATAL_ERROR ("The table " << name << " of the distribution dataset " << fileName << " is out of the file");
+
+    m_tables[name] = &entry;
+  }
+
+  NS_LOG_INFO ("Mapped " << m_tables.size () << " tables of " << fileName);
+}
+
+DistributionDataset::~DistributionDataset (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_data)
+    munmap (const_cast<char *> (m_data), m_length);
+}
+
+const double*
+DistributionDataset::GetTable (const std::string &name, size_t &size) const
+{
+  auto table = m_tables.find (name);
+
+  if (table == m_tables.end ())
+    return nullptr;
+
+  size = table->second->size;
+  return reinterpret_cast<const double *> (m_data + table->second->offset);
+}
+
+std::vector<std::string>
+DistributionDataset::GetTableNames (void) const
+{
+  std::vector<std::pair<uint64_t, std::string>> tables;
+  std::vector<std::string>                      names;
+
+  for (auto const &table : m_tables)
+    tables.push_back (std::make_pair (table.second->offset, table.first));
+  std::sort (tables.begin (), tables.end ());
+
+  for (auto const &table : tables)
+    names.push_back (table.second);
+  return names;
+}
+
+void
+DistributionDataset::Compile (const std::string &csvFileName, const std::string &fileName)
+{
+  std::ifstream                                           csv (csvFileName.c_str ());
+  std::vector<std::pair<std::string, std::vector<double>>> tables;
+  std::string                                             line;
+  int                                                     lineNumber = 0;
+
+  if (!csv.is_open ())
+    NS_FATAL_ERROR ("Can't open the CSV file " << csvFileName);
+
+  while (std::getline (csv, line))
+  {
+    lineNumber++;
+
+    size_t start = line.find_first_not_of (" \t\r");
+    if (start == std::string::npos || line[start] == '#')
+      continue;
+
+    std::istringstream   fields (line.substr (start));
+    std::string          name;
+    std::string          field;
+    std::vector<double>  values;
+
+    std::getline (fields, name, ',');
+    name.erase (name.find_last_not_of (" \t\r") + 1);
+    if (name.empty () || name.size () >= sizeof(tableEntry::name))
+      NS_FATAL_ERROR ("Line " << lineNumber << " of " << csvFileName << " has no table name or a name of 48 characters or more");
+
+    while (std::getline (fields, field, ','))
+    {
+      char    *end;
+      double   value = strtod (field.c_str (), &end);
+
+      if (end == field.c_str () || field.find_first_not_of (" \t\r", end - field.c_str ()) != std::string::npos)
+        NS_FATAL_ERROR ("Line " << lineNumber << " of " << csvFileName << ": " << field << " is not a number");
+      values.push_back (value);
+    }
+
+    if (values.empty ())
+      NS_FATAL_ERROR ("The table " << name << " of " << csvFileName << " has no values");
+    tables.push_back (std::make_pair (name, values));
+  }
+
+  std::ofstream output (fileName.c_str (), std::ios::binary);
+  if (!output.is_open ())
+    NS_FATAL_ERROR ("Can't create the distribution dataset " << fileName);
+
+  uint64_t noTables = tables.size ();
+  uint64_t offset = sizeof(DATASET_MAGIC) + sizeof(noTables) + noTables * sizeof(tableEntry);
+
+  output.write (DATASET_MAGIC, sizeof(DATASET_MAGIC));
+  output.write (reinterpret_cast<const char *> (&noTables), sizeof(noTables));
+
+  for (auto const &table : tables)
+  {
+    tableEntry entry;
+
+    memset (&entry, 0, sizeof(entry));
+    memcpy (entry.name, table.first.c_str (), table.first.size ());
+    entry.offset = offset;
+    entry.size = table.second.size ();
+    output.write (reinterpret_cast<const char *> (&entry), sizeof(entry));
+
+    offset += entry.size * sizeof(double);
+  }
+
+  for (auto const &table : tables)
+    output.write (reinterpret_cast<const char *> (table.second.data ()), table.second.size () * sizeof(double));
+
+  if (!output.good ())
+    NS_FATAL_ERROR ("Can't write the distribution dataset " << fileName);
+}
+
+void
+DistributionDataset::WriteCsv (const std::map<std::string, std::vector<double>> &tables, const std::string &csvFileName)
+{
+  std::ofstream csv (csvFileName.c_str ());
+
+  if (!csv.is_open ())
+    NS_FATAL_ERROR ("Can't create the CSV file " << csvFileName);
+
+  csv << "# name,values...\n";
+  csv.precision (17);
+  for (auto const &table : tables)
+  {
+    csv << table.first;
+    for (auto value : table.second)
+      csv << "," << value;
+    csv << "\n";
+  }
+}
+
+
+void
+SetDistributionDataset (Ptr<const DistributionDataset> dataset)
+{
+  GetDataset () = dataset;
+  GetDatasetVersion ()++;
+}
+
+uint32_t
+GetDistributionDatasetVersion (void)
+{
+  return GetDatasetVersion ();
+}
+
+const double*
+GetDistributionTable (const std::string &name, size_t &size)
+{
+  if (GetDataset ())
+  {
+    const double *values = GetDataset ()->GetTable (name, size);
+    if (values)
+      return values;
+  }
+
+  auto builtin = GetBuiltinTables ().find (name);
+  if (builtin == GetBuiltinTables ().end ())
+    NS_FATAL_ERROR ("There is no distribution table " << name);
+
+  size = builtin->second.size;
+  return builtin->second.values;
+}
+
+std::map<std::string, std::vector<double>>
+GetBuiltinDistributionTables (void)
+{
+  std::map<std::string, std::vector<double>> tables;
+
+  for (auto const &table : GetBuiltinTables ())
+    tables[table.first] = std::vector<double> (table.second.values, table.second.values + table.second.size);
+  return tables;
+}
+
+} // namespace ns3
@@ -0,0 +1,102 @@
+/**
+ * This file contains the declaration of the DistributionDataset, which maps a file of distribution tables in memory,
+ * and of the lookup of the tables used by the simulation.
+ */
+
+#ifndef BITCOIN_DISTRIBUTION_DATASET_H
+#define BITCOIN_DISTRIBUTION_DATASET_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * A read-only dataset of named tables of doubles, e.g. the weights of the bandwidth distributions of a new crawl.
+ * The dataset is a binary file which is memory-mapped, so its tables are never copied: all the nodes of a process
+ * read the same pages, and the processes of an MPI run on the same host share them through the page cache.
+ *
+ * The file is compiled from a CSV file with Compile, e.g. with scratch/distribution-dataset. Its layout, in the
+ * byte order of the host, is:
+ *   - the header: the magic "BTCDIST1", the number of tables (uint64)
+ *   - the index: per table, its name (48 chars, 0-padded), the offset of its values from the start of the file
+ *     and the number of its values (uint64)
+ *   - the values of the tables (double)
+ */
+class DistributionDataset : public SimpleRefCount<DistributionDataset>
+{
+public:
+  /**
+   * \brief Maps a dataset file. It is a fatal error if the file can't be mapped or is not a valid dataset.
+   */
+  DistributionDataset (const std::string &fileName);
+  ~DistributionDataset (void);
+
+  /**
+   * \param name the name of the table
+   * \param size set to the number of values of the table
+   * \return the values of the table, or null if the dataset has no such table
+   */
+  const double* GetTable (const std::string &name, size_t &size) const;
+
+  /**
+   * \return the names of the tables, in the order of the file
+   */
+  std::vector<std::string> GetTableNames (void) const;
+
+  /**
+   * \brief Compiles a CSV file to a dataset file. Each line of the CSV file is a table: its name followed by its values,
+   * separated by commas. Empty lines and lines starting with # are skipped.
+   */
+  static void Compile (const std::string &csvFileName, const std::string &fileName);
+
+  /**
+   * \brief Writes tables to a CSV file which Compile accepts
+   */
+  static void WriteCsv (const std::map<std::string, std::vector<double>> &tables, const std::string &csvFileName);
+
+private:
+  typedef struct {
+    char       name[48];
+    uint64_t   offset;      // in Bytes from the start of the file
+    uint64_t   size;        // the number of values
+  } tableEntry;
+
+  std::string                  m_fileName;
+  const char                  *m_data;       // the mapped file
+  size_t                       m_length;     // the length of the mapping in Bytes
+  std::map<std::string, const tableEntry *>  m_tables;
+};
+
+
+/**
+ * \brief Sets the dataset of the process. Its tables replace the built-in tables of the same name.
+ * It must be set before the topology is built and before the miners start.
+ */
+void SetDistributionDataset (Ptr<const DistributionDataset> dataset);
+
+/**
+ * \return the version of the dataset of the process, which changes whenever SetDistributionDataset is called. The objects
+ * built from the tables, e.g. the shared samplers, are rebuilt when it changes.
+ */
+uint32_t GetDistributionDatasetVersion (void);
+
+/**
+ * \param name the name of the table
+ * \param size set to the number of values of the table
+ * \return the table of the dataset of the process, or the built-in table of the same name. It is a fatal error if there is neither.
+ */
+const double* GetDistributionTable (const std::string &name, size_t &size);
+
+/**
+ * \return a copy of the built-in tables, by name
+ */
+std::map<std::string, std::vector<double>> GetBuiltinDistributionTables (void);
+
+} // namespace ns3
+
+#endif /* BITCOIN_DISTRIBUTION_DATASET_H */
@@ -0,0 +1,93 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-fast-link-channel.h
+ */
+
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/inet-socket-address.h"
+#include "bitcoin-fast-link-channel.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FastLinkChannel");
+
+FastLinkChannel::FastLinkChannel (void)
+{
+}
+
+FastLinkChannel::~FastLinkChannel (void)
+{
+}
+
+void
+FastLinkChannel::AddLink (uint32_t node1, Ipv4Address address1, uint32_t node2, Ipv4Address address2, double latency, double bandwidth)
+{
+  NS_LOG_FUNCTION (this);
+
+  fastLink forward = {node2, address1, latency / 1000, bandwidth * 1000000 / 8, 0};
+  fastLink backward = {node1, address2, latency / 1000, bandwidth * 1000000 / 8, 0};
+
+  m_links[GetLinkKey(node1, address2)] = forward;
+  m_links[GetLinkKey(node2, address1)] = backward;
+}
+
+void
+FastLinkChannel::SetReceiveCallback (uint32_t nodeId, ReceiveCallback callback)
+{
+  m_receivers[nodeId] = callback;
+}
+
+void
+FastLinkChannel::Send (uint32_t nodeId, Ipv4Address peer, const std::string &message)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto link_it = m_links.find(GetLinkKey(nodeId, peer));
+
+  if (link_it == m_links.end())
+    NS_FATAL_ERROR ("Node " << nodeId << " is not linked with " << peer);
+
+  fastLink &link = link_it->second;
+  double    now = Simulator::Now ().GetSeconds ();
+
+  /**
+   * The message is transmitted after the messages already queued on the link and
+   * arrives one latency after its last Byte has been transmitted.
+   */
+  link.busyUntil = std::max(now, link.busyUntil) + message.size() / link.bandwidth;
+
+  NS_LOG_INFO ("Send: At time " << now << " node " << nodeId << " sent " << message.size()
+               << " Bytes to " << peer << ", which arrive at " << link.busyUntil + link.latency);
+
+  Simulator::ScheduleWithContext (link.peerId, Seconds (link.busyUntil + link.latency - now), &FastLinkChannel::Deliver, this,
+                                  link.peerId, message, InetSocketAddress (link.localAddress));
+}
+
+size_t
+FastLinkChannel::GetNoLinks (void) const
+{
+  return m_links.size() / 2;
+}
+
+void
+FastLinkChannel::Deliver (uint32_t nodeId, std::string message, Address from)
+{
+  NS_LOG_FUNCTION (this);
+
+  auto receiver_it = m_receivers.find(nodeId);
+
+  if (receiver_it == m_receivers.end())
+    NS_FATAL_ERROR ("Node " << nodeId << " is not attached to the fast link channel. All the nodes must run in the same process");
+
+  if (!receiver_it->second.IsNull ())
+    receiver_it->second (message, from);
+}
+
+uint64_t
+FastLinkChannel::GetLinkKey (uint32_t nodeId, Ipv4Address peer)
+{
+  return (static_cast<uint64_t>(nodeId) << 32) | peer.Get ();
+}
+
+} // namespace ns3
@@ -0,0 +1,93 @@
+/**
+ * This file contains the declaration of the FastLinkChannel, which delivers the messages of the bitcoin nodes
+ * without going through the TCP/IP stack.
+ */
+
+#ifndef BITCOIN_FAST_LINK_CHANNEL_H
+#define BITCOIN_FAST_LINK_CHANNEL_H
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include "ns3/address.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/callback.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * An analytic model of the point-to-point links created by the BitcoinTopologyHelper. Every direction of a link
+ * transmits one message at a time at the link bandwidth, and the message is delivered to the peer after the link latency.
+ * Delivering a message costs a single simulator event, instead of the TCP segments and IP packets of the full stack,
+ * so the model is suitable for large topologies where the TCP dynamics do not matter.
+ * All the nodes must be simulated by the same process, since the deliveries are scheduled directly on the simulator.
+ */
+class FastLinkChannel : public SimpleRefCount<FastLinkChannel>
+{
+public:
+  /**
+   * Invoked with the received message and the address of the sender on the link
+   */
+  typedef Callback<void, const std::string &, const Address &> ReceiveCallback;
+
+  FastLinkChannel (void);
+  ~FastLinkChannel (void);
+
+  /**
+   * \brief Creates a link between two nodes. Both directions have the same latency and bandwidth.
+   * \param node1 the id of the first node
+   * \param address1 the address of the first node on the link
+   * \param node2 the id of the second node
+   * \param address2 the address of the second node on the link
+   * \param latency the latency of the link in ms
+   * \param bandwidth the bandwidth of the link in Mbps
+   */
+  void AddLink (uint32_t node1, Ipv4Address address1, uint32_t node2, Ipv4Address address2, double latency, double bandwidth);
+
+  /**
+   * \brief Sets the callback which receives the messages delivered to a node
+   * \param nodeId the id of the node
+   * \param callback the callback. A null callback drops the messages delivered to the node
+   */
+  void SetReceiveCallback (uint32_t nodeId, ReceiveCallback callback);
+
+  /**
+   * \brief Transmits a message over the link between a node and its peer
+   * \param nodeId the id of the sending node
+   * \param peer the address of the peer on the link
+   * \param message the message
+   */
+  void Send (uint32_t nodeId, Ipv4Address peer, const std::string &message);
+
+  /**
+   * \return the number of links
+   */
+  size_t GetNoLinks (void) const;
+
+private:
+  typedef struct {
+    uint32_t     peerId;            // the id of the node on the other end of the link
+    Ipv4Address  localAddress;      // the address of the sending node on the link
+    double       latency;           // in seconds
+    double       bandwidth;         // in Bytes/s
+    double       busyUntil;         // the time when the last queued message has been transmitted
+  } fastLink;
+
+  /**
+   * \brief Delivers a message to the receive callback of a node
+   */
+  void Deliver (uint32_t nodeId, std::string message, Address from);
+
+  /**
+   * \return the key of the link from a node to the peer with the given address
+   */
+  static uint64_t GetLinkKey (uint32_t nodeId, Ipv4Address peer);
+
+  std::unordered_map<uint64_t, fastLink>     m_links;          // key = (sending node id, peer address), one entry per direction
+  std::map<uint32_t, ReceiveCallback>        m_receivers;      // key = nodeId
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_FAST_LINK_CHANNEL_H */
@@ -0,0 +1,261 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-link-scheduler.h
+ */
+
+#include <algorithm>
+#include <limits>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "bitcoin-link-scheduler.h"
+#include "bitcoin-memory-accountant.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LinkScheduler");
+
+LinkScheduler::LinkScheduler (void)
+  : m_rate (0),
+    m_discipline (LINK_FIFO),
+    m_busy (false),
+    m_size (0),
+    m_sizeCounter (0),
+    m_lastUpdate (0)
+{
+}
+
+LinkScheduler::~LinkScheduler (void)
+{
+}
+
+void
+LinkScheduler::SetRate (double rate)
+{
+  m_rate = rate;
+}
+
+void
+LinkScheduler::SetDiscipline (enum LinkDiscipline discipline)
+{
+  m_discipline = discipline;
+}
+
+void
+LinkScheduler::SetSizeCounter (int64_t *counter)
+{
+  m_sizeCounter = counter;
+}
+
+void
+LinkScheduler::Enqueue (Ipv4Address peer, double bytes, double peerRate, TransferHandler onStart, TransferHandler onComplete)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (m_rate > 0, "The rate of the link has not been set");
+
+  std::vector<TransferHandler>  handlers;
+  std::deque<linkTransfer>     &queue = m_queues[peer];
+  linkTransfer                  transfer = {bytes, peerRate, 0, onStart, onComplete};
+
+  Advance ();
+  queue.push_back(transfer);
+  m_size++;
+  if (m_sizeCounter)
+    (*m_sizeCounter)++;
+
+  if (m_discipline == LINK_FIFO)
+    m_turns.push_back(peer);
+  else if (m_discipline == LINK_ROUND_ROBIN && queue.size() == 1)
+    m_turns.push_back(peer);
+  else if (m_discipline == LINK_FAIR_SHARE && queue.size() > 1)
+    return;                     // The transfer waits for the previous transfers of the peer, so the shares do not change
+
+  Dispatch (handlers);
+
+  for (auto &handler : handlers)
+    handler ();
+}
+
+size_t
+LinkScheduler::GetSize (void) const
+{
+  return m_size;
+}
+
+uint64_t
+LinkScheduler::GetMemory (void) const
+{
+  uint64_t bytes = MapMemory (m_queues) + DequeMemory (m_turns);
+
+  for (auto const &queue : m_queues)
+    bytes += DequeMemory (queue.second);
+  return bytes;
+}
+
+void
+LinkScheduler::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_completionEvent.Cancel ();
+  m_queues.clear();
+  m_turns.clear();
+  m_busy = false;
+  if (m_sizeCounter)
+    *m_sizeCounter -= m_size;
+  m_size = 0;
+}
+
+void
+LinkScheduler::Advance (void)
+{
+  double now = Simulator::Now ().GetSeconds ();
+  double elapsed = now - m_lastUpdate;
+
+  m_lastUpdate = now;
+  if (elapsed <= 0)
+    return;
+
+  if (m_discipline == LINK_FAIR_SHARE)
+  {
+    for (auto &peerQueue : m_queues)
+    {
+      linkTransfer &transfer = peerQueue.second.front();
+      transfer.remainingBytes = std::max(0.0, transfer.remainingBytes - transfer.rate * elapsed);
+    }
+  }
+  else if (m_busy)
+  {
+    linkTransfer &transfer = m_queues[m_current].front();
+    transfer.remainingBytes = std::max(0.0, transfer.remainingBytes - transfer.rate * elapsed);
+  }
+}
+
+void
+LinkScheduler::Dispatch (std::vector<TransferHandler> &handlers)
+{
+  if (m_discipline == LINK_FAIR_SHARE)
+  {
+    /**
+     * The first transfer of every peer is in service. The ones which have not been started yet have no rate.
+     */
+    for (auto &peerQueue : m_queues)
+    {
+      linkTransfer &transfer = peerQueue.second.front();
+      if (transfer.rate == 0 && transfer.onStart)
+        handlers.push_back(transfer.onStart);
+    }
+
+    ShareRate ();
+    ScheduleCompletion ();
+    return;
+  }
+
+  if (m_busy || m_turns.empty())
+    return;
+
+  m_current = m_turns.front();
+  m_turns.pop_front();
+  m_busy = true;
+
+  linkTransfer &transfer = m_queues[m_current].front();
+  transfer.rate = (transfer.peerRate > 0) ? std::min(m_rate, transfer.peerRate) : m_rate;
+  if (transfer.onStart)
+    handlers.push_back(transfer.onStart);
+
+  ScheduleCompletion ();
+}
+
+void
+LinkScheduler::ShareRate (void)
+{
+  std::vector<linkTransfer *> transfers;
+  double                      available = m_rate;
+
+  for (auto &peerQueue : m_queues)
+    transfers.push_back(&peerQueue.second.front());
+
+  /**
+   * Water-filling: the transfers capped below their equal share keep their cap,
+   * and the rest of the link rate is shared equally by the remaining transfers.
+   */
+  std::sort(transfers.begin(), transfers.end(), [](const linkTransfer *a, const linkTransfer *b)
+    {
+      if (a->peerRate == 0 || b->peerRate == 0)
+        return b->peerRate == 0 && a->peerRate != 0;
+      return a->peerRate < b->peerRate;
+    });
+
+  for (size_t i = 0; i < transfers.size(); i++)
+  {
+    double share = available / (transfers.size() - i);
+
+    transfers[i]->rate = (transfers[i]->peerRate > 0) ? std::min(share, transfers[i]->peerRate) : share;
+    available -= transfers[i]->rate;
+  }
+}
+
+void
+LinkScheduler::ScheduleCompletion (void)
+{
+  double delay = std::numeric_limits<double>::infinity();
+
+  m_completionEvent.Cancel ();
+
+  if (m_discipline == LINK_FAIR_SHARE)
+  {
+    for (auto &peerQueue : m_queues)
+    {
+      const linkTransfer &transfer = peerQueue.second.front();
+      if (transfer.remainingBytes / transfer.rate < delay)
+      {
+        delay = transfer.remainingBytes / transfer.rate;
+        m_next = peerQueue.first;
+      }
+    }
+  }
+  else if (m_busy)
+  {
+    const linkTransfer &transfer = m_queues[m_current].front();
+    delay = transfer.remainingBytes / transfer.rate;
+    m_next = m_current;
+  }
+
+  if (delay < std::numeric_limits<double>::infinity())
+    m_completionEvent = Simulator::Schedule (Seconds (delay), &LinkScheduler::CompleteTransfer, this);
+}
+
+void
+LinkScheduler::CompleteTransfer (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<TransferHandler> handlers;
+
+  Advance ();
+
+  auto          queue_it = m_queues.find(m_next);
+  linkTransfer  transfer = queue_it->second.front();
+
+  queue_it->second.pop_front();
+  if (queue_it->second.empty())
+    m_queues.erase(queue_it);
+  else if (m_discipline == LINK_ROUND_ROBIN)
+    m_turns.push_back(m_next);
+
+  m_size--;
+  if (m_sizeCounter)
+    (*m_sizeCounter)--;
+  m_busy = false;
+
+  NS_LOG_INFO ("CompleteTransfer: At time " << Simulator::Now ().GetSeconds () << " a transfer with " << m_next << " was completed");
+
+  if (transfer.onComplete)
+    handlers.push_back(transfer.onComplete);
+
+  Dispatch (handlers);
+
+  for (auto &handler : handlers)
+    handler ();
+}
+
+} // namespace ns3
@@ -0,0 +1,128 @@
+/**
+ * This file contains the declaration of the LinkScheduler, which serializes the block and chunk transfers
+ * of a node over its upload or download link.
+ */
+
+#ifndef BITCOIN_LINK_SCHEDULER_H
+#define BITCOIN_LINK_SCHEDULER_H
+
+#include <deque>
+#include <map>
+#include <vector>
+#include <functional>
+#include "ns3/address.h"
+#include "ns3/event-id.h"
+#include "bitcoin.h"
+
+namespace ns3 {
+
+/**
+ * The scheduler of a node link. Each peer has its own queue of transfers and the queues are served according to the discipline:
+ *   - LINK_FIFO: one transfer at a time, in the order they were queued
+ *   - LINK_ROUND_ROBIN: one transfer at a time, taking turns between the peers which have queued transfers
+ *   - LINK_FAIR_SHARE: the first transfer of every peer is served concurrently, sharing the link rate max-min fairly
+ * A transfer is never served faster than the rate of the peer on the other end of the link.
+ * The scheduler keeps a single pending event, for the next completion, so each transfer costs one simulator event.
+ */
+class LinkScheduler
+{
+public:
+  typedef std::function<void (void)> TransferHandler;
+
+  LinkScheduler (void);
+  ~LinkScheduler (void);
+
+  /**
+   * \brief Sets the rate of the link. It should be called before the first transfer is queued.
+   * \param rate the rate in Bytes/s
+   */
+  void SetRate (double rate);
+
+  /**
+   * \brief Sets the discipline of the link. It should be called before the first transfer is queued.
+   * \param discipline the discipline
+   */
+  void SetDiscipline (enum LinkDiscipline discipline);
+
+  /**
+   * \brief Sets a counter which follows the number of transfers of the link, e.g. a total shared by the links of many nodes
+   * \param counter the counter, which is increased and decreased along with GetSize. It can be null
+   */
+  void SetSizeCounter (int64_t *counter);
+
+  /**
+   * \brief Queues a transfer
+   * \param peer the peer on the other end of the link
+   * \param bytes the size of the transfer in Bytes
+   * \param peerRate the rate of the peer in Bytes/s, which caps the rate of the transfer. 0 means that the transfer is not capped
+   * \param onStart invoked when the transfer starts being served. It can be empty
+   * \param onComplete invoked when the last Byte of the transfer has been served. It can be empty
+   */
+  void Enqueue (Ipv4Address peer, double bytes, double peerRate, TransferHandler onStart, TransferHandler onComplete);
+
+  /**
+   * \return the number of transfers which have not been completed yet
+   */
+  size_t GetSize (void) const;
+
+  /**
+   * \return the estimated Bytes held by the queues, excluding the state captured by the handlers of the transfers
+   */
+  uint64_t GetMemory (void) const;
+
+  /**
+   * \brief Drops the queued transfers and cancels the pending event
+   */
+  void Clear (void);
+
+private:
+  typedef struct {
+    double           remainingBytes;      // the Bytes which have not been served yet
+    double           peerRate;            // the rate cap of the transfer in Bytes/s, 0 if it is not capped
+    double           rate;                // the current rate of the transfer in Bytes/s, 0 if it is waiting
+    TransferHandler  onStart;
+    TransferHandler  onComplete;
+  } linkTransfer;
+
+  /**
+   * \brief Charges the Bytes served since the last update to the transfers in service
+   */
+  void Advance (void);
+
+  /**
+   * \brief Starts the next transfers according to the discipline and updates their rates
+   * \param handlers collects the onStart handlers of the started transfers
+   */
+  void Dispatch (std::vector<TransferHandler> &handlers);
+
+  /**
+   * \brief Shares the link rate max-min fairly between the first transfers of all the peers
+   */
+  void ShareRate (void);
+
+  /**
+   * \brief Schedules the event of the next completion, replacing the pending one
+   */
+  void ScheduleCompletion (void);
+
+  /**
+   * \brief The completion event. Completes the next transfer and dispatches the following ones
+   */
+  void CompleteTransfer (void);
+
+  double                                              m_rate;           // the link rate in Bytes/s
+  enum LinkDiscipline                                 m_discipline;     // the discipline of the link
+  std::map<Ipv4Address, std::deque<linkTransfer>>     m_queues;         // the transfers of each peer. With LINK_FAIR_SHARE, the first one of each peer is in service
+  std::deque<Ipv4Address>                             m_turns;          // LINK_FIFO: the peers of the waiting transfers in arrival order. LINK_ROUND_ROBIN: the peers with waiting transfers in turn order
+  bool                                                m_busy;           // LINK_FIFO and LINK_ROUND_ROBIN: whether a transfer is in service
+  Ipv4Address                                         m_current;        // LINK_FIFO and LINK_ROUND_ROBIN: the peer of the transfer in service
+  Ipv4Address                                         m_next;           // the peer of the transfer which completes next
+  size_t                                              m_size;           // the number of queued transfers
+  int64_t                                            *m_sizeCounter;    // the external counter of the transfers, null if there is none
+  double                                              m_lastUpdate;     // the time of the last call to Advance
+  EventId                                             m_completionEvent;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_LINK_SCHEDULER_H */
@@ -0,0 +1,43 @@
+/**
+ * This file contains the logging macros of the message path, i.e. the code which runs for every message
+ * (HandleRead/HandleMessage, SendMessage, the advertisements of the blocks).
+ *
+ * They behave like the NS_LOG macros: the arguments are only evaluated when the level of the log component is enabled,
+ * so a message is only serialized with MessageToString for an enabled component. When BITCOIN_NO_MESSAGE_LOGS is defined
+ * (e.g. CXXFLAGS="-DBITCOIN_NO_MESSAGE_LOGS"), they are compiled out entirely, including the check of the level,
+ * while the rest of the logs of the module are kept. The arguments are still type checked in that case.
+ */
+
+#ifndef BITCOIN_LOG_H
+#define BITCOIN_LOG_H
+
+#include <iostream>
+#include "ns3/log.h"
+
+#ifdef BITCOIN_NO_MESSAGE_LOGS
+
+#define BITCOIN_MESSAGE_LOG_DISCARD(msg)  \
+  do                                      \
+    {                                     \
+      if (false)                          \
+        {                                 \
+          std::clog << msg;               \
+        }                                 \
+    }                                     \
+  while (false)
+
+#define BITCOIN_MESSAGE_LOG_FUNCTION(parameters)  do { } while (false)
+#define BITCOIN_MESSAGE_LOG_DEBUG(msg)            BITCOIN_MESSAGE_LOG_DISCARD (msg)
+#define BITCOIN_MESSAGE_LOG_INFO(msg)             BITCOIN_MESSAGE_LOG_DISCARD (msg)
+#define BITCOIN_MESSAGE_LOG_WARN(msg)             BITCOIN_MESSAGE_LOG_DISCARD (msg)
+
+#else
+
+#define BITCOIN_MESSAGE_LOG_FUNCTION(parameters)  NS_LOG_FUNCTION (parameters)
+#define BITCOIN_MESSAGE_LOG_DEBUG(msg)            NS_LOG_DEBUG (msg)
+#define BITCOIN_MESSAGE_LOG_INFO(msg)             NS_LOG_INFO (msg)
+#define BITCOIN_MESSAGE_LOG_WARN(msg)             NS_LOG_WARN (msg)
+
+#endif /* BITCOIN_NO_MESSAGE_LOGS */
+
+#endif /* BITCOIN_LOG_H */
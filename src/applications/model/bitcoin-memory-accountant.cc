@@ -0,0 +1,198 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-memory-accountant.h
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <algorithm>
+#include <sys/resource.h>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "bitcoin-node.h"
+#include "bitcoin-memory-accountant.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MemoryAccountant");
+
+MemoryAccountant::MemoryAccountant (void)
+  : m_role (0), m_peakTotal (0), m_peakTime (0), m_noMeasurements (0), m_peakRssKB (0), m_noProcesses (1)
+{
+  NS_LOG_FUNCTION (this);
+  memset (m_noNodes, 0, sizeof(m_noNodes));
+  memset (m_bytes, 0, sizeof(m_bytes));
+  memset (m_peakBytes, 0, sizeof(m_peakBytes));
+}
+
+MemoryAccountant::~MemoryAccountant (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MemoryAccountant::Register (const BitcoinNode *node)
+{
+  m_nodes.push_back (node);
+}
+
+void
+MemoryAccountant::Start (Time interval)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!interval.IsStrictlyPositive ())
+    NS_FATAL_ERROR ("The interval of the memory measurements must be positive");
+
+  m_interval = interval;
+  Simulator::Schedule (m_interval, &MemoryAccountant::Sample, this);
+}
+
+void
+MemoryAccountant::Measure (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  memset (m_noNodes, 0, sizeof(m_noNodes));
+  memset (m_bytes, 0, sizeof(m_bytes));
+
+  for (auto node : m_nodes)
+    node->AccountMemory (*this);
+
+  double total = 0;
+  for (int role = 0; role < 2; role++)
+  {
+    for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEMS; subsystem++)
+    {
+      m_peakBytes[role][subsystem] = std::max (m_peakBytes[role][subsystem], m_bytes[role][subsystem]);
+      total += m_bytes[role][subsystem];
+    }
+  }
+
+  if (total > m_peakTotal)
+  {
+    m_peakTotal = total;
+    m_peakTime = Simulator::Now ().GetSeconds ();
+  }
+
+  struct rusage usage;
+  if (getrusage (RUSAGE_SELF, &usage) == 0)
+    m_peakRssKB = usage.ru_maxrss;
+
+  m_noMeasurements++;
+}
+
+void
+MemoryAccountant::AddNode (bool isMiner)
+{
+  m_role = isMiner ? 1 : 0;
+  m_noNodes[m_role]++;
+}
+
+void
+MemoryAccountant::Add (enum MemorySubsystem subsystem, uint64_t bytes)
+{
+  m_bytes[m_role][subsystem] += bytes;
+}
+
+double
+MemoryAccountant::GetBytes (bool miners, enum MemorySubsystem subsystem) const
+{
+  return m_bytes[miners ? 1 : 0][subsystem];
+}
+
+void
+MemoryAccountant::Merge (uint32_t systemId, uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (systemCount == 1)
+    return;
+
+#ifdef NS3_MPI
+  double noNodes[2];
+  double bytes[2][MEMORY_SUBSYSTEMS];
+  double peakBytes[2][MEMORY_SUBSYSTEMS];
+  double peakTotal;
+  double peakRssKB;
+
+  MPI_Reduce (m_noNodes, noNodes, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (m_bytes, bytes, 2 * MEMORY_SUBSYSTEMS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (m_peakBytes, peakBytes, 2 * MEMORY_SUBSYSTEMS, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (&m_peakTotal, &peakTotal, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (&m_peakRssKB, &peakRssKB, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  if (systemId == 0)
+  {
+    memcpy (m_noNodes, noNodes, sizeof(m_noNodes));
+    memcpy (m_bytes, bytes, sizeof(m_bytes));
+    memcpy (m_peakBytes, peakBytes, sizeof(m_peakBytes));
+    m_peakTotal = peakTotal;
+    m_peakRssKB = peakRssKB;
+    m_noProcesses = systemCount;
+  }
+#else
+  NS_FATAL_ERROR ("Can't merge the memory measurements of multiple processes without MPI compiled in");
+#endif
+}
+
+void
+MemoryAccountant::PrintReport (std::ostream &os) const
+{
+  const double         MB = 1024 * 1024;
+  std::vector<int>     subsystems;
+  double               totals[2] = {0, 0};
+
+  for (int subsystem = 0; subsystem < MEMORY_SUBSYSTEMS; subsystem++)
+  {
+    subsystems.push_back (subsystem);
+    totals[0] += m_bytes[0][subsystem];
+    totals[1] += m_bytes[1][subsystem];
+  }
+
+  std::sort(subsystems.begin(), subsystems.end(), [this] (int a, int b)
+            { return m_bytes[0][a] + m_bytes[1][a] > m_bytes[0][b] + m_bytes[1][b]; });
+
+  os << "\nMemory accounting (" << m_noMeasurements << " measurements, "
+     << m_noNodes[1] << " miners, " << m_noNodes[0] << " nodes):\n"
+     << std::left << std::setw (20) << "subsystem" << std::right << std::setw (14) << "miners (MB)"
+     << std::setw (16) << "per miner (KB)" << std::setw (14) << "nodes (MB)" << std::setw (16) << "per node (KB)"
+     << std::setw (14) << "peak (MB)" << "\n";
+
+  os << std::fixed;
+  for (int subsystem : subsystems)
+  {
+    os << std::left << std::setw (20) << getMemorySubsystem (static_cast<enum MemorySubsystem>(subsystem)) << std::right
+       << std::setprecision (2) << std::setw (14) << m_bytes[1][subsystem] / MB
+       << std::setprecision (1) << std::setw (16) << m_bytes[1][subsystem] / 1024 / std::max (m_noNodes[1], 1.)
+       << std::setprecision (2) << std::setw (14) << m_bytes[0][subsystem] / MB
+       << std::setprecision (1) << std::setw (16) << m_bytes[0][subsystem] / 1024 / std::max (m_noNodes[0], 1.)
+       << std::setprecision (2) << std::setw (14) << (m_peakBytes[0][subsystem] + m_peakBytes[1][subsystem]) / MB << "\n";
+  }
+
+  os << std::left << std::setw (20) << "total" << std::right
+     << std::setprecision (2) << std::setw (14) << totals[1] / MB
+     << std::setprecision (1) << std::setw (16) << totals[1] / 1024 / std::max (m_noNodes[1], 1.)
+     << std::setprecision (2) << std::setw (14) << totals[0] / MB
+     << std::setprecision (1) << std::setw (16) << totals[0] / 1024 / std::max (m_noNodes[0], 1.)
+     << std::setprecision (2) << std::setw (14) << m_peakTotal / MB << "\n";
+
+  if (m_noProcesses == 1)
+    os << "The peak of the accounted memory was at " << m_peakTime << "s.\n";
+
+  os << "Peak RSS of the " << m_noProcesses << " process(es) = " << m_peakRssKB / 1024 << "MB, of which "
+     << std::setprecision (1) << 100. * (totals[0] + totals[1]) / (std::max (m_peakRssKB, 1.) * 1024) << "% is accounted at the end of the run\n";
+  os.unsetf (std::ios::fixed);
+}
+
+void
+MemoryAccountant::Sample (void)
+{
+  Measure ();
+  Simulator::Schedule (m_interval, &MemoryAccountant::Sample, this);
+}
+
+} // namespace ns3
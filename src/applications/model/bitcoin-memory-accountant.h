@@ -0,0 +1,153 @@
+/**
+ * This file contains the declaration of the MemoryAccountant, which estimates the memory held by the subsystems of the nodes,
+ * and the estimators of the memory of the standard containers.
+ */
+
+#ifndef BITCOIN_MEMORY_ACCOUNTANT_H
+#define BITCOIN_MEMORY_ACCOUNTANT_H
+
+#include <map>
+#include <deque>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "bitcoin.h"
+
+namespace ns3 {
+
+class BitcoinNode;
+
+/**
+ * The number of subsystems of the accounting
+ */
+const int MEMORY_SUBSYSTEMS = MEMORY_DEVICES + 1;
+
+/**
+ * Fixed estimates of the ns-3 objects whose size is not visible to the applications: a TCP socket with its
+ * congestion control and its buffer objects, and a point-to-point net device with its queue and its half of the channel.
+ * The data buffered by the sockets is accounted separately.
+ */
+const uint64_t MEMORY_SOCKET_BYTES = 1536;
+const uint64_t MEMORY_DEVICE_BYTES = 1024;
+
+
+/**
+ * The estimators of the heap memory of the standard containers, for libstdc++ on a 64-bit platform. They do not include
+ * the memory owned by the elements, e.g. the elements of nested vectors, which the callers add themselves.
+ */
+template <typename T>
+uint64_t
+VectorMemory (const std::vector<T> &v)
+{
+  return v.capacity () * sizeof(T);
+}
+
+template <typename T>
+uint64_t
+DequeMemory (const std::deque<T> &d)
+{
+  //the elements are stored in blocks of 512 Bytes, which are indexed by a map of block pointers
+  const uint64_t elementsPerBlock = sizeof(T) < 512 ? 512 / sizeof(T) : 1;
+  const uint64_t blocks = d.size () / elementsPerBlock + 1;
+
+  return blocks * elementsPerBlock * sizeof(T) + (blocks + 8) * sizeof(void *);
+}
+
+template <typename K, typename V, typename C>
+uint64_t
+MapMemory (const std::map<K, V, C> &m)
+{
+  //each tree node has a color, a parent, a left and a right pointer
+  return m.size () * (sizeof(std::pair<const K, V>) + 4 * sizeof(void *));
+}
+
+template <typename K, typename V, typename H>
+uint64_t
+HashMapMemory (const std::unordered_map<K, V, H> &m)
+{
+  //each node has a next pointer and the cached hash, and each bucket a pointer
+  return m.size () * (sizeof(std::pair<const K, V>) + 2 * sizeof(void *)) + m.bucket_count () * sizeof(void *);
+}
+
+
+/**
+ * An opt-in accountant shared by all the nodes of a process. On each measurement it visits the nodes, which add the
+ * estimated Bytes of their subsystems, and it sums them per subsystem and per role (miners and plain nodes).
+ * The estimates cover the containers of the applications and fixed estimates of the ns-3 sockets and devices,
+ * so they are lower bounds of the real usage: they are meant to rank the structures, not to predict the RSS.
+ *
+ * The end of run measurement is taken with Measure, after Simulator::Run and before Simulator::Destroy. With Start,
+ * the nodes are also measured periodically during the run and the peak of each subsystem is reported.
+ */
+class MemoryAccountant : public SimpleRefCount<MemoryAccountant>
+{
+public:
+  MemoryAccountant (void);
+  ~MemoryAccountant (void);
+
+  /**
+   * \brief Adds a node to the measurements
+   */
+  void Register (const BitcoinNode *node);
+
+  /**
+   * \brief Schedules the periodic measurements. It should be called before Simulator::Run.
+   * \param interval the simulated time between two measurements
+   */
+  void Start (Time interval);
+
+  /**
+   * \brief Measures the nodes and updates the peaks
+   */
+  void Measure (void);
+
+  /**
+   * \brief Starts the accounting of a node. The following calls of Add are charged to its role. Called by the nodes.
+   */
+  void AddNode (bool isMiner);
+
+  /**
+   * \brief Adds the Bytes of a subsystem of the current node. Called by the nodes.
+   */
+  void Add (enum MemorySubsystem subsystem, uint64_t bytes);
+
+  /**
+   * \return the Bytes of a subsystem for the miners or the plain nodes, as of the last measurement
+   */
+  double GetBytes (bool miners, enum MemorySubsystem subsystem) const;
+
+  /**
+   * \brief Merges the measurements of all the processes in the process with systemId 0. It must be called by all the processes.
+   * The measurements and the peak RSS are summed, and so are the peaks, which gives an upper bound of the peak of the total.
+   */
+  void Merge (uint32_t systemId, uint32_t systemCount);
+
+  /**
+   * \brief Prints the Bytes per subsystem and role of the last measurement and their peaks, from the largest subsystem
+   */
+  void PrintReport (std::ostream &os) const;
+
+private:
+  /**
+   * \brief Measures the nodes and schedules the next measurement
+   */
+  void Sample (void);
+
+  std::vector<const BitcoinNode *>   m_nodes;
+  Time                               m_interval;
+  int                                m_role;                                   // the role of the node being measured: 0 for the plain nodes, 1 for the miners
+  double                             m_noNodes[2];                             // the number of nodes per role
+  double                             m_bytes[2][MEMORY_SUBSYSTEMS];            // the Bytes of the last measurement
+  double                             m_peakBytes[2][MEMORY_SUBSYSTEMS];        // the highest Bytes of all the measurements
+  double                             m_peakTotal;                              // the highest total of a measurement
+  double                             m_peakTime;                               // the simulated time of the highest total
+  double                             m_noMeasurements;
+  double                             m_peakRssKB;                              // the peak resident set size of the process(es)
+  uint32_t                           m_noProcesses;                            // the processes whose measurements have been merged
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_MEMORY_ACCOUNTANT_H */
@@ -0,0 +1,728 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-message-codec.h
+ */
+
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "bitcoin-message-codec.h"
+#include "../../rapidjson/writer.h"
+#include "../../rapidjson/stringbuffer.h"
+#include "../../rapidjson/memorystream.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BitcoinMessageCodec");
+
+namespace {
+
+/**
+ * The value tags of the binary codec. Every value is preceded by its tag.
+ */
+enum BinaryTag
+{
+  TAG_NULL,                    //0
+  TAG_FALSE,                   //1
+  TAG_TRUE,                    //2
+  TAG_INT,                     //3: 4 Bytes
+  TAG_INT64,                   //4: 8 Bytes
+  TAG_DOUBLE,                  //5: 8 Bytes
+  TAG_STRING,                  //6: 4 Bytes length + characters
+  TAG_ARRAY,                   //7: 4 Bytes count + values
+  TAG_OBJECT,                  //8: 4 Bytes count + (key, value) pairs
+  TAG_BLOCK_HASH,              //9: "height/minerId" packed as 2 x 4 Bytes
+  TAG_CHUNK_HASH,              //10: "height/minerId/chunk" packed as 3 x 4 Bytes
+  TAG_KNOWN_STRING             //11: 1 Byte index in knownStrings
+};
+
+/**
+ * The keys used in the bitcoin messages. They are encoded as their 1 Byte index.
+ * The order must not change, since it defines the wire format.
+ */
+const char *knownKeys[] = {"message", "type", "inv", "blocks", "chunks", "hash", "size", "fullBlock", "availableChunks",
+                           "chunk", "requestChunks", "height", "minerId", "parentBlockMinerId", "timeCreated", "timeReceived"};
+const uint8_t noKnownKeys = sizeof(knownKeys) / sizeof(knownKeys[0]);
+const uint8_t unknownKey = 0xFF;                         //!< followed by 1 Byte length + characters
+
+/**
+ * The string values used in the bitcoin messages (the "type" field)
+ */
+const char *knownStrings[] = {"block", "compressed-block", "chunk"};
+const uint8_t noKnownStrings = sizeof(knownStrings) / sizeof(knownStrings[0]);
+
+const uint8_t  noMessageType = 0xFF;                     //!< the message has no integer "message" field
+const size_t   binaryLengthSize = 4;                     //!< the size of the length prefix
+const char     jsonDelimiter = '#';
+const int      maxDepth = 16;                            //!< protects the decoder against corrupted frames
+
+
+void
+WriteUint32 (std::string &out, uint32_t value)
+{
+  for (int i = 0; i < 4; i++)
+    out.push_back (static_cast<char> ((value >> (8 * i)) & 0xFF));
+}
+
+
+void
+WriteUint64 (std::string &out, uint64_t value)
+{
+  for (int i = 0; i < 8; i++)
+    out.push_back (static_cast<char> ((value >> (8 * i)) & 0xFF));
+}
+
+
+uint32_t
+ReadUint32 (const uint8_t *data)
+{
+  return static_cast<uint32_t> (data[0]) | (static_cast<uint32_t> (data[1]) << 8)
+         | (static_cast<uint32_t> (data[2]) << 16) | (static_cast<uint32_t> (data[3]) << 24);
+}
+
+
+uint64_t
+ReadUint64 (const uint8_t *data)
+{
+  return static_cast<uint64_t> (ReadUint32 (data)) | (static_cast<uint64_t> (ReadUint32 (data + 4)) << 32);
+}
+
+
+/**
+ * Parses "height/minerId" or "height/minerId/chunk". The hash is only packed if every part is a canonical
+ * decimal integer, so that the decoder restores exactly the same string.
+ * Returns the number of parts or 0 if the string cannot be packed.
+ */
+int
+ParseHash (const char *str, size_t length, int32_t parts[3])
+{
+  int    noParts = 0;
+  size_t i = 0;
+
+  while (noParts < 3)
+  {
+    bool    negative = false;
+    int64_t value = 0;
+    size_t  start;
+
+    if (i < length && str[i] == '-')
+    {
+      negative = true;
+      i++;
+    }
+
+    start = i;
+    while (i < length && str[i] >= '0' && str[i] <= '9')
+    {
+      value = value * 10 + (str[i] - '0');
+      if (value > INT32_MAX)
+        return 0;
+      i++;
+    }
+
+    if (i == start || (i - start > 1 && str[start] == '0') || (negative && value == 0))
+      return 0;
+
+    parts[noParts++] = static_cast<int32_t> (negative ? -value : value);
+
+    if (i == length)
+      break;
+    if (str[i] != '/')
+      return 0;
+    i++;
+  }
+
+  if (i != length || noParts < 2)
+    return 0;
+  return noParts;
+}
+
+
+void EncodeValue (const rapidjson::Value &v, std::string &out);
+
+
+void
+EncodeKey (const rapidjson::Value &key, std::string &out)
+{
+  const char *name = key.GetString ();
+  size_t      length = key.GetStringLength ();
+
+  for (uint8_t i = 0; i < noKnownKeys; i++)
+  {
+    if (std::strlen (knownKeys[i]) == length && std::memcmp (knownKeys[i], name, length) == 0)
+    {
+      out.push_back (static_cast<char> (i));
+      return;
+    }
+  }
+
+  if (length > 0xFF)
+    NS_FATAL_ERROR ("The key " << name << " is too long for the binary codec");
+
+  out.push_back (static_cast<char> (unknownKey));
+  out.push_back (static_cast<char> (length));
+  out.append (name, length);
+}
+
+
+void
+EncodeString (const rapidjson::Value &v, std::string &out)
+{
+  const char *str = v.GetString ();
+  size_t      length = v.GetStringLength ();
+  int32_t     parts[3];
+  int         noParts;
+
+  for (uint8_t i = 0; i < noKnownStrings; i++)
+  {
+    if (std::strlen (knownStrings[i]) == length && std::memcmp (knownStrings[i], str, length) == 0)
+    {
+      out.push_back (static_cast<char> (TAG_KNOWN_STRING));
+      out.push_back (static_cast<char> (i));
+      return;
+    }
+  }
+
+  noParts = ParseHash (str, length, parts);
+  if (noParts > 0)
+  {
+    out.push_back (static_cast<char> (noParts == 2 ? TAG_BLOCK_HASH : TAG_CHUNK_HASH));
+    for (int i = 0; i < noParts; i++)
+      WriteUint32 (out, static_cast<uint32_t> (parts[i]));
+    return;
+  }
+
+  out.push_back (static_cast<char> (TAG_STRING));
+  WriteUint32 (out, length);
+  out.append (str, length);
+}
+
+
+void
+EncodeMembers (const rapidjson::Value &v, std::string &out, bool skipMessage)
+{
+  uint32_t count = v.MemberCount ();
+
+  if (skipMessage)
+    count--;
+
+  WriteUint32 (out, count);
+  for (rapidjson::Value::ConstMemberIterator it = v.MemberBegin (); it != v.MemberEnd (); ++it)
+  {
+    if (skipMessage && std::strcmp (it->name.GetString (), "message") == 0)
+      continue;
+
+    EncodeKey (it->name, out);
+    EncodeValue (it->value, out);
+  }
+}
+
+
+void
+EncodeValue (const rapidjson::Value &v, std::string &out)
+{
+  switch (v.GetType ())
+  {
+    case rapidjson::kNullType:
+    {
+      out.push_back (static_cast<char> (TAG_NULL));
+      break;
+    }
+    case rapidjson::kFalseType:
+    {
+      out.push_back (static_cast<char> (TAG_FALSE));
+      break;
+    }
+    case rapidjson::kTrueType:
+    {
+      out.push_back (static_cast<char> (TAG_TRUE));
+      break;
+    }
+    case rapidjson::kNumberType:
+    {
+      if (v.IsInt ())
+      {
+        out.push_back (static_cast<char> (TAG_INT));
+        WriteUint32 (out, static_cast<uint32_t> (v.GetInt ()));
+      }
+      else if (v.IsInt64 ())
+      {
+        out.push_back (static_cast<char> (TAG_INT64));
+        WriteUint64 (out, static_cast<uint64_t> (v.GetInt64 ()));
+      }
+      else
+      {
+        double   value = v.GetDouble ();
+        uint64_t bits;
+
+        std::memcpy (&bits, &value, sizeof (bits));
+        out.push_back (static_cast<char> (TAG_DOUBLE));
+        WriteUint64 (out, bits);
+      }
+      break;
+    }
+    case rapidjson::kStringType:
+    {
+      EncodeString (v, out);
+      break;
+    }
+    case rapidjson::kArrayType:
+    {
+      out.push_back (static_cast<char> (TAG_ARRAY));
+      WriteUint32 (out, v.Size ());
+      for (rapidjson::Value::ConstValueIterator it = v.Begin (); it != v.End (); ++it)
+        EncodeValue (*it, out);
+      break;
+    }
+    case rapidjson::kObjectType:
+    {
+      out.push_back (static_cast<char> (TAG_OBJECT));
+      EncodeMembers (v, out, false);
+      break;
+    }
+  }
+}
+
+
+/**
+ * A cursor over the binary payload. All the reads are bounds checked.
+ */
+struct BinaryReader
+{
+  const uint8_t *pos;
+  const uint8_t *end;
+
+  bool Has (size_t n) const { return static_cast<size_t> (end - pos) >= n; }
+};
+
+
+bool DecodeValue (BinaryReader &reader, rapidjson::Value &v, rapidjson::Document::AllocatorType &allocator, int depth);
+
+
+bool
+DecodeMembers (BinaryReader &reader, rapidjson::Value &v, rapidjson::Document::AllocatorType &allocator, int depth)
+{
+  uint32_t count;
+
+  if (!reader.Has (4))
+    return false;
+  count = ReadUint32 (reader.pos);
+  reader.pos += 4;
+
+  for (uint32_t i = 0; i < count; i++)
+  {
+    rapidjson::Value key;
+    rapidjson::Value value;
+    uint8_t          keyId;
+
+    if (!reader.Has (1))
+      return false;
+    keyId = *reader.pos++;
+
+    if (keyId < noKnownKeys)
+      key.SetString (rapidjson::StringRef (knownKeys[keyId]));
+    else if (keyId == unknownKey)
+    {
+      uint8_t length;
+
+      if (!reader.Has (1))
+        return false;
+      length = *reader.pos++;
+      if (!reader.Has (length))
+        return false;
+      key.SetString (reinterpret_cast<const char*> (reader.pos), length, allocator);
+      reader.pos += length;
+    }
+    else
+      return false;
+
+    if (!DecodeValue (reader, value, allocator, depth + 1))
+      return false;
+    v.AddMember (key, value, allocator);
+  }
+  return true;
+}
+
+
+bool
+DecodeValue (BinaryReader &reader, rapidjson::Value &v, rapidjson::Document::AllocatorType &allocator, int depth)
+{
+  uint8_t tag;
+
+  if (depth > maxDepth || !reader.Has (1))
+    return false;
+  tag = *reader.pos++;
+
+  switch (tag)
+  {
+    case TAG_NULL:
+    {
+      v.SetNull ();
+      return true;
+    }
+    case TAG_FALSE:
+    {
+      v.SetBool (false);
+      return true;
+    }
+    case TAG_TRUE:
+    {
+      v.SetBool (true);
+      return true;
+    }
+    case TAG_INT:
+    {
+      if (!reader.Has (4))
+        return false;
+      v.SetInt (static_cast<int32_t> (ReadUint32 (reader.pos)));
+      reader.pos += 4;
+      return true;
+    }
+    case TAG_INT64:
+    {
+      if (!reader.Has (8))
+        return false;
+      v.SetInt64 (static_cast<int64_t> (ReadUint64 (reader.pos)));
+      reader.pos += 8;
+      return true;
+    }
+    case TAG_DOUBLE:
+    {
+      uint64_t bits;
+      double   value;
+
+      if (!reader.Has (8))
+        return false;
+      bits = ReadUint64 (reader.pos);
+      std::memcpy (&value, &bits, sizeof (value));
+      v.SetDouble (value);
+      reader.pos += 8;
+      return true;
+    }
+    case TAG_STRING:
+    {
+      uint32_t length;
+
+      if (!reader.Has (4))
+        return false;
+      length = ReadUint32 (reader.pos);
+      reader.pos += 4;
+      if (!reader.Has (length))
+        return false;
+      v.SetString (reinterpret_cast<const char*> (reader.pos), length, allocator);
+      reader.pos += length;
+      return true;
+    }
+    case TAG_ARRAY:
+    {
+      uint32_t count;
+
+      if (!reader.Has (4))
+        return false;
+      count = ReadUint32 (reader.pos);
+      reader.pos += 4;
+      if (!reader.Has (count))                          //every value has at least its tag
+        return false;
+
+      v.SetArray ();
+      v.Reserve (count, allocator);
+      for (uint32_t i = 0; i < count; i++)
+      {
+        rapidjson::Value element;
+
+        if (!DecodeValue (reader, element, allocator, depth + 1))
+          return false;
+        v.PushBack (element, allocator);
+      }
+      return true;
+    }
+    case TAG_OBJECT:
+    {
+      v.SetObject ();
+      return DecodeMembers (reader, v, allocator, depth);
+    }
+    case TAG_BLOCK_HASH:
+    case TAG_CHUNK_HASH:
+    {
+      int  noParts = (tag == TAG_BLOCK_HASH) ? 2 : 3;
+      char hash[3 * 12];
+      int  length = 0;
+
+      if (!reader.Has (4 * noParts))
+        return false;
+      for (int i = 0; i < noParts; i++)
+      {
+        length += std::snprintf (hash + length, sizeof (hash) - length, i == 0 ? "%d" : "/%d",
+                                 static_cast<int32_t> (ReadUint32 (reader.pos)));
+        reader.pos += 4;
+      }
+      v.SetString (hash, length, allocator);
+      return true;
+    }
+    case TAG_KNOWN_STRING:
+    {
+      uint8_t index;
+
+      if (!reader.Has (1))
+        return false;
+      index = *reader.pos++;
+      if (index >= noKnownStrings)
+        return false;
+      v.SetString (rapidjson::StringRef (knownStrings[index]));
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+
+std::string
+EncodeBinary (const rapidjson::Document &d)
+{
+  std::string frame;
+  uint8_t     messageType = noMessageType;
+  rapidjson::Value::ConstMemberIterator message = d.FindMember ("message");
+
+  if (message != d.MemberEnd () && message->value.IsInt () && message->value.GetInt () >= 0
+      && message->value.GetInt () < noMessageType)
+    messageType = static_cast<uint8_t> (message->value.GetInt ());
+
+  frame.reserve (64);
+  frame.append (binaryLengthSize, '\0');
+  frame.push_back (static_cast<char> (messageType));
+  EncodeMembers (d, frame, messageType != noMessageType);
+
+  /**
+   * Fill in the length prefix
+   */
+  uint32_t length = frame.size () - binaryLengthSize;
+  for (size_t i = 0; i < binaryLengthSize; i++)
+    frame[i] = static_cast<char> ((length >> (8 * i)) & 0xFF);
+
+  return frame;
+}
+
+
+bool
+DecodeBinary (const uint8_t *data, size_t size, rapidjson::Document &d)
+{
+  BinaryReader reader;
+  uint8_t      messageType;
+
+  if (size < binaryLengthSize + 1 || ReadUint32 (data) != size - binaryLengthSize)
+    return false;
+
+  reader.pos = data + binaryLengthSize;
+  reader.end = data + size;
+  messageType = *reader.pos++;
+
+  d.SetObject ();
+  if (messageType != noMessageType)
+  {
+    rapidjson::Value value (static_cast<int> (messageType));
+    d.AddMember ("message", value, d.GetAllocator ());
+  }
+
+  return DecodeMembers (reader, d, d.GetAllocator (), 0) && reader.pos == reader.end;
+}
+
+} // anonymous namespace
+
+
+std::string
+EncodeMessage (const rapidjson::Document &d, enum MessageCodec codec)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  switch (codec)
+  {
+    case JSON_CODEC:
+    {
+      rapidjson::StringBuffer buffer;
+      rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+      std::string frame;
+
+      d.Accept(writer);
+      frame.reserve (buffer.GetSize () + 1);
+      frame.append (buffer.GetString (), buffer.GetSize ());
+      frame.push_back (jsonDelimiter);
+      return frame;
+    }
+    case BINARY_CODEC:
+      return EncodeBinary (d);
+  }
+
+  NS_FATAL_ERROR ("Unknown message codec " << codec);
+  return std::string ();
+}
+
+
+size_t
+GetFrameSize (const char *data, size_t size, enum MessageCodec codec)
+{
+  switch (codec)
+  {
+    case JSON_CODEC:
+    {
+      const char *delimiter = static_cast<const char*> (std::memchr (data, jsonDelimiter, size));
+      return delimiter == nullptr ? 0 : delimiter - data + 1;
+    }
+    case BINARY_CODEC:
+    {
+      size_t frameSize;
+
+      if (size < binaryLengthSize)
+        return 0;
+      frameSize = binaryLengthSize + ReadUint32 (reinterpret_cast<const uint8_t*> (data));
+      return size < frameSize ? 0 : frameSize;
+    }
+  }
+
+  NS_FATAL_ERROR ("Unknown message codec " << codec);
+  return 0;
+}
+
+
+bool
+DecodeMessage (const char *data, size_t size, enum MessageCodec codec, rapidjson::Document &d)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  switch (codec)
+  {
+    case JSON_CODEC:
+    {
+      if (size == 0 || data[size - 1] != jsonDelimiter)
+        return false;
+
+      /**
+       * Parse the text before the delimiter from the frame itself. The length-bounded stream
+       * reads as '\0' at its end, so the frame does not have to be copied to be terminated.
+       */
+      rapidjson::MemoryStream text (data, size - 1);
+      d.ParseStream(text);
+      return !d.HasParseError () && d.IsObject ();
+    }
+    case BINARY_CODEC:
+      return DecodeBinary (reinterpret_cast<const uint8_t*> (data), size, d);
+  }
+
+  NS_FATAL_ERROR ("Unknown message codec " << codec);
+  return false;
+}
+
+
+bool
+DecodeMessage (const std::string &frame, enum MessageCodec codec, rapidjson::Document &d)
+{
+  return DecodeMessage (frame.data (), frame.size (), codec, d);
+}
+
+
+std::string
+MessageToString (const rapidjson::Value &d)
+{
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+
+  d.Accept(writer);
+  return std::string (buffer.GetString (), buffer.GetSize ());
+}
+
+
+std::string
+FrameToString (const std::string &frame, enum MessageCodec codec)
+{
+  rapidjson::Document d;
+
+  if (!DecodeMessage (frame, codec, d))
+    return "<corrupted frame>";
+  return MessageToString (d);
+}
+
+
+const size_t ReceiveBuffer::m_maxIdleCapacity = 64 * 1024;
+
+
+ReceiveBuffer::ReceiveBuffer (void) : m_begin (0), m_end (0)
+{
+}
+
+
+uint8_t*
+ReceiveBuffer::Reserve (uint32_t size)
+{
+  if (m_end + size > m_data.size () && m_begin > 0)
+  {
+    /**
+     * Move the incomplete frame to the front instead of growing the buffer
+     */
+    std::memmove (m_data.data (), m_data.data () + m_begin, m_end - m_begin);
+    m_end -= m_begin;
+    m_begin = 0;
+  }
+
+  if (m_end + size > m_data.size ())
+    m_data.resize (std::max (m_end + size, 2 * m_data.size ()));
+
+  return reinterpret_cast<uint8_t*> (m_data.data () + m_end);
+}
+
+
+void
+ReceiveBuffer::Commit (uint32_t size)
+{
+  NS_ASSERT (m_end + size <= m_data.size ());
+  m_end += size;
+}
+
+
+bool
+ReceiveBuffer::NextFrame (enum MessageCodec codec, const char *&frame, size_t &frameSize)
+{
+  if (m_begin == m_end)
+  {
+    /**
+     * The buffer has been drained, so rewind the cursors and release
+     * the memory allocated for unusually large frames
+     */
+    m_begin = m_end = 0;
+    if (m_data.size () > m_maxIdleCapacity)
+      std::vector<char> ().swap (m_data);
+    return false;
+  }
+
+  frameSize = GetFrameSize (m_data.data () + m_begin, m_end - m_begin, codec);
+  if (frameSize == 0)
+    return false;
+
+  frame = m_data.data () + m_begin;
+  m_begin += frameSize;
+  return true;
+}
+
+
+size_t
+ReceiveBuffer::GetSize (void) const
+{
+  return m_end - m_begin;
+}
+
+
+size_t
+ReceiveBuffer::GetCapacity (void) const
+{
+  return m_data.capacity ();
+}
+
+
+void
+ReceiveBuffer::Clear (void)
+{
+  std::vector<char> ().swap (m_data);
+  m_begin = m_end = 0;
+}
+
+} // namespace ns3
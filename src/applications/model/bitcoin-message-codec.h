@@ -0,0 +1,129 @@
+/**
+ * This file contains the declarations of the functions used to encode and decode the messages exchanged by the bitcoin nodes.
+ * Two codecs are supported:
+ *   - JSON_CODEC: the rapidjson text of the message followed by the '#' delimiter (human readable, used for debugging)
+ *   - BINARY_CODEC: a 4 Bytes length prefix, followed by the message type and a compact tagged encoding of the remaining fields
+ * In both cases the decoder rebuilds the rapidjson::Document, so the message handlers are not affected by the codec.
+ */
+
+#ifndef BITCOIN_MESSAGE_CODEC_H
+#define BITCOIN_MESSAGE_CODEC_H
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include "bitcoin.h"
+#include "../../rapidjson/document.h"
+
+namespace ns3 {
+
+/**
+ * \brief Encodes a message to a wire frame
+ * \param d the rapidjson document containing the info of the message
+ * \param codec the codec used for the encoding
+ * \return the frame, ready to be sent to the socket
+ */
+std::string EncodeMessage (const rapidjson::Document &d, enum MessageCodec codec);
+
+/**
+ * \brief Checks if a complete frame is available at the beginning of a buffer
+ * \param data the buffered data
+ * \param size the size of the buffered data in Bytes
+ * \param codec the codec used for the encoding
+ * \return the size of the first frame in Bytes, or 0 if the frame has not been fully received yet
+ */
+size_t GetFrameSize (const char *data, size_t size, enum MessageCodec codec);
+
+/**
+ * \brief Decodes a frame created by EncodeMessage
+ * \param data the beginning of the frame
+ * \param size the size of the frame in Bytes, as returned by GetFrameSize
+ * \param codec the codec used for the encoding
+ * \param d the rapidjson document which will contain the decoded message
+ * \return true if the frame was decoded successfully, false if it is corrupted
+ */
+bool DecodeMessage (const char *data, size_t size, enum MessageCodec codec, rapidjson::Document &d);
+
+/**
+ * \brief Decodes a frame created by EncodeMessage
+ * \param frame the frame
+ * \param codec the codec used for the encoding
+ * \param d the rapidjson document which will contain the decoded message
+ * \return true if the frame was decoded successfully, false if it is corrupted
+ */
+bool DecodeMessage (const std::string &frame, enum MessageCodec codec, rapidjson::Document &d);
+
+/**
+ * \brief Stringifies a message. Only meant to be used for logging.
+ * \param d the rapidjson value containing the info of the message
+ * \return the JSON text of the message
+ */
+std::string MessageToString (const rapidjson::Value &d);
+
+/**
+ * \brief Stringifies an encoded frame. Only meant to be used for logging.
+ * \param frame the frame
+ * \param codec the codec used for the encoding
+ * \return the JSON text of the message
+ */
+std::string FrameToString (const std::string &frame, enum MessageCodec codec);
+
+
+/**
+ * A per-peer receive buffer. Packets are copied once at the write end and complete frames are returned as views
+ * from the read cursor, so they are decoded in place. The consumed Bytes are reclaimed when the buffer drains,
+ * or compacted before an append that would otherwise grow the buffer.
+ */
+class ReceiveBuffer
+{
+public:
+  ReceiveBuffer (void);
+
+  /**
+   * \brief Makes room for the next packet
+   * \param size the size of the packet in Bytes
+   * \return a pointer to the write end, valid for size Bytes until the next call to Commit
+   */
+  uint8_t* Reserve (uint32_t size);
+
+  /**
+   * \brief Appends the Bytes written after the last Reserve
+   * \param size the number of Bytes written
+   */
+  void Commit (uint32_t size);
+
+  /**
+   * \brief Consumes the next complete frame
+   * \param codec the codec used for the encoding
+   * \param frame set to the beginning of the frame. It is valid until the next call to Reserve
+   * \param frameSize set to the size of the frame in Bytes
+   * \return true if a complete frame was available, false otherwise
+   */
+  bool NextFrame (enum MessageCodec codec, const char *&frame, size_t &frameSize);
+
+  /**
+   * \return the number of buffered Bytes which do not form a complete frame yet
+   */
+  size_t GetSize (void) const;
+
+  /**
+   * \return the number of Bytes allocated by the buffer
+   */
+  size_t GetCapacity (void) const;
+
+  /**
+   * \brief Discards the buffered data and releases the memory
+   */
+  void Clear (void);
+
+private:
+  std::vector<char> m_data;                  //!< the buffered data
+  size_t            m_begin;                 //!< the read cursor
+  size_t            m_end;                   //!< the write cursor
+  
+  static const size_t m_maxIdleCapacity;     //!< the capacity kept by a drained buffer
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_MESSAGE_CODEC_H */
@@ -14,6 +14,8 @@
 #include "ns3/tcp-socket-factory.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
 #include "ns3/bitcoin-miner.h"
 #include "../../rapidjson/document.h"
 #include "../../rapidjson/writer.h"
@@ -93,6 +95,18 @@ BitcoinMiner::GetTypeId (void)
                    DoubleValue (-1),
                    MakeDoubleAccessor (&BitcoinMiner::m_blockGenParameter),
                    MakeDoubleChecker<double> ())	
+    .AddAttribute ("BlockTimeDistribution",
+                   "The distribution of the block generation times",
+                   EnumValue (BLOCK_TIME_GEOMETRIC),
+                   MakeEnumAccessor (&BitcoinMiner::m_blockTimeDistribution),
+                   MakeEnumChecker (BLOCK_TIME_EXPONENTIAL, "Exponential",
+                                    BLOCK_TIME_GEOMETRIC, "Geometric",
+                                    BLOCK_TIME_TRACE, "Trace"))
+    .AddAttribute ("BlockTimeTrace",
+                   "The file of the block intervals replayed by the Trace distribution, one interval per line",
+                   StringValue (""),
+                   MakeStringAccessor (&BitcoinMiner::m_blockTimeTrace),
+                   MakeStringChecker ())
     .AddAttribute ("AverageBlockGenIntervalSeconds", 
                    "The average block generation interval we aim at (in seconds)",
                    DoubleValue (10*60),
@@ -108,6 +122,19 @@ BitcoinMiner::GetTypeId (void)
                    UintegerValue (100000),
                    MakeUintegerAccessor (&BitcoinMiner::m_chunkSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MessageCodec",
+                   "The codec used to encode the messages on the wire",
+                   EnumValue (JSON_CODEC),
+                   MakeEnumAccessor (&BitcoinMiner::m_messageCodec),
+                   MakeEnumChecker (JSON_CODEC, "Json",
+                                    BINARY_CODEC, "Binary"))
+    .AddAttribute ("LinkDiscipline",
+                   "The discipline used to share the upload and download links between the peers",
+                   EnumValue (LINK_FIFO),
+                   MakeEnumAccessor (&BitcoinMiner::m_linkDiscipline),
+                   MakeEnumChecker (LINK_FIFO, "Fifo",
+                                    LINK_ROUND_ROBIN, "RoundRobin",
+                                    LINK_FAIR_SHARE, "FairShare"))
     .AddTraceSource ("Rx",
                      "A packet has been received",
                      MakeTraceSourceAccessor (&BitcoinMiner::m_rxTrace),
@@ -116,7 +143,7 @@ BitcoinMiner::GetTypeId (void)
   return tid;
 }
 
-BitcoinMiner::BitcoinMiner () : BitcoinNode(), m_realAverageBlockGenIntervalSeconds(10*m_secondsPerMin),
+BitcoinMiner::BitcoinMiner () : BitcoinNode(), m_realAverageBlockGenIntervalSeconds(BITCOIN_BLOCK_GEN_INTERVAL_SECONDS),
                                 m_timeStart (0), m_timeFinish (0), m_fistToMine (false)
 {
   NS_LOG_FUNCTION (this);
@@ -124,9 +151,6 @@ BitcoinMiner::BitcoinMiner () : BitcoinNode(), m_realAverageBlockGenIntervalSeco
   m_minerGeneratedBlocks = 0;
   m_previousBlockGenerationTime = 0;
   
-  std::random_device rd;
-  m_generator.seed(rd());
-  
   if (m_fixedBlockTimeGeneration > 0)
     m_nextBlockTime = m_fixedBlockTimeGeneration;  
   else
@@ -151,6 +175,7 @@ void
 BitcoinMiner::StartApplication ()    // Called at time specified by Start
 {
   BitcoinNode::StartApplication ();
+  m_blockSizeGenerator.SetStream (RNG_BLOCK_SIZE, GetNode ()->GetId ());
   NS_LOG_WARN ("Miner " << GetNode()->GetId() << " m_noMiners = " << m_noMiners << "");
   NS_LOG_WARN ("Miner " << GetNode()->GetId() << " m_realAverageBlockGenIntervalSeconds = " << m_realAverageBlockGenIntervalSeconds << "s");
   NS_LOG_WARN ("Miner " << GetNode()->GetId() << " m_averageBlockGenIntervalSeconds = " << m_averageBlockGenIntervalSeconds << "s");
@@ -168,95 +193,12 @@ BitcoinMiner::StartApplication ()    // Called at time specified by Start
     m_blockGenParameter *= m_hashRate;
 
   if (m_fixedBlockTimeGeneration == 0)
-    m_blockGenTimeDistribution.param(std::geometric_distribution<int>::param_type(m_blockGenParameter)); 
+    ConfigureBlockTimeSampler ();
 
   if (m_fixedBlockSize > 0)
     m_nextBlockSize = m_fixedBlockSize;
   else
-  {
-    switch(m_cryptocurrency)
-    {
-      case BITCOIN:
-      {
-        std::array<double,201> intervals {0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95, 100, 105, 110, 115, 120, 125, 
-                                         130, 135, 140, 145, 150, 155, 160, 165, 170, 175, 180, 185, 190, 195, 200, 205, 210, 215, 220, 225, 230, 235, 
-                                         240, 245, 250, 255, 260, 265, 270, 275, 280, 285, 290, 295, 300, 305, 310, 315, 320, 325, 330, 335, 340, 345, 
-                                         350, 355, 360, 365, 370, 375, 380, 385, 390, 395, 400, 405, 410, 415, 420, 425, 430, 435, 440, 445, 450, 455, 
-                                         460, 465, 470, 475, 480, 485, 490, 495, 500, 505, 510, 515, 520, 525, 530, 535, 540, 545, 550, 555, 560, 565, 
-                                         570, 575, 580, 585, 590, 595, 600, 605, 610, 615, 620, 625, 630, 635, 640, 645, 650, 655, 660, 665, 670, 675, 
-                                         680, 685, 690, 695, 700, 705, 710, 715, 720, 725, 730, 735, 740, 745, 750, 755, 760, 765, 770, 775, 780, 785, 
-                                         790, 795, 800, 805, 810, 815, 820, 825, 830, 835, 840, 845, 850, 855, 860, 865, 870, 875, 880, 885, 890, 895, 
-                                         900, 905, 910, 915, 920, 925, 930, 935, 940, 945, 950, 955, 960, 965, 970, 975, 980, 985, 990, 995, 1000};
-        std::array<double,200> weights {4.96, 0.21, 0.17, 0.25, 0.27, 0.3, 0.34, 0.26, 0.26, 0.33, 0.35, 0.49, 0.42, 0.42, 0.48, 0.41, 0.46, 0.45, 
-                                       0.58, 0.58, 0.57, 0.52, 0.54, 0.47, 0.53, 0.56, 0.5, 0.48, 0.53, 0.54, 0.49, 0.51, 0.56, 0.53, 0.56, 0.5, 
-                                       0.47, 0.45, 0.52, 0.43, 0.46, 0.47, 0.6, 0.53, 0.42, 0.48, 0.55, 0.49, 0.63, 2.38, 0.47, 0.53, 0.43, 0.51, 
-                                       0.44, 0.46, 0.44, 0.41, 0.47, 0.46, 0.45, 0.37, 0.49, 0.4, 0.41, 0.41, 0.41, 0.37, 0.43, 0.47, 0.48, 0.37, 
-                                       0.4, 0.46, 0.34, 0.35, 0.37, 0.36, 0.37, 0.31, 0.35, 0.39, 0.34, 0.38, 0.29, 0.41, 0.37, 0.34, 0.36, 0.34, 
-                                       0.29, 0.3, 0.36, 0.26, 0.29, 0.31, 0.3, 0.29, 0.35, 0.5, 0.28, 0.37, 0.31, 0.33, 0.32, 0.28, 0.34, 0.31, 
-                                       0.26, 0.24, 0.22, 0.25, 0.24, 0.25, 0.26, 0.25, 0.24, 0.33, 0.24, 0.23, 0.2, 0.24, 0.26, 0.27, 0.27, 0.21, 
-                                       0.22, 0.3, 0.25, 0.21, 0.26, 0.21, 0.21, 0.21, 0.23, 0.48, 0.2, 0.19, 0.21, 0.2, 0.17, 0.19, 0.21, 0.22, 
-                                       0.24, 0.25, 0.23, 0.31, 0.46, 8.32, 0.22, 0.11, 0.13, 0.17, 0.12, 0.16, 0.15, 0.16, 0.19, 0.21, 0.18, 0.24, 
-                                       0.19, 0.2, 0.16, 0.17, 0.19, 0.17, 0.22, 0.33, 0.17, 0.22, 0.25, 0.19, 0.2, 0.17, 0.28, 0.25, 0.24, 0.25, 0.3,
-                                       0.34, 0.46, 0.49, 0.67, 3.13, 2.94, 0.14, 0.36, 3.88, 0.07, 0.11, 0.11, 0.11, 0.26, 0.12, 0.13, 0.88, 5.84, 4.11};
-        m_blockSizeDistribution = std::piecewise_constant_distribution<double> (intervals.begin(), intervals.end(), weights.begin());
-        break;
-      }
-      case LITECOIN:
-      {
-        std::array<double,201> intervals {0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 4.5, 5.0, 5.5, 6.0, 6.5, 7.0, 7.5, 8.0, 8.5, 9.0, 9.5, 10.0,
-										 10.5, 11.0, 11.5, 12.0, 12.5, 13.0, 13.5, 14.0, 14.5, 15.0, 15.5, 16.0, 16.5, 17.0, 17.5, 18.0, 18.5, 19.0, 19.5,
-										 20.0, 20.5, 21.0, 21.5, 22.0, 22.5, 23.0, 23.5, 24.0, 24.5, 25.0, 25.5, 26.0, 26.5, 27.0, 27.5, 28.0, 28.5, 29.0,
-										 29.5, 30.0, 30.5, 31.0, 31.5, 32.0, 32.5, 33.0, 33.5, 34.0, 34.5, 35.0, 35.5, 36.0, 36.5, 37.0, 37.5, 38.0, 38.5,
-										 39.0, 39.5, 40.0, 40.5, 41.0, 41.5, 42.0, 42.5, 43.0, 43.5, 44.0, 44.5, 45.0, 45.5, 46.0, 46.5, 47.0, 47.5, 48.0,
-										 48.5, 49.0, 49.5, 50.0, 50.5, 51.0, 51.5, 52.0, 52.5, 53.0, 53.5, 54.0, 54.5, 55.0, 55.5, 56.0, 56.5, 57.0, 57.5,
-										 58.0, 58.5, 59.0, 59.5, 60.0, 60.5, 61.0, 61.5, 62.0, 62.5, 63.0, 63.5, 64.0, 64.5, 65.0, 65.5, 66.0, 66.5, 67.0,
-										 67.5, 68.0, 68.5, 69.0, 69.5, 70.0, 70.5, 71.0, 71.5, 72.0, 72.5, 73.0, 73.5, 74.0, 74.5, 75.0, 75.5, 76.0, 76.5,
-										 77.0, 77.5, 78.0, 78.5, 79.0, 79.5, 80.0, 80.5, 81.0, 81.5, 82.0, 82.5, 83.0, 83.5, 84.0, 84.5, 85.0, 85.5, 86.0,
-										 86.5, 87.0, 87.5, 88.0, 88.5, 89.0, 89.5, 90.0, 90.5, 91.0, 91.5, 92.0, 92.5, 93.0, 93.5, 94.0, 94.5, 95.0, 95.5,
-										 96.0, 96.5, 97.0, 97.5, 98.0, 98.5, 99.0, 99.5, 100.0};
-        std::array<double,200> weights {38.91, 5.76, 4.97, 4.11, 3.4, 3.13, 2.77, 2.36, 2.24, 2.04, 1.85, 1.74, 1.55, 1.47, 1.32, 1.19, 1.1, 1.0, 0.89,
-										0.87, 0.82, 0.75, 0.73, 0.63, 0.61, 0.61, 0.53, 0.52, 0.52, 0.56, 0.47, 0.48, 0.45, 0.39, 0.4, 0.37, 0.37, 0.34,
-										0.32, 0.34, 0.32, 0.27, 0.32, 0.32, 0.3, 0.26, 0.25, 0.35, 0.89, 0.18, 0.12, 0.11, 0.1, 0.1, 0.09, 0.1, 0.09, 0.1,
-										0.09, 0.1, 0.08, 0.08, 0.07, 0.07, 0.05, 0.07, 0.07, 0.06, 0.06, 0.06, 0.05, 0.05, 0.04, 0.05, 0.03, 0.05, 0.04,
-										0.04, 0.04, 0.04, 0.04, 0.05, 0.03, 0.03, 0.04, 0.02, 0.03, 0.02, 0.02, 0.03, 0.03, 0.03, 0.03, 0.03, 0.03, 0.02,
-										0.05, 0.09, 0.01, 0.02, 0.02, 0.02, 0.01, 0.01, 0.01, 0.02, 0.01, 0.01, 0.02, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01,
-										0.01, 0.02, 0.01, 0.01, 0.01, 0.01, 0.02, 0.0, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.0, 0.01, 0.01, 0.01, 0.01,
-										0.01, 0.01, 0.01, 0.01, 0.0, 0.01, 0.01, 0.0, 0.0, 0.01, 0.01, 0.01, 0.0, 0.0, 0.0, 0.01, 0.01, 0.01, 0.01, 0.01,
-										0.0, 0.0, 0.0, 0.01, 0.0, 0.01, 0.0, 0.0, 0.01, 0.0, 0.0, 0.0, 0.01, 0.01, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0,
-										0.01, 0.0, 0.01, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.01, 0.0, 0.0, 0.0, 0.0, 0.01, 0.0,
-										0.0, 0.24};
-        m_blockSizeDistribution = std::piecewise_constant_distribution<double> (intervals.begin(), intervals.end(), weights.begin());
-        break;
-      }
-      case DOGECOIN:
-      {
-        std::array<double,201> intervals {0.0, 0.5, 1.0, 1.5, 2.0, 2.5, 3.0, 3.5, 4.0, 4.5, 5.0, 5.5, 6.0, 6.5, 7.0, 7.5, 8.0, 8.5, 9.0, 9.5, 10.0,
-										 10.5, 11.0, 11.5, 12.0, 12.5, 13.0, 13.5, 14.0, 14.5, 15.0, 15.5, 16.0, 16.5, 17.0, 17.5, 18.0, 18.5, 19.0, 19.5,
-										 20.0, 20.5, 21.0, 21.5, 22.0, 22.5, 23.0, 23.5, 24.0, 24.5, 25.0, 25.5, 26.0, 26.5, 27.0, 27.5, 28.0, 28.5, 29.0,
-										 29.5, 30.0, 30.5, 31.0, 31.5, 32.0, 32.5, 33.0, 33.5, 34.0, 34.5, 35.0, 35.5, 36.0, 36.5, 37.0, 37.5, 38.0, 38.5,
-										 39.0, 39.5, 40.0, 40.5, 41.0, 41.5, 42.0, 42.5, 43.0, 43.5, 44.0, 44.5, 45.0, 45.5, 46.0, 46.5, 47.0, 47.5, 48.0,
-										 48.5, 49.0, 49.5, 50.0, 50.5, 51.0, 51.5, 52.0, 52.5, 53.0, 53.5, 54.0, 54.5, 55.0, 55.5, 56.0, 56.5, 57.0, 57.5,
-										 58.0, 58.5, 59.0, 59.5, 60.0, 60.5, 61.0, 61.5, 62.0, 62.5, 63.0, 63.5, 64.0, 64.5, 65.0, 65.5, 66.0, 66.5, 67.0,
-										 67.5, 68.0, 68.5, 69.0, 69.5, 70.0, 70.5, 71.0, 71.5, 72.0, 72.5, 73.0, 73.5, 74.0, 74.5, 75.0, 75.5, 76.0, 76.5,
-										 77.0, 77.5, 78.0, 78.5, 79.0, 79.5, 80.0, 80.5, 81.0, 81.5, 82.0, 82.5, 83.0, 83.5, 84.0, 84.5, 85.0, 85.5, 86.0,
-										 86.5, 87.0, 87.5, 88.0, 88.5, 89.0, 89.5, 90.0, 90.5, 91.0, 91.5, 92.0, 92.5, 93.0, 93.5, 94.0, 94.5, 95.0, 95.5,
-										 96.0, 96.5, 97.0, 97.5, 98.0, 98.5, 99.0, 99.5, 100.0};
-        std::array<double,200> weights {16.38, 9.75, 7.9, 6.45, 5.51, 4.78, 4.13, 3.52, 3.12, 2.76, 2.48, 2.2, 1.88, 1.77, 1.59, 1.47, 1.31, 1.22, 1.11, 
-										1.02, 0.92, 0.86, 0.76, 0.73, 0.68, 0.61, 0.6, 0.56, 0.53, 0.5, 0.52, 0.51, 0.51, 0.47, 0.46, 0.43, 0.41, 0.4,
-										0.38, 0.36, 0.34, 0.33, 0.3, 0.29, 0.27, 0.25, 0.27, 0.24, 0.23, 0.2, 0.2, 0.19, 0.17, 0.16, 0.16, 0.15, 0.14,
-										0.12, 0.14, 0.13, 0.11, 0.13, 0.11, 0.11, 0.09, 0.1, 0.08, 0.08, 0.07, 0.07, 0.07, 0.07, 0.06, 0.07, 0.07, 0.05,
-										0.06, 0.06, 0.05, 0.06, 0.06, 0.05, 0.04, 0.04, 0.04, 0.04, 0.04, 0.03, 0.04, 0.04, 0.03, 0.03, 0.03, 0.03, 0.03,
-										0.03, 0.03, 0.04, 0.04, 0.03, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02,
-										0.02, 0.01, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.02, 0.01, 0.02, 0.01, 0.02,
-										0.01, 0.01, 0.01, 0.01, 0.02, 0.01, 0.02, 0.02, 0.02, 0.02, 0.01, 0.01, 0.02, 0.01, 0.01, 0.02, 0.01, 0.02, 0.01,
-										0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01,
-										0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01,
-										0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.01, 0.02, 0.41};
-        m_blockSizeDistribution = std::piecewise_constant_distribution<double> (intervals.begin(), intervals.end(), weights.begin());
-        break;
-      }
-    }
-  }
+    m_blockSizeSampler = GetBlockSizeSampler (m_cryptocurrency);
   
 /*   if (GetNode()->GetId() == 0)
   {
@@ -264,8 +206,8 @@ BitcoinMiner::StartApplication ()    // Called at time specified by Start
     m_blockchain.AddBlock(newBlock); 
   } */
   
-  m_nodeStats->hashRate = m_hashRate;
-  m_nodeStats->miner = 1;
+  m_nodeStats->hashRate[m_nodeId] = m_hashRate;
+  m_nodeStats->miner[m_nodeId] = 1;
 
   ScheduleNextMiningEvent ();
 }
@@ -274,7 +216,7 @@ void
 BitcoinMiner::StopApplication ()
 {
   BitcoinNode::StopApplication ();  
-  Simulator::Cancel (m_nextMiningEvent);
+  StopMining ();
   
   NS_LOG_WARN ("The miner " << GetNode ()->GetId () << " with hash rate = " << m_hashRate << " generated " << m_minerGeneratedBlocks 
                 << " blocks "<< "(" << 100. * m_minerGeneratedBlocks / (m_blockchain.GetTotalBlocks() - 1) 
@@ -284,9 +226,9 @@ BitcoinMiner::StopApplication ()
                 << " and average size " << m_minerAverageBlockSize << " Bytes");
 				
   
-  m_nodeStats->minerGeneratedBlocks = m_minerGeneratedBlocks;
-  m_nodeStats->minerAverageBlockGenInterval = m_minerAverageBlockGenInterval;
-  m_nodeStats->minerAverageBlockSize = m_minerAverageBlockSize;
+  m_nodeStats->minerGeneratedBlocks[m_nodeId] = m_minerGeneratedBlocks;
+  m_nodeStats->minerAverageBlockGenInterval[m_nodeId] = m_minerAverageBlockGenInterval;
+  m_nodeStats->minerAverageBlockSize[m_nodeId] = m_minerAverageBlockSize;
   
   if (m_fistToMine)
   {
@@ -356,8 +298,6 @@ BitcoinMiner::SetBlockGenParameter (double blockGenParameter)
 {
   NS_LOG_FUNCTION (this);
   m_blockGenParameter = blockGenParameter;
-  m_blockGenTimeDistribution.param(std::geometric_distribution<int>::param_type(m_blockGenParameter));
-
 }
 
 double 
@@ -381,11 +321,39 @@ BitcoinMiner::SetBlockBroadcastType (enum BlockBroadcastType blockBroadcastType)
   m_blockBroadcastType = blockBroadcastType;
 }
 
+void
+BitcoinMiner::SetMiningOracle (Ptr<MiningOracle> miningOracle)
+{
+  NS_LOG_FUNCTION (this);
+  m_miningOracle = miningOracle;
+}
+
 void
 BitcoinMiner::ScheduleNextMiningEvent (void)
 {
   NS_LOG_FUNCTION (this);
   
+  if (m_miningOracle)
+  {
+    if (m_fixedBlockTimeGeneration > 0)
+      NS_FATAL_ERROR ("The mining oracle can't be used with a fixed block generation time");
+
+    if (m_blockTimeSampler.GetDistribution () == BLOCK_TIME_TRACE)
+      NS_FATAL_ERROR ("The mining oracle can't replay a trace of block generation times");
+
+    /**
+     * The miner joins the race with the rate of its exponential block times. The oracle only redraws the next block
+     * when the rate changes, not on every new tip.
+     */
+    double rate = m_blockTimeSampler.GetRate ();
+
+    if (rate > 0)
+      m_miningOracle->SetMiner (GetNode ()->GetId (), rate, std::bind (&BitcoinMiner::MineBlock, this));
+    else
+      m_miningOracle->RemoveMiner (GetNode ()->GetId ());
+    return;
+  }
+
   if(m_fixedBlockTimeGeneration > 0)
   {
     m_nextBlockTime = m_fixedBlockTimeGeneration;
@@ -396,8 +364,7 @@ BitcoinMiner::ScheduleNextMiningEvent (void)
   }
   else
   {
-    m_nextBlockTime = m_blockGenTimeDistribution(m_generator)*m_blockGenBinSize*m_secondsPerMin
-                    *( m_averageBlockGenIntervalSeconds/m_realAverageBlockGenIntervalSeconds )/m_hashRate;
+    m_nextBlockTime = m_blockTimeSampler.Draw ();
 
     //NS_LOG_DEBUG("m_nextBlockTime = " << m_nextBlockTime << ", binsize = " << m_blockGenBinSize << ", m_blockGenParameter = " << m_blockGenParameter << ", hashrate = " << m_hashRate);
     m_nextMiningEvent = Simulator::Schedule (Seconds(m_nextBlockTime), &BitcoinMiner::MineBlock, this);
@@ -405,14 +372,40 @@ BitcoinMiner::ScheduleNextMiningEvent (void)
     NS_LOG_WARN ("Time " << Simulator::Now ().GetSeconds () << ": Miner " << GetNode ()->GetId () << " will generate a block in " 
                  << m_nextBlockTime << "s or " << static_cast<int>(m_nextBlockTime) / m_secondsPerMin 
                  << "  min and  " << static_cast<int>(m_nextBlockTime) % m_secondsPerMin 
-                 << "s using Geometric Block Time Generation with parameter = "<< m_blockGenParameter);
+                 << "s using " << getBlockTimeDistribution (m_blockTimeSampler.GetDistribution ())
+                 << " Block Time Generation with parameter = "<< m_blockGenParameter);
   }
 }
 
+void
+BitcoinMiner::ConfigureBlockTimeSampler (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_blockTimeSampler.SetStream (GetNode ()->GetId ());
+  m_blockTimeSampler.SetDistribution (m_blockTimeDistribution);
+  if (m_blockTimeDistribution == BLOCK_TIME_TRACE)
+    m_blockTimeSampler.SetTrace (m_blockTimeTrace);
+
+  m_blockTimeSampler.SetParameters (m_blockGenBinSize*m_secondsPerMin*(m_averageBlockGenIntervalSeconds/m_realAverageBlockGenIntervalSeconds)/m_hashRate,
+                                    m_blockGenParameter);
+}
+
+void
+BitcoinMiner::StopMining (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Simulator::Cancel (m_nextMiningEvent);
+  if (m_miningOracle)
+    m_miningOracle->RemoveMiner (GetNode ()->GetId ());
+}
+
 void 
 BitcoinMiner::MineBlock (void)
 {
   NS_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_MINE_BLOCK);
   rapidjson::Document inv; 
   rapidjson::Document block; 
 
@@ -420,11 +413,7 @@ BitcoinMiner::MineBlock (void)
   int minerId = GetNode ()->GetId ();
   int parentBlockMinerId = m_blockchain.GetCurrentTopBlock()->GetMinerId();
   double currentTime = Simulator::Now ().GetSeconds ();
-  std::ostringstream stringStream;  
-  std::string blockHash;
-  
-  stringStream << height << "/" << minerId;
-  blockHash = stringStream.str();
+  std::string blockHash = BlockId (height, minerId).ToString();
   
   inv.SetObject();
   block.SetObject();
@@ -447,25 +436,8 @@ BitcoinMiner::MineBlock (void)
    } */
    
   
-  if (m_fixedBlockSize > 0)
-    m_nextBlockSize = m_fixedBlockSize;
-  else
-  {
-    m_nextBlockSize = m_blockSizeDistribution(m_generator) * 1000;	// *1000 because the m_blockSizeDistribution returns KBytes
-
-    if (m_cryptocurrency == BITCOIN)
-    {
-      // The block size is linearly dependent on the averageBlockGenIntervalSeconds
-      if(m_nextBlockSize < m_maxBlockSize - m_headersSizeBytes)
-        m_nextBlockSize = m_nextBlockSize*m_averageBlockGenIntervalSeconds / m_realAverageBlockGenIntervalSeconds
-                        + m_headersSizeBytes;	
-      else
-        m_nextBlockSize = m_nextBlockSize*m_averageBlockGenIntervalSeconds / m_realAverageBlockGenIntervalSeconds;
-    }
-  }
-
-  if (m_nextBlockSize < m_averageTransactionSize)
-    m_nextBlockSize = m_averageTransactionSize + m_headersSizeBytes;
+  m_nextBlockSize = DrawBlockSize (m_fixedBlockSize, m_blockSizeSampler, m_blockSizeGenerator,
+                                   m_cryptocurrency, m_averageBlockGenIntervalSeconds, m_maxBlockSize);
 
   Block newBlock (height, minerId, parentBlockMinerId, m_nextBlockSize,
                   currentTime, currentTime, Ipv4Address("127.0.0.1"));
@@ -553,36 +525,7 @@ BitcoinMiner::MineBlock (void)
     }
     case UNSOLICITED:
     {
-      rapidjson::Value value (BLOCK);
-      rapidjson::Value blockInfo(rapidjson::kObjectType);
-      rapidjson::Value array(rapidjson::kArrayType);
-	  
-      block.AddMember("message", value, block.GetAllocator());
-
-      value.SetString("block"); //Remove
-      block.AddMember("type", value, block.GetAllocator());
-
-      value = newBlock.GetBlockHeight ();
-      blockInfo.AddMember("height", value, block.GetAllocator ());
-
-      value = newBlock.GetMinerId ();
-      blockInfo.AddMember("minerId", value, block.GetAllocator ());
-
-      value = newBlock.GetParentBlockMinerId ();
-      blockInfo.AddMember("parentBlockMinerId", value, block.GetAllocator ());
-
-      value = newBlock.GetBlockSizeBytes ();
-      blockInfo.AddMember("size", value, block.GetAllocator ());
-
-      value = newBlock.GetTimeCreated ();
-      blockInfo.AddMember("timeCreated", value, block.GetAllocator ());
-
-      value = newBlock.GetTimeReceived ();							
-      blockInfo.AddMember("timeReceived", value, block.GetAllocator ());
-
-      array.PushBack(blockInfo, block.GetAllocator());
-      block.AddMember("blocks", array, block.GetAllocator());
-      
+      CreateBlockMessage(newBlock, "block", block);
       break;
     }
     case RELAY_NETWORK:
@@ -590,9 +533,7 @@ BitcoinMiner::MineBlock (void)
       rapidjson::Value value;
       rapidjson::Value headersInfo(rapidjson::kObjectType);
       rapidjson::Value chunkInfo(rapidjson::kObjectType);
-      rapidjson::Value blockInfo(rapidjson::kObjectType);
       rapidjson::Value invArray(rapidjson::kArrayType);
-      rapidjson::Value blockArray(rapidjson::kArrayType);
 	  
       value.SetString("block"); //Remove
       inv.AddMember("type", value, inv.GetAllocator());
@@ -669,100 +610,16 @@ BitcoinMiner::MineBlock (void)
 	  
 	  
       //Unsolicited for miners
-      value = BLOCK;
-      block.AddMember("message", value, block.GetAllocator());
-
-      value.SetString("compressed-block"); //Remove
-      block.AddMember("type", value, block.GetAllocator());
-
-      value = newBlock.GetBlockHeight ();
-      blockInfo.AddMember("height", value, block.GetAllocator ());
-
-      value = newBlock.GetMinerId ();
-      blockInfo.AddMember("minerId", value, block.GetAllocator ());
-
-      value = newBlock.GetParentBlockMinerId ();
-      blockInfo.AddMember("parentBlockMinerId", value, block.GetAllocator ());
-
-      value = newBlock.GetBlockSizeBytes ();
-      blockInfo.AddMember("size", value, block.GetAllocator ());
-
-      value = newBlock.GetTimeCreated ();
-      blockInfo.AddMember("timeCreated", value, block.GetAllocator ());
-
-      value = newBlock.GetTimeReceived ();							
-      blockInfo.AddMember("timeReceived", value, block.GetAllocator ());
-
-      blockArray.PushBack(blockInfo, block.GetAllocator());
-      block.AddMember("blocks", blockArray, block.GetAllocator());
-      
+      CreateBlockMessage(newBlock, "compressed-block", block);
       break;
     }
     case UNSOLICITED_RELAY_NETWORK:
     {
-      rapidjson::Value value;
-      rapidjson::Value blockNodesInfo(rapidjson::kObjectType);
-      rapidjson::Value blockInfo(rapidjson::kObjectType);
-      rapidjson::Value invArray(rapidjson::kArrayType);
-      rapidjson::Value blockArray(rapidjson::kArrayType);
-	  
       //Unsolicited for nodes
-      value = BLOCK;
-      inv.AddMember("message", value, inv.GetAllocator());
-
-      value.SetString("block"); //Remove
-      inv.AddMember("type", value, inv.GetAllocator());
-
-      value = newBlock.GetBlockHeight ();
-      blockNodesInfo.AddMember("height", value, inv.GetAllocator ());
-
-      value = newBlock.GetMinerId ();
-      blockNodesInfo.AddMember("minerId", value, inv.GetAllocator ());
-
-      value = newBlock.GetParentBlockMinerId ();
-      blockNodesInfo.AddMember("parentBlockMinerId", value, inv.GetAllocator ());
+      CreateBlockMessage(newBlock, "block", inv);
 
-      value = newBlock.GetBlockSizeBytes ();
-      blockNodesInfo.AddMember("size", value, inv.GetAllocator ());
-
-      value = newBlock.GetTimeCreated ();
-      blockNodesInfo.AddMember("timeCreated", value, inv.GetAllocator ());
-
-      value = newBlock.GetTimeReceived ();							
-      blockNodesInfo.AddMember("timeReceived", value, inv.GetAllocator ());
-
-      invArray.PushBack(blockNodesInfo, inv.GetAllocator());
-      inv.AddMember("blocks", invArray, inv.GetAllocator());
-	  
-	  
       //Unsolicited for miners
-      value = BLOCK;
-      block.AddMember("message", value, block.GetAllocator());
-
-      value.SetString("compressed-block"); //Remove
-      block.AddMember("type", value, block.GetAllocator());
-
-      value = newBlock.GetBlockHeight ();
-      blockInfo.AddMember("height", value, block.GetAllocator ());
-
-      value = newBlock.GetMinerId ();
-      blockInfo.AddMember("minerId", value, block.GetAllocator ());
-
-      value = newBlock.GetParentBlockMinerId ();
-      blockInfo.AddMember("parentBlockMinerId", value, block.GetAllocator ());
-
-      value = newBlock.GetBlockSizeBytes ();
-      blockInfo.AddMember("size", value, block.GetAllocator ());
-
-      value = newBlock.GetTimeCreated ();
-      blockInfo.AddMember("timeCreated", value, block.GetAllocator ());
-
-      value = newBlock.GetTimeReceived ();							
-      blockInfo.AddMember("timeReceived", value, block.GetAllocator ());
-
-      blockArray.PushBack(blockInfo, block.GetAllocator());
-      block.AddMember("blocks", blockArray, block.GetAllocator());
-      
+      CreateBlockMessage(newBlock, "compressed-block", block);
       break;
     }
   }
@@ -781,91 +638,67 @@ BitcoinMiner::MineBlock (void)
                   + (m_nextBlockSize)/static_cast<double>(m_blockchain.GetTotalBlocks());
 				  
   m_blockchain.AddBlock(newBlock);
+  TraceBlock(newBlock);
 
-  // Stringify the DOM
-  rapidjson::StringBuffer invInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> invWriter(invInfo);
-  inv.Accept(invWriter);
-  
-  rapidjson::StringBuffer blockInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> blockWriter(blockInfo);
-  block.Accept(blockWriter);
+  std::string invInfo = EncodeMessage(inv, m_messageCodec);
+  std::string blockInfo = EncodeMessage(block, m_messageCodec);
   
   int count = 0;
 
   for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i, ++count)
   {
     
-    const uint8_t delimiter[] = "#";
-
     switch(m_blockBroadcastType)				  
     {
       case STANDARD:
       {
-        m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(invInfo.GetString()), invInfo.GetSize(), 0);
-        m_peersSockets[*i]->Send (delimiter, 1, 0);
+        SendFrame(invInfo, *i);
 		
         if (m_protocolType == STANDARD_PROTOCOL && !m_blockTorrent)
-          m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+          m_nodeStats->invSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
         else if (m_protocolType == SENDHEADERS && !m_blockTorrent)
-          m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+          m_nodeStats->headersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
         else if (m_protocolType == STANDARD_PROTOCOL && m_blockTorrent)
         {
-          m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+          m_nodeStats->extInvSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
           for (int j=0; j<inv["inv"].Size(); j++)
           {
-            m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
+            m_nodeStats->extInvSentBytes[m_nodeId] += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
             if (!inv["inv"][j]["fullBlock"].GetBool())
-              m_nodeStats->extInvSentBytes += inv["inv"][j]["availableChunks"].Size()*1;
+              m_nodeStats->extInvSentBytes[m_nodeId] += inv["inv"][j]["availableChunks"].Size()*1;
           }
         }
         else if (m_protocolType == SENDHEADERS && m_blockTorrent)
         {
-          m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+          m_nodeStats->extHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
           for (int j=0; j<inv["blocks"].Size(); j++)
           {
-            m_nodeStats->extHeadersSentBytes += 1;//fullBlock
+            m_nodeStats->extHeadersSentBytes[m_nodeId] += 1;//fullBlock
             if (!inv["blocks"][j]["fullBlock"].GetBool())
-              m_nodeStats->extHeadersSentBytes += inv["inv"][j]["availableChunks"].Size();
+              m_nodeStats->extHeadersSentBytes[m_nodeId] += inv["inv"][j]["availableChunks"].Size();
           }	
         }
 		
-        NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+        BITCOIN_MESSAGE_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
                      << "s bitcoin miner " << GetNode ()->GetId () 
-                     << " sent a packet " << invInfo.GetString() 
+                     << " sent a packet " << MessageToString(inv) 
 			         << " to " << *i);
         break;
       }
       case UNSOLICITED:
       {
-        m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + block["blocks"][0]["size"].GetInt();
+        m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + block["blocks"][0]["size"].GetInt();
 
-        double sendTime = m_nextBlockSize / m_uploadSpeed;
-        double eventTime;	
 				
 /*                 std::cout << "Node " << GetNode()->GetId() << "-" << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
                           << " " << m_peersDownloadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] << " Mbps , time = "
                           << Simulator::Now ().GetSeconds() << "s \n"; */
                 
-        if (m_sendBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendBlockTimes.back())
-        {
-          eventTime = 0; 
-        }
-        else
-        {
-          //std::cout << "m_sendBlockTimes.back() = m_sendBlockTimes.back() = " << m_sendBlockTimes.back() << std::endl;
-          eventTime = m_sendBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-        }
-        m_sendBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
- 
-        /* std::cout << sendTime << " " << eventTime << " " << m_sendBlockTimes.size() << std::endl; */
-        NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the block to " << *i 
-                    << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
+        NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the block for " << *i << "\n");
 
-        std::string packet = blockInfo.GetString();
-        Simulator::Schedule (Seconds(eventTime), &BitcoinMiner::SendBlock, this, packet, m_peersSockets[*i]);
-        Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinMiner::RemoveSendTime, this);
+        std::string packet = blockInfo;
+        m_uploadLink.Enqueue (*i, m_nextBlockSize, 0, std::bind (&BitcoinMiner::SendUnsolicitedBlock, this, packet, *i),
+                              LinkScheduler::TransferHandler ());
 
         break;
       }
@@ -875,79 +708,58 @@ BitcoinMiner::MineBlock (void)
         {
           int    noTransactions = static_cast<int>((m_nextBlockSize - m_blockHeadersSizeBytes)/m_averageTransactionSize);
           long   blockSize = m_blockHeadersSizeBytes + m_transactionIndexSize*noTransactions;
-          double sendTime = blockSize / m_uploadSpeed;
-          double eventTime;
 		  
-          m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + blockSize;
+          m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + blockSize;
 			  
 /* 				std::cout << "Node " << GetNode()->GetId() << "-" << *i 
                             << " " << m_peersDownloadSpeeds[*i] << " Mbps , time = "
                             << Simulator::Now ().GetSeconds() << "s \n"; */
                 
-          if (m_sendCompressedBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendCompressedBlockTimes.back())
-          {
-            eventTime = 0; 
-          }
-          else
-          {
-            //std::cout << "m_sendCompressedBlockTimes.back() = m_sendCompressedBlockTimes.back() = " << m_sendCompressedBlockTimes.back() << std::endl;
-            eventTime = m_sendCompressedBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-          }
-          m_sendCompressedBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
-          //std::cout << sendTime << " " << eventTime << " " << m_sendCompressedBlockTimes.size() << std::endl;
-          NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the block to " << *i
-                      << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
-
-          //sendTime = blockSize / m_uploadSpeed * count;		  
-          //std::cout << sendTime << std::endl;
+          NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the compressed-block for " << *i << "\n");
 
-          std::string packet = blockInfo.GetString();
-          Simulator::Schedule (Seconds(sendTime), &BitcoinMiner::SendBlock, this, packet, m_peersSockets[*i]);
-          Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinMiner::RemoveCompressedBlockSendTime, this);
+          std::string packet = blockInfo;
+          m_compressedUploadLink.Enqueue (*i, blockSize, 0, LinkScheduler::TransferHandler (),
+                                          std::bind (&BitcoinMiner::SendUnsolicitedBlock, this, packet, *i));
 
         }
         else
         {	    
-          m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(invInfo.GetString()), invInfo.GetSize(), 0);
-          m_peersSockets[*i]->Send (delimiter, 1, 0);
+          SendFrame(invInfo, *i);
 	  
           if (m_protocolType == STANDARD_PROTOCOL && !m_blockTorrent)
-            m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+            m_nodeStats->invSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
           else if (m_protocolType == SENDHEADERS && !m_blockTorrent)
-            m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+            m_nodeStats->headersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
           else if (m_protocolType == STANDARD_PROTOCOL && m_blockTorrent)
           {
-            m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+            m_nodeStats->extInvSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
             for (int j=0; j<inv["inv"].Size(); j++)
             {
-              m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
+              m_nodeStats->extInvSentBytes[m_nodeId] += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
               if (!inv["inv"][j]["fullBlock"].GetBool())
-                m_nodeStats->extInvSentBytes += inv["inv"][j]["availableChunks"].Size()*1;
+                m_nodeStats->extInvSentBytes[m_nodeId] += inv["inv"][j]["availableChunks"].Size()*1;
             }
           }
           else if (m_protocolType == SENDHEADERS && m_blockTorrent)
           {
-            m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+            m_nodeStats->extHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
             for (int j=0; j<inv["blocks"].Size(); j++)
             {
-            m_nodeStats->extHeadersSentBytes += 1;//fullBlock
+            m_nodeStats->extHeadersSentBytes[m_nodeId] += 1;//fullBlock
             if (!inv["blocks"][j]["fullBlock"].GetBool())
-                m_nodeStats->extHeadersSentBytes += inv["blocks"][j]["availableChunks"].Size()*1;
+                m_nodeStats->extHeadersSentBytes[m_nodeId] += inv["blocks"][j]["availableChunks"].Size()*1;
             }	
           }
 	  
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+          BITCOIN_MESSAGE_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
                        << "s bitcoin miner " << GetNode ()->GetId () 
-                       << " sent a packet " << invInfo.GetString() 
+                       << " sent a packet " << MessageToString(inv) 
                        << " to " << *i);
         }
         break;
       }
       case UNSOLICITED_RELAY_NETWORK:
       {
-        double sendTime;
-        double eventTime;
         std::string packet;
 			  
 /* 				std::cout << "Node " << GetNode()->GetId() << "-" << *i 
@@ -958,54 +770,23 @@ BitcoinMiner::MineBlock (void)
         {
           int    noTransactions = static_cast<int>((m_nextBlockSize - m_blockHeadersSizeBytes)/m_averageTransactionSize);
           long   blockSize = m_blockHeadersSizeBytes + m_transactionIndexSize*noTransactions;
-          sendTime = blockSize / m_uploadSpeed;
 
-          m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + blockSize;
+          m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + blockSize;
 		  
-          if (m_sendCompressedBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendCompressedBlockTimes.back())
-          {
-            eventTime = 0; 
-          }
-          else
-          {
-            //std::cout << "m_sendCompressedBlockTimes.back() = m_sendCompressedBlockTimes.back() = " << m_sendCompressedBlockTimes.back() << std::endl;
-            eventTime = m_sendCompressedBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-          }
-          m_sendCompressedBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
-          //std::cout << sendTime << " " << eventTime << " " << m_sendCompressedBlockTimes.size() << std::endl;
-          NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the block to " << *i
-                      << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
-
-          //sendTime = blockSize / m_uploadSpeed * count;		  
-          //std::cout << sendTime << std::endl;
-
-          std::string packet = blockInfo.GetString();
-          Simulator::Schedule (Seconds(sendTime), &BitcoinMiner::SendBlock, this, packet, m_peersSockets[*i]);
-          Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinMiner::RemoveCompressedBlockSendTime, this);
+          NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the compressed-block for " << *i << "\n");
+
+          std::string packet = blockInfo;
+          m_compressedUploadLink.Enqueue (*i, blockSize, 0, LinkScheduler::TransferHandler (),
+                                          std::bind (&BitcoinMiner::SendUnsolicitedBlock, this, packet, *i));
         }
         else
         {
-          sendTime = m_nextBlockSize / m_uploadSpeed;
-          m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + m_nextBlockSize;
-          if (m_sendBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendBlockTimes.back())
-          {
-            eventTime = 0; 
-          }
-          else
-          {
-            //std::cout << "m_sendBlockTimes.back() = m_sendBlockTimes.back() = " << m_sendBlockTimes.back() << std::endl;
-            eventTime = m_sendBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-          }
-          m_sendBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
-          packet = invInfo.GetString();
-		  
-          /* std::cout << sendTime << " " << eventTime << " " << m_sendBlockTimes.size() << std::endl; */
-          NS_LOG_INFO("Node " << GetNode()->GetId() << " will send the block to " << *i 
-                      << " at " << Simulator::Now ().GetSeconds() + eventTime << ", eventTime = " << eventTime  << "\n");
+          m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_nextBlockSize;
+          NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the block for " << *i << "\n");
 
-          Simulator::Schedule (Seconds(eventTime), &BitcoinMiner::SendBlock, this, packet, m_peersSockets[*i]);
-          Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinMiner::RemoveSendTime, this);
+          packet = invInfo;
+          m_uploadLink.Enqueue (*i, m_nextBlockSize, 0, std::bind (&BitcoinMiner::SendUnsolicitedBlock, this, packet, *i),
+                                LinkScheduler::TransferHandler ());
 
         }
 	   break;
@@ -1032,6 +813,8 @@ BitcoinMiner::MineBlock (void)
   m_minerGeneratedBlocks++;
 			   
   ScheduleNextMiningEvent ();
+
+  UpdateNetworkState();
 }
 
 void 
@@ -1043,29 +826,6 @@ BitcoinMiner::ReceivedHigherBlock(const Block &newBlock)
   ScheduleNextMiningEvent ();
 }
 
-
-void 
-BitcoinMiner::SendBlock(std::string packetInfo, Ptr<Socket> to) 
-{
-  NS_LOG_FUNCTION (this);
-
-  NS_LOG_INFO ("SendBlock: At time " << Simulator::Now ().GetSeconds ()
-               << "s bitcoin miner " << GetNode ()->GetId () << " send " 
-               << packetInfo << " to " << to);
-
-  rapidjson::Document d;
-  
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-
-  d.Parse(packetInfo.c_str());  
-  d.Accept(writer);
-  
-/*   if (d["type"] != "compressed-block")
-    m_sendBlockTimes.erase(m_sendBlockTimes.begin()); */				
-  SendMessage(NO_MESSAGE, BLOCK, d, to);
-  m_nodeStats->blockSentBytes -= m_bitcoinMessageHeader + d["blocks"][0]["size"].GetInt();
-}
 } // Namespace ns3
 
 
@@ -2,6 +2,9 @@
 #define BITCOIN_MINER_H
 
 #include "bitcoin-node.h"
+#include "bitcoin-mining-oracle.h"
+#include "bitcoin-block-time-sampler.h"
+#include "bitcoin-alias-sampler.h"
 #include <random>
 
 namespace ns3 {
@@ -108,6 +111,12 @@ public:
    * set the type of block broadcast
    */
   void SetBlockBroadcastType (enum BlockBroadcastType blockBroadcastType);
+
+  /**
+   * \brief Sets the oracle which draws the blocks of all the miners. When it is set, the miner doesn't schedule its own mining events
+   * \param miningOracle the oracle shared by the miners of the process. A null oracle restores the mining events of the miner
+   */
+  void SetMiningOracle (Ptr<MiningOracle> miningOracle);
    
 protected:
   // inherited from Application base class.
@@ -120,6 +129,16 @@ protected:
    * \brief Schedule the next mining event
    */
   void ScheduleNextMiningEvent (void);
+
+  /**
+   * \brief Cancels the next mining event, or leaves the race of the mining oracle
+   */
+  void StopMining (void);
+
+  /**
+   * \brief Configures the sampler of the block generation times with the distribution and the parameters of the miner
+   */
+  void ConfigureBlockTimeSampler (void);
   
   /**
    * \brief Mines a new block and advertises it to its peers
@@ -132,18 +151,13 @@ protected:
    */
   virtual void ReceivedHigherBlock(const Block &newBlock);	
 
-  /**
-   * \brief Sends a BLOCK message as a response to a GET_DATA message
-   * \param packetInfo the info of the BLOCK message
-   * \param to the socket of the receiving peer
-   */
-  void SendBlock(std::string packetInfo, Ptr<Socket> to);				   
-
   int               m_noMiners;                
   uint32_t          m_fixedBlockSize;  
   double            m_fixedBlockTimeGeneration; 	//!< Fixed Block Time Generation
   EventId           m_nextMiningEvent; 				//!< Event to mine the next block
-  std::default_random_engine m_generator;
+  Ptr<MiningOracle> m_miningOracle;               //!< Draws the blocks of all the miners, null when the miner schedules its own mining events
+  BlockTimeSampler  m_blockTimeSampler;           //!< Draws the block generation times
+  RandomStream      m_blockSizeGenerator;         //!< Draws the block sizes
 
   /** 
    * The m_blockGenBinSize states binSize of the block generation time.
@@ -158,12 +172,13 @@ protected:
   int               m_minerGeneratedBlocks;
   double            m_hashRate;
 
-  std::geometric_distribution<int> m_blockGenTimeDistribution ;
+  enum BlockTimeDistribution  m_blockTimeDistribution;  //!< The distribution of the block generation times
+  std::string                 m_blockTimeTrace;         //!< The trace of the block intervals, for BLOCK_TIME_TRACE
   
   int                                            m_nextBlockSize;
   int                                            m_maxBlockSize;
   double                                         m_minerAverageBlockSize;
-  std::piecewise_constant_distribution<double>   m_blockSizeDistribution;
+  Ptr<const AliasSampler>                        m_blockSizeSampler;     //!< Draws the block sizes in KB, shared by the miners of the same cryptocurrency
   
   const double  m_realAverageBlockGenIntervalSeconds;  //!< in seconds, 10 mins
   double        m_averageBlockGenIntervalSeconds;      //!< the new m_averageBlockGenInterval we set
@@ -0,0 +1,118 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-mining-oracle.h
+ */
+
+#include <cmath>
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "bitcoin-mining-oracle.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MiningOracle");
+
+MiningOracle::MiningOracle (void)
+  : m_totalRate (0), m_stream (RNG_MINING_ORACLE, 0), m_noBlocks (0), m_noScheduledEvents (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MiningOracle::~MiningOracle (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MiningOracle::SetMiner (uint32_t minerId, double rate, MineBlockHandler mineBlock)
+{
+  if (!(rate > 0))
+    NS_FATAL_ERROR ("The mining rate of miner " << minerId << " must be positive");
+
+  auto miner = m_miners.find (minerId);
+
+  if (miner != m_miners.end () && miner->second.rate == rate)
+    return;
+
+  NS_LOG_INFO ("Miner " << minerId << " joins the race with rate = " << rate << " blocks/s");
+
+  m_miners[minerId] = {rate, mineBlock};
+  Reschedule ();
+}
+
+void
+MiningOracle::RemoveMiner (uint32_t minerId)
+{
+  auto miner = m_miners.find (minerId);
+
+  if (miner == m_miners.end ())
+    return;
+
+  m_miners.erase (miner);
+
+  Reschedule ();
+}
+
+double
+MiningOracle::GetTotalRate (void) const
+{
+  return m_totalRate;
+}
+
+uint64_t
+MiningOracle::GetNoBlocks (void) const
+{
+  return m_noBlocks;
+}
+
+uint64_t
+MiningOracle::GetNoScheduledEvents (void) const
+{
+  return m_noScheduledEvents;
+}
+
+void
+MiningOracle::Reschedule (void)
+{
+  Simulator::Cancel (m_nextBlockEvent);
+
+  m_totalRate = 0;
+  for (auto const &miner : m_miners)
+    m_totalRate += miner.second.rate;
+
+  if (m_miners.empty ())
+    return;
+
+  //The remaining time of the race does not depend on the time already spent, so it is drawn from scratch
+  double nextBlockTime = -std::log1p (-m_stream.GetDouble ()) / m_totalRate;
+
+  m_nextBlockEvent = Simulator::Schedule (Seconds (nextBlockTime), &MiningOracle::Dispatch, this);
+  m_noScheduledEvents++;
+
+  NS_LOG_DEBUG ("Time " << Simulator::Now ().GetSeconds () << ": the next block of the " << m_miners.size ()
+                << " miners will be generated in " << nextBlockTime << "s");
+}
+
+void
+MiningOracle::Dispatch (void)
+{
+  double                                      target = m_stream.GetDouble () * m_totalRate;
+  std::map<uint32_t, oracleMiner>::iterator   winner = m_miners.begin ();
+
+  for (double cumulativeRate = winner->second.rate; cumulativeRate <= target && std::next (winner) != m_miners.end (); )
+  {
+    winner++;
+    cumulativeRate += winner->second.rate;
+  }
+
+  NS_LOG_INFO ("Time " << Simulator::Now ().GetSeconds () << ": miner " << winner->first << " won the race");
+
+  m_noBlocks++;
+
+  //The handler is copied, since MineBlock may change the miners
+  MineBlockHandler mineBlock = winner->second.mineBlock;
+
+  Reschedule ();
+  mineBlock ();
+}
+
+} // namespace ns3
@@ -0,0 +1,96 @@
+/**
+ * This file contains the declaration of the MiningOracle, which draws the blocks of all the miners of a process from a single race.
+ */
+
+#ifndef BITCOIN_MINING_ORACLE_H
+#define BITCOIN_MINING_ORACLE_H
+
+#include <map>
+#include <functional>
+#include "ns3/event-id.h"
+#include "ns3/simple-ref-count.h"
+#include "bitcoin.h"
+#include "bitcoin-random-stream.h"
+
+namespace ns3 {
+
+/**
+ * An optional scheduler of the mining events, shared by all the miners of a process.
+ *
+ * Without it, each miner keeps its own mining event, and every miner cancels and reschedules it whenever its tip changes,
+ * so each block costs a cancel and a schedule per miner. The mining time of a miner is geometric with a tiny bin, i.e.
+ * exponential, and the exponential races are memoryless: restarting a race when the tip changes does not change the
+ * distribution of its remaining time. So the next block of the process is the first of independent exponential races,
+ * which is exponential with the sum of the rates, and it is won by each miner with a probability proportional to its rate.
+ * The oracle draws it directly and dispatches MineBlock to the winner, so each block costs a single simulator event,
+ * and a tip change costs nothing.
+ *
+ * The oracle requires all the miners to run in a single process. A race per MPI process would depend on how the miners
+ * are split between the processes, so the same seed would give different blocks for different numbers of processes.
+ */
+class MiningOracle : public SimpleRefCount<MiningOracle>
+{
+public:
+  typedef std::function<void (void)> MineBlockHandler;
+
+  MiningOracle (void);
+  ~MiningOracle (void);
+
+  /**
+   * \brief Adds a miner to the race, or updates its rate. The next block is only redrawn when the total rate changes.
+   * \param minerId the id of the miner
+   * \param rate the mining rate of the miner in blocks per second, which must be positive
+   * \param mineBlock invoked when the miner wins the race
+   */
+  void SetMiner (uint32_t minerId, double rate, MineBlockHandler mineBlock);
+
+  /**
+   * \brief Removes a miner from the race, e.g. when its application stops
+   */
+  void RemoveMiner (uint32_t minerId);
+
+  /**
+   * \return the sum of the rates of the miners in blocks per second
+   */
+  double GetTotalRate (void) const;
+
+  /**
+   * \return the number of blocks dispatched to the miners
+   */
+  uint64_t GetNoBlocks (void) const;
+
+  /**
+   * \return the number of mining events scheduled, including the ones cancelled by a change of the miners
+   */
+  uint64_t GetNoScheduledEvents (void) const;
+
+private:
+  /**
+   * A miner of the race
+   */
+  typedef struct {
+    double             rate;         // blocks per second
+    MineBlockHandler   mineBlock;
+  } oracleMiner;
+
+  /**
+   * \brief Cancels the pending event, sums the rates and draws the time of the next block from the total rate
+   */
+  void Reschedule (void);
+
+  /**
+   * \brief Draws the winner of the block, schedules the next block and dispatches the block to the winner
+   */
+  void Dispatch (void);
+
+  std::map<uint32_t, oracleMiner>   m_miners;
+  double                            m_totalRate;
+  RandomStream                      m_stream;             // draws the times and the winners of the blocks
+  EventId                           m_nextBlockEvent;
+  uint64_t                          m_noBlocks;
+  uint64_t                          m_noScheduledEvents;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_MINING_ORACLE_H */
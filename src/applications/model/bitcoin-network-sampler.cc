@@ -0,0 +1,134 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-network-sampler.h
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/simulator.h"
+#include "bitcoin-network-sampler.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NetworkStateSampler");
+
+NetworkStateSampler::NetworkStateSampler (const std::string &fileName, Time interval)
+  : m_interval (interval), m_noSamples (0), m_noNodes (0), m_inFlightTransfers (0), m_queuedInvs (0), m_invTimeouts (0)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_interval.IsStrictlyPositive ())
+    NS_FATAL_ERROR ("The interval of the network sampler must be positive");
+
+  m_file.open (fileName.c_str (), std::ios::out | std::ios::trunc);
+  if (!m_file)
+    NS_FATAL_ERROR ("Could not open the network samples " << fileName);
+
+  m_file << "time,nodes,minHeight,maxHeight";
+  for (int lag = 0; lag < NETWORK_SAMPLER_HEIGHT_LAGS - 1; lag++)
+    m_file << ",lag" << lag;
+  m_file << ",lag" << NETWORK_SAMPLER_HEIGHT_LAGS - 1 << "+";
+  m_file << ",distinctTips,inFlightTransfers,queuedInvs,invTimeouts\n";
+}
+
+NetworkStateSampler::~NetworkStateSampler (void)
+{
+  Close ();
+}
+
+void
+NetworkStateSampler::Start (void)
+{
+  NS_LOG_FUNCTION (this);
+  Simulator::Schedule (m_interval, &NetworkStateSampler::Sample, this);
+}
+
+void
+NetworkStateSampler::Close (void)
+{
+  if (m_file.is_open ())
+    m_file.close ();
+}
+
+void
+NetworkStateSampler::AddNode (const BlockId &tip)
+{
+  m_noNodes++;
+  m_heights[tip.GetBlockHeight ()]++;
+  m_tips[tip]++;
+}
+
+void
+NetworkStateSampler::UpdateTip (const BlockId &oldTip, const BlockId &newTip)
+{
+  auto height = m_heights.find (oldTip.GetBlockHeight ());
+  auto tip = m_tips.find (oldTip);
+
+  NS_ASSERT_MSG (height != m_heights.end () && tip != m_tips.end (), "The tip " << oldTip << " was not reported");
+
+  if (--height->second == 0)
+    m_heights.erase (height);
+  if (--tip->second == 0)
+    m_tips.erase (tip);
+
+  m_heights[newTip.GetBlockHeight ()]++;
+  m_tips[newTip]++;
+}
+
+void
+NetworkStateSampler::UpdateInvs (int64_t queuedInvsDelta, int64_t invTimeoutsDelta)
+{
+  m_queuedInvs += queuedInvsDelta;
+  m_invTimeouts += invTimeoutsDelta;
+}
+
+int64_t*
+NetworkStateSampler::GetInFlightTransfersCounter (void)
+{
+  return &m_inFlightTransfers;
+}
+
+uint64_t
+NetworkStateSampler::GetNoSamples (void) const
+{
+  return m_noSamples;
+}
+
+void
+NetworkStateSampler::Sample (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!m_file.is_open ())
+    return;
+
+  int64_t lags[NETWORK_SAMPLER_HEIGHT_LAGS] = {0};
+  int     minHeight = 0;
+  int     maxHeight = 0;
+
+  if (!m_heights.empty ())
+  {
+    minHeight = m_heights.begin ()->first;
+    maxHeight = m_heights.rbegin ()->first;
+
+    /**
+     * Only the heights close to the highest tip have their own bucket, so the walk stops after a few entries
+     */
+    int64_t counted = 0;
+    for (auto it = m_heights.rbegin (); it != m_heights.rend () && maxHeight - it->first < NETWORK_SAMPLER_HEIGHT_LAGS - 1; it++)
+    {
+      lags[maxHeight - it->first] = it->second;
+      counted += it->second;
+    }
+    lags[NETWORK_SAMPLER_HEIGHT_LAGS - 1] = m_noNodes - counted;
+  }
+
+  m_file << Simulator::Now ().GetSeconds () << "," << m_noNodes << "," << minHeight << "," << maxHeight;
+  for (int lag = 0; lag < NETWORK_SAMPLER_HEIGHT_LAGS; lag++)
+    m_file << "," << lags[lag];
+  m_file << "," << m_tips.size () << "," << m_inFlightTransfers << "," << m_queuedInvs << "," << m_invTimeouts << "\n";
+  m_noSamples++;
+
+  Simulator::Schedule (m_interval, &NetworkStateSampler::Sample, this);
+}
+
+} // namespace ns3
@@ -0,0 +1,100 @@
+/**
+ * This file contains the declaration of the NetworkStateSampler, which records the state of the network periodically during a run.
+ */
+
+#ifndef BITCOIN_NETWORK_SAMPLER_H
+#define BITCOIN_NETWORK_SAMPLER_H
+
+#include <map>
+#include <string>
+#include <fstream>
+#include <unordered_map>
+#include "ns3/nstime.h"
+#include "ns3/simple-ref-count.h"
+#include "bitcoin.h"
+
+namespace ns3 {
+
+/**
+ * The number of buckets of the tip height distribution. The last bucket holds the nodes
+ * which are NETWORK_SAMPLER_HEIGHT_LAGS - 1 or more blocks behind the highest tip.
+ */
+const int NETWORK_SAMPLER_HEIGHT_LAGS = 4;
+
+
+/**
+ * A sampler shared by all the nodes of a process, which writes the aggregate state of the nodes every interval
+ * of simulated time to a CSV file, one row per sample:
+ *   time,nodes,minHeight,maxHeight,lag0,lag1,lag2,lag3+,distinctTips,inFlightTransfers,queuedInvs,invTimeouts
+ * where lagN is the number of nodes whose tip is N blocks below maxHeight, inFlightTransfers the transfers queued
+ * in the links of the nodes, queuedInvs the blocks with queued INVs (m_queueInv) and invTimeouts the pending
+ * INV timeouts (m_invTimeouts).
+ *
+ * The nodes report the changes of their state after each event, so the sampler keeps running totals and
+ * a sample does not visit the nodes. With MPI, every process samples its own nodes.
+ */
+class NetworkStateSampler : public SimpleRefCount<NetworkStateSampler>
+{
+public:
+  /**
+   * \param fileName the name of the time series, which is created or truncated
+   * \param interval the simulated time between two samples
+   */
+  NetworkStateSampler (const std::string &fileName, Time interval);
+  ~NetworkStateSampler (void);
+
+  /**
+   * \brief Schedules the samples. The first sample is taken after one interval. It should be called before Simulator::Run.
+   */
+  void Start (void);
+
+  /**
+   * \brief Writes the buffered samples and closes the file. The later samples are dropped.
+   */
+  void Close (void);
+
+  /**
+   * \brief Adds a node with its current tip
+   */
+  void AddNode (const BlockId &tip);
+
+  /**
+   * \brief Moves a node from its previous tip to its new one
+   */
+  void UpdateTip (const BlockId &oldTip, const BlockId &newTip);
+
+  /**
+   * \brief Adds the changes of the queued INVs and the INV timeouts of a node
+   */
+  void UpdateInvs (int64_t queuedInvsDelta, int64_t invTimeoutsDelta);
+
+  /**
+   * \return the counter of the in-flight transfers, which the links of the nodes update directly
+   */
+  int64_t* GetInFlightTransfersCounter (void);
+
+  /**
+   * \return the number of samples taken
+   */
+  uint64_t GetNoSamples (void) const;
+
+private:
+  /**
+   * \brief Writes a sample and schedules the next one
+   */
+  void Sample (void);
+
+  std::ofstream                                   m_file;
+  Time                                            m_interval;
+  uint64_t                                        m_noSamples;
+  int64_t                                         m_noNodes;
+  std::map<int, int64_t>                          m_heights;            // the number of nodes per tip height
+  std::unordered_map<BlockId, int64_t, BlockIdHash> m_tips;             // the number of nodes per tip
+  int64_t                                         m_inFlightTransfers;
+  int64_t                                         m_queuedInvs;
+  int64_t                                         m_invTimeouts;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_NETWORK_SAMPLER_H */
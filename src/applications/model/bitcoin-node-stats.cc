@@ -0,0 +1,276 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-node-stats.h
+ */
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "bitcoin-node-stats.h"
+#include "../../rapidjson/writer.h"
+#include "../../rapidjson/stringbuffer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NodeStatsRegistry");
+
+/**
+ * The JSON writers of the types of the statistics
+ */
+static void
+WriteJsonValue (rapidjson::Writer<rapidjson::StringBuffer> &writer, int value)
+{
+  writer.Int (value);
+}
+
+static void
+WriteJsonValue (rapidjson::Writer<rapidjson::StringBuffer> &writer, long value)
+{
+  writer.Int64 (value);
+}
+
+static void
+WriteJsonValue (rapidjson::Writer<rapidjson::StringBuffer> &writer, double value)
+{
+  if (std::isfinite (value))
+    writer.Double (value);
+  else
+    writer.Null ();
+}
+
+
+NodeStatsHistogram::NodeStatsHistogram (double min, int binsPerDecade, int bins)
+  : m_min (min), m_binsPerDecade (binsPerDecade), m_bins (bins)
+{
+  NS_ASSERT_MSG (min > 0 && binsPerDecade > 0 && bins > 1, "Invalid histogram parameters");
+}
+
+void
+NodeStatsHistogram::Resize (uint32_t noNodes)
+{
+  m_counts.assign(static_cast<size_t>(noNodes) * m_bins, 0);
+}
+
+void
+NodeStatsHistogram::Reset (uint32_t nodeId)
+{
+  std::fill_n (Get (nodeId), m_bins, 0);
+}
+
+void
+NodeStatsHistogram::Add (uint32_t nodeId, double value)
+{
+  int bin = 0;
+
+  if (value >= m_min)
+    bin = std::min(1 + static_cast<int>(std::log10(value / m_min) * m_binsPerDecade), m_bins - 1);
+
+  Get (nodeId)[bin]++;
+}
+
+uint32_t*
+NodeStatsHistogram::Get (uint32_t nodeId)
+{
+  return m_counts.data() + static_cast<size_t>(nodeId) * m_bins;
+}
+
+const uint32_t*
+NodeStatsHistogram::Get (uint32_t nodeId) const
+{
+  return m_counts.data() + static_cast<size_t>(nodeId) * m_bins;
+}
+
+int
+NodeStatsHistogram::GetNoBins (void) const
+{
+  return m_bins;
+}
+
+double
+NodeStatsHistogram::GetBinStart (int bin) const
+{
+  if (bin == 0)
+    return 0;
+  return m_min * std::pow(10, (bin - 1) / static_cast<double>(m_binsPerDecade));
+}
+
+
+#define BITCOIN_STATS_NONE(type, name, description)
+#define BITCOIN_STATS_INIT_HISTOGRAM(name, min, binsPerDecade, bins, description) name (min, binsPerDecade, bins),
+
+NodeStatsRegistry::NodeStatsRegistry (uint32_t noNodes)
+  : BITCOIN_NODE_STATS (BITCOIN_STATS_NONE, BITCOIN_STATS_NONE, BITCOIN_STATS_INIT_HISTOGRAM)
+    m_noNodes (noNodes)
+{
+#define BITCOIN_STATS_RESIZE_ARRAY(type, name, description) name.assign(noNodes, 0);
+#define BITCOIN_STATS_RESIZE_HISTOGRAM(name, min, binsPerDecade, bins, description) name.Resize (noNodes);
+  BITCOIN_NODE_STATS (BITCOIN_STATS_RESIZE_ARRAY, BITCOIN_STATS_RESIZE_ARRAY, BITCOIN_STATS_RESIZE_HISTOGRAM)
+#undef BITCOIN_STATS_RESIZE_ARRAY
+#undef BITCOIN_STATS_RESIZE_HISTOGRAM
+}
+
+#undef BITCOIN_STATS_INIT_HISTOGRAM
+
+NodeStatsRegistry::~NodeStatsRegistry (void)
+{
+}
+
+uint32_t
+NodeStatsRegistry::GetNoNodes (void) const
+{
+  return m_noNodes;
+}
+
+void
+NodeStatsRegistry::Reset (uint32_t nodeId)
+{
+  NS_ASSERT_MSG (nodeId < m_noNodes, "Node " << nodeId << " is not in the registry");
+
+#define BITCOIN_STATS_RESET_ARRAY(type, name, description) name[nodeId] = 0;
+#define BITCOIN_STATS_RESET_HISTOGRAM(name, min, binsPerDecade, bins, description) name.Reset (nodeId);
+  BITCOIN_NODE_STATS (BITCOIN_STATS_RESET_ARRAY, BITCOIN_STATS_RESET_ARRAY, BITCOIN_STATS_RESET_HISTOGRAM)
+#undef BITCOIN_STATS_RESET_ARRAY
+#undef BITCOIN_STATS_RESET_HISTOGRAM
+}
+
+size_t
+NodeStatsRegistry::GetRecordSize (void) const
+{
+  size_t size = sizeof(uint32_t);
+
+#define BITCOIN_STATS_ARRAY_SIZE(type, name, description) size += sizeof(type);
+#define BITCOIN_STATS_HISTOGRAM_SIZE(name, min, binsPerDecade, bins, description) size += bins * sizeof(uint32_t);
+  BITCOIN_NODE_STATS (BITCOIN_STATS_ARRAY_SIZE, BITCOIN_STATS_ARRAY_SIZE, BITCOIN_STATS_HISTOGRAM_SIZE)
+#undef BITCOIN_STATS_ARRAY_SIZE
+#undef BITCOIN_STATS_HISTOGRAM_SIZE
+
+  return size;
+}
+
+void
+NodeStatsRegistry::Pack (uint32_t nodeId, std::vector<char> &buffer) const
+{
+  size_t offset = buffer.size();
+
+  buffer.resize(offset + GetRecordSize ());
+  memcpy (&buffer[offset], &nodeId, sizeof(nodeId));
+  offset += sizeof(nodeId);
+
+#define BITCOIN_STATS_PACK_ARRAY(type, name, description) \
+  memcpy (&buffer[offset], &name[nodeId], sizeof(type)); \
+  offset += sizeof(type);
+#define BITCOIN_STATS_PACK_HISTOGRAM(name, min, binsPerDecade, bins, description) \
+  memcpy (&buffer[offset], name.Get (nodeId), bins * sizeof(uint32_t)); \
+  offset += bins * sizeof(uint32_t);
+  BITCOIN_NODE_STATS (BITCOIN_STATS_PACK_ARRAY, BITCOIN_STATS_PACK_ARRAY, BITCOIN_STATS_PACK_HISTOGRAM)
+#undef BITCOIN_STATS_PACK_ARRAY
+#undef BITCOIN_STATS_PACK_HISTOGRAM
+}
+
+const char*
+NodeStatsRegistry::Unpack (const char *record)
+{
+  uint32_t nodeId;
+
+  memcpy (&nodeId, record, sizeof(nodeId));
+  record += sizeof(nodeId);
+
+  if (nodeId >= m_noNodes)
+    NS_FATAL_ERROR ("The record of node " << nodeId << " does not fit in a registry of " << m_noNodes << " nodes");
+
+#define BITCOIN_STATS_UNPACK_ARRAY(type, name, description) \
+  memcpy (&name[nodeId], record, sizeof(type)); \
+  record += sizeof(type);
+#define BITCOIN_STATS_UNPACK_HISTOGRAM(name, min, binsPerDecade, bins, description) \
+  memcpy (name.Get (nodeId), record, bins * sizeof(uint32_t)); \
+  record += bins * sizeof(uint32_t);
+  BITCOIN_NODE_STATS (BITCOIN_STATS_UNPACK_ARRAY, BITCOIN_STATS_UNPACK_ARRAY, BITCOIN_STATS_UNPACK_HISTOGRAM)
+#undef BITCOIN_STATS_UNPACK_ARRAY
+#undef BITCOIN_STATS_UNPACK_HISTOGRAM
+
+  return record;
+}
+
+void
+NodeStatsRegistry::WriteCsv (std::ostream &os) const
+{
+  std::streamsize precision = os.precision (10);
+
+  os << "nodeId";
+#define BITCOIN_STATS_CSV_HEADER(type, name, description) os << "," #name;
+#define BITCOIN_STATS_CSV_HISTOGRAM_HEADER(name, min, binsPerDecade, bins, description) \
+  for (int bin = 0; bin < bins; bin++) \
+    os << "," #name "[" << name.GetBinStart (bin) << "]";
+  BITCOIN_NODE_STATS (BITCOIN_STATS_CSV_HEADER, BITCOIN_STATS_CSV_HEADER, BITCOIN_STATS_CSV_HISTOGRAM_HEADER)
+#undef BITCOIN_STATS_CSV_HEADER
+#undef BITCOIN_STATS_CSV_HISTOGRAM_HEADER
+  os << "\n";
+
+  for (uint32_t nodeId = 0; nodeId < m_noNodes; nodeId++)
+  {
+    os << nodeId;
+#define BITCOIN_STATS_CSV_ARRAY(type, name, description) os << "," << name[nodeId];
+#define BITCOIN_STATS_CSV_HISTOGRAM(name, min, binsPerDecade, bins, description) \
+    for (int bin = 0; bin < bins; bin++) \
+      os << "," << name.Get (nodeId)[bin];
+    BITCOIN_NODE_STATS (BITCOIN_STATS_CSV_ARRAY, BITCOIN_STATS_CSV_ARRAY, BITCOIN_STATS_CSV_HISTOGRAM)
+#undef BITCOIN_STATS_CSV_ARRAY
+#undef BITCOIN_STATS_CSV_HISTOGRAM
+    os << "\n";
+  }
+
+  os.precision (precision);
+}
+
+void
+NodeStatsRegistry::WriteJson (std::ostream &os) const
+{
+  rapidjson::StringBuffer                     buffer;
+  rapidjson::Writer<rapidjson::StringBuffer>  writer (buffer);
+
+  writer.StartArray ();
+  for (uint32_t nodeId = 0; nodeId < m_noNodes; nodeId++)
+  {
+    writer.StartObject ();
+    writer.Key ("nodeId");
+    writer.Uint (nodeId);
+#define BITCOIN_STATS_JSON_ARRAY(type, name, description) \
+    writer.Key (#name); \
+    WriteJsonValue (writer, name[nodeId]);
+#define BITCOIN_STATS_JSON_HISTOGRAM(name, min, binsPerDecade, bins, description) \
+    writer.Key (#name); \
+    writer.StartArray (); \
+    for (int bin = 0; bin < bins; bin++) \
+      writer.Uint (name.Get (nodeId)[bin]); \
+    writer.EndArray ();
+    BITCOIN_NODE_STATS (BITCOIN_STATS_JSON_ARRAY, BITCOIN_STATS_JSON_ARRAY, BITCOIN_STATS_JSON_HISTOGRAM)
+#undef BITCOIN_STATS_JSON_ARRAY
+#undef BITCOIN_STATS_JSON_HISTOGRAM
+    writer.EndObject ();
+  }
+  writer.EndArray ();
+
+  os << buffer.GetString () << "\n";
+}
+
+void
+NodeStatsRegistry::Export (const std::string &fileName) const
+{
+  std::ofstream file (fileName.c_str ());
+
+  if (!file)
+    NS_FATAL_ERROR ("Could not open " << fileName << " for writing the node statistics");
+
+  if (fileName.size () >= 5 && fileName.compare (fileName.size () - 5, 5, ".json") == 0)
+    WriteJson (file);
+  else
+    WriteCsv (file);
+
+  NS_LOG_INFO ("Export: the statistics of " << m_noNodes << " nodes were written to " << fileName);
+}
+
+#undef BITCOIN_STATS_NONE
+
+} // namespace ns3
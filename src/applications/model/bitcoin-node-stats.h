@@ -0,0 +1,180 @@
+/**
+ * This file contains the declaration of the NodeStatsRegistry, which stores the statistics of all the nodes.
+ * The statistics are declared once, in BITCOIN_NODE_STATS, and the storage, the reset, the MPI serialization
+ * and the CSV/JSON export are generated from that declaration.
+ */
+
+#ifndef BITCOIN_NODE_STATS_H
+#define BITCOIN_NODE_STATS_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <stdint.h>
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+/**
+ * The statistics collected for every node. Each entry is one of:
+ *   - COUNTER (type, name, description): a value which is only incremented during the simulation
+ *   - GAUGE (type, name, description): a value which is set during the simulation
+ *   - HISTOGRAM (name, min, binsPerDecade, bins, description): a logarithmic histogram of the values added to it.
+ *     The first bin also counts the values below min and the last one the values above its end.
+ * Adding a statistic only requires a new entry here.
+ */
+#define BITCOIN_NODE_STATS(COUNTER, GAUGE, HISTOGRAM) \
+  GAUGE     (double, meanBlockReceiveTime,          "The mean time between two received blocks (s)") \
+  GAUGE     (double, meanBlockPropagationTime,      "The mean propagation time of the received blocks (s)") \
+  GAUGE     (double, meanBlockSize,                 "The mean size of the received blocks (Bytes)") \
+  GAUGE     (int,    totalBlocks,                   "The blocks in the blockchain, including the genesis block") \
+  GAUGE     (int,    staleBlocks,                   "The blocks which are not in the main chain") \
+  GAUGE     (int,    miner,                         "0 for nodes, 1 for miners") \
+  COUNTER   (int,    minerGeneratedBlocks,          "The blocks generated by the miner") \
+  GAUGE     (double, minerAverageBlockGenInterval,  "The mean interval between the blocks generated by the miner (s)") \
+  GAUGE     (double, minerAverageBlockSize,         "The mean size of the blocks generated by the miner (Bytes)") \
+  GAUGE     (double, hashRate,                      "The fraction of the total hash rate owned by the miner") \
+  COUNTER   (int,    attackSuccess,                 "The successful attacks of an attacker") \
+  COUNTER   (long,   invReceivedBytes,              "Bytes of the received INV messages") \
+  COUNTER   (long,   invSentBytes,                  "Bytes of the sent INV messages") \
+  COUNTER   (long,   getHeadersReceivedBytes,       "Bytes of the received GET_HEADERS messages") \
+  COUNTER   (long,   getHeadersSentBytes,           "Bytes of the sent GET_HEADERS messages") \
+  COUNTER   (long,   headersReceivedBytes,          "Bytes of the received HEADERS messages") \
+  COUNTER   (long,   headersSentBytes,              "Bytes of the sent HEADERS messages") \
+  COUNTER   (long,   getDataReceivedBytes,          "Bytes of the received GET_DATA messages") \
+  COUNTER   (long,   getDataSentBytes,              "Bytes of the sent GET_DATA messages") \
+  COUNTER   (long,   blockReceivedBytes,            "Bytes of the received BLOCK messages") \
+  COUNTER   (long,   blockSentBytes,                "Bytes of the sent BLOCK messages") \
+  COUNTER   (long,   extInvReceivedBytes,           "Bytes of the received EXT_INV messages") \
+  COUNTER   (long,   extInvSentBytes,               "Bytes of the sent EXT_INV messages") \
+  COUNTER   (long,   extGetHeadersReceivedBytes,    "Bytes of the received EXT_GET_HEADERS messages") \
+  COUNTER   (long,   extGetHeadersSentBytes,        "Bytes of the sent EXT_GET_HEADERS messages") \
+  COUNTER   (long,   extHeadersReceivedBytes,       "Bytes of the received EXT_HEADERS messages") \
+  COUNTER   (long,   extHeadersSentBytes,           "Bytes of the sent EXT_HEADERS messages") \
+  COUNTER   (long,   extGetDataReceivedBytes,       "Bytes of the received EXT_GET_DATA messages") \
+  COUNTER   (long,   extGetDataSentBytes,           "Bytes of the sent EXT_GET_DATA messages") \
+  COUNTER   (long,   chunkReceivedBytes,            "Bytes of the received CHUNK messages") \
+  COUNTER   (long,   chunkSentBytes,                "Bytes of the sent CHUNK messages") \
+  GAUGE     (int,    longestFork,                   "The longest chain of blocks in consecutive forked heights") \
+  GAUGE     (int,    blocksInForks,                 "The blocks in heights with more than one block") \
+  GAUGE     (int,    connections,                   "The number of peers") \
+  COUNTER   (long,   blockTimeouts,                 "The expired block timeouts") \
+  COUNTER   (long,   chunkTimeouts,                 "The expired chunk timeouts") \
+  GAUGE     (int,    minedBlocksInMainChain,        "The blocks of an attacker which are in the main chain") \
+  HISTOGRAM (blockPropagationTimes, 0.01, 4, 24,    "The propagation times of the received blocks (s)")
+
+
+/**
+ * A logarithmic histogram per node, stored contiguously for all the nodes.
+ */
+class NodeStatsHistogram
+{
+public:
+  /**
+   * \param min the start of the second bin
+   * \param binsPerDecade the number of bins per decade
+   * \param bins the number of bins
+   */
+  NodeStatsHistogram (double min, int binsPerDecade, int bins);
+
+  /**
+   * \brief Sets the number of nodes and clears the histograms
+   */
+  void Resize (uint32_t noNodes);
+
+  /**
+   * \brief Clears the histogram of a node
+   */
+  void Reset (uint32_t nodeId);
+
+  /**
+   * \brief Adds a value to the histogram of a node
+   */
+  void Add (uint32_t nodeId, double value);
+
+  /**
+   * \return the histogram of a node, which has GetNoBins () counts
+   */
+  uint32_t* Get (uint32_t nodeId);
+  const uint32_t* Get (uint32_t nodeId) const;
+
+  int GetNoBins (void) const;
+
+  /**
+   * \return the start of a bin. The first bin starts at 0.
+   */
+  double GetBinStart (int bin) const;
+
+private:
+  double                  m_min;
+  int                     m_binsPerDecade;
+  int                     m_bins;
+  std::vector<uint32_t>   m_counts;        // the bins of node i are at [i * m_bins, (i + 1) * m_bins)
+};
+
+
+/**
+ * The statistics of all the nodes, stored as one array per statistic and indexed by the node id.
+ * Every process keeps the registry of all the nodes, but only updates the statistics of the nodes it simulates.
+ */
+class NodeStatsRegistry : public SimpleRefCount<NodeStatsRegistry>
+{
+public:
+  /**
+   * \param noNodes the number of nodes. All the statistics start at 0.
+   */
+  NodeStatsRegistry (uint32_t noNodes);
+  ~NodeStatsRegistry (void);
+
+  uint32_t GetNoNodes (void) const;
+
+  /**
+   * \brief Sets all the statistics of a node to 0
+   */
+  void Reset (uint32_t nodeId);
+
+  /**
+   * \return the size of the record of a node in Bytes, as written by Pack
+   */
+  size_t GetRecordSize (void) const;
+
+  /**
+   * \brief Appends the record of a node, which consists of the node id and all its statistics without padding.
+   * The records are only meant to be read by Unpack in a process running the same binary.
+   */
+  void Pack (uint32_t nodeId, std::vector<char> &buffer) const;
+
+  /**
+   * \brief Reads a record written by Pack and stores the statistics in the node of the record
+   * \return the end of the record
+   */
+  const char* Unpack (const char *record);
+
+  /**
+   * \brief Writes the statistics of all the nodes as CSV, one row per node. Every bin of the histograms is a column.
+   */
+  void WriteCsv (std::ostream &os) const;
+
+  /**
+   * \brief Writes the statistics of all the nodes as a JSON array, one object per node
+   */
+  void WriteJson (std::ostream &os) const;
+
+  /**
+   * \brief Writes the statistics of all the nodes to a file, as JSON if its name ends with ".json" and as CSV otherwise
+   */
+  void Export (const std::string &fileName) const;
+
+#define BITCOIN_STATS_ARRAY(type, name, description) std::vector<type> name;
+#define BITCOIN_STATS_HISTOGRAM(name, min, binsPerDecade, bins, description) NodeStatsHistogram name;
+  BITCOIN_NODE_STATS (BITCOIN_STATS_ARRAY, BITCOIN_STATS_ARRAY, BITCOIN_STATS_HISTOGRAM)
+#undef BITCOIN_STATS_ARRAY
+#undef BITCOIN_STATS_HISTOGRAM
+
+private:
+  uint32_t    m_noNodes;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_NODE_STATS_H */
@@ -2,6 +2,7 @@
  * This file contains the definitions of the functions declared in bitcoin-node.h
  */
 
+#include <cstring>
 #include "ns3/address.h"
 #include "ns3/address-utils.h"
 #include "ns3/log.h"
@@ -18,6 +19,7 @@
 #include "ns3/tcp-socket-factory.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
 #include "bitcoin-node.h"
 
 namespace ns3 {
@@ -63,6 +65,19 @@ BitcoinNode::GetTypeId (void)
                    UintegerValue (100000),
                    MakeUintegerAccessor (&BitcoinNode::m_chunkSize),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MessageCodec",
+                   "The codec used to encode the messages on the wire",
+                   EnumValue (JSON_CODEC),
+                   MakeEnumAccessor (&BitcoinNode::m_messageCodec),
+                   MakeEnumChecker (JSON_CODEC, "Json",
+                                    BINARY_CODEC, "Binary"))
+    .AddAttribute ("LinkDiscipline",
+                   "The discipline used to share the upload and download links between the peers",
+                   EnumValue (LINK_FIFO),
+                   MakeEnumAccessor (&BitcoinNode::m_linkDiscipline),
+                   MakeEnumChecker (LINK_FIFO, "Fifo",
+                                    LINK_ROUND_ROBIN, "RoundRobin",
+                                    LINK_FAIR_SHARE, "FairShare"))
     .AddTraceSource ("Rx",
                      "A packet has been received",
                      MakeTraceSourceAccessor (&BitcoinNode::m_rxTrace),
@@ -72,16 +87,21 @@ BitcoinNode::GetTypeId (void)
 }
 
 BitcoinNode::BitcoinNode (void) : m_bitcoinPort (8333), m_secondsPerMin(60), m_isMiner (false), m_countBytes (4), m_bitcoinMessageHeader (90),
-                                  m_inventorySizeBytes (36), m_getHeadersSizeBytes (72), m_headersSizeBytes (81), m_blockHeadersSizeBytes (81),
-                                  m_averageTransactionSize (522.4), m_transactionIndexSize (2)
+                                  m_inventorySizeBytes (36), m_getHeadersSizeBytes (72), m_headersSizeBytes (HEADERS_SIZE_BYTES), m_blockHeadersSizeBytes (81),
+                                  m_averageTransactionSize (AVERAGE_TRANSACTION_SIZE_BYTES), m_transactionIndexSize (2)
 {
   NS_LOG_FUNCTION (this);
   m_socket = 0;
+  m_nodeId = 0;
   m_meanBlockReceiveTime = 0;
   m_previousBlockReceiveTime = 0;
   m_meanBlockPropagationTime = 0;
   m_meanBlockSize = 0;
   m_numberOfPeers = m_peersAddresses.size();
+  m_messageCodec = JSON_CODEC;
+  m_linkDiscipline = LINK_FIFO;
+  m_sampledQueueInv = 0;
+  m_sampledInvTimeouts = 0;
   
 }
 
@@ -105,6 +125,13 @@ BitcoinNode::GetPeersAddresses (void) const
   return m_peersAddresses;
 }
 
+forkStatistics
+BitcoinNode::GetForkStatistics (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_blockchain.GetForkStatistics();
+}
+
 
 void 
 BitcoinNode::SetPeersAddresses (const std::vector<Ipv4Address> &peers)
@@ -141,7 +168,7 @@ BitcoinNode::SetNodeInternetSpeeds (const nodeInternetSpeeds &internetSpeeds)
   
   
 void 
-BitcoinNode::SetNodeStats (nodeStatistics *nodeStats)
+BitcoinNode::SetNodeStats (Ptr<NodeStatsRegistry> nodeStats)
 {
   NS_LOG_FUNCTION (this);
   m_nodeStats = nodeStats;
@@ -154,6 +181,182 @@ BitcoinNode::SetProtocolType (enum ProtocolType protocolType)
   m_protocolType = protocolType;
 }
 
+void 
+BitcoinNode::SetFastLinkChannel (Ptr<FastLinkChannel> fastLinkChannel)
+{
+  NS_LOG_FUNCTION (this);
+  m_fastLinkChannel = fastLinkChannel;
+}
+
+void 
+BitcoinNode::SetPropagationTrace (Ptr<PropagationTrace> propagationTrace)
+{
+  NS_LOG_FUNCTION (this);
+  m_propagationTrace = propagationTrace;
+}
+
+void
+BitcoinNode::SetSimulationProfiler (Ptr<SimulationProfiler> profiler)
+{
+  NS_LOG_FUNCTION (this);
+  m_profiler = profiler;
+}
+
+void
+BitcoinNode::SetNetworkStateSampler (Ptr<NetworkStateSampler> sampler)
+{
+  NS_LOG_FUNCTION (this);
+  m_networkSampler = sampler;
+  if (!m_networkSampler)
+    return;
+
+  m_sampledTip = m_blockchain.GetCurrentTopBlock()->GetBlockId();
+  m_sampledQueueInv = m_queueInv.size();
+  m_sampledInvTimeouts = m_invTimeouts.size();
+  m_networkSampler->AddNode (m_sampledTip);
+  m_networkSampler->UpdateInvs (m_sampledQueueInv, m_sampledInvTimeouts);
+
+  int64_t *inFlightTransfers = m_networkSampler->GetInFlightTransfersCounter ();
+  m_uploadLink.SetSizeCounter (inFlightTransfers);
+  m_compressedUploadLink.SetSizeCounter (inFlightTransfers);
+  m_downloadLink.SetSizeCounter (inFlightTransfers);
+  m_compressedDownloadLink.SetSizeCounter (inFlightTransfers);
+}
+
+void
+BitcoinNode::SetMemoryAccountant (Ptr<MemoryAccountant> accountant)
+{
+  NS_LOG_FUNCTION (this);
+  m_memoryAccountant = accountant;
+  if (m_memoryAccountant)
+    m_memoryAccountant->Register (this);
+}
+
+void
+BitcoinNode::AccountMemory (MemoryAccountant &accountant) const
+{
+  uint64_t bytes;
+
+  accountant.AddNode (m_isMiner);
+
+  accountant.Add (MEMORY_BLOCKCHAIN_BLOCKS, m_blockchain.GetBlocksMemory ());
+  accountant.Add (MEMORY_BLOCKCHAIN_ORPHANS, m_blockchain.GetOrphansMemory ());
+
+  bytes = HashMapMemory (m_queueInv);
+  for (auto const &inv : m_queueInv)
+    bytes += VectorMemory (inv.second);
+  accountant.Add (MEMORY_QUEUED_INVS, bytes);
+
+  bytes = HashMapMemory (m_queueChunkPeers) + HashMapMemory (m_queueChunks) + HashMapMemory (m_receivedChunks);
+  for (auto const &peers : m_queueChunkPeers)
+    bytes += VectorMemory (peers.second);
+  for (auto const &chunks : m_queueChunks)
+    bytes += VectorMemory (chunks.second);
+  for (auto const &chunks : m_receivedChunks)
+    bytes += VectorMemory (chunks.second);
+  accountant.Add (MEMORY_CHUNKS, bytes);
+
+  accountant.Add (MEMORY_PENDING_BLOCKS, HashMapMemory (m_receivedNotValidated) + HashMapMemory (m_onlyHeadersReceived));
+  accountant.Add (MEMORY_TIMEOUTS, HashMapMemory (m_invTimeouts) + HashMapMemory (m_chunkTimeouts));
+
+  bytes = MapMemory (m_receiveBuffers);
+  for (auto const &buffer : m_receiveBuffers)
+    bytes += buffer.second.GetCapacity ();
+  accountant.Add (MEMORY_RECEIVE_BUFFERS, bytes);
+
+  accountant.Add (MEMORY_LINKS, m_uploadLink.GetMemory () + m_compressedUploadLink.GetMemory ()
+                                + m_downloadLink.GetMemory () + m_compressedDownloadLink.GetMemory ());
+
+  accountant.Add (MEMORY_PEERS, VectorMemory (m_peersAddresses) + MapMemory (m_peersDownloadSpeeds)
+                                + MapMemory (m_peersUploadSpeeds) + MapMemory (m_peersSockets));
+
+  /**
+   * The accepted sockets are owned by the TCP stack, so there is one per peer which connected to the node, besides
+   * the listening socket and the outgoing sockets. Only the data of the outgoing sockets is visible.
+   */
+  if (m_socket)
+  {
+    bytes = (1 + m_peersAddresses.size () + m_peersSockets.size ()) * MEMORY_SOCKET_BYTES;
+    for (auto const &peerSocket : m_peersSockets)
+    {
+      UintegerValue sndBufSize;
+      uint64_t      txAvailable = peerSocket.second->GetTxAvailable ();
+
+      peerSocket.second->GetAttribute ("SndBufSize", sndBufSize);
+      if (sndBufSize.Get () > txAvailable)
+        bytes += sndBufSize.Get () - txAvailable;
+    }
+    accountant.Add (MEMORY_SOCKETS, bytes);
+  }
+
+  accountant.Add (MEMORY_DEVICES, GetNode ()->GetNDevices () * MEMORY_DEVICE_BYTES);
+}
+
+void
+BitcoinNode::InjectBlock (int blockSizeBytes, enum BlockBroadcastType blockBroadcastType)
+{
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+
+  const Block  *tip = m_blockchain.GetCurrentTopBlock();
+  double        currentTime = Simulator::Now ().GetSeconds ();
+  Block         newBlock (tip->GetBlockHeight() + 1, GetNode ()->GetId (), tip->GetMinerId(), blockSizeBytes,
+                          currentTime, currentTime, Ipv4Address("127.0.0.1"));
+
+  BITCOIN_MESSAGE_LOG_INFO ("InjectBlock: At time " << currentTime << "s bitcoin node " << GetNode ()->GetId ()
+                            << " mined the injected block " << newBlock);
+
+  /**
+   * Update the means with the timeCreated of the injected block, as a miner does for its own blocks
+   */
+  m_meanBlockReceiveTime = (m_blockchain.GetTotalBlocks() - 1)/static_cast<double>(m_blockchain.GetTotalBlocks())*m_meanBlockReceiveTime 
+                         + (currentTime - m_previousBlockReceiveTime)/(m_blockchain.GetTotalBlocks());
+  m_previousBlockReceiveTime = currentTime;	
+  
+  m_meanBlockPropagationTime = (m_blockchain.GetTotalBlocks() - 1)/static_cast<double>(m_blockchain.GetTotalBlocks())*m_meanBlockPropagationTime;
+  
+  m_meanBlockSize = (m_blockchain.GetTotalBlocks() - 1)/static_cast<double>(m_blockchain.GetTotalBlocks())*m_meanBlockSize  
+                  + blockSizeBytes/static_cast<double>(m_blockchain.GetTotalBlocks());
+
+  m_blockchain.AddBlock(newBlock);
+  TraceBlock(newBlock);
+
+  m_nodeStats->miner[m_nodeId] = 1;
+  m_nodeStats->minerGeneratedBlocks[m_nodeId]++;
+
+  switch (blockBroadcastType)
+  {
+    case STANDARD:
+    {
+      //The block was received from 127.0.0.1, so it is advertised to all the peers
+      if (!m_blockTorrent)
+        AdvertiseNewBlock(newBlock);
+      else
+        AdvertiseFullBlock(newBlock);
+      break;
+    }
+    case UNSOLICITED:
+    {
+      rapidjson::Document d;
+
+      CreateBlockMessage(newBlock, "block", d);
+      std::string packet = EncodeMessage(d, m_messageCodec);
+
+      for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i)
+      {
+        m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + blockSizeBytes;
+        m_uploadLink.Enqueue (*i, blockSizeBytes, 0, std::bind (&BitcoinNode::SendUnsolicitedBlock, this, packet, *i),
+                              LinkScheduler::TransferHandler ());
+      }
+      break;
+    }
+    default:
+      NS_FATAL_ERROR ("The block broadcast type " << getBlockBroadcastType (blockBroadcastType)
+                      << " can't be used with injected blocks");
+  }
+
+  UpdateNetworkState();
+}
+
 void 
 BitcoinNode::DoDispose (void)
 {
@@ -172,7 +375,8 @@ BitcoinNode::StartApplication ()    // Called at time specified by Start
   NS_LOG_FUNCTION (this);
   // Create the socket if not already
   
-  srand(time(NULL) + GetNode()->GetId());
+  m_nodeId = GetNode ()->GetId ();
+  m_peerSelectionStream.SetStream (RNG_PEER_SELECTION, m_nodeId);
   NS_LOG_INFO ("Node " << GetNode()->GetId() << ": download speed = " << m_downloadSpeed << " B/s");
   NS_LOG_INFO ("Node " << GetNode()->GetId() << ": upload speed = " << m_uploadSpeed << " B/s");
   NS_LOG_INFO ("Node " << GetNode()->GetId() << ": m_numberOfPeers = " << m_numberOfPeers);
@@ -180,6 +384,10 @@ BitcoinNode::StartApplication ()    // Called at time specified by Start
   NS_LOG_WARN ("Node " << GetNode()->GetId() << ": m_protocolType = " << getProtocolType(m_protocolType));
   NS_LOG_WARN ("Node " << GetNode()->GetId() << ": m_blockTorrent = " << m_blockTorrent);
   NS_LOG_WARN ("Node " << GetNode()->GetId() << ": m_chunkSize = " << m_chunkSize << " Bytes");
+  NS_LOG_WARN ("Node " << GetNode()->GetId() << ": m_messageCodec = " << getMessageCodec(m_messageCodec));
+  NS_LOG_WARN ("Node " << GetNode()->GetId() << ": m_linkDiscipline = " << getLinkDiscipline(m_linkDiscipline));
+
+  SetupLinks ();
 
   NS_LOG_INFO ("Node " << GetNode()->GetId() << ": My peers are");
   
@@ -193,81 +401,53 @@ BitcoinNode::StartApplication ()    // Called at time specified by Start
     //std::cout << "Node " << GetNode()->GetId() << ": peer " << it->first << "download speed = " << it->second << " Mbps" << std::endl;
   }
   
-  if (!m_socket)
+  if (m_fastLinkChannel)
+  {
+    NS_LOG_WARN ("Node " << GetNode()->GetId() << ": the messages are delivered by the fast link channel");
+    m_fastLinkChannel->SetReceiveCallback (GetNode ()->GetId (), MakeCallback (&BitcoinNode::HandleFrame, this));
+  }
+  else
   {
-    m_socket = Socket::CreateSocket (GetNode (), m_tid);
-    m_socket->Bind (m_local);
-    m_socket->Listen ();
-    m_socket->ShutdownSend ();
-    if (addressUtils::IsMulticast (m_local))
+    if (!m_socket)
     {
-      Ptr<UdpSocket> udpSocket = DynamicCast<UdpSocket> (m_socket);
-      if (udpSocket)
+      m_socket = Socket::CreateSocket (GetNode (), m_tid);
+      m_socket->Bind (m_local);
+      m_socket->Listen ();
+      m_socket->ShutdownSend ();
+      if (addressUtils::IsMulticast (m_local))
       {
-        // equivalent to setsockopt (MCAST_JOIN_GROUP)
-        udpSocket->MulticastJoinGroup (0, m_local);
-      }
-      else
-      {
-        NS_FATAL_ERROR ("Error: joining multicast on a non-UDP socket");
+        Ptr<UdpSocket> udpSocket = DynamicCast<UdpSocket> (m_socket);
+        if (udpSocket)
+        {
+          // equivalent to setsockopt (MCAST_JOIN_GROUP)
+          udpSocket->MulticastJoinGroup (0, m_local);
+        }
+        else
+        {
+          NS_FATAL_ERROR ("Error: joining multicast on a non-UDP socket");
+        }
       }
     }
-  }
 
-  m_socket->SetRecvCallback (MakeCallback (&BitcoinNode::HandleRead, this));
-  m_socket->SetAcceptCallback (
-    MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
-    MakeCallback (&BitcoinNode::HandleAccept, this));
-  m_socket->SetCloseCallbacks (
-    MakeCallback (&BitcoinNode::HandlePeerClose, this),
-    MakeCallback (&BitcoinNode::HandlePeerError, this));
+    m_socket->SetRecvCallback (MakeCallback (&BitcoinNode::HandleRead, this));
+    m_socket->SetAcceptCallback (
+      MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+      MakeCallback (&BitcoinNode::HandleAccept, this));
+    m_socket->SetCloseCallbacks (
+      MakeCallback (&BitcoinNode::HandlePeerClose, this),
+      MakeCallback (&BitcoinNode::HandlePeerError, this));
 	
-  NS_LOG_DEBUG ("Node " << GetNode()->GetId() << ": Before creating sockets");
-  for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i)
-  {
-    m_peersSockets[*i] = Socket::CreateSocket (GetNode (), TcpSocketFactory::GetTypeId ());
-    m_peersSockets[*i]->Connect (InetSocketAddress (*i, m_bitcoinPort));
+    NS_LOG_DEBUG ("Node " << GetNode()->GetId() << ": Before creating sockets");
+    for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i)
+    {
+      m_peersSockets[*i] = Socket::CreateSocket (GetNode (), TcpSocketFactory::GetTypeId ());
+      m_peersSockets[*i]->Connect (InetSocketAddress (*i, m_bitcoinPort));
+    }
+    NS_LOG_DEBUG ("Node " << GetNode()->GetId() << ": After creating sockets");
   }
-  NS_LOG_DEBUG ("Node " << GetNode()->GetId() << ": After creating sockets");
-
-  m_nodeStats->nodeId = GetNode ()->GetId ();
-  m_nodeStats->meanBlockReceiveTime = 0;
-  m_nodeStats->meanBlockPropagationTime = 0;
-  m_nodeStats->meanBlockSize = 0;
-  m_nodeStats->totalBlocks = 0;
-  m_nodeStats->staleBlocks = 0;
-  m_nodeStats->miner = 0;
-  m_nodeStats->minerGeneratedBlocks = 0;
-  m_nodeStats->minerAverageBlockGenInterval = 0;
-  m_nodeStats->minerAverageBlockSize = 0;
-  m_nodeStats->hashRate = 0;
-  m_nodeStats->attackSuccess = 0;
-  m_nodeStats->invReceivedBytes = 0;
-  m_nodeStats->invSentBytes = 0;
-  m_nodeStats->getHeadersReceivedBytes = 0;
-  m_nodeStats->getHeadersSentBytes = 0;
-  m_nodeStats->headersReceivedBytes = 0;
-  m_nodeStats->headersSentBytes = 0;
-  m_nodeStats->getDataReceivedBytes = 0;
-  m_nodeStats->getDataSentBytes = 0;
-  m_nodeStats->blockReceivedBytes = 0;
-  m_nodeStats->blockSentBytes = 0;
-  m_nodeStats->extInvReceivedBytes = 0;
-  m_nodeStats->extInvSentBytes = 0;
-  m_nodeStats->extGetHeadersReceivedBytes = 0;
-  m_nodeStats->extGetHeadersSentBytes = 0;
-  m_nodeStats->extHeadersReceivedBytes = 0;
-  m_nodeStats->extHeadersSentBytes = 0;
-  m_nodeStats->extGetDataReceivedBytes = 0;
-  m_nodeStats->extGetDataSentBytes = 0;
-  m_nodeStats->chunkReceivedBytes = 0;
-  m_nodeStats->chunkSentBytes = 0;
-  m_nodeStats->longestFork = 0;
-  m_nodeStats->blocksInForks = 0;
-  m_nodeStats->connections = m_peersAddresses.size();
-  m_nodeStats->blockTimeouts = 0;
-  m_nodeStats->chunkTimeouts = 0;
-  m_nodeStats->minedBlocksInMainChain = 0;
+
+  m_nodeStats->Reset (m_nodeId);
+  m_nodeStats->connections[m_nodeId] = m_peersAddresses.size();
 }
 
 void 
@@ -275,10 +455,13 @@ BitcoinNode::StopApplication ()     // Called at time specified by Stop
 {
   NS_LOG_FUNCTION (this);
 
-  for (std::vector<Ipv4Address>::iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i) //close the outgoing sockets
+  for (auto &peerSocket : m_peersSockets) //close the outgoing sockets
   {
-    m_peersSockets[*i]->Close ();
+    peerSocket.second->Close ();
   }
+
+  if (m_fastLinkChannel)
+    m_fastLinkChannel->SetReceiveCallback (GetNode ()->GetId (), MakeNullCallback<void, const std::string &, const Address &> ());
   
 
   if (m_socket) 
@@ -286,6 +469,8 @@ BitcoinNode::StopApplication ()     // Called at time specified by Stop
     m_socket->Close ();
     m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
   }
+  
+  m_receiveBuffers.clear ();
 
   NS_LOG_WARN ("\n\nBITCOIN NODE " << GetNode ()->GetId () << ":");
   NS_LOG_WARN ("Current Top Block is:\n" << *(m_blockchain.GetCurrentTopBlock()));
@@ -303,25 +488,25 @@ BitcoinNode::StopApplication ()     // Called at time specified by Stop
   NS_LOG_WARN("Stale Blocks = " << m_blockchain.GetNoStaleBlocks() << " (" 
               << 100. * m_blockchain.GetNoStaleBlocks() / m_blockchain.GetTotalBlocks() << "%)");
   NS_LOG_WARN("receivedButNotValidated size = " << m_receivedNotValidated.size());
-  NS_LOG_WARN("m_sendBlockTimes size = " << m_sendBlockTimes.size());
-  NS_LOG_WARN("m_receiveBlockTimes size = " << m_receiveBlockTimes.size());
+  NS_LOG_WARN("m_uploadLink size = " << m_uploadLink.GetSize());
+  NS_LOG_WARN("m_downloadLink size = " << m_downloadLink.GetSize());
   NS_LOG_WARN("longest fork = " << m_blockchain.GetLongestForkSize());
   NS_LOG_WARN("blocks in forks = " << m_blockchain.GetBlocksInForks());
   
-  m_nodeStats->meanBlockReceiveTime = m_meanBlockReceiveTime;
-  m_nodeStats->meanBlockPropagationTime = m_meanBlockPropagationTime;
-  m_nodeStats->meanBlockSize = m_meanBlockSize;
-  m_nodeStats->totalBlocks = m_blockchain.GetTotalBlocks();
-  m_nodeStats->staleBlocks = m_blockchain.GetNoStaleBlocks();
-  m_nodeStats->longestFork = m_blockchain.GetLongestForkSize();
-  m_nodeStats->blocksInForks = m_blockchain.GetBlocksInForks();
+  m_nodeStats->meanBlockReceiveTime[m_nodeId] = m_meanBlockReceiveTime;
+  m_nodeStats->meanBlockPropagationTime[m_nodeId] = m_meanBlockPropagationTime;
+  m_nodeStats->meanBlockSize[m_nodeId] = m_meanBlockSize;
+  m_nodeStats->totalBlocks[m_nodeId] = m_blockchain.GetTotalBlocks();
+  m_nodeStats->staleBlocks[m_nodeId] = m_blockchain.GetNoStaleBlocks();
+  m_nodeStats->longestFork[m_nodeId] = m_blockchain.GetLongestForkSize();
+  m_nodeStats->blocksInForks[m_nodeId] = m_blockchain.GetBlocksInForks();
 
 }
 
 void 
 BitcoinNode::HandleRead (Ptr<Socket> socket)
 {	
-  NS_LOG_FUNCTION (this << socket);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this << socket);
   Ptr<Packet> packet;
   Address from;
   double newBlockReceiveTime = Simulator::Now ().GetSeconds();
@@ -339,1505 +524,1323 @@ BitcoinNode::HandleRead (Ptr<Socket> socket)
          * We may receive more than one packets simultaneously on the socket,
          * so we have to parse each one of them.
          */
-        std::string delimiter = "#";
-        std::string parsedPacket;
-        size_t pos = 0;
-        char *packetInfo = new char[packet->GetSize () + 1];
-        std::ostringstream totalStream;
+        const char *frame;
+        size_t frameSize;
+        ReceiveBuffer &receiveBuffer = m_receiveBuffers[from];
 		
-        packet->CopyData (reinterpret_cast<uint8_t*>(packetInfo), packet->GetSize ());
-        packetInfo[packet->GetSize ()] = '\0'; // ensure that it is null terminated to avoid bugs
-		  
         /**
-         * Add the buffered data to complete the packet
+         * Append the packet to the data buffered from the previous packets of this peer
+         * and decode the complete frames in place
          */
-        totalStream << m_bufferedData[from] << packetInfo; 
-        std::string totalReceivedData(totalStream.str());
-        NS_LOG_INFO("Node " << GetNode ()->GetId () << " Total Received Data: " << totalReceivedData);
+        packet->CopyData (receiveBuffer.Reserve (packet->GetSize ()), packet->GetSize ());
+        receiveBuffer.Commit (packet->GetSize ());
 		  
-        while ((pos = totalReceivedData.find(delimiter)) != std::string::npos) 
+        while (receiveBuffer.NextFrame (m_messageCodec, frame, frameSize)) 
         {
-          parsedPacket = totalReceivedData.substr(0, pos);
-          NS_LOG_INFO("Node " << GetNode ()->GetId () << " Parsed Packet: " << parsedPacket);
-		  
           rapidjson::Document d;
-          d.Parse(parsedPacket.c_str());
 		  
-          if(!d.IsObject())
+          if(!DecodeMessage(frame, frameSize, m_messageCodec, d))
           {
             NS_LOG_WARN("The parsed packet is corrupted");
-            totalReceivedData.erase(0, pos + delimiter.length()); 
             continue;
           }			
 		  
-          rapidjson::StringBuffer buffer;
-          rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-          d.Accept(writer);
-		  
-          NS_LOG_INFO ("At time "  << Simulator::Now ().GetSeconds ()
+          BITCOIN_MESSAGE_LOG_INFO ("At time "  << Simulator::Now ().GetSeconds ()
                         << "s bitcoin node " << GetNode ()->GetId () << " received "
                         <<  packet->GetSize () << " bytes from "
                         << InetSocketAddress::ConvertFrom(from).GetIpv4 ()
                         << " port " << InetSocketAddress::ConvertFrom (from).GetPort () 
-                        << " with info = " << buffer.GetString());	
+                        << " with info = " << MessageToString(d));	
 						
-          switch (d["message"].GetInt())
-          {
-            case INV:
-            {
-              //NS_LOG_INFO ("INV");
-              int j;
-              std::vector<std::string>            requestBlocks;
-              std::vector<std::string>::iterator  block_it;
+          HandleMessage (d, frame, frameSize, from);
+        }
+      }
+      else if (Inet6SocketAddress::IsMatchingType (from))
+      {
+        BITCOIN_MESSAGE_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+                     << "s bitcoin node " << GetNode ()->GetId () << " received "
+                     <<  packet->GetSize () << " bytes from "
+                     << Inet6SocketAddress::ConvertFrom(from).GetIpv6 ()
+                     << " port " << Inet6SocketAddress::ConvertFrom (from).GetPort ());
+      }
+      m_rxTrace (packet, from);
+  }
+}
+
+
+void 
+BitcoinNode::HandleFrame (const std::string &frame, const Address &from)
+{
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  rapidjson::Document d;
+  Address peer = from;
+
+  if(!DecodeMessage(frame.data(), frame.size(), m_messageCodec, d))
+  {
+    NS_LOG_WARN("The delivered frame is corrupted");
+    return;
+  }
+
+  BITCOIN_MESSAGE_LOG_INFO ("At time "  << Simulator::Now ().GetSeconds ()
+                << "s bitcoin node " << GetNode ()->GetId () << " received "
+                <<  frame.size () << " bytes from "
+                << InetSocketAddress::ConvertFrom(from).GetIpv4 ()
+                << " with info = " << MessageToString(d));
+
+  HandleMessage (d, frame.data (), frame.size (), peer);
+}
+
+
+void 
+BitcoinNode::HandleMessage (rapidjson::Document &d, const char *frame, size_t frameSize, Address &from)
+{
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_HANDLE_MESSAGE, static_cast<enum Messages>(d["message"].GetInt()));
+
+  switch (d["message"].GetInt())
+  {
+    case INV:
+    {
+      //BITCOIN_MESSAGE_LOG_INFO ("INV");
+      int j;
+      std::vector<BlockId>                requestBlocks;
+      std::vector<BlockId>::iterator      block_it;
 			  
-              m_nodeStats->invReceivedBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
+      m_nodeStats->invReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
 			  
-              for (j=0; j<d["inv"].Size(); j++)
-              {  
-                std::string   invDelimiter = "/";
-                std::string   parsedInv = d["inv"][j].GetString();
-                size_t        invPos = parsedInv.find(invDelimiter);
-                EventId       timeout;
-
-                int height = atoi(parsedInv.substr(0, invPos).c_str());
-                int minerId = atoi(parsedInv.substr(invPos+1, parsedInv.size()).c_str());
+      for (j=0; j<d["inv"].Size(); j++)
+      {  
+        BlockId       blockId (d["inv"][j].GetString());
+        EventId       timeout;
+
+        int height = blockId.GetBlockHeight();
+        int minerId = blockId.GetMinerId();
 				  
                 								  
-                if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId) || ReceivedButNotValidated(parsedInv))
-                {
-                  NS_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId () 
-                              << " has already received the block with height = " 
-                              << height << " and minerId = " << minerId);				  
-                }
-                else
-                {
-                  NS_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId () 
-                              << " does not have the block with height = " 
-                              << height << " and minerId = " << minerId);
+        if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId) || ReceivedButNotValidated(blockId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId () 
+                      << " has already received the block with height = " 
+                      << height << " and minerId = " << minerId);				  
+        }
+        else
+        {
+          BITCOIN_MESSAGE_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId () 
+                      << " does not have the block with height = " 
+                      << height << " and minerId = " << minerId);
 				  
-                  /**
-                   * Check if we have already requested the block
-                   */
+          /**
+           * Check if we have already requested the block
+           */
 				   
-                  if (m_invTimeouts.find(parsedInv) == m_invTimeouts.end())
-                  {
-                    NS_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has not requested the block yet");
-                    requestBlocks.push_back(parsedInv);
-                    timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, parsedInv);
-                    m_invTimeouts[parsedInv] = timeout;
-                  }
-                  else
-                  {
-                    NS_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has already requested the block");
-                  }
+          if (m_invTimeouts.find(blockId) == m_invTimeouts.end())
+          {
+            BITCOIN_MESSAGE_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId ()
+                         << " has not requested the block yet");
+            requestBlocks.push_back(blockId);
+            timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, blockId);
+            m_invTimeouts[blockId] = timeout;
+          }
+          else
+          {
+            BITCOIN_MESSAGE_LOG_INFO("INV: Bitcoin node " << GetNode ()->GetId ()
+                         << " has already requested the block");
+          }
 				  
-                  m_queueInv[parsedInv].push_back(from);
-                  //PrintQueueInv();
-                  //PrintInvTimeouts();
-                }								  
-              }
+          m_queueInv[blockId].push_back(from);
+          //PrintQueueInv();
+          //PrintInvTimeouts();
+        }								  
+      }
 			
-              if (!requestBlocks.empty())
-              {
-                rapidjson::Value   value;
-                rapidjson::Value   array(rapidjson::kArrayType);
-                d.RemoveMember("inv");
-
-                for (block_it = requestBlocks.begin(); block_it < requestBlocks.end(); block_it++) 
-                {
-                  value.SetString(block_it->c_str(), block_it->size(), d.GetAllocator());
-                  array.PushBack(value, d.GetAllocator());
-                }		
+      if (!requestBlocks.empty())
+      {
+        rapidjson::Value   value;
+        rapidjson::Value   array(rapidjson::kArrayType);
+        d.RemoveMember("inv");
+
+        for (block_it = requestBlocks.begin(); block_it < requestBlocks.end(); block_it++) 
+        {
+          std::string blockHash = block_it->ToString();
+          value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
+          array.PushBack(value, d.GetAllocator());
+        }		
 			  
-                d.AddMember("blocks", array, d.GetAllocator());
+        d.AddMember("blocks", array, d.GetAllocator());
 					
-                SendMessage(INV, GET_HEADERS, d, from);				
-                SendMessage(INV, GET_DATA, d, from);	
+        SendMessage(INV, GET_HEADERS, d, from);				
+        SendMessage(INV, GET_DATA, d, from);	
 				
-              }
-              break;
-            }
-            case EXT_INV:
-            {
-              //NS_LOG_INFO ("EXT_INV");
-              int j;
-              std::vector<std::string>            requestHeaders;
-              std::vector<std::string>            requestChunks;
+      }
+      break;
+    }
+    case EXT_INV:
+    {
+      //BITCOIN_MESSAGE_LOG_INFO ("EXT_INV");
+      int j;
+      std::vector<BlockId>                requestHeaders;
+      std::vector<ChunkId>                requestChunks;
 
-              std::vector<std::string>::iterator  block_it;
+      std::vector<BlockId>::iterator      block_it;
 			  
-              m_nodeStats->extInvReceivedBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
+      m_nodeStats->extInvReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
 			  
-              for (j=0; j<d["inv"].Size(); j++)
-              {  
-                std::string   invDelimiter = "/";
-                std::string   blockHash = d["inv"][j]["hash"].GetString();
-                int           blockSize = d["inv"][j]["size"].GetInt();
-                size_t        invPos = blockHash.find(invDelimiter);
-                EventId       timeout;
-
-                int height = atoi(blockHash.substr(0, invPos).c_str());
-                int minerId = atoi(blockHash.substr(invPos+1, blockHash.size()).c_str());
-
-                m_nodeStats->extInvReceivedBytes += 5;
-                if (!d["inv"][j]["fullBlock"].GetBool())
-                  m_nodeStats->extInvReceivedBytes += d["inv"][j]["availableChunks"].Size();
+      for (j=0; j<d["inv"].Size(); j++)
+      {  
+        BlockId       blockId (d["inv"][j]["hash"].GetString());
+        int           blockSize = d["inv"][j]["size"].GetInt();
+        EventId       timeout;
+
+        int height = blockId.GetBlockHeight();
+        int minerId = blockId.GetMinerId();
+
+        m_nodeStats->extInvReceivedBytes[m_nodeId] += 5;
+        if (!d["inv"][j]["fullBlock"].GetBool())
+          m_nodeStats->extInvReceivedBytes[m_nodeId] += d["inv"][j]["availableChunks"].Size();
 			  
-                if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId) || ReceivedButNotValidated(blockHash))
-                {
-                  NS_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId () 
-                              << " has already received the block with height = " 
-                              << height << " and minerId = " << minerId);				  
-                }
-                else
-                {
-                  NS_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId () 
-                              << " does not have the block with height = " 
-                              << height << " and minerId = " << minerId);
+        if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId) || ReceivedButNotValidated(blockId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId () 
+                      << " has already received the block with height = " 
+                      << height << " and minerId = " << minerId);				  
+        }
+        else
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId () 
+                      << " does not have the block with height = " 
+                      << height << " and minerId = " << minerId);
 				  
-                  if (m_queueChunks.find(blockHash) == m_queueChunks.end())
-                  {
-                    NS_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
-                                << " does not have an entry in m_queueChunks");			       
-                    for (int i = 0; i < ceil(blockSize/static_cast<double>(m_chunkSize)); i++)
-                      m_queueChunks[blockHash].push_back(i);
-                  }
-                  //PrintQueueChunks();
+          if (m_queueChunks.find(blockId) == m_queueChunks.end())
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
+                        << " does not have an entry in m_queueChunks");			       
+            for (int i = 0; i < ceil(blockSize/static_cast<double>(m_chunkSize)); i++)
+              m_queueChunks[blockId].push_back(i);
+          }
+          //PrintQueueChunks();
 				  
 				  
-                  /**
-                   * Check if we have already requested all the chunks
-                   */
+          /**
+           * Check if we have already requested all the chunks
+           */
 				   
-                  if (m_queueChunks[blockHash].size() > 0)
-                  {
-                    NS_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has not requested all the chunks yet");
-                    if (!OnlyHeadersReceived(blockHash))
-                      requestHeaders.push_back(blockHash);
-                    //timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, blockHash);
-                    //m_invTimeouts[blockHash] = timeout;
+          if (m_queueChunks[blockId].size() > 0)
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
+                         << " has not requested all the chunks yet");
+            if (!OnlyHeadersReceived(blockId))
+              requestHeaders.push_back(blockId);
+            //timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, blockId);
+            //m_invTimeouts[blockId] = timeout;
 					
                     
-                    std::vector<int> candidateChunks;
-                    if (d["inv"][j]["fullBlock"].GetBool())
-                    {
-                      for (auto &chunk : m_queueChunks[blockHash])
-                        candidateChunks.push_back(chunk);
-                    }
-                    else
-                    {
-                      for (int k = 0; k < d["inv"][j]["availableChunks"].Size(); k++)
-                      {
+            std::vector<int> candidateChunks;
+            if (d["inv"][j]["fullBlock"].GetBool())
+            {
+              for (auto &chunk : m_queueChunks[blockId])
+                candidateChunks.push_back(chunk);
+            }
+            else
+            {
+              for (int k = 0; k < d["inv"][j]["availableChunks"].Size(); k++)
+              {
                         
-                        if (std::find(m_queueChunks[blockHash].begin(), m_queueChunks[blockHash].end(), d["inv"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockHash].end())
-                          candidateChunks.push_back(d["inv"][j]["availableChunks"][k].GetInt());
-                      }
-                    }
+                if (std::find(m_queueChunks[blockId].begin(), m_queueChunks[blockId].end(), d["inv"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockId].end())
+                  candidateChunks.push_back(d["inv"][j]["availableChunks"][k].GetInt());
+              }
+            }
 					
 /*                     std::cout << "candidateChunks = ";
-                    for (auto chunk : candidateChunks)
-                      std::cout << chunk << ", ";
-                    std::cout << "\n"; */
-
-                    if (candidateChunks.size() > 0)
-                    {
-                      int randomIndex = rand() % candidateChunks.size();
-                      NS_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
-                                  << " will request the chunk with index = " << randomIndex << " and value = " << candidateChunks[randomIndex]);	
-                      m_queueChunks[blockHash].erase(std::remove(m_queueChunks[blockHash].begin(),
-                                                                 m_queueChunks[blockHash].end(), candidateChunks[randomIndex]),
-                                                                 m_queueChunks[blockHash].end());
+            for (auto chunk : candidateChunks)
+              std::cout << chunk << ", ";
+            std::cout << "\n"; */
+
+            if (candidateChunks.size() > 0)
+            {
+              int randomIndex = m_peerSelectionStream.GetInteger(candidateChunks.size());
+              BITCOIN_MESSAGE_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
+                          << " will request the chunk with index = " << randomIndex << " and value = " << candidateChunks[randomIndex]);	
+              m_queueChunks[blockId].erase(std::remove(m_queueChunks[blockId].begin(),
+                                                         m_queueChunks[blockId].end(), candidateChunks[randomIndex]),
+                                                         m_queueChunks[blockId].end());
 																		  
-                      std::ostringstream chunk;
-                      chunk << blockHash << "/" << candidateChunks[randomIndex];
-                      requestChunks.push_back(chunk.str());
+              ChunkId chunk (blockId, candidateChunks[randomIndex]);
+              requestChunks.push_back(chunk);
 					  
-                      timeout = Simulator::Schedule (Minutes(m_invTimeoutMinutes.GetMinutes() / ceil(blockSize/static_cast<double>(m_chunkSize))),
-                                                     &BitcoinNode::ChunkTimeoutExpired, this, chunk.str());
+              timeout = Simulator::Schedule (Minutes(m_invTimeoutMinutes.GetMinutes() / ceil(blockSize/static_cast<double>(m_chunkSize))),
+                                             &BitcoinNode::ChunkTimeoutExpired, this, chunk);
 													 
-                      m_chunkTimeouts[chunk.str()] = timeout;
-                      m_queueChunkPeers[blockHash].push_back(from);
-                    }
-                    else
-                    {
-                      NS_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
-                                  << " will not request any chunks from this peer, because it has already all the available ones");
-                    }
+              m_chunkTimeouts[chunk] = timeout;
+              m_queueChunkPeers[blockId].push_back(from);
+            }
+            else
+            {
+              BITCOIN_MESSAGE_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
+                          << " will not request any chunks from this peer, because it has already all the available ones");
+            }
 					
 /*                     PrintQueueChunks();
-                    PrintChunkTimeouts();
-                    PrintQueueChunkPeers();
-                    PrintReceivedChunks(); */
-                  }
-                  else
-                  {
-                    NS_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has already requested all the chunks");
-                  }
+            PrintChunkTimeouts();
+            PrintQueueChunkPeers();
+            PrintReceivedChunks(); */
+          }
+          else
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_INV: Bitcoin node " << GetNode ()->GetId ()
+                         << " has already requested all the chunks");
+          }
 				  
-                }								  
-              }
+        }								  
+      }
 			
-              d.RemoveMember("inv");
+      d.RemoveMember("inv");
 			  
-              if (!requestHeaders.empty())
-              {
-                rapidjson::Value   value;
-                rapidjson::Value   array(rapidjson::kArrayType);
+      if (!requestHeaders.empty())
+      {
+        rapidjson::Value   value;
+        rapidjson::Value   array(rapidjson::kArrayType);
                 
-                for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
-                {
-                  value.SetString(block_it->c_str(), block_it->size(), d.GetAllocator());
-                  array.PushBack(value, d.GetAllocator());
-                }		
+        for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
+        {
+          std::string blockHash = block_it->ToString();
+          value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
+          array.PushBack(value, d.GetAllocator());
+        }		
 			  
-                d.AddMember("blocks", array, d.GetAllocator());
+        d.AddMember("blocks", array, d.GetAllocator());
                 
-                SendMessage(EXT_INV, EXT_GET_HEADERS, d, from);				
+        SendMessage(EXT_INV, EXT_GET_HEADERS, d, from);				
                 
-              }
+      }
 			  
-              if (!requestChunks.empty())
-              {
-                rapidjson::Value   value;
-                rapidjson::Value   chunkArray(rapidjson::kArrayType);
-                rapidjson::Value   availableChunks(rapidjson::kArrayType);
-                rapidjson::Value   chunkInfo(rapidjson::kObjectType);
+      if (!requestChunks.empty())
+      {
+        rapidjson::Value   value;
+        rapidjson::Value   chunkArray(rapidjson::kArrayType);
+        rapidjson::Value   availableChunks(rapidjson::kArrayType);
+        rapidjson::Value   chunkInfo(rapidjson::kObjectType);
 
-                d.RemoveMember("type");
-                d.RemoveMember("blocks");
+        d.RemoveMember("type");
+        d.RemoveMember("blocks");
 				
-                value.SetString("chunk");	
-                d.AddMember("type", value, d.GetAllocator());
+        value.SetString("chunk");	
+        d.AddMember("type", value, d.GetAllocator());
 				
-                for (auto chunk_it = requestChunks.begin(); chunk_it < requestChunks.end(); chunk_it++) 
-                {
+        for (auto chunk_it = requestChunks.begin(); chunk_it < requestChunks.end(); chunk_it++) 
+        {
 					
-                  std::string            invDelimiter = "/";
-                  std::string            chunkHash = *chunk_it;
-                  std::string            chunkHashHelp = chunkHash.substr(0);
-                  std::ostringstream     help;
-                  std::string            blockHash;
-                  size_t                 invPos = chunkHashHelp.find(invDelimiter);
-				  
-                  int height = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-                  chunkHashHelp.erase(0, invPos + invDelimiter.length());
-                  invPos = chunkHashHelp.find(invDelimiter);
-                  int minerId = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-                  chunkHashHelp.erase(0, invPos + invDelimiter.length());
-                  int chunkId = atoi(chunkHashHelp.substr(0).c_str());
-                  help << height << "/" << minerId;
-                  blockHash = help.str();
+          std::string            chunkHash = chunk_it->ToString();
+          BlockId                blockId = chunk_it->GetBlockId();
 				
-                  if (m_receivedChunks.find(blockHash) != m_receivedChunks.end())
-                  {
-                    for ( auto k : m_receivedChunks[blockHash])
-                    {
-                      value = k;
-                      availableChunks.PushBack(value, d.GetAllocator());
-                    }
-                  }
-                  chunkInfo.AddMember("availableChunks", availableChunks, d.GetAllocator());
+          if (m_receivedChunks.find(blockId) != m_receivedChunks.end())
+          {
+            for ( auto k : m_receivedChunks[blockId])
+            {
+              value = k;
+              availableChunks.PushBack(value, d.GetAllocator());
+            }
+          }
+          chunkInfo.AddMember("availableChunks", availableChunks, d.GetAllocator());
 				  
-                  value = false;
-                  chunkInfo.AddMember("fullBlock", value, d.GetAllocator());
+          value = false;
+          chunkInfo.AddMember("fullBlock", value, d.GetAllocator());
 				  
-                  value.SetString(chunk_it->c_str(), chunk_it->size(), d.GetAllocator());
-                  chunkInfo.AddMember("chunk", value, d.GetAllocator());
+          value.SetString(chunkHash.c_str(), chunkHash.size(), d.GetAllocator());
+          chunkInfo.AddMember("chunk", value, d.GetAllocator());
 				  
-                  chunkArray.PushBack(chunkInfo, d.GetAllocator());
-                }		
-                d.AddMember("chunks", chunkArray, d.GetAllocator());
+          chunkArray.PushBack(chunkInfo, d.GetAllocator());
+        }		
+        d.AddMember("chunks", chunkArray, d.GetAllocator());
 				
-                SendMessage(EXT_INV, EXT_GET_DATA, d, from);	
+        SendMessage(EXT_INV, EXT_GET_DATA, d, from);	
 				
-              }
-              break;
-            }
-            case GET_HEADERS:
-            {
-              int j;
-              std::vector<Block>              requestHeaders;
-              std::vector<Block>::iterator    block_it;
+      }
+      break;
+    }
+    case GET_HEADERS:
+    {
+      int j;
+      std::vector<Block>              requestHeaders;
+      std::vector<Block>::iterator    block_it;
 			  
-              m_nodeStats->getHeadersReceivedBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
+      m_nodeStats->getHeadersReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
 			  
-              for (j=0; j<d["blocks"].Size(); j++)
-              {  
-                std::string   invDelimiter = "/";
-                std::string   blockHash = d["blocks"][j].GetString();
-                size_t        invPos = blockHash.find(invDelimiter);
+      for (j=0; j<d["blocks"].Size(); j++)
+      {  
+        BlockId       blockId (d["blocks"][j].GetString());
 				
-                int height = atoi(blockHash.substr(0, invPos).c_str());
-                int minerId = atoi(blockHash.substr(invPos+1, blockHash.size()).c_str());
+        int height = blockId.GetBlockHeight();
+        int minerId = blockId.GetMinerId();
 				
-                if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId))
-                {
-                  NS_LOG_INFO("GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                              << " has the block with height = " 
-                              << height << " and minerId = " << minerId);
-                  Block newBlock (m_blockchain.ReturnBlock (height, minerId));
-                  requestHeaders.push_back(newBlock);
-                }
-                else if (ReceivedButNotValidated(blockHash))
-                {
-                  NS_LOG_INFO("GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                              << " has received but not yet validated the block with height = " 
-                              << height << " and minerId = " << minerId);
-                  requestHeaders.push_back(m_receivedNotValidated[blockHash]);
-                }
-                else
-                {
-                  NS_LOG_INFO("GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                              << " does not have the full block with height = " 
-                              << height << " and minerId = " << minerId);   
+        if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+                      << " has the block with height = " 
+                      << height << " and minerId = " << minerId);
+          Block newBlock (m_blockchain.ReturnBlock (height, minerId));
+          requestHeaders.push_back(newBlock);
+        }
+        else if (ReceivedButNotValidated(blockId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+                      << " has received but not yet validated the block with height = " 
+                      << height << " and minerId = " << minerId);
+          requestHeaders.push_back(m_receivedNotValidated[blockId]);
+        }
+        else
+        {
+          BITCOIN_MESSAGE_LOG_INFO("GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+                      << " does not have the full block with height = " 
+                      << height << " and minerId = " << minerId);   
 				  
-                }	
-              }
+        }	
+      }
 			  
-              if (!requestHeaders.empty())
-              {
-                rapidjson::Value value;
-                rapidjson::Value array(rapidjson::kArrayType);
+      if (!requestHeaders.empty())
+      {
+        rapidjson::Value value;
+        rapidjson::Value array(rapidjson::kArrayType);
 
-                d.RemoveMember("blocks");
+        d.RemoveMember("blocks");
 				
-                for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
-                {
-                  rapidjson::Value blockInfo(rapidjson::kObjectType);
-                  NS_LOG_INFO ("In requestHeaders " << *block_it);
+        for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
+        {
+          rapidjson::Value blockInfo(rapidjson::kObjectType);
+          BITCOIN_MESSAGE_LOG_INFO ("In requestHeaders " << *block_it);
                   
-                  value = block_it->GetBlockHeight ();
-                  blockInfo.AddMember("height", value, d.GetAllocator ());
+          value = block_it->GetBlockHeight ();
+          blockInfo.AddMember("height", value, d.GetAllocator ());
 
-                  value = block_it->GetMinerId ();
-                  blockInfo.AddMember("minerId", value, d.GetAllocator ());
+          value = block_it->GetMinerId ();
+          blockInfo.AddMember("minerId", value, d.GetAllocator ());
 
-                  value = block_it->GetParentBlockMinerId ();
-                  blockInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
+          value = block_it->GetParentBlockMinerId ();
+          blockInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
   
-                  value = block_it->GetBlockSizeBytes ();
-                  blockInfo.AddMember("size", value, d.GetAllocator ());
+          value = block_it->GetBlockSizeBytes ();
+          blockInfo.AddMember("size", value, d.GetAllocator ());
   
-                  value = block_it->GetTimeCreated ();
-                  blockInfo.AddMember("timeCreated", value, d.GetAllocator ());
+          value = block_it->GetTimeCreated ();
+          blockInfo.AddMember("timeCreated", value, d.GetAllocator ());
   
-                  value = block_it->GetTimeReceived ();							
-                  blockInfo.AddMember("timeReceived", value, d.GetAllocator ());
+          value = block_it->GetTimeReceived ();							
+          blockInfo.AddMember("timeReceived", value, d.GetAllocator ());
 				  
-                  array.PushBack(blockInfo, d.GetAllocator());
-                }	
+          array.PushBack(blockInfo, d.GetAllocator());
+        }	
 				
-                d.AddMember("blocks", array, d.GetAllocator());
+        d.AddMember("blocks", array, d.GetAllocator());
 				
-                SendMessage(GET_HEADERS, HEADERS, d, from);
-              }
-              break;
-            }
-            case EXT_GET_HEADERS:
-            {
-              int j;
-              std::vector<Block>              requestHeaders;
-              std::vector<Block>::iterator    block_it;
+        SendMessage(GET_HEADERS, HEADERS, d, from);
+      }
+      break;
+    }
+    case EXT_GET_HEADERS:
+    {
+      int j;
+      std::vector<Block>              requestHeaders;
+      std::vector<Block>::iterator    block_it;
 			  
-              m_nodeStats->extGetHeadersReceivedBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
+      m_nodeStats->extGetHeadersReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
 			  
-              for (j=0; j<d["blocks"].Size(); j++)
-              {  
-                std::string   invDelimiter = "/";
-                std::string   blockHash = d["blocks"][j].GetString();
-                size_t        invPos = blockHash.find(invDelimiter);
+      for (j=0; j<d["blocks"].Size(); j++)
+      {  
+        BlockId       blockId (d["blocks"][j].GetString());
 				  
-                int height = atoi(blockHash.substr(0, invPos).c_str());
-                int minerId = atoi(blockHash.substr(invPos+1, blockHash.size()).c_str());
+        int height = blockId.GetBlockHeight();
+        int minerId = blockId.GetMinerId();
 				
-                if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId))
-                {
-                  NS_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                              << " has the block with height = " 
-                              << height << " and minerId = " << minerId);
-                  Block newBlock (m_blockchain.ReturnBlock (height, minerId));
-                  requestHeaders.push_back(newBlock); 
-                }
-                else if (ReceivedButNotValidated(blockHash))
-                {
-                  NS_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                  << " has received but not yet validated the block with height = " 
-                  << height << " and minerId = " << minerId);
-                  requestHeaders.push_back(m_receivedNotValidated[blockHash]); 
-                }
-                else if (OnlyHeadersReceived(blockHash))	
-                {	
-                  NS_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                  << " has received only the headers of the block with hash = " << blockHash); 
-                  requestHeaders.push_back(m_onlyHeadersReceived[blockHash]);
-                }
-                else
-                {
-                  NS_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                  << " has neither the block nor the headers of the block hash = " << blockHash); 
+        if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+                      << " has the block with height = " 
+                      << height << " and minerId = " << minerId);
+          Block newBlock (m_blockchain.ReturnBlock (height, minerId));
+          requestHeaders.push_back(newBlock); 
+        }
+        else if (ReceivedButNotValidated(blockId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+          << " has received but not yet validated the block with height = " 
+          << height << " and minerId = " << minerId);
+          requestHeaders.push_back(m_receivedNotValidated[blockId]); 
+        }
+        else if (OnlyHeadersReceived(blockId))	
+        {	
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+          << " has received only the headers of the block with hash = " << blockId); 
+          requestHeaders.push_back(m_onlyHeadersReceived[blockId]);
+        }
+        else
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+          << " has neither the block nor the headers of the block hash = " << blockId); 
 			  
-                }	
-              }
+        }	
+      }
 			  
-              if (!requestHeaders.empty())
-              {
-                rapidjson::Value     value;
-                rapidjson::Value     array(rapidjson::kArrayType);
-                rapidjson::Value     chunkArray(rapidjson::kArrayType);
-                rapidjson::Value     chunkInfo(rapidjson::kObjectType);
-                std::ostringstream   blockHashHelp;
-                std::string          blockHash;
+      if (!requestHeaders.empty())
+      {
+        rapidjson::Value     value;
+        rapidjson::Value     array(rapidjson::kArrayType);
+        rapidjson::Value     chunkArray(rapidjson::kArrayType);
+        rapidjson::Value     chunkInfo(rapidjson::kObjectType);
 				
-                d.RemoveMember("blocks");
+        d.RemoveMember("blocks");
 				
-                for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
-                {
-                  NS_LOG_INFO ("In requestHeaders " << *block_it);
+        for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
+        {
+          BITCOIN_MESSAGE_LOG_INFO ("In requestHeaders " << *block_it);
 				  
-                  blockHashHelp << block_it->GetBlockHeight () << "/" << block_it->GetMinerId ();
-                  blockHash = blockHashHelp.str();
+          BlockId blockId = block_it->GetBlockId ();
 				  
-                  value = block_it->GetBlockHeight ();
-                  chunkInfo.AddMember("height", value, d.GetAllocator ());
-  
-                  value = block_it->GetMinerId ();
-                  chunkInfo.AddMember("minerId", value, d.GetAllocator ());
-
-                  value = block_it->GetParentBlockMinerId ();
-                  chunkInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
-  
-                  value = block_it->GetBlockSizeBytes ();
-                  chunkInfo.AddMember("size", value, d.GetAllocator ());
-  
-                  value = block_it->GetTimeCreated ();
-                  chunkInfo.AddMember("timeCreated", value, d.GetAllocator ());
-  
-                  value = block_it->GetTimeReceived ();							
-                  chunkInfo.AddMember("timeReceived", value, d.GetAllocator ());
-
-                  if (m_blockchain.HasBlock(block_it->GetBlockHeight (), block_it->GetMinerId ()) 
-                      || m_blockchain.IsOrphan(block_it->GetBlockHeight (), block_it->GetMinerId ())
-                      || ReceivedButNotValidated(blockHash))
-                  {
-                    value = true;							
-                    chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
-                  }
-                  else if (OnlyHeadersReceived(blockHash))
-                  {
-                    int noChunks = ceil(block_it->GetBlockSizeBytes ()/static_cast<double>(m_chunkSize));
+          value = block_it->GetBlockHeight ();
+          chunkInfo.AddMember("height", value, d.GetAllocator ());
+  
+          value = block_it->GetMinerId ();
+          chunkInfo.AddMember("minerId", value, d.GetAllocator ());
+
+          value = block_it->GetParentBlockMinerId ();
+          chunkInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
+  
+          value = block_it->GetBlockSizeBytes ();
+          chunkInfo.AddMember("size", value, d.GetAllocator ());
+  
+          value = block_it->GetTimeCreated ();
+          chunkInfo.AddMember("timeCreated", value, d.GetAllocator ());
+  
+          value = block_it->GetTimeReceived ();							
+          chunkInfo.AddMember("timeReceived", value, d.GetAllocator ());
+
+          if (m_blockchain.HasBlock(block_it->GetBlockHeight (), block_it->GetMinerId ()) 
+              || m_blockchain.IsOrphan(block_it->GetBlockHeight (), block_it->GetMinerId ())
+              || ReceivedButNotValidated(blockId))
+          {
+            value = true;							
+            chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
+          }
+          else if (OnlyHeadersReceived(blockId))
+          {
+            int noChunks = ceil(block_it->GetBlockSizeBytes ()/static_cast<double>(m_chunkSize));
 					
-                    if (m_receivedChunks[blockHash].size() == noChunks)
-                    {
-                      value = true;
-                      chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
-                    }
-                    else
-                    {
-                      value = false;							
-                      chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
-
-                      for (auto &chunk : m_receivedChunks[blockHash])
-                      {
-                        value = chunk;
-                        chunkArray.PushBack(value, d.GetAllocator());
-                      }
-                      chunkInfo.AddMember("availableChunks", chunkArray, d.GetAllocator ());
-                    }
-				  }
+            if (m_receivedChunks[blockId].size() == noChunks)
+            {
+              value = true;
+              chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
+            }
+            else
+            {
+              value = false;							
+              chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
+
+              for (auto &chunk : m_receivedChunks[blockId])
+              {
+                value = chunk;
+                chunkArray.PushBack(value, d.GetAllocator());
+              }
+              chunkInfo.AddMember("availableChunks", chunkArray, d.GetAllocator ());
+            }
+		  }
 				  
-                  array.PushBack(chunkInfo, d.GetAllocator());
-                }	
+          array.PushBack(chunkInfo, d.GetAllocator());
+        }	
 				
-                d.AddMember("blocks", array, d.GetAllocator());
+        d.AddMember("blocks", array, d.GetAllocator());
 				
-                SendMessage(EXT_GET_HEADERS, EXT_HEADERS, d, from); 
-              }
-              break;
-            }
-            case GET_DATA:
-            {
-              NS_LOG_INFO ("GET_DATA");
+        SendMessage(EXT_GET_HEADERS, EXT_HEADERS, d, from); 
+      }
+      break;
+    }
+    case GET_DATA:
+    {
+      BITCOIN_MESSAGE_LOG_INFO ("GET_DATA");
 			  
-              int j;
-              int totalBlockMessageSize = 0;
-              std::vector<Block>              requestBlocks;
-              std::vector<Block>::iterator    block_it;
-
-              m_nodeStats->getDataReceivedBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_inventorySizeBytes;
-
-              for (j=0; j<d["blocks"].Size(); j++)
-              {  
-                std::string    invDelimiter = "/";
-                std::string    parsedInv = d["blocks"][j].GetString();
-                size_t         invPos = parsedInv.find(invDelimiter);
+      int j;
+      int totalBlockMessageSize = 0;
+      std::vector<Block>              requestBlocks;
+      std::vector<Block>::iterator    block_it;
+
+      m_nodeStats->getDataReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_inventorySizeBytes;
+
+      for (j=0; j<d["blocks"].Size(); j++)
+      {  
+        BlockId        blockId (d["blocks"][j].GetString());
 				  
-                int height = atoi(parsedInv.substr(0, invPos).c_str());
-                int minerId = atoi(parsedInv.substr(invPos+1, parsedInv.size()).c_str());
+        int height = blockId.GetBlockHeight();
+        int minerId = blockId.GetMinerId();
 				
-                if (m_blockchain.HasBlock(height, minerId))
-                {
-                  NS_LOG_INFO("GET_DATA: Bitcoin node " << GetNode ()->GetId () 
-                              << " has already received the block with height = " 
-                              << height << " and minerId = " << minerId);
-                  Block newBlock (m_blockchain.ReturnBlock (height, minerId));
-                  requestBlocks.push_back(newBlock);
-                }
-                else
-                {
-                  NS_LOG_INFO("GET_DATA: Bitcoin node " << GetNode ()->GetId () 
-                  << " does not have the block with height = " 
-                  << height << " and minerId = " << minerId);                
-                }	
-              }
+        if (m_blockchain.HasBlock(height, minerId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("GET_DATA: Bitcoin node " << GetNode ()->GetId () 
+                      << " has already received the block with height = " 
+                      << height << " and minerId = " << minerId);
+          Block newBlock (m_blockchain.ReturnBlock (height, minerId));
+          requestBlocks.push_back(newBlock);
+        }
+        else
+        {
+          BITCOIN_MESSAGE_LOG_INFO("GET_DATA: Bitcoin node " << GetNode ()->GetId () 
+          << " does not have the block with height = " 
+          << height << " and minerId = " << minerId);                
+        }	
+      }
 			  
-              if (!requestBlocks.empty())
-              {
-                rapidjson::Value value;
-                rapidjson::Value array(rapidjson::kArrayType);
+      if (!requestBlocks.empty())
+      {
+        rapidjson::Value value;
+        rapidjson::Value array(rapidjson::kArrayType);
                 
 
-                d.RemoveMember("blocks");
+        d.RemoveMember("blocks");
 				
-                for (block_it = requestBlocks.begin(); block_it < requestBlocks.end(); block_it++) 
-                {
-                  rapidjson::Value blockInfo(rapidjson::kObjectType);
-                  NS_LOG_INFO ("In requestBlocks " << *block_it);
+        for (block_it = requestBlocks.begin(); block_it < requestBlocks.end(); block_it++) 
+        {
+          rapidjson::Value blockInfo(rapidjson::kObjectType);
+          BITCOIN_MESSAGE_LOG_INFO ("In requestBlocks " << *block_it);
     
-                  value = block_it->GetBlockHeight ();
-                  blockInfo.AddMember("height", value, d.GetAllocator ());
+          value = block_it->GetBlockHeight ();
+          blockInfo.AddMember("height", value, d.GetAllocator ());
   
-                  value = block_it->GetMinerId ();
-                  blockInfo.AddMember("minerId", value, d.GetAllocator ());
+          value = block_it->GetMinerId ();
+          blockInfo.AddMember("minerId", value, d.GetAllocator ());
 
-                  value = block_it->GetParentBlockMinerId ();
-                  blockInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
+          value = block_it->GetParentBlockMinerId ();
+          blockInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
   
-                  value = block_it->GetBlockSizeBytes ();
-                  totalBlockMessageSize += value.GetInt();
-                  blockInfo.AddMember("size", value, d.GetAllocator ());
+          value = block_it->GetBlockSizeBytes ();
+          totalBlockMessageSize += value.GetInt();
+          blockInfo.AddMember("size", value, d.GetAllocator ());
   
-                  value = block_it->GetTimeCreated ();
-                  blockInfo.AddMember("timeCreated", value, d.GetAllocator ());
+          value = block_it->GetTimeCreated ();
+          blockInfo.AddMember("timeCreated", value, d.GetAllocator ());
   
-                  value = block_it->GetTimeReceived ();							
-                  blockInfo.AddMember("timeReceived", value, d.GetAllocator ());
+          value = block_it->GetTimeReceived ();							
+          blockInfo.AddMember("timeReceived", value, d.GetAllocator ());
 				  
-                  array.PushBack(blockInfo, d.GetAllocator());
-                }	
-				
-                d.AddMember("blocks", array, d.GetAllocator());
+          array.PushBack(blockInfo, d.GetAllocator());
+        }	
 				
-                double sendTime = totalBlockMessageSize / m_uploadSpeed;
-	            double eventTime;	
+        d.AddMember("blocks", array, d.GetAllocator());
+        d["message"].SetInt(BLOCK);
 				
-/*                 std::cout << "Node " << GetNode()->GetId() << "-" << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
-		  		          << " " << m_peersDownloadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] << " Mbps , time = "
-		  		          << Simulator::Now ().GetSeconds() << "s \n"; */
-                
-                if (m_sendBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendBlockTimes.back())
-                {
-                  eventTime = 0; 
-                }
-                else
-                {
-                  //std::cout << "m_sendBlockTimes.back() = m_sendBlockTimes.back() = " << m_sendBlockTimes.back() << std::endl;
-                  eventTime = m_sendBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-                }
-                m_sendBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
-                //std::cout << sendTime << " " << eventTime << " " << m_sendBlockTimes.size() << std::endl;
-                NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the block to " << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
-                            << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
-							
-               
-                // Stringify the DOM
-                rapidjson::StringBuffer packetInfo;
-                rapidjson::Writer<rapidjson::StringBuffer> writer(packetInfo);
-                d.Accept(writer);
-                std::string packet = packetInfo.GetString();
-                NS_LOG_INFO ("DEBUG: " << packetInfo.GetString());
+        std::string packet = EncodeMessage(d, m_messageCodec);
+        BITCOIN_MESSAGE_LOG_INFO ("DEBUG: " << MessageToString(d));
+        BITCOIN_MESSAGE_LOG_INFO("Node " << GetNode()->GetId() << " queued the block for " << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
+                    << " behind " << m_uploadLink.GetSize() << " transfers\n");
 				
-                Simulator::Schedule (Seconds(eventTime), &BitcoinNode::SendBlock, this, packet, from);
-                Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinNode::RemoveSendTime, this);
+        m_uploadLink.Enqueue (InetSocketAddress::ConvertFrom(from).GetIpv4 (), totalBlockMessageSize, 0,
+                              std::bind (&BitcoinNode::SendBlock, this, packet, GetBlockMessageBytes(d), from), LinkScheduler::TransferHandler ());
 
-              }
-              break;
-            }
-            case EXT_GET_DATA:
-            {
-              NS_LOG_INFO ("EXT_GET_DATA");
+      }
+      break;
+    }
+    case EXT_GET_DATA:
+    {
+      BITCOIN_MESSAGE_LOG_INFO ("EXT_GET_DATA");
 			  
-              int j;
-              int totalChunkMessageSize = 0;
-              std::map<std::string, int>            requestedChunks;
-              std::vector<std::string>::iterator    chunk_it;
+      int j;
+      int totalChunkMessageSize = 0;
+      std::map<ChunkId, int>                requestedChunks;
               
-              m_nodeStats->extGetDataReceivedBytes += m_bitcoinMessageHeader + m_countBytes + d["chunks"].Size()*m_inventorySizeBytes;
-
-              for (j=0; j<d["chunks"].Size(); j++)
-              {  
-                std::string            invDelimiter = "/";
-                std::string            chunkHash = d["chunks"][j]["chunk"].GetString();
-                std::string            chunkHashHelp = chunkHash.substr(0);
-                std::ostringstream     help;
-                std::string            blockHash;
-                size_t                 invPos = chunkHashHelp.find(invDelimiter);
-                std::vector<int>       candidateChunks;
-                int                    blockSize = -1;
+      m_nodeStats->extGetDataReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["chunks"].Size()*m_inventorySizeBytes;
+
+      for (j=0; j<d["chunks"].Size(); j++)
+      {  
+        ChunkId                peerChunk (d["chunks"][j]["chunk"].GetString());
+        BlockId                blockId = peerChunk.GetBlockId();
+        std::vector<int>       candidateChunks;
+        int                    blockSize = -1;
 				
-                int height = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-                chunkHashHelp.erase(0, invPos + invDelimiter.length());
-                invPos = chunkHashHelp.find(invDelimiter);
-                int minerId = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-                chunkHashHelp.erase(0, invPos + invDelimiter.length());
-                int chunkId = atoi(chunkHashHelp.substr(0).c_str());
-                help << height << "/" << minerId;
-                blockHash = help.str();
+        int height = blockId.GetBlockHeight();
+        int minerId = blockId.GetMinerId();
+        int chunkId = peerChunk.GetChunkId();
 				
-                m_nodeStats->extGetDataReceivedBytes += 6; //1Byte(fullBlock) + 4Bytes(numberOfChunks) + 1Byte(requested chunk)
-                if (!d["chunks"][j]["fullBlock"].GetBool())
-                  m_nodeStats->extGetDataReceivedBytes += d["chunks"][j]["availableChunks"].Size();
+        m_nodeStats->extGetDataReceivedBytes[m_nodeId] += 6; //1Byte(fullBlock) + 4Bytes(numberOfChunks) + 1Byte(requested chunk)
+        if (!d["chunks"][j]["fullBlock"].GetBool())
+          m_nodeStats->extGetDataReceivedBytes[m_nodeId] += d["chunks"][j]["availableChunks"].Size();
 				
-                if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId) || ReceivedButNotValidated(blockHash))
-                {
-                  NS_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId () 
-                  << " has already received the block with height = " 
-                  << height << " and minerId = " << minerId);
-                  requestedChunks[chunkHash] = -1;
-                }
-                else if (OnlyHeadersReceived(blockHash))	
-                {	
-                  NS_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId () 
-                              << " has received the headers (and maybe some chunks) of the block with hash = " << blockHash); 
-                  if (HasChunk(blockHash, chunkId))
-                    requestedChunks[chunkHash] = -1;
-                  blockSize = m_onlyHeadersReceived[blockHash].GetBlockSizeBytes();
+        if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId) || ReceivedButNotValidated(blockId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId () 
+          << " has already received the block with height = " 
+          << height << " and minerId = " << minerId);
+          requestedChunks[peerChunk] = -1;
+        }
+        else if (OnlyHeadersReceived(blockId))	
+        {	
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId () 
+                      << " has received the headers (and maybe some chunks) of the block with hash = " << blockId); 
+          if (HasChunk(blockId, chunkId))
+            requestedChunks[peerChunk] = -1;
+          blockSize = m_onlyHeadersReceived[blockId].GetBlockSizeBytes();
 				  
-                  if (d["chunks"][j]["fullBlock"].GetBool())
-                  {
-                    for (auto &chunk : m_queueChunks[blockHash])
-                      candidateChunks.push_back(chunk);
-                  }
-                  else
-                  {
-                    for (int k = 0; k < d["chunks"][j]["availableChunks"].Size(); k++)
-                    {
-                      if (std::find(m_queueChunks[blockHash].begin(), m_queueChunks[blockHash].end(), d["chunks"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockHash].end())
-                        candidateChunks.push_back(d["chunks"][j]["availableChunks"][k].GetInt());
-                    }
-                  }
-                }
-                else
-                {
-                  NS_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId () 
-                  << " does not have the block with height = " 
-                  << height << " and minerId = " << minerId);                
-                }
+          if (d["chunks"][j]["fullBlock"].GetBool())
+          {
+            for (auto &chunk : m_queueChunks[blockId])
+              candidateChunks.push_back(chunk);
+          }
+          else
+          {
+            for (int k = 0; k < d["chunks"][j]["availableChunks"].Size(); k++)
+            {
+              if (std::find(m_queueChunks[blockId].begin(), m_queueChunks[blockId].end(), d["chunks"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockId].end())
+                candidateChunks.push_back(d["chunks"][j]["availableChunks"][k].GetInt());
+            }
+          }
+        }
+        else
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId () 
+          << " does not have the block with height = " 
+          << height << " and minerId = " << minerId);                
+        }
 
 
 /*                     std::cout << "candidateChunks = ";
-                    for (auto chunk : candidateChunks)
-                      std::cout << chunk << ", ";
-                    std::cout << "\n"; */
-
-                if (candidateChunks.size() > 0)
-                {
-                  EventId              timeout;
-                  int randomIndex = rand() % candidateChunks.size();
-				  
-                  NS_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId ()
-                               << " will request the chunk with index = " << randomIndex << " and value = " << candidateChunks[randomIndex]);	
-                  m_queueChunks[blockHash].erase(std::remove(m_queueChunks[blockHash].begin(),
-                                                             m_queueChunks[blockHash].end(), candidateChunks[randomIndex]),
-                                                             m_queueChunks[blockHash].end());
+            for (auto chunk : candidateChunks)
+              std::cout << chunk << ", ";
+            std::cout << "\n"; */
+
+        if (candidateChunks.size() > 0)
+        {
+          EventId              timeout;
+          int randomIndex = m_peerSelectionStream.GetInteger(candidateChunks.size());
+				  
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId ()
+                       << " will request the chunk with index = " << randomIndex << " and value = " << candidateChunks[randomIndex]);	
+          m_queueChunks[blockId].erase(std::remove(m_queueChunks[blockId].begin(),
+                                                     m_queueChunks[blockId].end(), candidateChunks[randomIndex]),
+                                                     m_queueChunks[blockId].end());
 																		  
-                  std::ostringstream chunk;
-                  chunk << blockHash << "/" << candidateChunks[randomIndex];
-                  requestedChunks[chunkHash] = candidateChunks[randomIndex];
+          ChunkId chunk (blockId, candidateChunks[randomIndex]);
+          requestedChunks[peerChunk] = candidateChunks[randomIndex];
 
 
-                  if (blockSize == -1)
-                    NS_FATAL_ERROR ("blockSize == -1");
+          if (blockSize == -1)
+            NS_FATAL_ERROR ("blockSize == -1");
 				
-                  timeout = Simulator::Schedule (Minutes(m_invTimeoutMinutes.GetMinutes() / ceil(blockSize/static_cast<double>(m_chunkSize))),
-                                                     &BitcoinNode::ChunkTimeoutExpired, this, chunk.str());
-
-                  m_chunkTimeouts[chunk.str()] = timeout;
-                  m_queueChunkPeers[blockHash].push_back(from);
-                }
-                else
-                {
-                  NS_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId ()
-                              << " will not request any chunks from this peer, because it has already all the available ones");
-                }
-              }
+          timeout = Simulator::Schedule (Minutes(m_invTimeoutMinutes.GetMinutes() / ceil(blockSize/static_cast<double>(m_chunkSize))),
+                                             &BitcoinNode::ChunkTimeoutExpired, this, chunk);
+
+          m_chunkTimeouts[chunk] = timeout;
+          m_queueChunkPeers[blockId].push_back(from);
+        }
+        else
+        {
+          BITCOIN_MESSAGE_LOG_INFO("EXT_GET_DATA: Bitcoin node " << GetNode ()->GetId ()
+                      << " will not request any chunks from this peer, because it has already all the available ones");
+        }
+      }
 			  
 
-              if (!requestedChunks.empty())
-              {
-                rapidjson::Value value;
-                rapidjson::Value chunkArray(rapidjson::kArrayType);
+      if (!requestedChunks.empty())
+      {
+        rapidjson::Value value;
+        rapidjson::Value chunkArray(rapidjson::kArrayType);
 
-                d.RemoveMember("chunks");
+        d.RemoveMember("chunks");
 				
-                for (auto &requestedChunk : requestedChunks) 
-                {
-                  NS_LOG_INFO ("In requestedChunks " << requestedChunk.first);
-				  
-                  rapidjson::Value availableChunks(rapidjson::kArrayType);
-                  rapidjson::Value requestChunks(rapidjson::kArrayType);
-                  rapidjson::Value chunkInfo(rapidjson::kObjectType);
-				  
-                  std::string            invDelimiter = "/";
-                  std::ostringstream     help;
-                  std::string            blockHash;
-                  std::string            chunkHash = requestedChunk.first.substr(0);
-                  size_t                 invPos = chunkHash.find(invDelimiter);
-                  Block                  newBlock;
-                  int                    blockSize;
-                  int height = atoi(chunkHash.substr(0, invPos).c_str());
+        for (auto &requestedChunk : requestedChunks) 
+        {
+          BITCOIN_MESSAGE_LOG_INFO ("In requestedChunks " << requestedChunk.first);
 				  
-                  chunkHash.erase(0, invPos + invDelimiter.length());
-                  invPos = chunkHash.find(invDelimiter);
-                  int minerId = atoi(chunkHash.substr(0, invPos).c_str());
+          rapidjson::Value availableChunks(rapidjson::kArrayType);
+          rapidjson::Value requestChunks(rapidjson::kArrayType);
+          rapidjson::Value chunkInfo(rapidjson::kObjectType);
 				  
-                  chunkHash.erase(0, invPos + invDelimiter.length());
-                  int chunkId = atoi(chunkHash.substr(0).c_str());
-                  help << height << "/" << minerId;
-                  blockHash = help.str();
+          BlockId                blockId = requestedChunk.first.GetBlockId();
+          Block                  newBlock;
+          int                    blockSize;
+          int height = blockId.GetBlockHeight();
+          int minerId = blockId.GetMinerId();
+          int chunkId = requestedChunk.first.GetChunkId();
 				  
 				  
-                  if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId))
-                  {
-                    newBlock = m_blockchain.ReturnBlock (height, minerId);
-                    value = true;
-                    chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
-                    blockSize = newBlock.GetBlockSizeBytes ();
-                  }
-                  else if (ReceivedButNotValidated(blockHash))
-                  {
-                    newBlock = m_receivedNotValidated[blockHash];
-                    value = true;
-                    chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
-                    blockSize = newBlock.GetBlockSizeBytes ();
-                  }
-                  else if (OnlyHeadersReceived(blockHash))	
-                  {
-                    newBlock = m_onlyHeadersReceived[blockHash];
-                    blockSize = newBlock.GetBlockSizeBytes ();
-                    int noChunks = ceil(blockSize/static_cast<double>(m_chunkSize));
+          if (m_blockchain.HasBlock(height, minerId) || m_blockchain.IsOrphan(height, minerId))
+          {
+            newBlock = m_blockchain.ReturnBlock (height, minerId);
+            value = true;
+            chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
+            blockSize = newBlock.GetBlockSizeBytes ();
+          }
+          else if (ReceivedButNotValidated(blockId))
+          {
+            newBlock = m_receivedNotValidated[blockId];
+            value = true;
+            chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
+            blockSize = newBlock.GetBlockSizeBytes ();
+          }
+          else if (OnlyHeadersReceived(blockId))	
+          {
+            newBlock = m_onlyHeadersReceived[blockId];
+            blockSize = newBlock.GetBlockSizeBytes ();
+            int noChunks = ceil(blockSize/static_cast<double>(m_chunkSize));
 					
-                    if (m_receivedChunks[blockHash].size() == noChunks)
-                    {
-                      value = true;
-                      chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
-                      NS_LOG_DEBUG("1 " << m_receivedChunks[blockHash].size());
-                    }
-                    else
-                    {
-                      NS_LOG_DEBUG("2 " << m_receivedChunks[blockHash].size());
-
-                      value = false;
-                      chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
+            if (m_receivedChunks[blockId].size() == noChunks)
+            {
+              value = true;
+              chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
+              BITCOIN_MESSAGE_LOG_DEBUG("1 " << m_receivedChunks[blockId].size());
+            }
+            else
+            {
+              BITCOIN_MESSAGE_LOG_DEBUG("2 " << m_receivedChunks[blockId].size());
+
+              value = false;
+              chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
 					  
-                      for (auto &c : m_receivedChunks[blockHash])
-                      {
-                        value = c;
-                        availableChunks.PushBack(value, d.GetAllocator());
-                      }
-                      chunkInfo.AddMember("availableChunks", availableChunks, d.GetAllocator ());
-                    }
-                  }
+              for (auto &c : m_receivedChunks[blockId])
+              {
+                value = c;
+                availableChunks.PushBack(value, d.GetAllocator());
+              }
+              chunkInfo.AddMember("availableChunks", availableChunks, d.GetAllocator ());
+            }
+          }
 					  
-                  value = newBlock.GetBlockHeight ();
-                  chunkInfo.AddMember("height", value, d.GetAllocator ());
+          value = newBlock.GetBlockHeight ();
+          chunkInfo.AddMember("height", value, d.GetAllocator ());
   
-                  value = newBlock.GetMinerId ();
-                  chunkInfo.AddMember("minerId", value, d.GetAllocator ());
+          value = newBlock.GetMinerId ();
+          chunkInfo.AddMember("minerId", value, d.GetAllocator ());
 
-                  value = chunkId;
-                  chunkInfo.AddMember("chunk", value, d.GetAllocator ());
+          value = chunkId;
+          chunkInfo.AddMember("chunk", value, d.GetAllocator ());
 				  
-                  value = newBlock.GetParentBlockMinerId ();
-                  chunkInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
+          value = newBlock.GetParentBlockMinerId ();
+          chunkInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
   
-                  value = newBlock.GetBlockSizeBytes ();
-                  if (chunkId == ceil(newBlock.GetBlockSizeBytes () / static_cast<double>(m_chunkSize) - 1) && 
-                      newBlock.GetBlockSizeBytes () % m_chunkSize > 0)
-                    totalChunkMessageSize += newBlock.GetBlockSizeBytes () % m_chunkSize;
-                  else
-                    totalChunkMessageSize += m_chunkSize;
+          value = newBlock.GetBlockSizeBytes ();
+          if (chunkId == ceil(newBlock.GetBlockSizeBytes () / static_cast<double>(m_chunkSize) - 1) && 
+              newBlock.GetBlockSizeBytes () % m_chunkSize > 0)
+            totalChunkMessageSize += newBlock.GetBlockSizeBytes () % m_chunkSize;
+          else
+            totalChunkMessageSize += m_chunkSize;
 
-                  chunkInfo.AddMember("size", value, d.GetAllocator ());
+          chunkInfo.AddMember("size", value, d.GetAllocator ());
                   
-                  value = newBlock.GetTimeCreated ();
-                  chunkInfo.AddMember("timeCreated", value, d.GetAllocator ());
+          value = newBlock.GetTimeCreated ();
+          chunkInfo.AddMember("timeCreated", value, d.GetAllocator ());
   
-                  value = newBlock.GetTimeReceived ();							
-                  chunkInfo.AddMember("timeReceived", value, d.GetAllocator ());
+          value = newBlock.GetTimeReceived ();							
+          chunkInfo.AddMember("timeReceived", value, d.GetAllocator ());
 				  
-                  if (requestedChunk.second != -1)
-                  {
-                    value = requestedChunk.second;
-                    requestChunks.PushBack(value, d.GetAllocator());
-                  }
-                  chunkInfo.AddMember("requestChunks", requestChunks, d.GetAllocator ());
+          if (requestedChunk.second != -1)
+          {
+            value = requestedChunk.second;
+            requestChunks.PushBack(value, d.GetAllocator());
+          }
+          chunkInfo.AddMember("requestChunks", requestChunks, d.GetAllocator ());
 				  
 /*                  //Test chunk to chunk messages
-                  value = 1;
-                  requestChunks.PushBack(value, d.GetAllocator());
-                  chunkInfo.AddMember("requestChunks", requestChunks, d.GetAllocator ()); */
+          value = 1;
+          requestChunks.PushBack(value, d.GetAllocator());
+          chunkInfo.AddMember("requestChunks", requestChunks, d.GetAllocator ()); */
 				  
-                  chunkArray.PushBack(chunkInfo, d.GetAllocator());
-                }	
-				
-                d.AddMember("chunks", chunkArray, d.GetAllocator());
+          chunkArray.PushBack(chunkInfo, d.GetAllocator());
+        }	
 				
-                double sendTime = totalChunkMessageSize / m_uploadSpeed;
-                double eventTime;
+        d.AddMember("chunks", chunkArray, d.GetAllocator());
+        d["message"].SetInt(CHUNK);
 				
-/*                 std::cout << "Node " << GetNode()->GetId() << "-" << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
-		  		          << " " << m_peersDownloadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] << " Mbps , time = "
-		  		          << Simulator::Now ().GetSeconds() << "s \n"; */
-                
-                if (m_sendBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendBlockTimes.back())
-                {
-                  eventTime = 0; 
-                }
-                else
-                {
-                  //std::cout << "m_sendBlockTimes.back() = m_sendBlockTimes.back() = " << m_sendBlockTimes.back() << std::endl;
-                  eventTime = m_sendBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-                }
-                m_sendBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
-                //std::cout << sendTime << " " << eventTime << " " << m_sendBlockTimes.size() << std::endl;
-                NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the chunk to " << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
-                            << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
-							
-               
-                // Stringify the DOM
-                rapidjson::StringBuffer packetInfo;
-                rapidjson::Writer<rapidjson::StringBuffer> writer(packetInfo);
-                d.Accept(writer);
-                std::string packet = packetInfo.GetString();
-                NS_LOG_INFO ("DEBUG: " << packetInfo.GetString());
+        std::string packet = EncodeMessage(d, m_messageCodec);
+        BITCOIN_MESSAGE_LOG_INFO ("DEBUG: " << MessageToString(d));
+        BITCOIN_MESSAGE_LOG_INFO("Node " << GetNode()->GetId() << " queued the chunk for " << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
+                    << " behind " << m_uploadLink.GetSize() << " transfers\n");
 				
-                Simulator::Schedule (Seconds(eventTime), &BitcoinNode::SendChunk, this, packet, from);
-                Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinNode::RemoveSendTime, this);
-              }
-              break;
-            }
-            case HEADERS:
-            {
-              NS_LOG_INFO ("HEADERS");
+        m_uploadLink.Enqueue (InetSocketAddress::ConvertFrom(from).GetIpv4 (), totalChunkMessageSize, 0,
+                              std::bind (&BitcoinNode::SendChunk, this, packet, GetChunkMessageBytes(d), from), LinkScheduler::TransferHandler ());
+      }
+      break;
+    }
+    case HEADERS:
+    {
+      BITCOIN_MESSAGE_LOG_INFO ("HEADERS");
 
-              std::vector<std::string>              requestHeaders;
-              std::vector<std::string>              requestBlocks;
-              std::vector<std::string>::iterator    block_it;
-              int j;
+      std::vector<BlockId>                  requestHeaders;
+      std::vector<BlockId>                  requestBlocks;
+      std::vector<BlockId>::iterator        block_it;
+      int j;
 
-              m_nodeStats->headersReceivedBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
+      m_nodeStats->headersReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
 
               
-              for (j=0; j<d["blocks"].Size(); j++)
-              {  
-                int parentHeight = d["blocks"][j]["height"].GetInt() - 1;
-                int parentMinerId = d["blocks"][j]["parentBlockMinerId"].GetInt();
-                int height = d["blocks"][j]["height"].GetInt();
-                int minerId = d["blocks"][j]["minerId"].GetInt();
-				
-				
-                EventId              timeout;
-                std::ostringstream   stringStream;  
-                std::string          blockHash;
-                std::string          parentBlockHash ;
-
-                stringStream << height << "/" << minerId;
-                blockHash = stringStream.str();
-                Block newBlockHeaders(d["blocks"][j]["height"].GetInt(), d["blocks"][j]["minerId"].GetInt(), d["blocks"][j]["parentBlockMinerId"].GetInt(), 
-                                      d["blocks"][j]["size"].GetInt(), d["blocks"][j]["timeCreated"].GetDouble(), 
-                                      Simulator::Now ().GetSeconds (), InetSocketAddress::ConvertFrom(from).GetIpv4 ());
-                m_onlyHeadersReceived[blockHash] = Block (d["blocks"][j]["height"].GetInt(), d["blocks"][j]["minerId"].GetInt(), d["blocks"][j]["parentBlockMinerId"].GetInt(), 
-                                                          d["blocks"][j]["size"].GetInt(), d["blocks"][j]["timeCreated"].GetDouble(), 
-                                                          Simulator::Now ().GetSeconds (), InetSocketAddress::ConvertFrom(from).GetIpv4 ());
-                //PrintOnlyHeadersReceived();
+      for (j=0; j<d["blocks"].Size(); j++)
+      {  
+        int parentHeight = d["blocks"][j]["height"].GetInt() - 1;
+        int parentMinerId = d["blocks"][j]["parentBlockMinerId"].GetInt();
+        int height = d["blocks"][j]["height"].GetInt();
+        int minerId = d["blocks"][j]["minerId"].GetInt();
 				
-                stringStream.clear();
-                stringStream.str("");
 				
-                stringStream << parentHeight << "/" << parentMinerId;
-                parentBlockHash = stringStream.str();
+        EventId              timeout;
+        BlockId              blockId (height, minerId);
+        BlockId              parentBlockId (parentHeight, parentMinerId);
+
+        m_onlyHeadersReceived[blockId] = Block (d["blocks"][j]["height"].GetInt(), d["blocks"][j]["minerId"].GetInt(), d["blocks"][j]["parentBlockMinerId"].GetInt(), 
+                                                  d["blocks"][j]["size"].GetInt(), d["blocks"][j]["timeCreated"].GetDouble(), 
+                                                  Simulator::Now ().GetSeconds (), InetSocketAddress::ConvertFrom(from).GetIpv4 ());
+        //PrintOnlyHeadersReceived();
 				
-                if(m_protocolType == SENDHEADERS && !m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockHash))
-                {
-                  NS_LOG_INFO("We have not received an INV for the block with height = " << d["blocks"][j]["height"].GetInt() 
-                               << " and minerId = " << d["blocks"][j]["minerId"].GetInt());
+        if(m_protocolType == SENDHEADERS && !m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockId))
+        {
+          BITCOIN_MESSAGE_LOG_INFO("We have not received an INV for the block with height = " << d["blocks"][j]["height"].GetInt() 
+                       << " and minerId = " << d["blocks"][j]["minerId"].GetInt());
 				  
-                  /**
-                   * Acquire block
-                   */
+          /**
+           * Acquire block
+           */
 	  
-                  if (m_invTimeouts.find(blockHash) == m_invTimeouts.end())
-                  {
-                    NS_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has not requested the block yet");
-                    requestBlocks.push_back(blockHash.c_str());
-                    timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, blockHash);
-                    m_invTimeouts[blockHash] = timeout;
-                  }
-                  else
-                  {
-                    NS_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has already requested the block");
-                  }
+          if (m_invTimeouts.find(blockId) == m_invTimeouts.end())
+          {
+            BITCOIN_MESSAGE_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has not requested the block yet");
+            requestBlocks.push_back(blockId);
+            timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, blockId);
+            m_invTimeouts[blockId] = timeout;
+          }
+          else
+          {
+            BITCOIN_MESSAGE_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has already requested the block");
+          }
 				  
-                  m_queueInv[blockHash].push_back(from); 
+          m_queueInv[blockId].push_back(from); 
 
-                }
+        }
 				  
 				  
-                if (!m_blockchain.HasBlock(parentHeight, parentMinerId) && !m_blockchain.IsOrphan(parentHeight, parentMinerId) && !ReceivedButNotValidated(parentBlockHash))
-                {				  
-                  NS_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
-                               << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
-                               << " is an orphan\n");
+        if (!m_blockchain.HasBlock(parentHeight, parentMinerId) && !m_blockchain.IsOrphan(parentHeight, parentMinerId) && !ReceivedButNotValidated(parentBlockId))
+        {				  
+          BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
+                       << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
+                       << " is an orphan\n");
 				  
-                  /**
-                   * Acquire parent
-                   */
+          /**
+           * Acquire parent
+           */
 	  
-                  if (m_invTimeouts.find(parentBlockHash) == m_invTimeouts.end())
-                  {
-                    NS_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has not requested its parent block yet");
+          if (m_invTimeouts.find(parentBlockId) == m_invTimeouts.end())
+          {
+            BITCOIN_MESSAGE_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has not requested its parent block yet");
 								 
-                    if(m_protocolType == STANDARD_PROTOCOL || 
-                      (m_protocolType == SENDHEADERS && std::find(requestBlocks.begin(), requestBlocks.end(), parentBlockHash) == requestBlocks.end()))
-                    {
-                      if (!OnlyHeadersReceived(parentBlockHash))
-                        requestHeaders.push_back(parentBlockHash.c_str());
-                      timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, parentBlockHash);
-                      m_invTimeouts[parentBlockHash] = timeout;
-                    }
-                  }
-                  else
-                  {
-                    NS_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has already requested the block");
-                  }
+            if(m_protocolType == STANDARD_PROTOCOL || 
+              (m_protocolType == SENDHEADERS && std::find(requestBlocks.begin(), requestBlocks.end(), parentBlockId) == requestBlocks.end()))
+            {
+              if (!OnlyHeadersReceived(parentBlockId))
+                requestHeaders.push_back(parentBlockId);
+              timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, parentBlockId);
+              m_invTimeouts[parentBlockId] = timeout;
+            }
+          }
+          else
+          {
+            BITCOIN_MESSAGE_LOG_INFO("HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has already requested the block");
+          }
 				  
-                  if(m_protocolType == STANDARD_PROTOCOL || 
-                    (m_protocolType == SENDHEADERS && std::find(requestBlocks.begin(), requestBlocks.end(), parentBlockHash) == requestBlocks.end()))
-                    m_queueInv[parentBlockHash].push_back(from); 
+          if(m_protocolType == STANDARD_PROTOCOL || 
+            (m_protocolType == SENDHEADERS && std::find(requestBlocks.begin(), requestBlocks.end(), parentBlockId) == requestBlocks.end()))
+            m_queueInv[parentBlockId].push_back(from); 
 
-                  //PrintQueueInv();
-                  //PrintInvTimeouts();
+          //PrintQueueInv();
+          //PrintInvTimeouts();
 				  
-                }
-                else
-                {
-                  /**
-	               * Block is not orphan, so we can go on validating
-	               */
-                  NS_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
-                              << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
-                              << " is NOT an orphan\n");			   
-                }
-              }
+        }
+        else
+        {
+          /**
+           * Block is not orphan, so we can go on validating
+           */
+          BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
+                      << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
+                      << " is NOT an orphan\n");			   
+        }
+      }
 			  
-              if (!requestHeaders.empty())
-              {
-                rapidjson::Value   value;
-                rapidjson::Value   array(rapidjson::kArrayType);
-                Time               timeout;
+      if (!requestHeaders.empty())
+      {
+        rapidjson::Value   value;
+        rapidjson::Value   array(rapidjson::kArrayType);
+        Time               timeout;
 
-                d.RemoveMember("blocks");
+        d.RemoveMember("blocks");
 
-                for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
-                {
-                  value.SetString(block_it->c_str(), block_it->size(), d.GetAllocator());
-                  array.PushBack(value, d.GetAllocator());
-                }		
+        for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
+        {
+          std::string blockHash = block_it->ToString();
+          value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
+          array.PushBack(value, d.GetAllocator());
+        }		
 			  
-                d.AddMember("blocks", array, d.GetAllocator());
+        d.AddMember("blocks", array, d.GetAllocator());
 
 					
-                SendMessage(HEADERS, GET_HEADERS, d, from);			
-                SendMessage(HEADERS, GET_DATA, d, from);	
-              }
+        SendMessage(HEADERS, GET_HEADERS, d, from);			
+        SendMessage(HEADERS, GET_DATA, d, from);	
+      }
 			  
-              if (!requestBlocks.empty())
-              {
-                rapidjson::Value   value;
-                rapidjson::Value   array(rapidjson::kArrayType);
-                Time               timeout;
+      if (!requestBlocks.empty())
+      {
+        rapidjson::Value   value;
+        rapidjson::Value   array(rapidjson::kArrayType);
+        Time               timeout;
 
-                d.RemoveMember("blocks");
+        d.RemoveMember("blocks");
 
-                for (block_it = requestBlocks.begin(); block_it < requestBlocks.end(); block_it++) 
-                {
-                  value.SetString(block_it->c_str(), block_it->size(), d.GetAllocator());
-                  array.PushBack(value, d.GetAllocator());
-                }		
+        for (block_it = requestBlocks.begin(); block_it < requestBlocks.end(); block_it++) 
+        {
+          std::string blockHash = block_it->ToString();
+          value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
+          array.PushBack(value, d.GetAllocator());
+        }		
 			  
-                d.AddMember("blocks", array, d.GetAllocator());
+        d.AddMember("blocks", array, d.GetAllocator());
 
-                SendMessage(HEADERS, GET_DATA, d, from);	
-              }
-              break;
-            }
-            case EXT_HEADERS:
-            {
-              NS_LOG_INFO ("EXT_HEADERS");
+        SendMessage(HEADERS, GET_DATA, d, from);	
+      }
+      break;
+    }
+    case EXT_HEADERS:
+    {
+      BITCOIN_MESSAGE_LOG_INFO ("EXT_HEADERS");
 
-              std::vector<std::string>              requestHeaders;
-              std::vector<std::string>              requestChunks;
-              std::vector<std::string>::iterator    block_it;
-              int j;
+      std::vector<BlockId>                  requestHeaders;
+      std::vector<ChunkId>                  requestChunks;
+      std::vector<BlockId>::iterator        block_it;
+      int j;
 
-              m_nodeStats->extHeadersReceivedBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
+      m_nodeStats->extHeadersReceivedBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
 
               
-              for (j=0; j<d["blocks"].Size(); j++)
-              {  
-                int parentHeight = d["blocks"][j]["height"].GetInt() - 1;
-                int parentMinerId = d["blocks"][j]["parentBlockMinerId"].GetInt();
-                int height = d["blocks"][j]["height"].GetInt();
-                int minerId = d["blocks"][j]["minerId"].GetInt();
-                int blockSize = d["blocks"][j]["size"].GetInt();
+      for (j=0; j<d["blocks"].Size(); j++)
+      {  
+        int parentHeight = d["blocks"][j]["height"].GetInt() - 1;
+        int parentMinerId = d["blocks"][j]["parentBlockMinerId"].GetInt();
+        int height = d["blocks"][j]["height"].GetInt();
+        int minerId = d["blocks"][j]["minerId"].GetInt();
+        int blockSize = d["blocks"][j]["size"].GetInt();
 
 				
-                EventId              timeout;
-                std::ostringstream   stringStream;  
-                std::string          blockHash;
-                std::string          parentBlockHash ;
-
-                m_nodeStats->extHeadersReceivedBytes += 1;//fullBlock
-                if (!d["blocks"][j]["fullBlock"].GetBool())
-                  m_nodeStats->extHeadersReceivedBytes += d["blocks"][j]["availableChunks"].Size();
-			  
-                stringStream << height << "/" << minerId;
-                blockHash = stringStream.str();
-                Block newBlockHeaders(d["blocks"][j]["height"].GetInt(), d["blocks"][j]["minerId"].GetInt(), d["blocks"][j]["parentBlockMinerId"].GetInt(), 
-                                                         d["blocks"][j]["size"].GetInt(), d["blocks"][j]["timeCreated"].GetDouble(), 
-                                                         Simulator::Now ().GetSeconds (), InetSocketAddress::ConvertFrom(from).GetIpv4 ());
-                if (!OnlyHeadersReceived(blockHash))														 
-                {
-                  m_onlyHeadersReceived[blockHash] = Block (d["blocks"][j]["height"].GetInt(), d["blocks"][j]["minerId"].GetInt(), d["blocks"][j]["parentBlockMinerId"].GetInt(), 
-                                                            d["blocks"][j]["size"].GetInt(), d["blocks"][j]["timeCreated"].GetDouble(), 
-                                                            Simulator::Now ().GetSeconds (), InetSocketAddress::ConvertFrom(from).GetIpv4 ());
-                }
-                //PrintOnlyHeadersReceived();
-				
-                stringStream.clear();
-                stringStream.str("");
-				
-                stringStream << parentHeight << "/" << parentMinerId;
-                parentBlockHash = stringStream.str();
+        EventId              timeout;
+        BlockId              blockId (height, minerId);
+        BlockId              parentBlockId (parentHeight, parentMinerId);
+
+        m_nodeStats->extHeadersReceivedBytes[m_nodeId] += 1;//fullBlock
+        if (!d["blocks"][j]["fullBlock"].GetBool())
+          m_nodeStats->extHeadersReceivedBytes[m_nodeId] += d["blocks"][j]["availableChunks"].Size();
+
+        if (!OnlyHeadersReceived(blockId))														 
+        {
+          m_onlyHeadersReceived[blockId] = Block (d["blocks"][j]["height"].GetInt(), d["blocks"][j]["minerId"].GetInt(), d["blocks"][j]["parentBlockMinerId"].GetInt(), 
+                                                    d["blocks"][j]["size"].GetInt(), d["blocks"][j]["timeCreated"].GetDouble(), 
+                                                    Simulator::Now ().GetSeconds (), InetSocketAddress::ConvertFrom(from).GetIpv4 ());
+        }
+        //PrintOnlyHeadersReceived();
 				
-                if(!m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockHash))
-                {
-/*                   NS_LOG_INFO("We have not received an INV for the block with height = " << d["blocks"][j]["height"].GetInt() 
-                               << " and minerId = " << d["blocks"][j]["minerId"].GetInt()); */
+        if(!m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockId))
+        {
+/*                   BITCOIN_MESSAGE_LOG_INFO("We have not received an INV for the block with height = " << d["blocks"][j]["height"].GetInt() 
+                       << " and minerId = " << d["blocks"][j]["minerId"].GetInt()); */
 							   
-                  NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId () 
-                              << " does not have the block with height = " 
-                              << height << " and minerId = " << minerId);
+          BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId () 
+                      << " does not have the block with height = " 
+                      << height << " and minerId = " << minerId);
 				  
-                  if (m_queueChunks.find(blockHash) == m_queueChunks.end())
-                  {
-                    NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                << " does not have an entry in m_queueChunks");			       
-                    for (int i = 0; i < ceil(blockSize/static_cast<double>(m_chunkSize)); i++)
-                      m_queueChunks[blockHash].push_back(i);
-                  }
-                  //PrintQueueChunks();
+          if (m_queueChunks.find(blockId) == m_queueChunks.end())
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                        << " does not have an entry in m_queueChunks");			       
+            for (int i = 0; i < ceil(blockSize/static_cast<double>(m_chunkSize)); i++)
+              m_queueChunks[blockId].push_back(i);
+          }
+          //PrintQueueChunks();
 				  
 				  
-                  /**
-                   * Check if we have already requested all the chunks
-                   */
+          /**
+           * Check if we have already requested all the chunks
+           */
 				   
-                  if (m_queueChunks[blockHash].size() > 0)
-                  {
-                    NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has not requested all the chunks yet");
+          if (m_queueChunks[blockId].size() > 0)
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has not requested all the chunks yet");
 
 								 
-                    std::vector<int> candidateChunks;
-                    if (d["blocks"][j]["fullBlock"].GetBool())
-                    {
-                      for (auto &chunk : m_queueChunks[blockHash])
-                        candidateChunks.push_back(chunk);
-                    }
-                    else
-                    {
-                      for (int k = 0; k < d["blocks"][j]["availableChunks"].Size(); k++)
-                      {
-                        if (std::find(m_queueChunks[blockHash].begin(), m_queueChunks[blockHash].end(), d["blocks"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockHash].end())
-                          candidateChunks.push_back(d["blocks"][j]["availableChunks"][k].GetInt());
-                      }
-                    }
+            std::vector<int> candidateChunks;
+            if (d["blocks"][j]["fullBlock"].GetBool())
+            {
+              for (auto &chunk : m_queueChunks[blockId])
+                candidateChunks.push_back(chunk);
+            }
+            else
+            {
+              for (int k = 0; k < d["blocks"][j]["availableChunks"].Size(); k++)
+              {
+                if (std::find(m_queueChunks[blockId].begin(), m_queueChunks[blockId].end(), d["blocks"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockId].end())
+                  candidateChunks.push_back(d["blocks"][j]["availableChunks"][k].GetInt());
+              }
+            }
 					
 /*                     std::cout << "candidateChunks = ";
-                    for (auto chunk : candidateChunks)
-                      std::cout << chunk << ", ";
-                    std::cout << "\n"; */
-
-                    if (candidateChunks.size() > 0 && 
-                        std::find(m_queueChunkPeers[blockHash].begin(), m_queueChunkPeers[blockHash].end(), from) == m_queueChunkPeers[blockHash].end())
-                    {
-                      int randomIndex = rand() % candidateChunks.size();
-                      NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                  << " will request the chunk with index = " << randomIndex << " and value = " << candidateChunks[randomIndex]);	
-                      m_queueChunks[blockHash].erase(std::remove(m_queueChunks[blockHash].begin(),
-                                                                 m_queueChunks[blockHash].end(), candidateChunks[randomIndex]),
-                                                                 m_queueChunks[blockHash].end());
+            for (auto chunk : candidateChunks)
+              std::cout << chunk << ", ";
+            std::cout << "\n"; */
+
+            if (candidateChunks.size() > 0 && 
+                std::find(m_queueChunkPeers[blockId].begin(), m_queueChunkPeers[blockId].end(), from) == m_queueChunkPeers[blockId].end())
+            {
+              int randomIndex = m_peerSelectionStream.GetInteger(candidateChunks.size());
+              BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                          << " will request the chunk with index = " << randomIndex << " and value = " << candidateChunks[randomIndex]);	
+              m_queueChunks[blockId].erase(std::remove(m_queueChunks[blockId].begin(),
+                                                         m_queueChunks[blockId].end(), candidateChunks[randomIndex]),
+                                                         m_queueChunks[blockId].end());
 																		  
-                      std::ostringstream chunk;
-                      chunk << blockHash << "/" << candidateChunks[randomIndex];
-                      requestChunks.push_back(chunk.str());
+              ChunkId chunk (blockId, candidateChunks[randomIndex]);
+              requestChunks.push_back(chunk);
 					  
-                      timeout = Simulator::Schedule (Minutes(m_invTimeoutMinutes.GetMinutes() / ceil(blockSize/static_cast<double>(m_chunkSize))),
-                                                     &BitcoinNode::ChunkTimeoutExpired, this, chunk.str());
+              timeout = Simulator::Schedule (Minutes(m_invTimeoutMinutes.GetMinutes() / ceil(blockSize/static_cast<double>(m_chunkSize))),
+                                             &BitcoinNode::ChunkTimeoutExpired, this, chunk);
 													 
-                      m_chunkTimeouts[chunk.str()] = timeout;
-                      m_queueChunkPeers[blockHash].push_back(from);
-                    }
-                    else
-                    {
-                      if (std::find(m_queueChunkPeers[blockHash].begin(), m_queueChunkPeers[blockHash].end(), from) == m_queueChunkPeers[blockHash].end())
-                        NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                    << " will not request any chunks from this peer, because it has already all the available ones");
-                      else								 
-                        NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                     << " has already requested a chunk from this peer");
-
-                    }
+              m_chunkTimeouts[chunk] = timeout;
+              m_queueChunkPeers[blockId].push_back(from);
+            }
+            else
+            {
+              if (std::find(m_queueChunkPeers[blockId].begin(), m_queueChunkPeers[blockId].end(), from) == m_queueChunkPeers[blockId].end())
+                BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                            << " will not request any chunks from this peer, because it has already all the available ones");
+              else								 
+                BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                             << " has already requested a chunk from this peer");
+
+            }
 					
 /*                     PrintQueueChunks();
-                    PrintChunkTimeouts();
-                    PrintQueueChunkPeers();
-                    PrintReceivedChunks(); */
-                  }
-                  else
-                  {
-                    NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has already requested a chunk from this peer");
-                  }
+            PrintChunkTimeouts();
+            PrintQueueChunkPeers();
+            PrintReceivedChunks(); */
+          }
+          else
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has already requested a chunk from this peer");
+          }
 				  
-                }
-                else
-                {
-                  /**
-                   * Block is not orphan, so we can go on validating
-                   */
-                  NS_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
-                              << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
-                              << " has already been received\n");			   
-                }
+        }
+        else
+        {
+          /**
+           * Block is not orphan, so we can go on validating
+           */
+          BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
+                      << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
+                      << " has already been received\n");			   
+        }
 				
-                if (!m_blockchain.HasBlock(parentHeight, parentMinerId) && !m_blockchain.IsOrphan(parentHeight, parentMinerId) && !ReceivedButNotValidated(parentBlockHash))
-                {				  
-                  NS_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
-                               << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
-                               << " is an orphan\n");
+        if (!m_blockchain.HasBlock(parentHeight, parentMinerId) && !m_blockchain.IsOrphan(parentHeight, parentMinerId) && !ReceivedButNotValidated(parentBlockId))
+        {				  
+          BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
+                       << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
+                       << " is an orphan\n");
 				  
-                  /**
-                   * Acquire parent
-                   */
+          /**
+           * Acquire parent
+           */
 	  
-                  if (m_queueChunks.find(parentBlockHash) == m_queueChunks.end() || 
-                      std::find(m_queueChunkPeers[parentBlockHash].begin(), m_queueChunkPeers[parentBlockHash].end(), from) == m_queueChunkPeers[parentBlockHash].end())
-                  {
-                    NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has not requested parent block chunks from this peer yet");
-                      requestHeaders.push_back(parentBlockHash.c_str());
-                  }
-                  else
-                  {
-                    NS_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
-                                 << " has already requested the block");
-                  }
+          if (m_queueChunks.find(parentBlockId) == m_queueChunks.end() || 
+              std::find(m_queueChunkPeers[parentBlockId].begin(), m_queueChunkPeers[parentBlockId].end(), from) == m_queueChunkPeers[parentBlockId].end())
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has not requested parent block chunks from this peer yet");
+              requestHeaders.push_back(parentBlockId);
+          }
+          else
+          {
+            BITCOIN_MESSAGE_LOG_INFO("EXT_HEADERS: Bitcoin node " << GetNode ()->GetId ()
+                         << " has already requested the block");
+          }
 				  
-                  if(m_protocolType == STANDARD_PROTOCOL || 
-                    (m_protocolType == SENDHEADERS && std::find(requestChunks.begin(), requestChunks.end(), parentBlockHash) == requestChunks.end()))
-                    m_queueInv[parentBlockHash].push_back(from); 
+          if(m_protocolType == STANDARD_PROTOCOL || 
+            (m_protocolType == SENDHEADERS && std::find_if(requestChunks.begin(), requestChunks.end(),
+                                                           [&parentBlockId](const ChunkId &chunk) { return chunk.GetBlockId() == parentBlockId; }) == requestChunks.end()))
+            m_queueInv[parentBlockId].push_back(from); 
 
-                  //PrintQueueInv();
-                  //PrintInvTimeouts();
+          //PrintQueueInv();
+          //PrintInvTimeouts();
 				  
-                }
-                else
-                {
-                  /**
-	               * Block is not orphan, so we can go on validating
-	               */
-                  NS_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
-                              << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
-                              << " is NOT an orphan\n");			   
-                }
-              }
+        }
+        else
+        {
+          /**
+           * Block is not orphan, so we can go on validating
+           */
+          BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
+                      << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
+                      << " is NOT an orphan\n");			   
+        }
+      }
 			  
-              if (!requestHeaders.empty())
-              {
-                rapidjson::Value   value;
-                rapidjson::Value   array(rapidjson::kArrayType);
-                Time               timeout;
+      if (!requestHeaders.empty())
+      {
+        rapidjson::Value   value;
+        rapidjson::Value   array(rapidjson::kArrayType);
+        Time               timeout;
 
-                d.RemoveMember("blocks");
+        d.RemoveMember("blocks");
 
-                for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
-                {
-                  value.SetString(block_it->c_str(), block_it->size(), d.GetAllocator());
-                  array.PushBack(value, d.GetAllocator());
-                }		
+        for (block_it = requestHeaders.begin(); block_it < requestHeaders.end(); block_it++) 
+        {
+          std::string blockHash = block_it->ToString();
+          value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
+          array.PushBack(value, d.GetAllocator());
+        }		
 			  
-                d.AddMember("blocks", array, d.GetAllocator());
+        d.AddMember("blocks", array, d.GetAllocator());
 
 					
-                SendMessage(EXT_HEADERS, EXT_GET_HEADERS, d, from);			
-              }
+        SendMessage(EXT_HEADERS, EXT_GET_HEADERS, d, from);			
+      }
 			  
-              if (!requestChunks.empty())
-              {
-                rapidjson::Value   value;
-                rapidjson::Value   chunkArray(rapidjson::kArrayType);
-                rapidjson::Value   availableChunks(rapidjson::kArrayType);
-                rapidjson::Value   chunkInfo(rapidjson::kObjectType);
+      if (!requestChunks.empty())
+      {
+        rapidjson::Value   value;
+        rapidjson::Value   chunkArray(rapidjson::kArrayType);
+        rapidjson::Value   availableChunks(rapidjson::kArrayType);
+        rapidjson::Value   chunkInfo(rapidjson::kObjectType);
 
-                d.RemoveMember("type");
-                d.RemoveMember("blocks");
+        d.RemoveMember("type");
+        d.RemoveMember("blocks");
 				
-                value.SetString("chunk");	
-                d.AddMember("type", value, d.GetAllocator());
+        value.SetString("chunk");	
+        d.AddMember("type", value, d.GetAllocator());
 				
-                for (auto chunk_it = requestChunks.begin(); chunk_it < requestChunks.end(); chunk_it++) 
-                {
+        for (auto chunk_it = requestChunks.begin(); chunk_it < requestChunks.end(); chunk_it++) 
+        {
 					
-                  std::string            invDelimiter = "/";
-                  std::string            chunkHash = *chunk_it;
-                  std::string            chunkHashHelp = chunkHash.substr(0);
-                  std::ostringstream     help;
-                  std::string            blockHash;
-                  size_t                 invPos = chunkHashHelp.find(invDelimiter);
-				  
-                  int height = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-                  chunkHashHelp.erase(0, invPos + invDelimiter.length());
-                  invPos = chunkHashHelp.find(invDelimiter);
-                  int minerId = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-                  chunkHashHelp.erase(0, invPos + invDelimiter.length());
-                  int chunkId = atoi(chunkHashHelp.substr(0).c_str());
-                  help << height << "/" << minerId;
-                  blockHash = help.str();
+          std::string            chunkHash = chunk_it->ToString();
+          BlockId                blockId = chunk_it->GetBlockId();
 				
-                  if (m_receivedChunks.find(blockHash) != m_receivedChunks.end())
-                  {
-                    for ( auto k : m_receivedChunks[blockHash])
-                    {
-                      value = k;
-                      availableChunks.PushBack(value, d.GetAllocator());
-                    }
-                  }
-                  chunkInfo.AddMember("availableChunks", availableChunks, d.GetAllocator());
+          if (m_receivedChunks.find(blockId) != m_receivedChunks.end())
+          {
+            for ( auto k : m_receivedChunks[blockId])
+            {
+              value = k;
+              availableChunks.PushBack(value, d.GetAllocator());
+            }
+          }
+          chunkInfo.AddMember("availableChunks", availableChunks, d.GetAllocator());
 				  
-                  value = false;
-                  chunkInfo.AddMember("fullBlock", value, d.GetAllocator());
+          value = false;
+          chunkInfo.AddMember("fullBlock", value, d.GetAllocator());
 				  
-                  value.SetString(chunk_it->c_str(), chunk_it->size(), d.GetAllocator());
-                  chunkInfo.AddMember("chunk", value, d.GetAllocator());
+          value.SetString(chunkHash.c_str(), chunkHash.size(), d.GetAllocator());
+          chunkInfo.AddMember("chunk", value, d.GetAllocator());
 				  
-                  chunkArray.PushBack(chunkInfo, d.GetAllocator());
-                }		
-                d.AddMember("chunks", chunkArray, d.GetAllocator());
+          chunkArray.PushBack(chunkInfo, d.GetAllocator());
+        }		
+        d.AddMember("chunks", chunkArray, d.GetAllocator());
 				
-                SendMessage(EXT_HEADERS, EXT_GET_DATA, d, from);	
+        SendMessage(EXT_HEADERS, EXT_GET_DATA, d, from);	
 	
-              }
-              break;
-            }
-            case BLOCK:
-            {
-              NS_LOG_INFO ("BLOCK");
-              int blockMessageSize = 0;
-              double receiveTime = 0;
-              double eventTime = 0;
-              double minSpeed = std::min(m_downloadSpeed, m_peersUploadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] * 1000000 / 8);
+      }
+      break;
+    }
+    case BLOCK:
+    {
+      BITCOIN_MESSAGE_LOG_INFO ("BLOCK");
+      int blockMessageSize = 0;
+      double peerUploadSpeed = m_peersUploadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] * 1000000 / 8;
 			  
-              std::string blockType = d["type"].GetString();
+      std::string blockType = d["type"].GetString();
 			  
-              blockMessageSize += m_bitcoinMessageHeader;
-
-              for (int j=0; j<d["blocks"].Size(); j++)
-              {  
-                if (blockType == "block")
-                  blockMessageSize += d["blocks"][j]["size"].GetInt();
-                else if (blockType == "compressed-block")
-                {
-                  int    noTransactions = static_cast<int>((d["blocks"][j]["size"].GetInt() - m_blockHeadersSizeBytes)/m_averageTransactionSize);
-                  long   blockSize = m_blockHeadersSizeBytes + m_transactionIndexSize*noTransactions;
-                  blockMessageSize += blockSize;
-                }
-              }
+      blockMessageSize += m_bitcoinMessageHeader;
 
-              m_nodeStats->blockReceivedBytes += blockMessageSize;
+      for (int j=0; j<d["blocks"].Size(); j++)
+      {  
+        if (blockType == "block")
+          blockMessageSize += d["blocks"][j]["size"].GetInt();
+        else if (blockType == "compressed-block")
+        {
+          int    noTransactions = static_cast<int>((d["blocks"][j]["size"].GetInt() - m_blockHeadersSizeBytes)/m_averageTransactionSize);
+          long   blockSize = m_blockHeadersSizeBytes + m_transactionIndexSize*noTransactions;
+          blockMessageSize += blockSize;
+        }
+      }
+
+      m_nodeStats->blockReceivedBytes[m_nodeId] += blockMessageSize;
               
-              // Stringify the DOM
-              rapidjson::StringBuffer blockInfo;
-              rapidjson::Writer<rapidjson::StringBuffer> blockWriter(blockInfo);
-              d.Accept(blockWriter);
-			  
-  
-              NS_LOG_INFO("BLOCK: At time " << Simulator::Now ().GetSeconds () 
-                          << " Node " << GetNode()->GetId() << " received a block message " << blockInfo.GetString());
-              NS_LOG_INFO(m_downloadSpeed << " " << m_peersUploadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] * 1000000 / 8 << " " << minSpeed);
-			  
-              std::string help = blockInfo.GetString();
+      BITCOIN_MESSAGE_LOG_INFO("BLOCK: At time " << Simulator::Now ().GetSeconds () 
+                  << " Node " << GetNode()->GetId() << " received a block message " << MessageToString(d));
+      BITCOIN_MESSAGE_LOG_INFO(m_downloadSpeed << " " << peerUploadSpeed);
 			  
-              if (blockType == "block")
-              {
-                if (m_receiveBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_receiveBlockTimes.back())
-                {
-                  receiveTime = blockMessageSize / m_downloadSpeed; 
-                  eventTime = blockMessageSize / minSpeed;
-                }
-                else
-                {
-                  receiveTime = blockMessageSize / m_downloadSpeed + m_receiveBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-                  eventTime = blockMessageSize / minSpeed + m_receiveBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-                }
-                m_receiveBlockTimes.push_back(Simulator::Now ().GetSeconds() + receiveTime);
+      std::string help (frame, frameSize);
 			  
-
-                Simulator::Schedule (Seconds(eventTime), &BitcoinNode::ReceivedBlockMessage, this, help, from);
-                Simulator::Schedule (Seconds(receiveTime), &BitcoinNode::RemoveReceiveTime, this);
-              }
-              else if (blockType == "compressed-block")
-              {
-                if (m_receiveCompressedBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_receiveCompressedBlockTimes.back())
-                {
-                  receiveTime = blockMessageSize / m_downloadSpeed; 
-                  eventTime = blockMessageSize / minSpeed;
-                }
-                else
-                {
-                  receiveTime = blockMessageSize / m_downloadSpeed + m_receiveCompressedBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-                  eventTime = blockMessageSize / minSpeed + m_receiveCompressedBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-                }
-                m_receiveCompressedBlockTimes.push_back(Simulator::Now ().GetSeconds() + receiveTime);
+      if (blockType == "block")
+        m_downloadLink.Enqueue (InetSocketAddress::ConvertFrom(from).GetIpv4 (), blockMessageSize, peerUploadSpeed, LinkScheduler::TransferHandler (),
+                                std::bind (&BitcoinNode::ReceivedBlockMessage, this, help, from));
+      else if (blockType == "compressed-block")
+        m_compressedDownloadLink.Enqueue (InetSocketAddress::ConvertFrom(from).GetIpv4 (), blockMessageSize, peerUploadSpeed, LinkScheduler::TransferHandler (),
+                                          std::bind (&BitcoinNode::ReceivedBlockMessage, this, help, from));
 			  
+      BITCOIN_MESSAGE_LOG_INFO("BLOCK:  Node " << GetNode()->GetId() << " queued the " << blockType << " message");
 
-                Simulator::Schedule (Seconds(eventTime), &BitcoinNode::ReceivedBlockMessage, this, help, from);
-                Simulator::Schedule (Seconds(receiveTime), &BitcoinNode::RemoveCompressedBlockReceiveTime, this);
-              }
-			  
-              NS_LOG_INFO("BLOCK:  Node " << GetNode()->GetId() << " will receive the full block message at " << Simulator::Now ().GetSeconds() + eventTime);
+      break;
+    }
+    case CHUNK:
+    {
+      BITCOIN_MESSAGE_LOG_INFO ("CHUNK");
+      int chunkMessageSize = 0;
+      double peerUploadSpeed = m_peersUploadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] * 1000000 / 8;
 
-              break;
-            }
-            case CHUNK:
-            {
-              NS_LOG_INFO ("CHUNK");
-              int chunkMessageSize = 0;
-              double receiveTime = 0;
-              double eventTime = 0;
-              double minSpeed = std::min(m_downloadSpeed, m_peersUploadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] * 1000000 / 8);
-
-              chunkMessageSize += m_bitcoinMessageHeader;
-              for (int j=0; j<d["chunks"].Size(); j++)
-              {  
-                int noChunks = ceil(d["chunks"][j]["size"].GetInt() / static_cast<double>(m_chunkSize));
-                if (d["chunks"][j]["chunk"] == noChunks -1 && d["chunks"][j]["size"].GetInt() % m_chunkSize > 0)
-                  chunkMessageSize += d["chunks"][j]["size"].GetInt() % m_chunkSize;
-                else
-                  chunkMessageSize += m_chunkSize;
-			  
-                m_nodeStats->chunkReceivedBytes += chunkMessageSize + 1 + 1;//the requested chunk + the fullBlock
-                if (!d["chunks"][j]["fullBlock"].GetBool())
-                  m_nodeStats->chunkReceivedBytes += d["chunks"][j]["availableChunks"].Size();
-                if (d["chunks"][j]["requestChunks"].Size() > 0)
-                  m_nodeStats->chunkReceivedBytes += d["chunks"][j]["requestChunks"].Size() - 1;
-              }
+      chunkMessageSize += m_bitcoinMessageHeader;
+      for (int j=0; j<d["chunks"].Size(); j++)
+      {  
+        int noChunks = ceil(d["chunks"][j]["size"].GetInt() / static_cast<double>(m_chunkSize));
+        if (d["chunks"][j]["chunk"] == noChunks -1 && d["chunks"][j]["size"].GetInt() % m_chunkSize > 0)
+          chunkMessageSize += d["chunks"][j]["size"].GetInt() % m_chunkSize;
+        else
+          chunkMessageSize += m_chunkSize;
 			  
-              // Stringify the DOM
-              rapidjson::StringBuffer chunkInfo;
-              rapidjson::Writer<rapidjson::StringBuffer> blockWriter(chunkInfo);
-              d.Accept(blockWriter);
+        m_nodeStats->chunkReceivedBytes[m_nodeId] += chunkMessageSize + 1 + 1;//the requested chunk + the fullBlock
+        if (!d["chunks"][j]["fullBlock"].GetBool())
+          m_nodeStats->chunkReceivedBytes[m_nodeId] += d["chunks"][j]["availableChunks"].Size();
+        if (d["chunks"][j]["requestChunks"].Size() > 0)
+          m_nodeStats->chunkReceivedBytes[m_nodeId] += d["chunks"][j]["requestChunks"].Size() - 1;
+      }
 			  
-  
-              NS_LOG_INFO("CHUNK: At time " << Simulator::Now ().GetSeconds () 
-                          << " Node " << GetNode()->GetId() << " received a chunk message " << chunkInfo.GetString());
+      BITCOIN_MESSAGE_LOG_INFO("CHUNK: At time " << Simulator::Now ().GetSeconds () 
+                  << " Node " << GetNode()->GetId() << " received a chunk message " << MessageToString(d));
 						  
-              std::string help = chunkInfo.GetString();
-              if (m_receiveBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_receiveBlockTimes.back())
-              {
-                receiveTime = chunkMessageSize / m_downloadSpeed; 
-                eventTime = chunkMessageSize / minSpeed; 
-              }
-              else
-              {
-                receiveTime = chunkMessageSize / m_downloadSpeed + m_receiveBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-                eventTime = chunkMessageSize / minSpeed + m_receiveBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-              }
-              m_receiveBlockTimes.push_back(Simulator::Now ().GetSeconds() + receiveTime);
-			  
-              NS_LOG_INFO("CHUNK:  Node " << GetNode()->GetId() << " will receive the full chunk message at " << Simulator::Now ().GetSeconds() + eventTime);
-              Simulator::Schedule (Seconds(eventTime), &BitcoinNode::ReceivedChunkMessage, this, help, from);
-              Simulator::Schedule (Seconds(receiveTime), &BitcoinNode::RemoveReceiveTime, this);
+      std::string help (frame, frameSize);
+      BITCOIN_MESSAGE_LOG_INFO("CHUNK:  Node " << GetNode()->GetId() << " queued the chunk message");
+      m_downloadLink.Enqueue (InetSocketAddress::ConvertFrom(from).GetIpv4 (), chunkMessageSize, peerUploadSpeed, LinkScheduler::TransferHandler (),
+                              std::bind (&BitcoinNode::ReceivedChunkMessage, this, help, from));
 
-              break;
-            }
-            default:
-              NS_LOG_INFO ("Default");
-              break;
-          }
-			
-          totalReceivedData.erase(0, pos + delimiter.length());
-        }
-		
-        /**
-        * Buffer the remaining data
-        */
-		 
-        m_bufferedData[from] = totalReceivedData;
-        delete[] packetInfo;
-      }
-      else if (Inet6SocketAddress::IsMatchingType (from))
-      {
-        NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
-                     << "s bitcoin node " << GetNode ()->GetId () << " received "
-                     <<  packet->GetSize () << " bytes from "
-                     << Inet6SocketAddress::ConvertFrom(from).GetIpv6 ()
-                     << " port " << Inet6SocketAddress::ConvertFrom (from).GetPort ());
-      }
-      m_rxTrace (packet, from);
+      break;
+    }
+    default:
+      BITCOIN_MESSAGE_LOG_INFO ("Default");
+      break;
   }
+
+  UpdateNetworkState();
 }
 
 
 void 
 BitcoinNode::ReceivedBlockMessage(std::string &blockInfo, Address &from) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
 
   rapidjson::Document d;
-  d.Parse(blockInfo.c_str());
+  DecodeMessage(blockInfo, m_messageCodec, d);
   
-  NS_LOG_INFO("ReceivedBlockMessage: At time " << Simulator::Now ().GetSeconds () 
-              << " Node " << GetNode()->GetId() << " received a block message " << blockInfo);
+  BITCOIN_MESSAGE_LOG_INFO("ReceivedBlockMessage: At time " << Simulator::Now ().GetSeconds () 
+              << " Node " << GetNode()->GetId() << " received a block message " << MessageToString(d));
 
-  //m_receiveBlockTimes.erase(m_receiveBlockTimes.begin());	
   
   for (int j=0; j<d["blocks"].Size(); j++)
   {  
@@ -1848,38 +1851,28 @@ BitcoinNode::ReceivedBlockMessage(std::string &blockInfo, Address &from)
 				
 
     EventId              timeout;
-    std::ostringstream   stringStream;  
-    std::string          blockHash;
-    std::string          parentBlockHash;
-				
-    stringStream << height << "/" << minerId;
-    blockHash = stringStream.str();
-
-    if (m_onlyHeadersReceived.find(blockHash) != m_onlyHeadersReceived.end())
-      m_onlyHeadersReceived.erase(blockHash);
-    if (m_queueChunkPeers.find(blockHash) != m_queueChunkPeers.end())
-      m_queueChunkPeers.erase (blockHash);	 
-    if (m_queueChunks.find(blockHash) != m_queueChunks.end())
-      m_queueChunks.erase (blockHash);
-    if (m_receivedChunks.find(blockHash) != m_receivedChunks.end())
-      m_receivedChunks.erase (blockHash);
-	  
-    stringStream.clear();
-    stringStream.str("");
-				
-    stringStream << parentHeight << "/" << parentMinerId;
-    parentBlockHash = stringStream.str();
+    BlockId              blockId (height, minerId);
+    BlockId              parentBlockId (parentHeight, parentMinerId);
+
+    if (m_onlyHeadersReceived.find(blockId) != m_onlyHeadersReceived.end())
+      m_onlyHeadersReceived.erase(blockId);
+    if (m_queueChunkPeers.find(blockId) != m_queueChunkPeers.end())
+      m_queueChunkPeers.erase (blockId);	 
+    if (m_queueChunks.find(blockId) != m_queueChunks.end())
+      m_queueChunks.erase (blockId);
+    if (m_receivedChunks.find(blockId) != m_receivedChunks.end())
+      m_receivedChunks.erase (blockId);
 				
     if (!m_blockchain.HasBlock(parentHeight, parentMinerId) && !m_blockchain.IsOrphan(parentHeight, parentMinerId) 
-        && !ReceivedButNotValidated(parentBlockHash) && !OnlyHeadersReceived(parentBlockHash))
+        && !ReceivedButNotValidated(parentBlockId) && !OnlyHeadersReceived(parentBlockId))
     {				  
-      NS_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
+      BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["blocks"][j]["height"].GetInt() 
                  << " and minerId = " << d["blocks"][j]["minerId"].GetInt() 
                  << " is an orphan, so it will be discarded\n");
 							   
-      m_queueInv.erase(blockHash);
-      Simulator::Cancel (m_invTimeouts[blockHash]);
-      m_invTimeouts.erase(blockHash);
+      m_queueInv.erase(blockId);
+      Simulator::Cancel (m_invTimeouts[blockId]);
+      m_invTimeouts.erase(blockId);
     }
     else
     {
@@ -1890,23 +1883,24 @@ BitcoinNode::ReceivedBlockMessage(std::string &blockInfo, Address &from)
       ReceiveBlock (newBlock);
     }
   }
+
+  UpdateNetworkState();
 }
 
 
 void 
 BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
   
   rapidjson::Document d;
-  d.Parse(chunkInfo.c_str());
+  DecodeMessage(chunkInfo, m_messageCodec, d);
   
-  NS_LOG_INFO ("ReceivedChunkMessage: At time " << Simulator::Now ().GetSeconds ()
-               << "s bitcoin node " << GetNode ()->GetId () << " received a  message " << chunkInfo);
+  BITCOIN_MESSAGE_LOG_INFO ("ReceivedChunkMessage: At time " << Simulator::Now ().GetSeconds ()
+               << "s bitcoin node " << GetNode ()->GetId () << " received a  message " << MessageToString(d));
 			
-  //m_receiveBlockTimes.erase(m_receiveBlockTimes.begin());	
 
-  std::vector<std::string>                    getDataMessages;
+  std::vector<ChunkId>                        getDataMessages;
   std::map<BitcoinChunk, std::vector<int>>    chunkMessages;
   int totalChunkMessageSize = 0;
 			  
@@ -1919,26 +1913,11 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
     int chunkId = d["chunks"][j]["chunk"].GetInt();
 
     EventId              timeout;
-    std::ostringstream   stringStream;  
-    std::string          blockHash;
-    std::string          chunkHash;
-    std::string          parentBlockHash;
+    BlockId              blockId (height, minerId);
+    ChunkId              receivedChunk (blockId, chunkId);
+    BlockId              parentBlockId (parentHeight, parentMinerId);
     std::string          blockType;
     std::vector<int>     candidateChunks;
-
-    stringStream << height << "/" << minerId;
-    blockHash = stringStream.str();
-
-		
-    stringStream.clear();
-    stringStream.str("");
-    stringStream << parentHeight << "/" << parentMinerId;
-    parentBlockHash = stringStream.str();
-
-    stringStream.clear();
-    stringStream.str("");
-    stringStream << height << "/" << minerId << "/" << chunkId;
-    chunkHash = stringStream.str();
 				
     blockType = d["type"].GetString();
 
@@ -1948,44 +1927,44 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
     PrintReceivedChunks();
     PrintOnlyHeadersReceived(); */
 
-    if (m_chunkTimeouts.find(chunkHash) != m_chunkTimeouts.end())
+    if (m_chunkTimeouts.find(receivedChunk) != m_chunkTimeouts.end())
     {
-      Simulator::Cancel (m_chunkTimeouts[chunkHash]);
-      m_chunkTimeouts.erase(chunkHash);
+      Simulator::Cancel (m_chunkTimeouts[receivedChunk]);
+      m_chunkTimeouts.erase(receivedChunk);
     }
 
 	
-    if (!m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockHash))
+    if (!m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockId))
     {
-      auto it = std::find(m_queueChunkPeers[blockHash].begin(), m_queueChunkPeers[blockHash].end(), from);
-      if(it !=  m_queueChunkPeers[blockHash].end())
-        m_queueChunkPeers[blockHash].erase(it);
+      auto it = std::find(m_queueChunkPeers[blockId].begin(), m_queueChunkPeers[blockId].end(), from);
+      if(it !=  m_queueChunkPeers[blockId].end())
+        m_queueChunkPeers[blockId].erase(it);
 		
-      auto it2 = std::find(m_queueChunks[blockHash].begin(), m_queueChunks[blockHash].end(), chunkId);
-      if(it2 !=  m_queueChunks[blockHash].end())
-        m_queueChunks[blockHash].erase(it2);
+      auto it2 = std::find(m_queueChunks[blockId].begin(), m_queueChunks[blockId].end(), chunkId);
+      if(it2 !=  m_queueChunks[blockId].end())
+        m_queueChunks[blockId].erase(it2);
 	
-      if(std::find(m_receivedChunks[blockHash].begin(), m_receivedChunks[blockHash].end(), chunkId) == m_receivedChunks[blockHash].end())
+      if(std::find(m_receivedChunks[blockId].begin(), m_receivedChunks[blockId].end(), chunkId) == m_receivedChunks[blockId].end())
       {
-        m_receivedChunks[blockHash].push_back(chunkId);
+        m_receivedChunks[blockId].push_back(chunkId);
 				  
-        if (m_receivedChunks[blockHash].size() == 1 && m_spv)
+        if (m_receivedChunks[blockId].size() == 1 && m_spv)
           AdvertiseFirstChunk (Block (d["chunks"][j]["height"].GetInt(), d["chunks"][j]["minerId"].GetInt(), d["chunks"][j]["parentBlockMinerId"].GetInt(), 
                                       d["chunks"][j]["size"].GetInt(), d["chunks"][j]["timeCreated"].GetDouble(), 
                                       Simulator::Now ().GetSeconds (), InetSocketAddress::ConvertFrom(from).GetIpv4 ()));
 				
-        if (m_receivedChunks[blockHash].size() == ceil(d["chunks"][j]["size"].GetInt()/static_cast<double>(m_chunkSize)))
+        if (m_receivedChunks[blockId].size() == ceil(d["chunks"][j]["size"].GetInt()/static_cast<double>(m_chunkSize)))
         {
           if (!m_blockchain.HasBlock(parentHeight, parentMinerId) && !m_blockchain.IsOrphan(parentHeight, parentMinerId)
-              && !ReceivedButNotValidated(parentBlockHash) && !OnlyHeadersReceived(parentBlockHash))
+              && !ReceivedButNotValidated(parentBlockId) && !OnlyHeadersReceived(parentBlockId))
           {				  
-            NS_LOG_INFO("The Block with height = " << d["chunks"][j]["height"].GetInt() 
+            BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["chunks"][j]["height"].GetInt() 
                         << " and minerId = " << d["chunks"][j]["minerId"].GetInt() 
                         << " is an orphan, so it will be discarded\n");
           }
           else
           {
-            NS_LOG_INFO("The Block with height = " << d["chunks"][j]["height"].GetInt() 
+            BITCOIN_MESSAGE_LOG_INFO("The Block with height = " << d["chunks"][j]["height"].GetInt() 
                         << " and minerId = " << d["chunks"][j]["minerId"].GetInt() 
                         << " is a new valid block\n");
 								   
@@ -2005,23 +1984,23 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
             chunkMessages[newChunk].push_back(d["chunks"][j]["requestChunks"][ii].GetInt());
           }
 		
-          m_onlyHeadersReceived.erase(blockHash);              
-          m_queueChunkPeers.erase (blockHash);	 
-          m_queueChunks.erase (blockHash);
-          m_receivedChunks.erase (blockHash);
+          m_onlyHeadersReceived.erase(blockId);              
+          m_queueChunkPeers.erase (blockId);	 
+          m_queueChunks.erase (blockId);
+          m_receivedChunks.erase (blockId);
         }
         else
         {
           if (d["chunks"][j]["fullBlock"].GetBool())
           {
-            for (auto &chunk : m_queueChunks[blockHash])
+            for (auto &chunk : m_queueChunks[blockId])
               candidateChunks.push_back(chunk);
           }
           else
           {
             for (int k = 0; k < d["chunks"][j]["availableChunks"].Size(); k++)
             {
-              if (std::find(m_queueChunks[blockHash].begin(), m_queueChunks[blockHash].end(), d["chunks"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockHash].end())
+              if (std::find(m_queueChunks[blockId].begin(), m_queueChunks[blockId].end(), d["chunks"][j]["availableChunks"][k].GetInt()) != m_queueChunks[blockId].end())
                 candidateChunks.push_back(d["chunks"][j]["availableChunks"][k].GetInt());
             }
           }
@@ -2033,18 +2012,17 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
 
           if (candidateChunks.size() > 0)
           {
-            int randomIndex = rand() % candidateChunks.size();
-            NS_LOG_INFO("ReceivedChunkMessage: Bitcoin node " << GetNode ()->GetId ()
+            int randomIndex = m_peerSelectionStream.GetInteger(candidateChunks.size());
+            BITCOIN_MESSAGE_LOG_INFO("ReceivedChunkMessage: Bitcoin node " << GetNode ()->GetId ()
                         << " will request the chunk with index = " << randomIndex << " and value = " << candidateChunks[randomIndex]);	
-            m_queueChunks[blockHash].erase(std::remove(m_queueChunks[blockHash].begin(),
-                                                       m_queueChunks[blockHash].end(), candidateChunks[randomIndex]),
-                                                       m_queueChunks[blockHash].end());
+            m_queueChunks[blockId].erase(std::remove(m_queueChunks[blockId].begin(),
+                                                       m_queueChunks[blockId].end(), candidateChunks[randomIndex]),
+                                                       m_queueChunks[blockId].end());
 																		  
-            std::ostringstream chunk;
-            chunk << blockHash << "/" << candidateChunks[randomIndex];
+            ChunkId chunk (blockId, candidateChunks[randomIndex]);
 
             if (d["chunks"][j]["requestChunks"].Size() == 0)
-              getDataMessages.push_back(chunk.str());
+              getDataMessages.push_back(chunk);
             else
             {
               for (int ii = 0; ii < d["chunks"][j]["requestChunks"].Size(); ii++)
@@ -2058,14 +2036,14 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
             }
 					  
             timeout = Simulator::Schedule (Minutes(m_invTimeoutMinutes.GetMinutes() / ceil(d["chunks"][j]["size"].GetInt()/static_cast<double>(m_chunkSize))),
-                                                   &BitcoinNode::ChunkTimeoutExpired, this, chunk.str());
+                                                   &BitcoinNode::ChunkTimeoutExpired, this, chunk);
 													 
-            m_chunkTimeouts[chunk.str()] = timeout;
-            m_queueChunkPeers[blockHash].push_back(from);
+            m_chunkTimeouts[chunk] = timeout;
+            m_queueChunkPeers[blockId].push_back(from);
           }
           else
           {
-            NS_LOG_INFO("ReceivedChunkMessage: Bitcoin node " << GetNode ()->GetId ()
+            BITCOIN_MESSAGE_LOG_INFO("ReceivedChunkMessage: Bitcoin node " << GetNode ()->GetId ()
                         << " will not request any chunks from this peer, because it has already all the available ones");
 								  
             for (int ii = 0; ii < d["chunks"][j]["requestChunks"].Size(); ii++)
@@ -2082,7 +2060,7 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
     }
     else
     {
-      NS_LOG_INFO("ReceivedChunkMessage: Bitcoin node " << GetNode ()->GetId ()
+      BITCOIN_MESSAGE_LOG_INFO("ReceivedChunkMessage: Bitcoin node " << GetNode ()->GetId ()
                   << " has already received this block");
 								  
       for (int ii = 0; ii < d["chunks"][j]["requestChunks"].Size(); ii++)
@@ -2112,29 +2090,14 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
 				
     for (auto chunk_it = getDataMessages.begin(); chunk_it < getDataMessages.end(); chunk_it++) 
     {
-      NS_LOG_INFO("In getDataMessages: " << *chunk_it);
+      BITCOIN_MESSAGE_LOG_INFO("In getDataMessages: " << *chunk_it);
 	  
-      std::string            invDelimiter = "/";
-      std::string            chunkHash = *chunk_it;
-      std::string            chunkHashHelp = chunkHash.substr(0);
-      std::ostringstream     help;
-      std::string            blockHash;
-      size_t                 invPos = chunkHashHelp.find(invDelimiter);
-				  
-      int height = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-      chunkHashHelp.erase(0, invPos + invDelimiter.length());
-      invPos = chunkHashHelp.find(invDelimiter);
-      int minerId = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-      chunkHashHelp.erase(0, invPos + invDelimiter.length());
-      int chunkId = atoi(chunkHashHelp.substr(0).c_str());
-      help << height << "/" << minerId;
-      blockHash = help.str();
+      std::string            chunkHash = chunk_it->ToString();
+      BlockId                blockId = chunk_it->GetBlockId();
 				
-      if (m_receivedChunks.find(blockHash) != m_receivedChunks.end())
+      if (m_receivedChunks.find(blockId) != m_receivedChunks.end())
       {
-        for ( auto k : m_receivedChunks[blockHash])
+        for ( auto k : m_receivedChunks[blockId])
         {
           value = k;
           availableChunks.PushBack(value, d.GetAllocator());
@@ -2145,7 +2108,7 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
       value = false;
       chunkInfo.AddMember("fullBlock", value, d.GetAllocator());
 				  
-      value.SetString(chunk_it->c_str(), chunk_it->size(), d.GetAllocator());
+      value.SetString(chunkHash.c_str(), chunkHash.size(), d.GetAllocator());
       chunkInfo.AddMember("chunk", value, d.GetAllocator());
 				  
       chunkArray.PushBack(chunkInfo, d.GetAllocator());
@@ -2167,18 +2130,9 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
 				
     for (auto &chunk : chunkMessages) 
     {
-      NS_LOG_INFO("In chunkMessages: " << chunk.first);
-
-      std::string            invDelimiter = "/";
-      std::string            chunkHash;
-      std::string            blockHash;
-      std::ostringstream     stringStream;				  
+      BITCOIN_MESSAGE_LOG_INFO("In chunkMessages: " << chunk.first);
 
-      stringStream << chunk.first.GetBlockHeight() << "/" << chunk.first.GetMinerId();
-      blockHash = stringStream.str();
-      stringStream.clear();
-      stringStream << chunk.first.GetBlockHeight() << "/" << chunk.first.GetMinerId() << "/" << chunk.first.GetChunkId();
-      chunkHash = stringStream.str();
+      BlockId                blockId = chunk.first.GetBlockId();
 
       for (auto requestedChunk_it = chunk.second.begin(); requestedChunk_it != chunk.second.end(); requestedChunk_it++)
       {
@@ -2215,16 +2169,16 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
 		
         if (m_blockchain.HasBlock(chunk.first.GetBlockHeight (), chunk.first.GetMinerId ()) 
             || m_blockchain.IsOrphan(chunk.first.GetBlockHeight (), chunk.first.GetMinerId ())
-            || ReceivedButNotValidated(blockHash))
+            || ReceivedButNotValidated(blockId))
         {
           value = true;							
           chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
         }
-        else if (OnlyHeadersReceived(blockHash))
+        else if (OnlyHeadersReceived(blockId))
         {
           int noChunks = ceil(chunk.first.GetBlockSizeBytes () / static_cast<double>(m_chunkSize));
 					
-          if (m_receivedChunks[blockHash].size() == noChunks)
+          if (m_receivedChunks[blockId].size() == noChunks)
           {
             value = true;
             chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
@@ -2234,7 +2188,7 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
             value = false;							
             chunkInfo.AddMember("fullBlock", value, d.GetAllocator ());
 
-            for (auto &chunk : m_receivedChunks[blockHash])
+            for (auto &chunk : m_receivedChunks[blockId])
             {
               value = chunk;
               availableChunks.PushBack(value, d.GetAllocator());
@@ -2256,81 +2210,55 @@ BitcoinNode::ReceivedChunkMessage(std::string &chunkInfo, Address &from)
       else
         totalChunkMessageSize += m_chunkSize;
     }
+    d["message"].SetInt(CHUNK);
 
-    double sendTime = totalChunkMessageSize / m_uploadSpeed;
-    double eventTime;
-				
-/*                 std::cout << "Node " << GetNode()->GetId() << "-" << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
-		  		          << " " << m_peersDownloadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] << " Mbps , time = "
-		  		          << Simulator::Now ().GetSeconds() << "s \n"; */
-                
-    if (m_sendBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendBlockTimes.back())
-    {
-      eventTime = 0; 
-    }
-    else
-    {
-      //std::cout << "m_sendBlockTimes.back() = m_sendBlockTimes.back() = " << m_sendBlockTimes.back() << std::endl;
-      eventTime = m_sendBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-    }
-    m_sendBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
-    //std::cout << sendTime << " " << eventTime << " " << m_sendBlockTimes.size() << std::endl;
-    NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the chunk to " << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
-                << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
-							
-               
-    // Stringify the DOM
-    rapidjson::StringBuffer packetInfo;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(packetInfo);
-    d.Accept(writer);
-    std::string packet = packetInfo.GetString();
-    NS_LOG_INFO ("DEBUG: " << packetInfo.GetString());
+    std::string packet = EncodeMessage(d, m_messageCodec);
+    BITCOIN_MESSAGE_LOG_INFO ("DEBUG: " << MessageToString(d));
+    BITCOIN_MESSAGE_LOG_INFO("Node " << GetNode()->GetId() << " queued the chunk for " << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
+                << " behind " << m_uploadLink.GetSize() << " transfers\n");
 				
-    Simulator::Schedule (Seconds(eventTime), &BitcoinNode::SendChunk, this, packet, from); 
-    Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinNode::RemoveSendTime, this);
+    m_uploadLink.Enqueue (InetSocketAddress::ConvertFrom(from).GetIpv4 (), totalChunkMessageSize, 0,
+                          std::bind (&BitcoinNode::SendChunk, this, packet, GetChunkMessageBytes(d), from), LinkScheduler::TransferHandler ());
 
   }
+
+  UpdateNetworkState();
 }
 
 
 void 
 BitcoinNode::ReceiveBlock(const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_INFO ("ReceiveBlock: At time " << Simulator::Now ().GetSeconds ()
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_INFO ("ReceiveBlock: At time " << Simulator::Now ().GetSeconds ()
                 << "s bitcoin node " << GetNode ()->GetId () << " received " << newBlock);
 
-  std::ostringstream   stringStream;  
-  std::string          blockHash = stringStream.str();
-				
-  stringStream << newBlock.GetBlockHeight() << "/" << newBlock.GetMinerId();
-  blockHash = stringStream.str();
+  BlockId              blockId = newBlock.GetBlockId();
   
-  if (m_blockchain.HasBlock(newBlock) || m_blockchain.IsOrphan(newBlock) || ReceivedButNotValidated(blockHash))
+  if (m_blockchain.HasBlock(newBlock) || m_blockchain.IsOrphan(newBlock) || ReceivedButNotValidated(blockId))
   {
-    NS_LOG_INFO ("ReceiveBlock: Bitcoin node " << GetNode ()->GetId () << " has already added this block in the m_blockchain: " << newBlock);
+    BITCOIN_MESSAGE_LOG_INFO ("ReceiveBlock: Bitcoin node " << GetNode ()->GetId () << " has already added this block in the m_blockchain: " << newBlock);
     
-    if (m_invTimeouts.find(blockHash) != m_invTimeouts.end())
+    if (m_invTimeouts.find(blockId) != m_invTimeouts.end())
     {
-      m_queueInv.erase(blockHash);
-      Simulator::Cancel (m_invTimeouts[blockHash]);
-      m_invTimeouts.erase(blockHash);
+      m_queueInv.erase(blockId);
+      Simulator::Cancel (m_invTimeouts[blockId]);
+      m_invTimeouts.erase(blockId);
     }
   }
   else
   {
-    NS_LOG_INFO ("ReceiveBlock: Bitcoin node " << GetNode ()->GetId () << " has NOT added this block in the m_blockchain: " << newBlock);
+    BITCOIN_MESSAGE_LOG_INFO ("ReceiveBlock: Bitcoin node " << GetNode ()->GetId () << " has NOT added this block in the m_blockchain: " << newBlock);
 
-    m_receivedNotValidated[blockHash] = newBlock;
+    m_receivedNotValidated[blockId] = newBlock;
 	//PrintQueueInv();
 	//PrintInvTimeouts();
 	
-    if (m_invTimeouts.find(blockHash) != m_invTimeouts.end())
+    if (m_invTimeouts.find(blockId) != m_invTimeouts.end())
     {
-      m_queueInv.erase(blockHash);
-      Simulator::Cancel (m_invTimeouts[blockHash]);
-      m_invTimeouts.erase(blockHash);
+      m_queueInv.erase(blockId);
+      Simulator::Cancel (m_invTimeouts[blockId]);
+      m_invTimeouts.erase(blockId);
     }
 	
     //PrintQueueInv();
@@ -2343,27 +2271,23 @@ BitcoinNode::ReceiveBlock(const Block &newBlock)
 void 
 BitcoinNode::ReceivedLastChunk(const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_INFO ("ReceivedLastChunk: At time " << Simulator::Now ().GetSeconds ()
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_INFO ("ReceivedLastChunk: At time " << Simulator::Now ().GetSeconds ()
                 << "s bitcoin node " << GetNode ()->GetId () 
                 << " received the last chunk of block " << newBlock);
 				
-  std::ostringstream   stringStream;  
-  std::string          blockHash = stringStream.str();
-				
-  stringStream << newBlock.GetBlockHeight() << "/" << newBlock.GetMinerId();
-  blockHash = stringStream.str();
+  BlockId              blockId = newBlock.GetBlockId();
   
-  if (m_blockchain.HasBlock(newBlock) || m_blockchain.IsOrphan(newBlock) || ReceivedButNotValidated(blockHash))
+  if (m_blockchain.HasBlock(newBlock) || m_blockchain.IsOrphan(newBlock) || ReceivedButNotValidated(blockId))
   {
-    NS_LOG_INFO ("ReceivedLastChunk: Bitcoin node " << GetNode ()->GetId () << " has already added this block in the m_blockchain: " << newBlock);
+    BITCOIN_MESSAGE_LOG_INFO ("ReceivedLastChunk: Bitcoin node " << GetNode ()->GetId () << " has already added this block in the m_blockchain: " << newBlock);
   }
   else
   {
-    NS_LOG_INFO ("ReceivedLastChunk: Bitcoin node " << GetNode ()->GetId () << " has NOT added this block in the m_blockchain: " << newBlock);
+    BITCOIN_MESSAGE_LOG_INFO ("ReceivedLastChunk: Bitcoin node " << GetNode ()->GetId () << " has NOT added this block in the m_blockchain: " << newBlock);
 
 	
-    m_receivedNotValidated[blockHash] = newBlock;
+    m_receivedNotValidated[blockId] = newBlock;
 
     //PrintQueueInv();
 	//PrintInvTimeouts();
@@ -2373,58 +2297,111 @@ BitcoinNode::ReceivedLastChunk(const Block &newBlock)
 
 
 void 
-BitcoinNode::SendBlock(std::string packetInfo, Address& from) 
+BitcoinNode::SendBlock(std::string packetInfo, long sentBytes, Address& from) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_SEND_MESSAGE, BLOCK);
   
-  NS_LOG_INFO ("SendBlock: At time " << Simulator::Now ().GetSeconds ()
+  BITCOIN_MESSAGE_LOG_INFO ("SendBlock: At time " << Simulator::Now ().GetSeconds ()
                 << "s bitcoin node " << GetNode ()->GetId () << " sent " 
-                << packetInfo << " to " << InetSocketAddress::ConvertFrom(from).GetIpv4 ());
+                << FrameToString(packetInfo, m_messageCodec) << " to " << InetSocketAddress::ConvertFrom(from).GetIpv4 ());
 				
-  //m_sendBlockTimes.erase(m_sendBlockTimes.begin());				
-  SendMessage(GET_DATA, BLOCK, packetInfo, from);
+  SendFrame(packetInfo, InetSocketAddress::ConvertFrom(from).GetIpv4 ());
+  m_nodeStats->blockSentBytes[m_nodeId] += sentBytes;
+}
+
+
+void
+BitcoinNode::SendUnsolicitedBlock(std::string packetInfo, Ipv4Address to)
+{
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_SEND_MESSAGE, BLOCK);
+
+  BITCOIN_MESSAGE_LOG_INFO ("SendUnsolicitedBlock: At time " << Simulator::Now ().GetSeconds ()
+                << "s bitcoin node " << GetNode ()->GetId () << " sent " 
+                << FrameToString(packetInfo, m_messageCodec) << " to " << to);
+
+  SendFrame(packetInfo, to);
+}
+
+
+void
+BitcoinNode::CreateBlockMessage(const Block &newBlock, const char *type, rapidjson::Document &d)
+{
+  rapidjson::Value value (BLOCK);
+  rapidjson::Value blockInfo(rapidjson::kObjectType);
+  rapidjson::Value array(rapidjson::kArrayType);
+
+  d.SetObject();
+  d.AddMember("message", value, d.GetAllocator());
+
+  value.SetString(type, strlen(type), d.GetAllocator());
+  d.AddMember("type", value, d.GetAllocator());
+
+  value = newBlock.GetBlockHeight ();
+  blockInfo.AddMember("height", value, d.GetAllocator ());
+
+  value = newBlock.GetMinerId ();
+  blockInfo.AddMember("minerId", value, d.GetAllocator ());
+
+  value = newBlock.GetParentBlockMinerId ();
+  blockInfo.AddMember("parentBlockMinerId", value, d.GetAllocator ());
+
+  value = newBlock.GetBlockSizeBytes ();
+  blockInfo.AddMember("size", value, d.GetAllocator ());
+
+  value = newBlock.GetTimeCreated ();
+  blockInfo.AddMember("timeCreated", value, d.GetAllocator ());
+
+  value = newBlock.GetTimeReceived ();
+  blockInfo.AddMember("timeReceived", value, d.GetAllocator ());
+
+  array.PushBack(blockInfo, d.GetAllocator());
+  d.AddMember("blocks", array, d.GetAllocator());
 }
 
 
 void 
-BitcoinNode::SendChunk(std::string packetInfo, Address& from) 
+BitcoinNode::SendChunk(std::string packetInfo, long sentBytes, Address& from) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_SEND_MESSAGE, CHUNK);
   
-  NS_LOG_INFO ("SendChunk: At time " << Simulator::Now ().GetSeconds ()
+  BITCOIN_MESSAGE_LOG_INFO ("SendChunk: At time " << Simulator::Now ().GetSeconds ()
                 << "s bitcoin node " << GetNode ()->GetId () << " sent " 
-                << packetInfo << " to " << InetSocketAddress::ConvertFrom(from).GetIpv4 ());
+                << FrameToString(packetInfo, m_messageCodec) << " to " << InetSocketAddress::ConvertFrom(from).GetIpv4 ());
 				
-  //m_sendBlockTimes.erase(m_sendBlockTimes.begin());				
-  SendMessage(EXT_GET_DATA, CHUNK, packetInfo, from);
+  SendFrame(packetInfo, InetSocketAddress::ConvertFrom(from).GetIpv4 ());
+  m_nodeStats->chunkSentBytes[m_nodeId] += sentBytes;
 }
 
 
 void 
 BitcoinNode::ReceivedHigherBlock(const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
-  NS_LOG_INFO("ReceivedHigherBlock: Bitcoin node " << GetNode ()->GetId () << " added a new block in the m_blockchain with higher height: " << newBlock);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_INFO("ReceivedHigherBlock: Bitcoin node " << GetNode ()->GetId () << " added a new block in the m_blockchain with higher height: " << newBlock);
 }
 
 
 void 
 BitcoinNode::ValidateBlock(const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_VALIDATE_BLOCK);
   
   const Block *parent = m_blockchain.GetParent(newBlock);
   
   if (parent == nullptr)
   {
-    NS_LOG_INFO("ValidateBlock: Block " << newBlock << " is an orphan\n"); 
+    BITCOIN_MESSAGE_LOG_INFO("ValidateBlock: Block " << newBlock << " is an orphan\n"); 
 	 
 	 m_blockchain.AddOrphan(newBlock);
 	 //m_blockchain.PrintOrphans();
   }
   else 
   {
-    NS_LOG_INFO("ValidateBlock: Block's " << newBlock << " parent is " << *parent << "\n");
+    BITCOIN_MESSAGE_LOG_INFO("ValidateBlock: Block's " << newBlock << " parent is " << *parent << "\n");
 
     /**
      * Block is not orphan, so we can go on validating
@@ -2435,7 +2412,7 @@ BitcoinNode::ValidateBlock(const Block &newBlock)
     double validationTime = averageValidationTimeSeconds * newBlock.GetBlockSizeBytes() / averageBlockSizeBytes;		
 	
     Simulator::Schedule (Seconds(validationTime), &BitcoinNode::AfterBlockValidation, this, newBlock);
-    NS_LOG_INFO ("ValidateBlock: The Block " << newBlock << " will be validated in " 
+    BITCOIN_MESSAGE_LOG_INFO ("ValidateBlock: The Block " << newBlock << " will be validated in " 
                  << validationTime << "s");
   }  
 
@@ -2444,19 +2421,12 @@ BitcoinNode::ValidateBlock(const Block &newBlock)
 void 
 BitcoinNode::AfterBlockValidation(const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_AFTER_BLOCK_VALIDATION);
 
-  int height = newBlock.GetBlockHeight();
-  int minerId = newBlock.GetMinerId();
-  std::ostringstream   stringStream;  
-  std::string          blockHash = stringStream.str();
-				
-  stringStream << height << "/" << minerId;
-  blockHash = stringStream.str();
+  RemoveReceivedButNotValidated(newBlock.GetBlockId());
   
-  RemoveReceivedButNotValidated(blockHash);
-  
-  NS_LOG_INFO ("AfterBlockValidation: At time " << Simulator::Now ().GetSeconds ()
+  BITCOIN_MESSAGE_LOG_INFO ("AfterBlockValidation: At time " << Simulator::Now ().GetSeconds ()
                << "s bitcoin node " << GetNode ()->GetId () 
                << " validated block " <<  newBlock);
 			   
@@ -2465,7 +2435,7 @@ BitcoinNode::AfterBlockValidation(const Block &newBlock)
   
   if (m_blockchain.IsOrphan(newBlock))
   {
-    NS_LOG_INFO ("AfterBlockValidation: Block " << newBlock << " was orphan");
+    BITCOIN_MESSAGE_LOG_INFO ("AfterBlockValidation: Block " << newBlock << " was orphan");
 	m_blockchain.RemoveOrphan(newBlock);
   }
 
@@ -2483,8 +2453,11 @@ BitcoinNode::AfterBlockValidation(const Block &newBlock)
 							 
   m_meanBlockSize = (m_blockchain.GetTotalBlocks() - 1)/static_cast<double>(m_blockchain.GetTotalBlocks())*m_meanBlockSize  
                   + (newBlock.GetBlockSizeBytes())/static_cast<double>(m_blockchain.GetTotalBlocks());
+
+  m_nodeStats->blockPropagationTimes.Add (m_nodeId, newBlock.GetTimeReceived() - newBlock.GetTimeCreated());
 				  
   m_blockchain.AddBlock(newBlock);
+  TraceBlock(newBlock);
   
   if (!m_blockTorrent)
     AdvertiseNewBlock(newBlock); 
@@ -2492,29 +2465,64 @@ BitcoinNode::AfterBlockValidation(const Block &newBlock)
     AdvertiseFullBlock(newBlock);
 
   ValidateOrphanChildren(newBlock);
-  
+
+  UpdateNetworkState();
 }  
 
 
+void
+BitcoinNode::TraceBlock(const Block &newBlock)
+{
+  if (m_propagationTrace)
+    m_propagationTrace->Record (newBlock.GetBlockId(), m_nodeId, newBlock.GetTimeReceived(),
+                                Simulator::Now ().GetSeconds (), newBlock.GetReceivedFromIpv4());
+}
+
+
+void
+BitcoinNode::UpdateNetworkState(void)
+{
+  if (!m_networkSampler)
+    return;
+
+  BlockId tip = m_blockchain.GetCurrentTopBlock()->GetBlockId();
+  int64_t queueInv = m_queueInv.size();
+  int64_t invTimeouts = m_invTimeouts.size();
+
+  if (tip != m_sampledTip)
+  {
+    m_networkSampler->UpdateTip (m_sampledTip, tip);
+    m_sampledTip = tip;
+  }
+
+  if (queueInv != m_sampledQueueInv || invTimeouts != m_sampledInvTimeouts)
+  {
+    m_networkSampler->UpdateInvs (queueInv - m_sampledQueueInv, invTimeouts - m_sampledInvTimeouts);
+    m_sampledQueueInv = queueInv;
+    m_sampledInvTimeouts = invTimeouts;
+  }
+}
+
+
 void 
 BitcoinNode::ValidateOrphanChildren(const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
 
   std::vector<const Block *> children = m_blockchain.GetOrphanChildrenPointers(newBlock);
 
   if (children.size() == 0)
   {
-    NS_LOG_INFO("ValidateOrphanChildren: Block " << newBlock << " has no orphan children\n");
+    BITCOIN_MESSAGE_LOG_INFO("ValidateOrphanChildren: Block " << newBlock << " has no orphan children\n");
   }
   else 
   {
     std::vector<const Block *>::iterator  block_it;
-	NS_LOG_INFO("ValidateOrphanChildren: Block " << newBlock << " has orphan children:");
+	BITCOIN_MESSAGE_LOG_INFO("ValidateOrphanChildren: Block " << newBlock << " has orphan children:");
 	
 	for (block_it = children.begin();  block_it < children.end(); block_it++)
     {
-       NS_LOG_INFO ("\t" << **block_it);
+       BITCOIN_MESSAGE_LOG_INFO ("\t" << **block_it);
        ValidateBlock (**block_it);
     }
   }
@@ -2524,13 +2532,12 @@ BitcoinNode::ValidateOrphanChildren(const Block &newBlock)
 void 
 BitcoinNode::AdvertiseNewBlock (const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
 
   rapidjson::Document d;
   rapidjson::Value value;
   rapidjson::Value array(rapidjson::kArrayType);  
-  std::ostringstream stringStream;  
-  std::string blockHash = stringStream.str();
+  std::string blockHash = newBlock.GetBlockId().ToString();
   d.SetObject();
   
   value.SetString("block");
@@ -2541,8 +2548,6 @@ BitcoinNode::AdvertiseNewBlock (const Block &newBlock)
     value = INV;
     d.AddMember("message", value, d.GetAllocator());
 
-    stringStream << newBlock.GetBlockHeight () << "/" << newBlock.GetMinerId ();
-    blockHash = stringStream.str();
     value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
     array.PushBack(value, d.GetAllocator());
     d.AddMember("inv", array, d.GetAllocator());
@@ -2576,26 +2581,20 @@ BitcoinNode::AdvertiseNewBlock (const Block &newBlock)
     d.AddMember("blocks", array, d.GetAllocator());      
   }	
 
-  // Stringify the DOM
-  rapidjson::StringBuffer packetInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(packetInfo);
-  d.Accept(writer);
+  std::string packetInfo = EncodeMessage(d, m_messageCodec);
   
   for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i)
   {
     if ( *i != newBlock.GetReceivedFromIpv4 () )
     {
-      const uint8_t delimiter[] = "#";
-
-      m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(packetInfo.GetString()), packetInfo.GetSize(), 0);
-	  m_peersSockets[*i]->Send (delimiter, 1, 0);
+      SendFrame(packetInfo, *i);
 	  
       if (m_protocolType == STANDARD_PROTOCOL)
-        m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
+        m_nodeStats->invSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
       else if (m_protocolType == SENDHEADERS)
-        m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;      
+        m_nodeStats->headersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;      
 	
-      NS_LOG_INFO ("AdvertiseNewBlock: At time " << Simulator::Now ().GetSeconds ()
+      BITCOIN_MESSAGE_LOG_INFO ("AdvertiseNewBlock: At time " << Simulator::Now ().GetSeconds ()
                    << "s bitcoin node " << GetNode ()->GetId () << " advertised a new Block: " 
                    << newBlock << " to " << *i);
     }
@@ -2606,14 +2605,13 @@ BitcoinNode::AdvertiseNewBlock (const Block &newBlock)
 void 
 BitcoinNode::AdvertiseFullBlock (const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
 
   rapidjson::Document d;
   rapidjson::Value value;
   rapidjson::Value array(rapidjson::kArrayType);  
   rapidjson::Value blockInfo(rapidjson::kObjectType);
-  std::ostringstream stringStream;  
-  std::string blockHash = stringStream.str();
+  std::string blockHash = newBlock.GetBlockId().ToString();
   d.SetObject();
   
   value.SetString("block");
@@ -2624,8 +2622,6 @@ BitcoinNode::AdvertiseFullBlock (const Block &newBlock)
     value = EXT_INV;
     d.AddMember("message", value, d.GetAllocator());
   
-    stringStream << newBlock.GetBlockHeight () << "/" << newBlock.GetMinerId ();
-    blockHash = stringStream.str();
     value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
     blockInfo.AddMember("hash", value, d.GetAllocator ());
 
@@ -2678,40 +2674,34 @@ BitcoinNode::AdvertiseFullBlock (const Block &newBlock)
     d.AddMember("blocks", array, d.GetAllocator());      
   }	
 
-  // Stringify the DOM
-  rapidjson::StringBuffer packetInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(packetInfo);
-  d.Accept(writer);
+  std::string packetInfo = EncodeMessage(d, m_messageCodec);
   
   for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i)
   {
-    const uint8_t delimiter[] = "#";
-
-    m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(packetInfo.GetString()), packetInfo.GetSize(), 0);
-    m_peersSockets[*i]->Send (delimiter, 1, 0);
+    SendFrame(packetInfo, *i);
 	  
     if (m_protocolType == STANDARD_PROTOCOL)
     {
-      m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
+      m_nodeStats->extInvSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
       for (int j=0; j<d["inv"].Size(); j++)
       {
-        m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
+        m_nodeStats->extInvSentBytes[m_nodeId] += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
         if (!d["inv"][j]["fullBlock"].GetBool())
-          m_nodeStats->extInvSentBytes += d["inv"][j]["availableChunks"].Size();
+          m_nodeStats->extInvSentBytes[m_nodeId] += d["inv"][j]["availableChunks"].Size();
       }
     }
     else if (m_protocolType == SENDHEADERS)
     {
-      m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
+      m_nodeStats->extHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
       for (int j=0; j<d["blocks"].Size(); j++)
       {
-        m_nodeStats->extHeadersSentBytes += 1;//fullBlock
+        m_nodeStats->extHeadersSentBytes[m_nodeId] += 1;//fullBlock
         if (!d["blocks"][j]["fullBlock"].GetBool())
-          m_nodeStats->extHeadersSentBytes += d["blocks"][j]["availableChunks"].Size()*1;
+          m_nodeStats->extHeadersSentBytes[m_nodeId] += d["blocks"][j]["availableChunks"].Size()*1;
       }	
     }
 	
-    NS_LOG_INFO ("AdvertiseFullBlock: At time " << Simulator::Now ().GetSeconds ()
+    BITCOIN_MESSAGE_LOG_INFO ("AdvertiseFullBlock: At time " << Simulator::Now ().GetSeconds ()
                  << "s bitcoin node " << GetNode ()->GetId () << " advertised a new Block: " 
                  << newBlock << " to " << *i);
   }
@@ -2721,20 +2711,18 @@ BitcoinNode::AdvertiseFullBlock (const Block &newBlock)
 void 
 BitcoinNode::AdvertiseFirstChunk (const Block &newBlock) 
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
 
   rapidjson::Document d;
   rapidjson::Value value;
   rapidjson::Value array(rapidjson::kArrayType); 
   rapidjson::Value chunkArray(rapidjson::kArrayType); 
   rapidjson::Value blockInfo(rapidjson::kObjectType);  
-  std::ostringstream stringStream;  
-  std::string blockHash;
+  BlockId blockId = newBlock.GetBlockId();
+  std::string blockHash = blockId.ToString();
   int noChunks = ceil(newBlock.GetBlockSizeBytes ()/static_cast<double>(m_chunkSize));
 
   d.SetObject();
-  stringStream << newBlock.GetBlockHeight () << "/" << newBlock.GetMinerId ();
-  blockHash = stringStream.str();
 
   value.SetString("block");
   d.AddMember("type", value, d.GetAllocator());
@@ -2751,7 +2739,7 @@ BitcoinNode::AdvertiseFirstChunk (const Block &newBlock)
     blockInfo.AddMember("size", value, d.GetAllocator ());
 		  
 					
-    if (m_receivedChunks[blockHash].size() == noChunks)
+    if (m_receivedChunks[blockId].size() == noChunks)
     {
       value = true;
       blockInfo.AddMember("fullBlock", value, d.GetAllocator ());
@@ -2761,7 +2749,7 @@ BitcoinNode::AdvertiseFirstChunk (const Block &newBlock)
       value = false;							
       blockInfo.AddMember("fullBlock", value, d.GetAllocator ());
 
-      for (auto &chunk : m_receivedChunks[blockHash])
+      for (auto &chunk : m_receivedChunks[blockId])
       {
         value = chunk;
         chunkArray.PushBack(value, d.GetAllocator());
@@ -2804,11 +2792,11 @@ BitcoinNode::AdvertiseFirstChunk (const Block &newBlock)
       value = EXT_HEADERS;
       d.AddMember("message", value, d.GetAllocator());
 		  
-      if (m_receivedChunks[blockHash].size() == noChunks)
+      if (m_receivedChunks[blockId].size() == noChunks)
       {
         value = true;
         blockInfo.AddMember("fullBlock", value, d.GetAllocator ());
-        NS_LOG_DEBUG("1 " << m_receivedChunks[blockHash].size());
+        BITCOIN_MESSAGE_LOG_DEBUG("1 " << m_receivedChunks[blockId].size());
       }
       else
       {
@@ -2817,7 +2805,7 @@ BitcoinNode::AdvertiseFirstChunk (const Block &newBlock)
         value = false;
         blockInfo.AddMember("fullBlock", value, d.GetAllocator ());
 					  
-        for (auto &c : m_receivedChunks[blockHash])
+        for (auto &c : m_receivedChunks[blockId])
         {
           value = c;
           availableChunks.PushBack(value, d.GetAllocator());
@@ -2830,42 +2818,36 @@ BitcoinNode::AdvertiseFirstChunk (const Block &newBlock)
     d.AddMember("blocks", array, d.GetAllocator());      
   }	
 
-  // Stringify the DOM
-  rapidjson::StringBuffer packetInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(packetInfo);
-  d.Accept(writer);
+  std::string packetInfo = EncodeMessage(d, m_messageCodec);
   
   for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i)
   {
     if ( *i != newBlock.GetReceivedFromIpv4 () )
     {
-      const uint8_t delimiter[] = "#";
-
-      m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(packetInfo.GetString()), packetInfo.GetSize(), 0);
-      m_peersSockets[*i]->Send (delimiter, 1, 0);
+      SendFrame(packetInfo, *i);
 	  
       if (m_protocolType == STANDARD_PROTOCOL)
       {
-        m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
+        m_nodeStats->extInvSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
         for (int j=0; j<d["inv"].Size(); j++)
         {
-          m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
+          m_nodeStats->extInvSentBytes[m_nodeId] += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
           if (!d["inv"][j]["fullBlock"].GetBool())
-            m_nodeStats->extInvSentBytes += d["inv"][j]["availableChunks"].Size();
+            m_nodeStats->extInvSentBytes[m_nodeId] += d["inv"][j]["availableChunks"].Size();
         }
       }
       else if (m_protocolType == SENDHEADERS)
       {
-        m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
+        m_nodeStats->extHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
         for (int j=0; j<d["blocks"].Size(); j++)
         {
-          m_nodeStats->extHeadersSentBytes += 1;//fullBlock
+          m_nodeStats->extHeadersSentBytes[m_nodeId] += 1;//fullBlock
           if (!d["blocks"][j]["fullBlock"].GetBool())
-            m_nodeStats->extHeadersSentBytes += d["blocks"][j]["availableChunks"].Size()*1;
+            m_nodeStats->extHeadersSentBytes[m_nodeId] += d["blocks"][j]["availableChunks"].Size()*1;
         }	
       } 
 	
-      NS_LOG_INFO ("AdvertiseFirstChunk: At time " << Simulator::Now ().GetSeconds ()
+      BITCOIN_MESSAGE_LOG_INFO ("AdvertiseFirstChunk: At time " << Simulator::Now ().GetSeconds ()
                    << "s bitcoin node " << GetNode ()->GetId () << " advertised a new chunk: " 
                    << newBlock << " to " << *i);
     }
@@ -2874,253 +2856,150 @@ BitcoinNode::AdvertiseFirstChunk (const Block &newBlock)
 
 
 void
-BitcoinNode::SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, rapidjson::Document &d, Ptr<Socket> outgoingSocket)
+BitcoinNode::SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, rapidjson::Document &d, Ipv4Address outgoingIpv4Address)
 {
-  NS_LOG_FUNCTION (this);
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_SEND_MESSAGE, responseMessage);
   
-  const uint8_t delimiter[] = "#";
-
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-				
   d["message"].SetInt(responseMessage);
-  d.Accept(writer);
-  NS_LOG_INFO ("Node " << GetNode ()->GetId () << " got a " 
+  BITCOIN_MESSAGE_LOG_INFO ("Node " << GetNode ()->GetId () << " got a " 
                << getMessageName(receivedMessage) << " message" 
                << " and sent a " << getMessageName(responseMessage) 
-               << " message: " << buffer.GetString());
+               << " message: " << MessageToString(d));
+
+  SendFrame(EncodeMessage(d, m_messageCodec), outgoingIpv4Address);
+  CountSentBytes(d);
+}
+
+void
+BitcoinNode::SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, rapidjson::Document &d, Address &outgoingAddress)
+{
+  SendMessage(receivedMessage, responseMessage, d, InetSocketAddress::ConvertFrom(outgoingAddress).GetIpv4 ());
+}
 
-  outgoingSocket->Send (reinterpret_cast<const uint8_t*>(buffer.GetString()), buffer.GetSize(), 0);
-  outgoingSocket->Send (delimiter, 1, 0);	
 
+void
+BitcoinNode::CountSentBytes(const rapidjson::Document &d)
+{
   switch (d["message"].GetInt()) 
   {
     case INV:
     {
-      m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
+      m_nodeStats->invSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
       break;
     }
     case EXT_INV:
     {
-      m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
+      m_nodeStats->extInvSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
       for (int j=0; j<d["inv"].Size(); j++)
       {
-        m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
+        m_nodeStats->extInvSentBytes[m_nodeId] += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
         if (!d["inv"][j]["fullBlock"].GetBool())
-          m_nodeStats->extInvSentBytes += d["inv"][j]["availableChunks"].Size();
+          m_nodeStats->extInvSentBytes[m_nodeId] += d["inv"][j]["availableChunks"].Size();
       }
       break;
     }
     case GET_HEADERS:
     {
-      m_nodeStats->getHeadersSentBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
+      m_nodeStats->getHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
       break;
     }
     case EXT_GET_HEADERS:
     {
-      m_nodeStats->extGetHeadersSentBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
+      m_nodeStats->extGetHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
       break;
     }
     case HEADERS:
     {
-      m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
+      m_nodeStats->headersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
       break;
     }
     case EXT_HEADERS:
     {
-      m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
+      m_nodeStats->extHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
       for (int j=0; j<d["blocks"].Size(); j++)
       {
-        m_nodeStats->extHeadersSentBytes += 1;//fullBlock
+        m_nodeStats->extHeadersSentBytes[m_nodeId] += 1;//fullBlock
         if (!d["blocks"][j]["fullBlock"].GetBool())
-          m_nodeStats->extHeadersSentBytes += d["blocks"][j]["availableChunks"].Size()*1;
+          m_nodeStats->extHeadersSentBytes[m_nodeId] += d["blocks"][j]["availableChunks"].Size()*1;
       }
       break;
     }
     case BLOCK:
     {
-	  for(int k = 0; k < d["blocks"].Size(); k++)
-        m_nodeStats->blockSentBytes += d["blocks"][k]["size"].GetInt();
-      m_nodeStats->blockSentBytes += m_bitcoinMessageHeader;
+      m_nodeStats->blockSentBytes[m_nodeId] += GetBlockMessageBytes(d);
       break;
     }
     case CHUNK:
     {
-      for(int k = 0; k < d["chunks"].Size(); k++)
-      {
-        int noChunks = ceil(d["chunks"][k]["size"].GetInt() / static_cast<double>(m_chunkSize));
-        if (d["chunks"][k]["chunk"] == noChunks -1 && d["chunks"][k]["size"].GetInt() % m_chunkSize > 0)
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["size"].GetInt() % m_chunkSize;
-        else
-          m_nodeStats->chunkSentBytes += m_chunkSize;
-	  
-        m_nodeStats->chunkSentBytes += 1 + 1;//the requested chunk + the fullBlock
-        if (!d["chunks"][k]["fullBlock"].GetBool())
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["availableChunks"].Size();
-        if (d["chunks"][k]["requestChunks"].Size() > 0)
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["requestChunks"].Size() - 1;	  
-      }
-      m_nodeStats->chunkSentBytes += m_bitcoinMessageHeader;
+      m_nodeStats->chunkSentBytes[m_nodeId] += GetChunkMessageBytes(d);
       break;
     }
     case GET_DATA:
     {
-      m_nodeStats->getDataSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_inventorySizeBytes;
+      m_nodeStats->getDataSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_inventorySizeBytes;
       break;
     }
     case EXT_GET_DATA:
     {
-      m_nodeStats->extGetDataSentBytes += m_bitcoinMessageHeader + m_countBytes + d["chunks"].Size()*m_inventorySizeBytes;
+      m_nodeStats->extGetDataSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + d["chunks"].Size()*m_inventorySizeBytes;
       for (int j=0; j<d["chunks"].Size(); j++)
       {
-        m_nodeStats->extGetDataSentBytes += 6; //1Byte(fullBlock) + 4Bytes(numberOfChunks) + 1Byte(requested chunk)
+        m_nodeStats->extGetDataSentBytes[m_nodeId] += 6; //1Byte(fullBlock) + 4Bytes(numberOfChunks) + 1Byte(requested chunk)
         if (!d["chunks"][j]["fullBlock"].GetBool())
-          m_nodeStats->extGetDataSentBytes += d["chunks"][j]["availableChunks"].Size();
+          m_nodeStats->extGetDataSentBytes[m_nodeId] += d["chunks"][j]["availableChunks"].Size();
       }
       break;
     }
   }  
 }
 
-void
-BitcoinNode::SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, rapidjson::Document &d, Address &outgoingAddress)
+
+long
+BitcoinNode::GetBlockMessageBytes(const rapidjson::Document &d) const
 {
-  NS_LOG_FUNCTION (this);
-  
-  const uint8_t delimiter[] = "#";
+  long bytes = m_bitcoinMessageHeader;
 
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-				
-  d["message"].SetInt(responseMessage);
-  d.Accept(writer);
-  NS_LOG_INFO ("Node " << GetNode ()->GetId () << " got a " 
-               << getMessageName(receivedMessage) << " message" 
-               << " and sent a " << getMessageName(responseMessage) 
-               << " message: " << buffer.GetString());
-			
-  Ipv4Address outgoingIpv4Address = InetSocketAddress::ConvertFrom(outgoingAddress).GetIpv4 ();
-  std::map<Ipv4Address, Ptr<Socket>>::iterator it = m_peersSockets.find(outgoingIpv4Address);
-  
-  if (it == m_peersSockets.end()) //Create the socket if it doesn't exist
-  {
-    m_peersSockets[outgoingIpv4Address] = Socket::CreateSocket (GetNode (), TcpSocketFactory::GetTypeId ());  
-    m_peersSockets[outgoingIpv4Address]->Connect (InetSocketAddress (outgoingIpv4Address, m_bitcoinPort));
-  }
-  
-  m_peersSockets[outgoingIpv4Address]->Send (reinterpret_cast<const uint8_t*>(buffer.GetString()), buffer.GetSize(), 0);
-  m_peersSockets[outgoingIpv4Address]->Send (delimiter, 1, 0);	
+  for(int k = 0; k < d["blocks"].Size(); k++)
+    bytes += d["blocks"][k]["size"].GetInt();
+  return bytes;
+}
 
-  switch (d["message"].GetInt()) 
+
+long
+BitcoinNode::GetChunkMessageBytes(const rapidjson::Document &d) const
+{
+  long bytes = m_bitcoinMessageHeader;
+
+  for(int k = 0; k < d["chunks"].Size(); k++)
   {
-    case INV:
-    {
-      m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
-      break;
-    }
-    case EXT_INV:
-    {
-      m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
-      for (int j=0; j<d["inv"].Size(); j++)
-      {
-        m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
-        if (!d["inv"][j]["fullBlock"].GetBool())
-          m_nodeStats->extInvSentBytes += d["inv"][j]["availableChunks"].Size();
-      }
-      break;
-    }
-    case GET_HEADERS:
-    {
-      m_nodeStats->getHeadersSentBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
-      break;
-    }
-    case EXT_GET_HEADERS:
-    {
-      m_nodeStats->extGetHeadersSentBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
-      break;
-    }
-    case HEADERS:
-    {
-      m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
-      break;
-    }
-    case EXT_HEADERS:
-    {
-      m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
-      for (int j=0; j<d["blocks"].Size(); j++)
-      {
-        m_nodeStats->extHeadersSentBytes += 1;//fullBlock
-        if (!d["blocks"][j]["fullBlock"].GetBool())
-          m_nodeStats->extHeadersSentBytes += d["blocks"][j]["availableChunks"].Size()*1;
-      }
-      break;
-    }
-    case BLOCK:
-    {
-	  for(int k = 0; k < d["blocks"].Size(); k++)
-        m_nodeStats->blockSentBytes += d["blocks"][k]["size"].GetInt();
-      m_nodeStats->blockSentBytes += m_bitcoinMessageHeader;
-      break;
-    }
-    case CHUNK:
-    {
-      for(int k = 0; k < d["chunks"].Size(); k++)
-      {
-        int noChunks = ceil(d["chunks"][k]["size"].GetInt() / static_cast<double>(m_chunkSize));
-        if (d["chunks"][k]["chunk"] == noChunks -1 && d["chunks"][k]["size"].GetInt() % m_chunkSize > 0)
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["size"].GetInt() % m_chunkSize;
-        else
-          m_nodeStats->chunkSentBytes += m_chunkSize;
+    int noChunks = ceil(d["chunks"][k]["size"].GetInt() / static_cast<double>(m_chunkSize));
+    if (d["chunks"][k]["chunk"] == noChunks -1 && d["chunks"][k]["size"].GetInt() % m_chunkSize > 0)
+      bytes += d["chunks"][k]["size"].GetInt() % m_chunkSize;
+    else
+      bytes += m_chunkSize;
 	  
-        m_nodeStats->chunkSentBytes += 1 + 1;//the requested chunk + the fullBlock
-        if (!d["chunks"][k]["fullBlock"].GetBool())
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["availableChunks"].Size();
-        if (d["chunks"][k]["requestChunks"].Size() > 0)
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["requestChunks"].Size() - 1;
-      }
-      m_nodeStats->chunkSentBytes += m_bitcoinMessageHeader;
-      break;
-    }
-    case GET_DATA:
-    {
-      m_nodeStats->getDataSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_inventorySizeBytes;
-      break;
-    }
-    case EXT_GET_DATA:
-    {
-      m_nodeStats->extGetDataSentBytes += m_bitcoinMessageHeader + m_countBytes + d["chunks"].Size()*m_inventorySizeBytes;
-      for (int j=0; j<d["chunks"].Size(); j++)
-      {
-        m_nodeStats->extGetDataSentBytes += 6; //1Byte(fullBlock) + 4Bytes(numberOfChunks) + 1Byte(requested chunk)
-        if (!d["chunks"][j]["fullBlock"].GetBool())
-          m_nodeStats->extGetDataSentBytes += d["chunks"][j]["availableChunks"].Size();
-      }
-      break;
-    }
-  } 
+    bytes += 1 + 1;//the requested chunk + the fullBlock
+    if (!d["chunks"][k]["fullBlock"].GetBool())
+      bytes += d["chunks"][k]["availableChunks"].Size();
+    if (d["chunks"][k]["requestChunks"].Size() > 0)
+      bytes += d["chunks"][k]["requestChunks"].Size() - 1;
+  }
+  return bytes;
 }
 
 
 void
-BitcoinNode::SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, std::string packet, Address &outgoingAddress)
+BitcoinNode::SendFrame(const std::string &frame, Ipv4Address outgoingIpv4Address)
 {
-  NS_LOG_FUNCTION (this);
-  
-  const uint8_t delimiter[] = "#";
-  rapidjson::Document d;
+  BITCOIN_MESSAGE_LOG_FUNCTION (this);
   
-  rapidjson::StringBuffer buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  if (m_fastLinkChannel)
+  {
+    m_fastLinkChannel->Send (GetNode ()->GetId (), outgoingIpv4Address, frame);
+    return;
+  }
 
-  d.Parse(packet.c_str());  
-  d["message"].SetInt(responseMessage);
-  d.Accept(writer);
-  NS_LOG_INFO ("Node " << GetNode ()->GetId () << " got a " 
-               << getMessageName(receivedMessage) << " message" 
-               << " and sent a " << getMessageName(responseMessage) 
-               << " message: " << buffer.GetString());
-			
-  Ipv4Address outgoingIpv4Address = InetSocketAddress::ConvertFrom(outgoingAddress).GetIpv4 ();
   std::map<Ipv4Address, Ptr<Socket>>::iterator it = m_peersSockets.find(outgoingIpv4Address);
   
   if (it == m_peersSockets.end()) //Create the socket if it doesn't exist
@@ -3128,98 +3007,8 @@ BitcoinNode::SendMessage(enum Messages receivedMessage,  enum Messages responseM
     m_peersSockets[outgoingIpv4Address] = Socket::CreateSocket (GetNode (), TcpSocketFactory::GetTypeId ());  
     m_peersSockets[outgoingIpv4Address]->Connect (InetSocketAddress (outgoingIpv4Address, m_bitcoinPort));
   }
-  
-  m_peersSockets[outgoingIpv4Address]->Send (reinterpret_cast<const uint8_t*>(buffer.GetString()), buffer.GetSize(), 0);
-  m_peersSockets[outgoingIpv4Address]->Send (delimiter, 1, 0);	
 
-  
-  switch (d["message"].GetInt()) 
-  {
-    case INV:
-    {
-      m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
-      break;
-    }
-    case EXT_INV:
-    {
-      m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + d["inv"].Size()*m_inventorySizeBytes;
-      for (int j=0; j<d["inv"].Size(); j++)
-      {
-        m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
-        if (!d["inv"][j]["fullBlock"].GetBool())
-          m_nodeStats->extInvSentBytes += d["inv"][j]["availableChunks"].Size();
-      }
-      break;
-    }
-    case GET_HEADERS:
-    {
-      m_nodeStats->getHeadersSentBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
-      break;
-    }
-    case EXT_GET_HEADERS:
-    {
-      m_nodeStats->extGetHeadersSentBytes += m_bitcoinMessageHeader + m_getHeadersSizeBytes;
-      break;
-    }
-    case HEADERS:
-    {
-      m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
-      break;
-    }
-    case EXT_HEADERS:
-    {
-      m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_headersSizeBytes;
-      for (int j=0; j<d["blocks"].Size(); j++)
-      {
-        m_nodeStats->extHeadersSentBytes += 1;//fullBlock
-        if (!d["blocks"][j]["fullBlock"].GetBool())
-          m_nodeStats->extHeadersSentBytes += d["blocks"][j]["availableChunks"].Size()*1;
-      }
-      break;
-    }
-    case BLOCK:
-    {
-	  for(int k = 0; k < d["blocks"].Size(); k++)
-        m_nodeStats->blockSentBytes += d["blocks"][k]["size"].GetInt();
-      m_nodeStats->blockSentBytes += m_bitcoinMessageHeader;
-      break;
-    }
-    case CHUNK:
-    {
-      for(int k = 0; k < d["chunks"].Size(); k++)
-      {
-        int noChunks = ceil(d["chunks"][k]["size"].GetInt() / static_cast<double>(m_chunkSize));
-        if (d["chunks"][k]["chunk"] == noChunks -1 && d["chunks"][k]["size"].GetInt() % m_chunkSize > 0)
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["size"].GetInt() % m_chunkSize;
-        else
-          m_nodeStats->chunkSentBytes += m_chunkSize;
-	  
-        m_nodeStats->chunkSentBytes += 1 + 1;//the requested chunk + the fullBlock
-        if (!d["chunks"][k]["fullBlock"].GetBool())
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["availableChunks"].Size();
-        if (d["chunks"][k]["requestChunks"].Size() > 0)
-          m_nodeStats->chunkSentBytes += d["chunks"][k]["requestChunks"].Size() - 1;
-      }
-      m_nodeStats->chunkSentBytes += m_bitcoinMessageHeader;
-      break;
-    }
-    case GET_DATA:
-    {
-      m_nodeStats->getDataSentBytes += m_bitcoinMessageHeader + m_countBytes + d["blocks"].Size()*m_inventorySizeBytes;
-      break;
-    }
-    case EXT_GET_DATA:
-    {
-      m_nodeStats->extGetDataSentBytes += m_bitcoinMessageHeader + m_countBytes + d["chunks"].Size()*m_inventorySizeBytes;
-      for (int j=0; j<d["chunks"].Size(); j++)
-      {
-        m_nodeStats->extGetDataSentBytes += 6; //1Byte(fullBlock) + 4Bytes(numberOfChunks) + 1Byte(requested chunk)
-        if (!d["chunks"][j]["fullBlock"].GetBool())
-          m_nodeStats->extGetDataSentBytes += d["chunks"][j]["availableChunks"].Size();
-      }
-      break;
-    }
-  } 
+  m_peersSockets[outgoingIpv4Address]->Send (reinterpret_cast<const uint8_t*>(frame.data()), frame.size(), 0);
 }
 
 
@@ -3360,30 +3149,28 @@ BitcoinNode::PrintOnlyHeadersReceived()
 
 
 void
-BitcoinNode::InvTimeoutExpired(std::string blockHash)
+BitcoinNode::InvTimeoutExpired(BlockId blockId)
 {
   NS_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_INV_TIMEOUT);
 
-  std::string   invDelimiter = "/";
-  size_t        invPos = blockHash.find(invDelimiter);
-
-  int height = atoi(blockHash.substr(0, invPos).c_str());
-  int minerId = atoi(blockHash.substr(invPos+1, blockHash.size()).c_str());
+  int height = blockId.GetBlockHeight();
+  int minerId = blockId.GetMinerId();
   
   NS_LOG_INFO ("Node " << GetNode ()->GetId () << ": At time "  << Simulator::Now ().GetSeconds ()
-                << " the timeout for block " << blockHash << " expired");
+                << " the timeout for block " << blockId << " expired");
   
-  m_nodeStats->blockTimeouts ++;
+  m_nodeStats->blockTimeouts[m_nodeId] ++;
   //PrintQueueInv();
   //PrintInvTimeouts();
   
-  m_queueInv[blockHash].erase(m_queueInv[blockHash].begin());
-  m_invTimeouts.erase(blockHash);
+  m_queueInv[blockId].erase(m_queueInv[blockId].begin());
+  m_invTimeouts.erase(blockId);
   
   //PrintQueueInv();
   //PrintInvTimeouts();
   
-  if (!m_queueInv[blockHash].empty() && !m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockHash))
+  if (!m_queueInv[blockId].empty() && !m_blockchain.HasBlock(height, minerId) && !m_blockchain.IsOrphan(height, minerId) && !ReceivedButNotValidated(blockId))
   {
     rapidjson::Document   d; 
     EventId               timeout;
@@ -3397,63 +3184,49 @@ BitcoinNode::InvTimeoutExpired(std::string blockHash)
     value.SetString("block");
     d.AddMember("type", value, d.GetAllocator());
 	
+    std::string blockHash = blockId.ToString();
     value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
     array.PushBack(value, d.GetAllocator());
     d.AddMember("blocks", array, d.GetAllocator());
 
-    int index = rand() % m_queueInv[blockHash].size();
-    Address temp = m_queueInv[blockHash][0];
-    m_queueInv[blockHash][0] = m_queueInv[blockHash][index];
-    m_queueInv[blockHash][index] = temp;
+    int index = m_peerSelectionStream.GetInteger(m_queueInv[blockId].size());
+    Address temp = m_queueInv[blockId][0];
+    m_queueInv[blockId][0] = m_queueInv[blockId][index];
+    m_queueInv[blockId][index] = temp;
     	
-    SendMessage(INV, GET_HEADERS, d, *(m_queueInv[blockHash].begin()));				
-    SendMessage(INV, GET_DATA, d, *(m_queueInv[blockHash].begin()));	
+    SendMessage(INV, GET_HEADERS, d, *(m_queueInv[blockId].begin()));				
+    SendMessage(INV, GET_DATA, d, *(m_queueInv[blockId].begin()));	
 					
-    timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, blockHash);
-    m_invTimeouts[blockHash] = timeout;
+    timeout = Simulator::Schedule (m_invTimeoutMinutes, &BitcoinNode::InvTimeoutExpired, this, blockId);
+    m_invTimeouts[blockId] = timeout;
   }
   else
-    m_queueInv.erase(blockHash);
+    m_queueInv.erase(blockId);
     
   //PrintQueueInv();
   //PrintInvTimeouts();
+
+  UpdateNetworkState();
 }
 
 
 void
-BitcoinNode::ChunkTimeoutExpired(std::string chunk)
+BitcoinNode::ChunkTimeoutExpired(ChunkId chunk)
 {
   NS_LOG_FUNCTION (this);
-
-  std::string            invDelimiter = "/";
-  std::string            chunkHashHelp = chunk.substr(0);
-  std::ostringstream     help;
-  std::string            blockHash;
-  size_t                 invPos = chunkHashHelp.find(invDelimiter);
-  
-  int height = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-  chunkHashHelp.erase(0, invPos + invDelimiter.length());
-  invPos = chunkHashHelp.find(invDelimiter);
-  int minerId = atoi(chunkHashHelp.substr(0, invPos).c_str());
-				  
-  chunkHashHelp.erase(0, invPos + invDelimiter.length());
-  int chunkId = atoi(chunkHashHelp.substr(0).c_str());
-  
-  help << height << "/" << minerId;
-  blockHash = help.str();
+  ProfilerScope profile (m_profiler, PROFILE_CHUNK_TIMEOUT);
   
   NS_LOG_WARN ("Node " << GetNode ()->GetId () << ": At time "  << Simulator::Now ().GetSeconds ()
                 << " the timeout for chunk " << chunk << " expired");
 				
-  m_nodeStats->chunkTimeouts ++;
+  m_nodeStats->chunkTimeouts[m_nodeId] ++;
 
 /*   PrintChunkTimeouts();
   PrintQueueChunks();
   PrintQueueChunkPeers(); */
   
   m_chunkTimeouts.erase(chunk);
-  m_queueChunks[blockHash].push_back(chunkId);
+  m_queueChunks[chunk.GetBlockId()].push_back(chunk.GetChunkId());
   
 /*   PrintChunkTimeouts();
   PrintQueueChunks();
@@ -3462,11 +3235,11 @@ BitcoinNode::ChunkTimeoutExpired(std::string chunk)
 
 
 bool 
-BitcoinNode::ReceivedButNotValidated (std::string blockHash)
+BitcoinNode::ReceivedButNotValidated (const BlockId &blockId)
 {
   NS_LOG_FUNCTION (this);
   
-  if ( m_receivedNotValidated.find(blockHash) != m_receivedNotValidated.end() )
+  if ( m_receivedNotValidated.find(blockId) != m_receivedNotValidated.end() )
     return true;
   else
     return false;
@@ -3474,28 +3247,28 @@ BitcoinNode::ReceivedButNotValidated (std::string blockHash)
 
 
 void 
-BitcoinNode::RemoveReceivedButNotValidated (std::string blockHash)
+BitcoinNode::RemoveReceivedButNotValidated (const BlockId &blockId)
 {
   NS_LOG_FUNCTION (this);
   
   
-  if ( m_receivedNotValidated.find(blockHash) != m_receivedNotValidated.end() )
+  if ( m_receivedNotValidated.find(blockId) != m_receivedNotValidated.end() )
   {
-    m_receivedNotValidated.erase(blockHash);
+    m_receivedNotValidated.erase(blockId);
   }
   else
   {
-    NS_LOG_WARN (blockHash << " was not found in m_receivedNotValidated");
+    NS_LOG_WARN (blockId << " was not found in m_receivedNotValidated");
   }
 }
 
 
 bool 
-BitcoinNode::OnlyHeadersReceived (std::string blockHash)
+BitcoinNode::OnlyHeadersReceived (const BlockId &blockId)
 {
   NS_LOG_FUNCTION (this);
   
-  if (m_onlyHeadersReceived.find(blockHash) != m_onlyHeadersReceived.end())
+  if (m_onlyHeadersReceived.find(blockId) != m_onlyHeadersReceived.end())
     return true;
   else
     return false;
@@ -3503,11 +3276,11 @@ BitcoinNode::OnlyHeadersReceived (std::string blockHash)
 
 
 bool 
-BitcoinNode::HasChunk (std::string blockHash, int chunk)
+BitcoinNode::HasChunk (const BlockId &blockId, int chunk)
 {
   NS_LOG_FUNCTION (this);
 
-  if (std::find(m_receivedChunks[blockHash].begin(), m_receivedChunks[blockHash].end(), chunk) != m_receivedChunks[blockHash].end())
+  if (std::find(m_receivedChunks[blockId].begin(), m_receivedChunks[blockId].end(), chunk) != m_receivedChunks[blockId].end())
     return true;
   else
     return false;
@@ -3515,42 +3288,19 @@ BitcoinNode::HasChunk (std::string blockHash, int chunk)
 
 
 void 
-BitcoinNode::RemoveSendTime ()
-{
-  NS_LOG_FUNCTION (this);
-
-  NS_LOG_INFO ("RemoveSendTime: At Time " << Simulator::Now ().GetSeconds () << " " << m_sendBlockTimes.front() << " was removed");
-  m_sendBlockTimes.erase(m_sendBlockTimes.begin());
-}
-
-
-void 
-BitcoinNode::RemoveCompressedBlockSendTime ()
-{
-  NS_LOG_FUNCTION (this);
-
-  NS_LOG_INFO ("RemoveCompressedBlockSendTime: At Time " << Simulator::Now ().GetSeconds () << " " << m_sendCompressedBlockTimes.front() << " was removed");
-  m_sendCompressedBlockTimes.erase(m_sendCompressedBlockTimes.begin());
-}
-
-
-void 
-BitcoinNode::RemoveReceiveTime ()
+BitcoinNode::SetupLinks (void)
 {
   NS_LOG_FUNCTION (this);
 
-  NS_LOG_INFO ("RemoveReceiveTime: At Time " << Simulator::Now ().GetSeconds () << " " << m_receiveBlockTimes.front() << " was removed");
-  m_receiveBlockTimes.erase(m_receiveBlockTimes.begin());
-}
-
-
-void 
-BitcoinNode::RemoveCompressedBlockReceiveTime ()
-{
-  NS_LOG_FUNCTION (this);
+  m_uploadLink.SetRate (m_uploadSpeed);
+  m_compressedUploadLink.SetRate (m_uploadSpeed);
+  m_downloadLink.SetRate (m_downloadSpeed);
+  m_compressedDownloadLink.SetRate (m_downloadSpeed);
 
-  NS_LOG_INFO ("RemoveCompressedBlockReceiveTime: At Time " << Simulator::Now ().GetSeconds () << " " << m_receiveCompressedBlockTimes.front() << " was removed");
-  m_receiveCompressedBlockTimes.erase(m_receiveCompressedBlockTimes.begin());
+  m_uploadLink.SetDiscipline (m_linkDiscipline);
+  m_compressedUploadLink.SetDiscipline (m_linkDiscipline);
+  m_downloadLink.SetDiscipline (m_linkDiscipline);
+  m_compressedDownloadLink.SetDiscipline (m_linkDiscipline);
 }
 
 
@@ -6,12 +6,23 @@
 #define BITCOIN_NODE_H
 
 #include <algorithm>
+#include <unordered_map>
 #include "ns3/application.h"
 #include "ns3/event-id.h"
 #include "ns3/ptr.h"
 #include "ns3/traced-callback.h"
 #include "ns3/address.h"
 #include "bitcoin.h"
+#include "bitcoin-message-codec.h"
+#include "bitcoin-link-scheduler.h"
+#include "bitcoin-fast-link-channel.h"
+#include "bitcoin-random-stream.h"
+#include "bitcoin-node-stats.h"
+#include "bitcoin-propagation-trace.h"
+#include "bitcoin-profiler.h"
+#include "bitcoin-network-sampler.h"
+#include "bitcoin-memory-accountant.h"
+#include "bitcoin-log.h"
 #include "ns3/boolean.h"
 #include "../../rapidjson/document.h"
 #include "../../rapidjson/writer.h"
@@ -47,6 +58,11 @@ public:
    * \return a vector containing the addresses of peers
    */  
   std::vector<Ipv4Address> GetPeersAddresses (void) const;
+
+  /**
+   * \return the current fork statistics of the node's blockchain. They are maintained incrementally, so they can be sampled at any time
+   */
+  forkStatistics GetForkStatistics (void) const;
   
   
   /**
@@ -75,9 +91,9 @@ public:
   
   /**
    * \brief Set the node statistics
-   * \param nodeStats a reference to a nodeStatistics struct
+   * \param nodeStats the registry of the statistics of all the nodes, which must contain this node
    */
-  void SetNodeStats (nodeStatistics *nodeStats);
+  void SetNodeStats (Ptr<NodeStatsRegistry> nodeStats);
   
   /**
    * \brief Set the protocol type(default: STANDARD_PROTOCOL)
@@ -85,6 +101,50 @@ public:
    */
   void SetProtocolType (enum ProtocolType protocolType);
 
+  /**
+   * \brief Set the fast link channel. When it is set, the messages are delivered through it instead of the TCP/IP stack
+   * \param fastLinkChannel the channel shared by all the nodes
+   */
+  void SetFastLinkChannel (Ptr<FastLinkChannel> fastLinkChannel);
+
+  /**
+   * \brief Sets the trace which records when the node receives and validates blocks
+   * \param propagationTrace the trace. A null trace disables the recording
+   */
+  void SetPropagationTrace (Ptr<PropagationTrace> propagationTrace);
+
+  /**
+   * \brief Sets the profiler which measures the wall time of the handlers of the node
+   * \param profiler the profiler. A null profiler disables the profiling
+   */
+  void SetSimulationProfiler (Ptr<SimulationProfiler> profiler);
+
+  /**
+   * \brief Sets the sampler which records the state of the network periodically, and reports the current state of the node to it
+   * \param sampler the sampler. A null sampler disables the reports
+   */
+  void SetNetworkStateSampler (Ptr<NetworkStateSampler> sampler);
+
+  /**
+   * \brief Sets the accountant which estimates the memory of the subsystems of the node, and registers the node to it
+   * \param accountant the accountant. A null accountant disables the accounting
+   */
+  void SetMemoryAccountant (Ptr<MemoryAccountant> accountant);
+
+  /**
+   * \brief Adds the estimated Bytes of the subsystems of the node to the accountant
+   */
+  void AccountMemory (MemoryAccountant &accountant) const;
+
+  /**
+   * \brief Adds a block on top of the current tip, as if the node had mined it, and broadcasts it to all the peers.
+   * It lets the BlockInjector use ordinary nodes as the locations of the miners. Only the STANDARD and UNSOLICITED
+   * broadcast types are supported, since the relay network types need the miners to be interconnected.
+   * \param blockSizeBytes the size of the block
+   * \param blockBroadcastType the broadcast type of the block, as for a miner
+   */
+  void InjectBlock (int blockSizeBytes, enum BlockBroadcastType blockBroadcastType);
+
 protected:
   virtual void DoDispose (void);           // inherited from Application base class.
 
@@ -96,6 +156,22 @@ protected:
    * \param socket the receiving socket
    */
   void HandleRead (Ptr<Socket> socket);
+
+  /**
+   * \brief Handle a frame delivered by the fast link channel
+   * \param frame the received frame
+   * \param from the address of the peer
+   */
+  void HandleFrame (const std::string &frame, const Address &from);
+
+  /**
+   * \brief Handle a decoded message
+   * \param d the rapidjson document containing the info of the message
+   * \param frame the received frame of the message, which is queued unchanged by the BLOCK and CHUNK messages
+   * \param frameSize the size of the frame in Bytes
+   * \param from the address of the peer
+   */
+  void HandleMessage (rapidjson::Document &d, const char *frame, size_t frameSize, Address &from);
   
   /**
    * \brief Handle an incoming connection
@@ -118,14 +194,14 @@ protected:
 
   /**
    * \brief Handle an incoming BLOCK Message.
-   * \param blockInfo the block message info 
+   * \param blockInfo the encoded frame of the block message
    * \param from the address the connection is from
    */
   void ReceivedBlockMessage(std::string &blockInfo, Address &from);	
 
   /**
    * \brief Handle an incoming CHUNK Message.
-   * \param chunkInfo the chunk message info 
+   * \param chunkInfo the encoded frame of the chunk message
    * \param from the address the connection is from
    */
   void ReceivedChunkMessage(std::string &chunkInfo, Address &from);		
@@ -143,18 +219,38 @@ protected:
   void ReceivedLastChunk(const Block &newBlock);				           
 
   /**
-   * \brief Sends a BLOCK message as a response to a GET_DATA message
-   * \param packetInfo the info of the BLOCK message
+   * \brief Sends a BLOCK message as a response to a GET_DATA message, when its transfer starts on the upload link.
+   * The frame is sent as it was encoded, and its Bytes are counted now, not when the message was queued.
+   * \param packetInfo the encoded frame of the BLOCK message
+   * \param sentBytes the Bytes of the message, as returned by GetBlockMessageBytes
    * \param from the address the GET_DATA was received from
    */
-  void SendBlock(std::string packetInfo, Address &from);
+  void SendBlock(std::string packetInfo, long sentBytes, Address &from);
 
   /**
-   * \brief Sends a CHUNK message as a response to a EXT_GET_DATA/CHUNK message
-   * \param packetInfo the info of the CHUNK message
+   * \brief Sends an unsolicited BLOCK message of a new block, once it has gone through the upload link. The frame is sent
+   * as it was encoded, and its Bytes are not counted, since they were counted when the message was queued.
+   * \param packetInfo the encoded frame of the BLOCK message
+   * \param to the Ipv4Address of the peer
+   */
+  void SendUnsolicitedBlock(std::string packetInfo, Ipv4Address to);
+
+  /**
+   * \brief Fills d with the unsolicited BLOCK message of a new block, as broadcast by its miner
+   * \param newBlock the new block
+   * \param type the type of the block: "block", or "compressed-block" for the miners of the relay networks
+   * \param d the message, whose previous members are removed
+   */
+  void CreateBlockMessage(const Block &newBlock, const char *type, rapidjson::Document &d);
+
+  /**
+   * \brief Sends a CHUNK message as a response to a EXT_GET_DATA/CHUNK message, when its transfer starts on the upload link.
+   * The frame is sent as it was encoded, and its Bytes are counted now, not when the message was queued.
+   * \param packetInfo the encoded frame of the CHUNK message
+   * \param sentBytes the Bytes of the message, as returned by GetChunkMessageBytes
    * \param from the address the EXT_GET_DATA/CHUNK was received from
    */
-  void SendChunk(std::string packetInfo, Address &from);				   
+  void SendChunk(std::string packetInfo, long sentBytes, Address &from);				   
 
   /**
    * \brief Called for blocks with higher score(height)
@@ -173,6 +269,18 @@ protected:
    * \param newBlock the new block
    */
   void AfterBlockValidation(const Block &newBlock);
+
+  /**
+   * \brief Records a block which was added to the blockchain in the propagation trace, if the node has one
+   * \param newBlock the new block
+   */
+  void TraceBlock(const Block &newBlock);
+
+  /**
+   * \brief Reports the changes of the tip, the queued INVs and the INV timeouts since the previous report
+   * to the network sampler, if the node has one. It is called at the end of the events which may change them.
+   */
+  void UpdateNetworkState(void);
   
   /**
    * \brief Validates any ophan children of the newly received block
@@ -203,9 +311,9 @@ protected:
    * \param receivedMessage the type of the received message
    * \param responseMessage the type of the response message
    * \param d the rapidjson document containing the info of the outgoing message
-   * \param outgoingSocket the socket of the peer
+   * \param outgoingIpv4Address the Ipv4Address of the peer
    */
-  void SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, rapidjson::Document &d, Ptr<Socket> outgoingSocket);
+  void SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, rapidjson::Document &d, Ipv4Address outgoingIpv4Address);
   
   /**
    * \brief Sends a message to a peer
@@ -217,13 +325,27 @@ protected:
   void SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, rapidjson::Document &d, Address &outgoingAddress);
   
   /**
-   * \brief Sends a message to a peer
-   * \param receivedMessage the type of the received message
-   * \param responseMessage the type of the response message
-   * \param packet a string containing the info of the outgoing message
-   * \param outgoingAddress the Address of the peer
+   * \brief Adds the Bytes of an outgoing message to the statistics of the node
+   * \param d the rapidjson document containing the info of the outgoing message
    */
-  void SendMessage(enum Messages receivedMessage,  enum Messages responseMessage, std::string packet, Address &outgoingAddress);
+  void CountSentBytes(const rapidjson::Document &d);
+
+  /**
+   * \return the Bytes of a BLOCK message, as counted in the blockSentBytes of the node
+   */
+  long GetBlockMessageBytes(const rapidjson::Document &d) const;
+
+  /**
+   * \return the Bytes of a CHUNK message, as counted in the chunkSentBytes of the node
+   */
+  long GetChunkMessageBytes(const rapidjson::Document &d) const;
+
+  /**
+   * \brief Sends an encoded frame to a peer
+   * \param frame the frame created by EncodeMessage
+   * \param outgoingIpv4Address the Ipv4Address of the peer
+   */
+  void SendFrame(const std::string &frame, Ipv4Address outgoingIpv4Address);
 
   /**
    * \brief Print m_queueInv to stdout
@@ -262,62 +384,47 @@ protected:
 
   /**
    * \brief Called when a timeout for a block expires
-   * \param blockHash the block hash for which the timeout expired
+   * \param blockId the block id for which the timeout expired
    */
-  void InvTimeoutExpired (std::string blockHash);
+  void InvTimeoutExpired (BlockId blockId);
   
   /**
    * \brief Called when a timeout for a chunk expires
-   * \param blockHash the chunk hash for which the timeout expired
+   * \param chunk the chunk id for which the timeout expired
    */
-  void ChunkTimeoutExpired (std::string chunk);
+  void ChunkTimeoutExpired (ChunkId chunk);
 
   /**
    * \brief Checks if a block has been received but not been validated yet (if it is included in m_receivedNotValidated)
-   * \param blockHash the block hash 
+   * \param blockId the block id 
    * \return true if the block has been received but not validated yet, false otherwise
    */
-  bool ReceivedButNotValidated (std::string blockHash);
+  bool ReceivedButNotValidated (const BlockId &blockId);
   
   /**
    * \brief Removes a block from m_receivedNotValidated
-   * \param blockHash the block hash 
+   * \param blockId the block id 
    */
-  void RemoveReceivedButNotValidated (std::string blockHash);
+  void RemoveReceivedButNotValidated (const BlockId &blockId);
 
   /**
    * \brief Checks if the node has received only the headers of a particular block (if it is included in m_onlyHeadersReceived)
-   * \param blockHash the block hash 
+   * \param blockId the block id 
    * \return true if only the block headers have been received, false otherwise
    */
-  bool OnlyHeadersReceived (std::string blockHash);
+  bool OnlyHeadersReceived (const BlockId &blockId);
   
   /**
    * \brief Checks if the node has received a particular chunk of a specific block
-   * \param blockHash the block hash 
-   * \param blockHash the chunk id
-   */
-  bool HasChunk (std::string blockHash, int chunk);
-
-  /**
-   * \brief Removes the fist element from m_sendBlockTimes, when a block is sent
-   */
-  void RemoveSendTime ();
-  
-  /**
-   * \brief Removes the fist element from m_sendCompressedBlockTimes, when a compressed-block is sent
+   * \param blockId the block id 
+   * \param chunk the chunk id
    */
-  void RemoveCompressedBlockSendTime ();
+  bool HasChunk (const BlockId &blockId, int chunk);
 
   /**
-   * \brief Removes the fist element from m_receiveBlockTimes, when a block is received
-   */
-  void RemoveReceiveTime ();
-  
-  /**
-   * \brief Removes the fist element from m_receiveCompressedBlockTimes, when a compressed-block is received
+   * \brief Sets the rates and the discipline of the link schedulers. Called when the application starts
    */
-  void RemoveCompressedBlockReceiveTime ();
+  void SetupLinks (void);
 
   // In the case of TCP, each socket accept returns a new socket, so the 
   // listening socket is stored separately from the accepted sockets
@@ -344,21 +451,33 @@ protected:
   std::map<Ipv4Address, double>                       m_peersDownloadSpeeds;            //!< The peersDownloadSpeeds of channels
   std::map<Ipv4Address, double>                       m_peersUploadSpeeds;              //!< The peersUploadSpeeds of channels
   std::map<Ipv4Address, Ptr<Socket>>                  m_peersSockets;                   //!< The sockets of peers
-  std::map<std::string, std::vector<Address>>         m_queueInv;                       //!< map holding the addresses of nodes which sent an INV for a particular block
-  std::map<std::string, std::vector<Address>>         m_queueChunkPeers;                //!< map holding the addresses of nodes from which we are waiting for a CHUNK, key = block_hash
-  std::map<std::string, std::vector<int>>             m_queueChunks;                    //!< map holding the chunks of the blocks which we have not requested yet, key = block_hash
-  std::map<std::string, std::vector<int>>             m_receivedChunks;                 //!< map holding the chunks of the blocks which we are currently downloading, key = block_hash
-  std::map<std::string, EventId>                      m_invTimeouts;                    //!< map holding the event timeouts of inv messages
-  std::map<std::string, EventId>                      m_chunkTimeouts;                  //!< map holding the event timeouts of chunk messages
-  std::map<Address, std::string>                      m_bufferedData;                   //!< map holding the buffered data from previous handleRead events
-  std::map<std::string, Block>                        m_receivedNotValidated;           //!< vector holding the received but not yet validated blocks
-  std::map<std::string, Block>                        m_onlyHeadersReceived;            //!< vector holding the blocks that we know but not received
-  nodeStatistics                                     *m_nodeStats;                      //!< struct holding the node stats
-  std::vector<double>                                 m_sendBlockTimes;                 //!< contains the times of the next sendBlock events
-  std::vector<double>                                 m_sendCompressedBlockTimes;       //!< contains the times of the next sendBlock events
-  std::vector<double>                                 m_receiveBlockTimes;              //!< contains the times of the next sendBlock events
-  std::vector<double>                                 m_receiveCompressedBlockTimes;    //!< contains the times of the next sendBlock events
+  std::unordered_map<BlockId, std::vector<Address>, BlockIdHash>   m_queueInv;         //!< map holding the addresses of nodes which sent an INV for a particular block
+  std::unordered_map<BlockId, std::vector<Address>, BlockIdHash>   m_queueChunkPeers;  //!< map holding the addresses of nodes from which we are waiting for a CHUNK, key = block_id
+  std::unordered_map<BlockId, std::vector<int>, BlockIdHash>       m_queueChunks;      //!< map holding the chunks of the blocks which we have not requested yet, key = block_id
+  std::unordered_map<BlockId, std::vector<int>, BlockIdHash>       m_receivedChunks;   //!< map holding the chunks of the blocks which we are currently downloading, key = block_id
+  std::unordered_map<BlockId, EventId, BlockIdHash>                m_invTimeouts;      //!< map holding the event timeouts of inv messages
+  std::unordered_map<ChunkId, EventId, ChunkIdHash>                m_chunkTimeouts;    //!< map holding the event timeouts of chunk messages
+  std::map<Address, ReceiveBuffer>                    m_receiveBuffers;                 //!< map holding the receive buffers of the peers, with the data of the incomplete frames
+  std::unordered_map<BlockId, Block, BlockIdHash>                  m_receivedNotValidated;  //!< vector holding the received but not yet validated blocks
+  std::unordered_map<BlockId, Block, BlockIdHash>                  m_onlyHeadersReceived;   //!< vector holding the blocks that we know but not received
+  Ptr<NodeStatsRegistry>                              m_nodeStats;                      //!< the registry holding the node stats
+  uint32_t                                            m_nodeId;                         //!< the id of the node, which indexes its stats
+  LinkScheduler                                       m_uploadLink;                     //!< serializes the blocks and chunks sent by the node
+  LinkScheduler                                       m_compressedUploadLink;           //!< serializes the compressed-blocks sent by the node
+  LinkScheduler                                       m_downloadLink;                   //!< serializes the blocks and chunks received by the node
+  LinkScheduler                                       m_compressedDownloadLink;         //!< serializes the compressed-blocks received by the node
+  enum LinkDiscipline                                 m_linkDiscipline;                 //!< the discipline used to share the links between the peers
   enum ProtocolType                                   m_protocolType;                   //!< protocol type
+  enum MessageCodec                                   m_messageCodec;                   //!< the codec used to encode the messages on the wire
+  RandomStream                                        m_peerSelectionStream;            //!< chooses the chunks to request and the peers to request blocks from
+  Ptr<FastLinkChannel>                                m_fastLinkChannel;                //!< the channel which delivers the messages in fast link mode, null when the TCP/IP stack is used
+  Ptr<PropagationTrace>                               m_propagationTrace;               //!< the trace of the received blocks, null when disabled
+  Ptr<SimulationProfiler>                             m_profiler;                       //!< the profiler of the handlers, null when disabled
+  Ptr<NetworkStateSampler>                            m_networkSampler;                 //!< the sampler of the network state, null when disabled
+  BlockId                                             m_sampledTip;                     //!< the tip last reported to the network sampler
+  int64_t                                             m_sampledQueueInv;                //!< the size of m_queueInv last reported to the network sampler
+  int64_t                                             m_sampledInvTimeouts;             //!< the size of m_invTimeouts last reported to the network sampler
+  Ptr<MemoryAccountant>                               m_memoryAccountant;               //!< the accountant of the memory of the node, null when disabled
 
   const int       m_bitcoinPort;               //!< 8333
   const int       m_secondsPerMin;             //!< 60
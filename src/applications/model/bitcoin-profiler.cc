@@ -0,0 +1,237 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-profiler.h
+ */
+
+#include <cstring>
+#include <iomanip>
+#include <algorithm>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "bitcoin-profiler.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("SimulationProfiler");
+
+NS_OBJECT_ENSURE_REGISTERED (CountingScheduler);
+
+uint64_t CountingScheduler::m_noEvents = 0;
+
+TypeId
+CountingScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingScheduler")
+    .SetParent<MapScheduler> ()
+    .SetGroupName("Applications")
+    .AddConstructor<CountingScheduler> ()
+  ;
+  return tid;
+}
+
+CountingScheduler::CountingScheduler (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+CountingScheduler::~CountingScheduler (void)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Scheduler::Event
+CountingScheduler::RemoveNext (void)
+{
+  m_noEvents++;
+  return MapScheduler::RemoveNext ();
+}
+
+uint64_t
+CountingScheduler::GetNoEvents (void)
+{
+  return m_noEvents;
+}
+
+
+SimulationProfiler::SimulationProfiler (void) : m_profiledScopes (0), m_events (0), m_startEvents (0), m_wallSeconds (0), m_noProcesses (1)
+{
+  NS_LOG_FUNCTION (this);
+  memset (m_entries, 0, sizeof(m_entries));
+  m_scopes.reserve(16);
+}
+
+SimulationProfiler::~SimulationProfiler (void)
+{
+}
+
+void
+SimulationProfiler::Start (void)
+{
+  m_startEvents = CountingScheduler::GetNoEvents ();
+  m_start = Clock::now ();
+}
+
+void
+SimulationProfiler::Stop (void)
+{
+  m_wallSeconds += std::chrono::duration<double> (Clock::now () - m_start).count ();
+  m_events += CountingScheduler::GetNoEvents () - m_startEvents;
+}
+
+void
+SimulationProfiler::Begin (enum ProfiledEvent event, enum Messages message)
+{
+  NS_ASSERT_MSG (event < PROFILED_EVENTS && message < PROFILED_MESSAGES, "Unknown profiled event");
+
+  openScope scope;
+
+  scope.entry = &m_entries[event][message];
+  scope.childSeconds = 0;
+
+  if (m_scopes.empty ())
+    m_profiledScopes++;
+
+  m_scopes.push_back(scope);
+  m_scopes.back().start = Clock::now ();
+}
+
+void
+SimulationProfiler::End (void)
+{
+  Clock::time_point end = Clock::now ();
+
+  NS_ASSERT_MSG (!m_scopes.empty (), "End without Begin");
+
+  openScope &scope = m_scopes.back();
+  double     seconds = std::chrono::duration<double> (end - scope.start).count ();
+
+  scope.entry->count++;
+  scope.entry->totalSeconds += seconds;
+  scope.entry->selfSeconds += seconds - scope.childSeconds;
+  m_scopes.pop_back();
+
+  if (!m_scopes.empty ())
+    m_scopes.back().childSeconds += seconds;
+}
+
+const profileEntry&
+SimulationProfiler::GetEntry (enum ProfiledEvent event, enum Messages message) const
+{
+  return m_entries[event][message];
+}
+
+double
+SimulationProfiler::GetNoProfiledScopes (void) const
+{
+  return m_profiledScopes;
+}
+
+double
+SimulationProfiler::GetNoEvents (void) const
+{
+  return m_events;
+}
+
+void
+SimulationProfiler::Merge (uint32_t systemId, uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (systemCount == 1)
+    return;
+
+#ifdef NS3_MPI
+  profileEntry   entries[PROFILED_EVENTS][PROFILED_MESSAGES];
+  double         profiledScopes;
+  double         events;
+  double         wallSeconds;
+
+  static_assert(sizeof(profileEntry) % sizeof(double) == 0, "The profileEntry must consist of doubles");
+  MPI_Reduce (m_entries, entries, sizeof(m_entries) / sizeof(double), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (&m_profiledScopes, &profiledScopes, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (&m_events, &events, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce (&m_wallSeconds, &wallSeconds, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+  if (systemId == 0)
+  {
+    memcpy (m_entries, entries, sizeof(m_entries));
+    m_profiledScopes = profiledScopes;
+    m_events = events;
+    m_wallSeconds = wallSeconds;
+    m_noProcesses = systemCount;
+  }
+#else
+  NS_FATAL_ERROR ("Can't merge the profiles of multiple processes without MPI compiled in");
+#endif
+}
+
+void
+SimulationProfiler::PrintReport (std::ostream &os, int topHandlers, double simulatedSeconds) const
+{
+  std::vector<std::pair<int, int>>  handlers;
+  double                            handlersSeconds = 0;
+
+  for (int event = 0; event < PROFILED_EVENTS; event++)
+  {
+    for (int message = 0; message < PROFILED_MESSAGES; message++)
+    {
+      if (m_entries[event][message].count > 0)
+      {
+        handlers.push_back(std::make_pair(event, message));
+        handlersSeconds += m_entries[event][message].selfSeconds;
+      }
+    }
+  }
+
+  std::sort(handlers.begin(), handlers.end(), [this] (const std::pair<int, int> &a, const std::pair<int, int> &b)
+            { return m_entries[a.first][a.second].selfSeconds > m_entries[b.first][b.second].selfSeconds; });
+
+  os << "\nProfile:\n";
+  if (m_events > 0)
+    os << "Simulator events = " << m_events << " in " << m_wallSeconds << "s of wall time ("
+       << m_events / m_wallSeconds << " events/s, " << m_events / simulatedSeconds << " events per simulated second)\n";
+  else
+    os << "Simulator events = not counted, the CountingScheduler is not installed\n";
+  os << "Profiled scopes = " << m_profiledScopes << " in " << m_wallSeconds << "s of wall time ("
+     << m_profiledScopes / m_wallSeconds << " profiled scopes/s, " << m_profiledScopes / simulatedSeconds << " profiled scopes per simulated second)\n";
+  os << "Time in the profiled handlers = " << handlersSeconds << "s ("
+     << 100. * handlersSeconds / (m_wallSeconds * m_noProcesses) << "% of the wall time of " << m_noProcesses << " processes)\n";
+
+  os << "\nPer event kind:\n";
+  for (int event = 0; event < PROFILED_EVENTS; event++)
+  {
+    profileEntry total = {0, 0, 0};
+
+    for (int message = 0; message < PROFILED_MESSAGES; message++)
+    {
+      total.count += m_entries[event][message].count;
+      total.totalSeconds += m_entries[event][message].totalSeconds;
+      total.selfSeconds += m_entries[event][message].selfSeconds;
+    }
+
+    if (total.count > 0)
+      os << std::left << std::setw (24) << getProfiledEvent (static_cast<enum ProfiledEvent>(event)) << std::right
+         << " count = " << std::setw (12) << total.count << ", total = " << std::setw (10) << total.totalSeconds
+         << "s, self = " << std::setw (10) << total.selfSeconds << "s\n";
+  }
+
+  os << "\nTop " << std::min(topHandlers, static_cast<int>(handlers.size())) << " handlers by self time:\n";
+  for (int i = 0; i < topHandlers && i < static_cast<int>(handlers.size()); i++)
+  {
+    const profileEntry &entry = m_entries[handlers[i].first][handlers[i].second];
+    std::string         name = getProfiledEvent (static_cast<enum ProfiledEvent>(handlers[i].first));
+
+    if (handlers[i].second != NO_MESSAGE)
+      name = name + "(" + getMessageName (static_cast<enum Messages>(handlers[i].second)) + ")";
+
+    os << std::left << std::setw (40) << name << std::right
+       << " count = " << std::setw (12) << entry.count << ", self = " << std::setw (10) << entry.selfSeconds
+       << "s (" << std::setw (5) << 100. * entry.selfSeconds / handlersSeconds << "%), "
+       << 1e6 * entry.selfSeconds / entry.count << "us/call\n";
+  }
+}
+
+} // namespace ns3
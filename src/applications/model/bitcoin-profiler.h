@@ -0,0 +1,181 @@
+/**
+ * This file contains the declaration of the SimulationProfiler, which measures the wall time spent in the event handlers of the nodes,
+ * and of the CountingScheduler, which counts the events processed by the simulator.
+ */
+
+#ifndef BITCOIN_PROFILER_H
+#define BITCOIN_PROFILER_H
+
+#include <vector>
+#include <ostream>
+#include <chrono>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/map-scheduler.h"
+#include "bitcoin.h"
+
+namespace ns3 {
+
+/**
+ * A MapScheduler which counts the events removed by the simulator to be processed, i.e. all the simulator events
+ * including the ones of the TCP/IP stack and the channels. The cancelled events are counted too, since they are
+ * only skipped when they are processed. Install it before the run with
+ *   ObjectFactory scheduler;
+ *   scheduler.SetTypeId ("ns3::CountingScheduler");
+ *   Simulator::SetScheduler (scheduler);
+ */
+class CountingScheduler : public MapScheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  CountingScheduler (void);
+  virtual ~CountingScheduler (void);
+
+  virtual Event RemoveNext (void);
+
+  /**
+   * \return the number of events processed by the simulator of the process since the scheduler was installed
+   */
+  static uint64_t GetNoEvents (void);
+
+private:
+  static uint64_t m_noEvents;     //!< shared by the schedulers of the process, since Simulator::SetScheduler replaces the instance
+};
+
+
+/**
+ * The number of event kinds and message types of the profile
+ */
+const int PROFILED_EVENTS = PROFILE_MINE_BLOCK + 1;
+const int PROFILED_MESSAGES = EXT_GET_DATA + 1;
+
+
+/**
+ * The measurements of an event kind and message type. All the fields are doubles, so that
+ * the profiles of the MPI processes can be merged with a single MPI_Reduce.
+ */
+typedef struct {
+  double   count;           //the number of invocations
+  double   totalSeconds;    //the wall time of the invocations, including the nested profiled events
+  double   selfSeconds;     //the wall time of the invocations, excluding the nested profiled events
+} profileEntry;
+
+
+/**
+ * An opt-in profiler shared by all the nodes of a process. The nodes open a ProfilerScope around each handler,
+ * and the profiler accumulates the invocations and the wall time per event kind and message type.
+ * The events without a message type, like the timers, are accounted under NO_MESSAGE.
+ * Nested scopes are supported, e.g. the SEND_MESSAGE events of a HANDLE_MESSAGE event, so both the inclusive
+ * and the self time are available. The outermost scopes are the handlers dispatched by the simulator.
+ */
+class SimulationProfiler : public SimpleRefCount<SimulationProfiler>
+{
+public:
+  SimulationProfiler (void);
+  ~SimulationProfiler (void);
+
+  /**
+   * \brief Starts the wall clock and the event count of the run, which are used for the rates of the report
+   */
+  void Start (void);
+
+  /**
+   * \brief Stops the wall clock and the event count of the run
+   */
+  void Stop (void);
+
+  /**
+   * \brief Opens the scope of an event
+   */
+  void Begin (enum ProfiledEvent event, enum Messages message);
+
+  /**
+   * \brief Closes the innermost open scope
+   */
+  void End (void);
+
+  /**
+   * \return the measurements of an event kind and message type
+   */
+  const profileEntry& GetEntry (enum ProfiledEvent event, enum Messages message) const;
+
+  /**
+   * \return the number of outermost profiled scopes. It is not the number of simulator events: the events
+   * which don't reach a profiled handler, e.g. of the TCP/IP stack, are not counted: see GetNoEvents.
+   */
+  double GetNoProfiledScopes (void) const;
+
+  /**
+   * \return the number of simulator events processed between Start and Stop, or 0 if the CountingScheduler was not installed
+   */
+  double GetNoEvents (void) const;
+
+  /**
+   * \brief Merges the profiles of all the processes in the process with systemId 0. It must be called by all the processes.
+   * The wall time of the run becomes the longest one among the processes, and the events and the times of the handlers are summed.
+   */
+  void Merge (uint32_t systemId, uint32_t systemCount);
+
+  /**
+   * \brief Prints the rate of the simulator events and of the profiled scopes, the totals per event kind and the handlers
+   * with the highest self time
+   * \param os the output stream
+   * \param topHandlers the number of handlers printed
+   * \param simulatedSeconds the simulated time of the run
+   */
+  void PrintReport (std::ostream &os, int topHandlers, double simulatedSeconds) const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  /**
+   * An open scope
+   */
+  typedef struct {
+    profileEntry        *entry;
+    Clock::time_point    start;
+    double               childSeconds;   //the wall time of the nested scopes
+  } openScope;
+
+  profileEntry               m_entries[PROFILED_EVENTS][PROFILED_MESSAGES];
+  double                     m_profiledScopes;  //the outermost profiled scopes
+  double                     m_events;          //the simulator events between Start and Stop
+  uint64_t                   m_startEvents;     //the events of the CountingScheduler at Start
+  double                     m_wallSeconds;     //the wall time between Start and Stop
+  uint32_t                   m_noProcesses;     //the processes whose profiles have been merged
+  Clock::time_point          m_start;
+  std::vector<openScope>     m_scopes;          //the stack of the open scopes
+};
+
+
+/**
+ * Measures the enclosing block as an event of a profiler. It does nothing when the profiler is null,
+ * so the handlers pay a single pointer check when the profiling is disabled.
+ */
+class ProfilerScope
+{
+public:
+  ProfilerScope (const Ptr<SimulationProfiler> &profiler, enum ProfiledEvent event, enum Messages message = NO_MESSAGE)
+    : m_profiler (PeekPointer (profiler))
+  {
+    if (m_profiler)
+      m_profiler->Begin (event, message);
+  }
+
+  ~ProfilerScope (void)
+  {
+    if (m_profiler)
+      m_profiler->End ();
+  }
+
+private:
+  ProfilerScope (const ProfilerScope &);
+  ProfilerScope& operator= (const ProfilerScope &);
+
+  SimulationProfiler *m_profiler;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_PROFILER_H */
@@ -0,0 +1,164 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-propagation-trace.h
+ */
+
+#include <cstring>
+#include "ns3/log.h"
+#include "bitcoin-propagation-trace.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PropagationTrace");
+
+static const char     traceMagic[4] = {'B', 'T', 'P', 'T'};
+static const uint32_t traceVersion = 1;
+
+/**
+ * \brief Writes the elements of a column
+ */
+template <typename T>
+static void
+WriteColumn (std::ofstream &file, const std::vector<T> &column)
+{
+  file.write (reinterpret_cast<const char *>(column.data()), column.size() * sizeof(T));
+}
+
+/**
+ * \brief Reads n elements of a column
+ */
+template <typename T>
+static bool
+ReadColumn (std::ifstream &file, std::vector<T> &column, uint32_t n)
+{
+  column.resize(n);
+  return static_cast<bool>(file.read (reinterpret_cast<char *>(column.data()), n * sizeof(T)));
+}
+
+
+PropagationTrace::PropagationTrace (const std::string &fileName, uint32_t chunkRecords)
+  : m_chunkRecords (chunkRecords), m_noRecords (0)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_file.open (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file)
+    NS_FATAL_ERROR ("Could not open the propagation trace " << fileName);
+
+  m_file.write (traceMagic, sizeof(traceMagic));
+  m_file.write (reinterpret_cast<const char *>(&traceVersion), sizeof(traceVersion));
+
+  m_blockIds.reserve(m_chunkRecords);
+  m_nodeIds.reserve(m_chunkRecords);
+  m_timesReceived.reserve(m_chunkRecords);
+  m_timesValidated.reserve(m_chunkRecords);
+  m_receivedFrom.reserve(m_chunkRecords);
+}
+
+PropagationTrace::~PropagationTrace (void)
+{
+  Close ();
+}
+
+void
+PropagationTrace::Record (BlockId blockId, uint32_t nodeId, double timeReceived, double timeValidated, Ipv4Address receivedFrom)
+{
+  if (!m_file.is_open ())
+    return;
+
+  m_blockIds.push_back(blockId.GetValue ());
+  m_nodeIds.push_back(nodeId);
+  m_timesReceived.push_back(timeReceived);
+  m_timesValidated.push_back(timeValidated);
+  m_receivedFrom.push_back(receivedFrom.Get ());
+  m_noRecords++;
+
+  if (m_blockIds.size() >= m_chunkRecords)
+    WriteChunk ();
+}
+
+void
+PropagationTrace::Close (void)
+{
+  if (!m_file.is_open ())
+    return;
+
+  WriteChunk ();
+  m_file.close ();
+  NS_LOG_INFO ("Close: the propagation trace has " << m_noRecords << " records");
+}
+
+uint64_t
+PropagationTrace::GetNoRecords (void) const
+{
+  return m_noRecords;
+}
+
+void
+PropagationTrace::WriteChunk (void)
+{
+  uint32_t records = m_blockIds.size();
+
+  if (records == 0)
+    return;
+
+  m_file.write (reinterpret_cast<const char *>(&records), sizeof(records));
+  WriteColumn (m_file, m_blockIds);
+  WriteColumn (m_file, m_nodeIds);
+  WriteColumn (m_file, m_timesReceived);
+  WriteColumn (m_file, m_timesValidated);
+  WriteColumn (m_file, m_receivedFrom);
+
+  if (!m_file)
+    NS_FATAL_ERROR ("Could not write the propagation trace");
+
+  m_blockIds.clear();
+  m_nodeIds.clear();
+  m_timesReceived.clear();
+  m_timesValidated.clear();
+  m_receivedFrom.clear();
+}
+
+uint64_t
+PropagationTrace::ReadFile (const std::string &fileName, RecordHandler handler)
+{
+  std::ifstream           file (fileName.c_str (), std::ios::in | std::ios::binary);
+  char                    magic[sizeof(traceMagic)];
+  uint32_t                version;
+  uint32_t                records;
+  uint64_t                totalRecords = 0;
+  std::vector<uint64_t>   blockIds;
+  std::vector<uint32_t>   nodeIds;
+  std::vector<double>     timesReceived;
+  std::vector<double>     timesValidated;
+  std::vector<uint32_t>   receivedFrom;
+
+  if (!file)
+    NS_FATAL_ERROR ("Could not open the propagation trace " << fileName);
+
+  if (!file.read (magic, sizeof(magic)) || memcmp (magic, traceMagic, sizeof(magic)) != 0
+      || !file.read (reinterpret_cast<char *>(&version), sizeof(version)))
+    NS_FATAL_ERROR (fileName << " is not a propagation trace");
+
+  if (version != traceVersion)
+    NS_FATAL_ERROR (fileName << " has version " << version << " instead of " << traceVersion);
+
+  while (file.read (reinterpret_cast<char *>(&records), sizeof(records)))
+  {
+    if (!ReadColumn (file, blockIds, records) || !ReadColumn (file, nodeIds, records)
+        || !ReadColumn (file, timesReceived, records) || !ReadColumn (file, timesValidated, records)
+        || !ReadColumn (file, receivedFrom, records))
+      NS_FATAL_ERROR (fileName << " ends in the middle of a chunk");
+
+    for (uint32_t i = 0; i < records; i++)
+    {
+      propagationTraceRecord record = {BlockId (static_cast<int>(blockIds[i] >> 32), static_cast<int>(blockIds[i] & 0xFFFFFFFF)),
+                                       nodeIds[i], timesReceived[i], timesValidated[i], Ipv4Address (receivedFrom[i])};
+      handler (record);
+    }
+    totalRecords += records;
+  }
+
+  return totalRecords;
+}
+
+} // namespace ns3
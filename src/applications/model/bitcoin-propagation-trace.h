@@ -0,0 +1,90 @@
+/**
+ * This file contains the declaration of the PropagationTrace, which records when every node received and validated every block.
+ */
+
+#ifndef BITCOIN_PROPAGATION_TRACE_H
+#define BITCOIN_PROPAGATION_TRACE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <functional>
+#include "ns3/ipv4-address.h"
+#include "ns3/simple-ref-count.h"
+#include "bitcoin.h"
+
+namespace ns3 {
+
+/**
+ * A record of the propagation trace
+ */
+typedef struct {
+  BlockId        blockId;
+  uint32_t       nodeId;
+  double         timeReceived;        // in seconds. The time the block was mined, for the blocks of the miner itself
+  double         timeValidated;       // in seconds
+  Ipv4Address    receivedFrom;        // the address of the peer which sent the block, 127.0.0.1 for the blocks of the miner itself
+} propagationTraceRecord;
+
+
+/**
+ * A trace sink which stores the propagation records of the nodes of one process in a binary columnar file.
+ * The records are buffered column by column and written in chunks of chunkRecords records. The file consists of
+ * a header ("BTPT" and the format version as uint32_t) followed by the chunks. Each chunk has the number of records n
+ * as uint32_t, followed by n blockIds (uint64_t), n nodeIds (uint32_t), n timeReceived (double), n timeValidated (double)
+ * and n receivedFrom (uint32_t), in the byte order of the machine which wrote it.
+ */
+class PropagationTrace : public SimpleRefCount<PropagationTrace>
+{
+public:
+  typedef std::function<void (const propagationTraceRecord &)> RecordHandler;
+
+  /**
+   * \param fileName the name of the trace file, which is created or truncated
+   * \param chunkRecords the number of records buffered before they are written
+   */
+  PropagationTrace (const std::string &fileName, uint32_t chunkRecords = 65536);
+  ~PropagationTrace (void);
+
+  /**
+   * \brief Adds a record to the trace
+   */
+  void Record (BlockId blockId, uint32_t nodeId, double timeReceived, double timeValidated, Ipv4Address receivedFrom);
+
+  /**
+   * \brief Writes the buffered records and closes the file. Later records are dropped.
+   */
+  void Close (void);
+
+  /**
+   * \return the number of records added to the trace
+   */
+  uint64_t GetNoRecords (void) const;
+
+  /**
+   * \brief Reads a trace file
+   * \param fileName the name of the trace file
+   * \param handler invoked for every record, in the order they were added
+   * \return the number of records read
+   */
+  static uint64_t ReadFile (const std::string &fileName, RecordHandler handler);
+
+private:
+  /**
+   * \brief Writes the buffered records as a chunk
+   */
+  void WriteChunk (void);
+
+  std::ofstream              m_file;
+  uint32_t                   m_chunkRecords;
+  uint64_t                   m_noRecords;
+  std::vector<uint64_t>      m_blockIds;            // the columns of the buffered records
+  std::vector<uint32_t>      m_nodeIds;
+  std::vector<double>        m_timesReceived;
+  std::vector<double>        m_timesValidated;
+  std::vector<uint32_t>      m_receivedFrom;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_PROPAGATION_TRACE_H */
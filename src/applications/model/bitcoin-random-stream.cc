@@ -0,0 +1,73 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-random-stream.h
+ */
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/rng-seed-manager.h"
+#include "bitcoin-random-stream.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RandomStream");
+
+RandomStream::RandomStream (void)
+{
+  SetStream (RNG_TOPOLOGY_MINERS, 0);
+}
+
+RandomStream::RandomStream (enum RngPurpose purpose, uint32_t id)
+{
+  SetStream (purpose, id);
+}
+
+void
+RandomStream::SetStream (enum RngPurpose purpose, uint32_t id)
+{
+  uint64_t seed = Mix (RngSeedManager::GetSeed ()) ^ RngSeedManager::GetRun ();
+
+  m_key = Mix (Mix (seed) + (static_cast<uint64_t>(purpose) << 32 | id));
+  m_counter = 0;
+
+  NS_LOG_DEBUG ("SetStream: " << getRngPurpose(purpose) << " stream of " << id << " has key " << m_key);
+}
+
+RandomStream::result_type
+RandomStream::operator() (void)
+{
+  /**
+   * The counter is spaced by the golden ratio as in SplitMix64, and mixed twice
+   * so that the streams of consecutive keys are not correlated.
+   */
+  return Mix (Mix (m_key + 0x9e3779b97f4a7c15ULL * ++m_counter) ^ m_key);
+}
+
+uint32_t
+RandomStream::GetInteger (uint32_t bound)
+{
+  NS_ASSERT_MSG (bound > 0, "The bound of GetInteger must be positive");
+
+  return static_cast<uint32_t>(((*this)() >> 32) * bound >> 32);
+}
+
+double
+RandomStream::GetDouble (void)
+{
+  return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t
+RandomStream::GetCounter (void) const
+{
+  return m_counter;
+}
+
+uint64_t
+RandomStream::Mix (uint64_t x)
+{
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+} // namespace ns3
@@ -0,0 +1,76 @@
+/**
+ * This file contains the declaration of the RandomStream, the counter-based random number generator
+ * used by the topology helper, the nodes and the miners.
+ */
+
+#ifndef BITCOIN_RANDOM_STREAM_H
+#define BITCOIN_RANDOM_STREAM_H
+
+#include <cstdint>
+#include "bitcoin.h"
+
+namespace ns3 {
+
+/**
+ * A counter-based random number generator. The i-th number of a stream is a hash of the stream key and i,
+ * and the key is derived from the global seed (the ns-3 RngSeed and RngRun values), the purpose and the id of
+ * the stream's owner. So, a stream depends only on the seed, its purpose and its owner: it gives the same numbers
+ * whatever the other streams draw and however the nodes are distributed between the MPI processes.
+ *
+ * It satisfies the UniformRandomBitGenerator requirements, so it can drive the <random> distributions.
+ */
+class RandomStream
+{
+public:
+  typedef uint64_t result_type;
+
+  /**
+   * Creates the stream of purpose RNG_TOPOLOGY_MINERS and id 0, to be set with SetStream
+   */
+  RandomStream (void);
+  RandomStream (enum RngPurpose purpose, uint32_t id);
+
+  /**
+   * \brief Derives the key of the stream from the current global seed and restarts it
+   * \param purpose the purpose of the stream
+   * \param id the id of the owner of the stream, usually the node id
+   */
+  void SetStream (enum RngPurpose purpose, uint32_t id);
+
+  static constexpr result_type min (void) { return 0; }
+  static constexpr result_type max (void) { return UINT64_MAX; }
+
+  /**
+   * \return the next 64 random bits
+   */
+  result_type operator() (void);
+
+  /**
+   * \param bound the upper bound, which must be positive
+   * \return a uniform integer in [0, bound)
+   */
+  uint32_t GetInteger (uint32_t bound);
+
+  /**
+   * \return a uniform double in [0, 1)
+   */
+  double GetDouble (void);
+
+  /**
+   * \return the number of 64-bit numbers drawn since the stream was set
+   */
+  uint64_t GetCounter (void) const;
+
+private:
+  /**
+   * \brief The SplitMix64 finalizer, a bijective 64-bit mixing function
+   */
+  static uint64_t Mix (uint64_t x);
+
+  uint64_t    m_key;          // derived from the seed, the purpose and the id
+  uint64_t    m_counter;      // the index of the next number
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_RANDOM_STREAM_H */
@@ -14,6 +14,8 @@
 #include "ns3/tcp-socket-factory.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
 #include "ns3/bitcoin-selfish-miner.h"
 #include "../../rapidjson/document.h"
 #include "../../rapidjson/writer.h"
@@ -77,11 +79,36 @@ BitcoinSelfishMiner::GetTypeId (void)
                    DoubleValue (-1),
                    MakeDoubleAccessor (&BitcoinSelfishMiner::m_blockGenParameter),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("BlockTimeDistribution",
+                   "The distribution of the block generation times",
+                   EnumValue (BLOCK_TIME_GEOMETRIC),
+                   MakeEnumAccessor (&BitcoinSelfishMiner::m_blockTimeDistribution),
+                   MakeEnumChecker (BLOCK_TIME_EXPONENTIAL, "Exponential",
+                                    BLOCK_TIME_GEOMETRIC, "Geometric",
+                                    BLOCK_TIME_TRACE, "Trace"))
+    .AddAttribute ("BlockTimeTrace",
+                   "The file of the block intervals replayed by the Trace distribution, one interval per line",
+                   StringValue (""),
+                   MakeStringAccessor (&BitcoinSelfishMiner::m_blockTimeTrace),
+                   MakeStringChecker ())
     .AddAttribute ("AverageBlockGenIntervalSeconds", 
 				   "The average block generation interval we aim at (in seconds)",
                    DoubleValue (10*60),
                    MakeDoubleAccessor (&BitcoinSelfishMiner::m_averageBlockGenIntervalSeconds),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("MessageCodec",
+                   "The codec used to encode the messages on the wire",
+                   EnumValue (JSON_CODEC),
+                   MakeEnumAccessor (&BitcoinSelfishMiner::m_messageCodec),
+                   MakeEnumChecker (JSON_CODEC, "Json",
+                                    BINARY_CODEC, "Binary"))
+    .AddAttribute ("LinkDiscipline",
+                   "The discipline used to share the upload and download links between the peers",
+                   EnumValue (LINK_FIFO),
+                   MakeEnumAccessor (&BitcoinSelfishMiner::m_linkDiscipline),
+                   MakeEnumChecker (LINK_FIFO, "Fifo",
+                                    LINK_ROUND_ROBIN, "RoundRobin",
+                                    LINK_FAIR_SHARE, "FairShare"))
     .AddTraceSource ("Rx",
                      "A packet has been received",
                      MakeTraceSourceAccessor (&BitcoinSelfishMiner::m_rxTrace),
@@ -110,6 +137,7 @@ void
 BitcoinSelfishMiner::StartApplication ()    // Called at time specified by Start
 {
   BitcoinNode::StartApplication ();
+  m_blockSizeGenerator.SetStream (RNG_BLOCK_SIZE, GetNode ()->GetId ());
   NS_LOG_WARN ("Selfish Miner " << GetNode()->GetId() << " m_realAverageBlockGenIntervalSeconds = " << m_realAverageBlockGenIntervalSeconds << "s");
   NS_LOG_WARN ("Selfish Miner " << GetNode()->GetId() << " m_averageBlockGenIntervalSeconds = " << m_averageBlockGenIntervalSeconds << "s");
   NS_LOG_WARN ("Selfish Miner " << GetNode()->GetId() << " m_fixedBlockTimeGeneration = " << m_fixedBlockTimeGeneration << "s");
@@ -125,35 +153,12 @@ BitcoinSelfishMiner::StartApplication ()    // Called at time specified by Start
     m_blockGenParameter *= m_hashRate;
 
   if (m_fixedBlockTimeGeneration == 0)
-	m_blockGenTimeDistribution.param(std::geometric_distribution<int>::param_type(m_blockGenParameter)); 
+    ConfigureBlockTimeSampler ();
 
   if (m_fixedBlockSize > 0)
     m_nextBlockSize = m_fixedBlockSize;
   else
-  {
-    std::array<double,201> intervals {0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95, 100, 105, 110, 115, 120, 125, 
-                                     130, 135, 140, 145, 150, 155, 160, 165, 170, 175, 180, 185, 190, 195, 200, 205, 210, 215, 220, 225, 230, 235, 
-                                     240, 245, 250, 255, 260, 265, 270, 275, 280, 285, 290, 295, 300, 305, 310, 315, 320, 325, 330, 335, 340, 345, 
-                                     350, 355, 360, 365, 370, 375, 380, 385, 390, 395, 400, 405, 410, 415, 420, 425, 430, 435, 440, 445, 450, 455, 
-                                     460, 465, 470, 475, 480, 485, 490, 495, 500, 505, 510, 515, 520, 525, 530, 535, 540, 545, 550, 555, 560, 565, 
-                                     570, 575, 580, 585, 590, 595, 600, 605, 610, 615, 620, 625, 630, 635, 640, 645, 650, 655, 660, 665, 670, 675, 
-                                     680, 685, 690, 695, 700, 705, 710, 715, 720, 725, 730, 735, 740, 745, 750, 755, 760, 765, 770, 775, 780, 785, 
-                                     790, 795, 800, 805, 810, 815, 820, 825, 830, 835, 840, 845, 850, 855, 860, 865, 870, 875, 880, 885, 890, 895, 
-                                     900, 905, 910, 915, 920, 925, 930, 935, 940, 945, 950, 955, 960, 965, 970, 975, 980, 985, 990, 995, 1000};
-    std::array<double,200> weights {3.58, 0.33, 0.35, 0.4, 0.38, 0.4, 0.53, 0.46, 0.43, 0.48, 0.56, 0.69, 0.62, 0.62, 0.63, 0.62, 0.62, 0.63, 0.73, 
-                                    1.96, 0.75, 0.76, 0.73, 0.64, 0.66, 0.66, 0.66, 0.7, 0.66, 0.73, 0.68, 0.66, 0.67, 0.66, 0.72, 0.68, 0.64, 0.61, 
-                                    0.63, 0.58, 0.66, 0.6, 0.7, 0.62, 0.49, 0.59, 0.58, 0.59, 0.63, 1.59, 0.6, 0.58, 0.54, 0.62, 0.55, 0.54, 0.52, 
-                                    0.5, 0.53, 0.55, 0.49, 0.47, 0.51, 0.49, 0.52, 0.49, 0.49, 0.49, 0.56, 0.75, 0.51, 0.42, 0.46, 0.47, 0.43, 0.38, 
-                                    0.39, 0.39, 0.41, 0.43, 0.38, 0.41, 0.36, 0.41, 0.38, 0.42, 0.42, 0.37, 0.41, 0.41, 0.34, 0.32, 0.37, 0.32, 0.34, 
-                                    0.34, 0.34, 0.32, 0.41, 0.62, 0.33, 0.4, 0.32, 0.32, 0.29, 0.35, 0.32, 0.32, 0.28, 0.26, 0.25, 0.29, 0.26, 0.27, 
-                                    0.27, 0.24, 0.28, 0.3, 0.27, 0.23, 0.23, 0.28, 0.25, 0.29, 0.24, 0.21, 0.26, 0.29, 0.23, 0.2, 0.24, 0.25, 0.23, 
-                                    0.21, 0.26, 0.38, 0.24, 0.21, 0.25, 0.23, 0.22, 0.22, 0.24, 0.23, 0.23, 0.26, 0.24, 0.28, 0.64, 9.96, 0.15, 0.11, 
-                                    0.11, 0.1, 0.1, 0.1, 0.11, 0.11, 0.12, 0.13, 0.12, 0.16, 0.12, 0.13, 0.12, 0.1, 0.13, 0.13, 0.13, 0.25, 0.1, 0.14, 
-                                    0.14, 0.12, 0.14, 0.14, 0.17, 0.15, 0.19, 0.38, 0.2, 0.19, 0.24, 0.26, 0.36, 1.58, 1.49, 0.1, 0.2, 1.98, 0.05, 0.08, 
-                                    0.07, 0.07, 0.14, 0.08, 0.08, 0.53, 3.06, 3.31};
-                                
-    m_blockSizeDistribution = std::piecewise_constant_distribution<double> (intervals.begin(), intervals.end(), weights.begin());
-  }
+    m_blockSizeSampler = GetAttackerBlockSizeSampler ();
   
 /*   if (GetNode()->GetId() == 0)
   {
@@ -161,8 +166,8 @@ BitcoinSelfishMiner::StartApplication ()    // Called at time specified by Start
     m_blockchain.AddBlock(newBlock); 
   } */
   
-  m_nodeStats->hashRate = m_hashRate;
-  m_nodeStats->miner = 1;
+  m_nodeStats->hashRate[m_nodeId] = m_hashRate;
+  m_nodeStats->miner[m_nodeId] = 1;
 
   ScheduleNextMiningEvent ();
 }
@@ -171,7 +176,7 @@ void
 BitcoinSelfishMiner::StopApplication ()
 {
   BitcoinNode::StopApplication ();  
-  Simulator::Cancel (m_nextMiningEvent);
+  StopMining ();
   
   NS_LOG_WARN ("The selfish miner " << GetNode ()->GetId () << " with hash rate = " << m_hashRate << " generated " << m_minerGeneratedBlocks 
                 << " blocks "<< "(" << 100. * m_minerGeneratedBlocks / (m_blockchain.GetTotalBlocks() - 1) 
@@ -180,9 +185,9 @@ BitcoinSelfishMiner::StopApplication ()
                 << m_minerAverageBlockGenInterval - static_cast<int>(m_minerAverageBlockGenInterval) / m_secondsPerMin * m_secondsPerMin << "s"
                 << " and average size " << m_minerAverageBlockSize << " Bytes");
 				
-  m_nodeStats->minerGeneratedBlocks = m_minerGeneratedBlocks;
-  m_nodeStats->minerAverageBlockGenInterval = m_minerAverageBlockGenInterval;
-  m_nodeStats->minerAverageBlockSize = m_minerAverageBlockSize;
+  m_nodeStats->minerGeneratedBlocks[m_nodeId] = m_minerGeneratedBlocks;
+  m_nodeStats->minerAverageBlockGenInterval[m_nodeId] = m_minerAverageBlockGenInterval;
+  m_nodeStats->minerAverageBlockSize[m_nodeId] = m_minerAverageBlockSize;
   
   Block b = m_honestNetworkTopBlock;
   bool stop = false;
@@ -190,7 +195,7 @@ BitcoinSelfishMiner::StopApplication ()
   do
   {
     if (b.GetMinerId() == GetNode()->GetId())
-      m_nodeStats->minedBlocksInMainChain++;
+      m_nodeStats->minedBlocksInMainChain[m_nodeId]++;
     if (m_blockchain.GetParent(b))
       b = *(m_blockchain.GetParent(b));
     else
@@ -210,17 +215,13 @@ void
 BitcoinSelfishMiner::MineBlock (void)  
 {
   NS_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_MINE_BLOCK);
 
   int height =  m_attackerTopBlock.GetBlockHeight() + 1;
   int minerId = GetNode ()->GetId ();
   int parentBlockMinerId = m_attackerTopBlock.GetMinerId();
   double currentTime = Simulator::Now ().GetSeconds ();
-  std::ostringstream stringStream;  
-  std::string blockHash;
-
-  
-  stringStream << height << "/" << minerId;
-  blockHash = stringStream.str();
+  std::string blockHash = BlockId (height, minerId).ToString();
 
 
 /*   //For attacks
@@ -236,30 +237,14 @@ BitcoinSelfishMiner::MineBlock (void)
    } */
    
   
-  if (m_fixedBlockSize > 0)
-    m_nextBlockSize = m_fixedBlockSize;
-  else
-  {
-    m_nextBlockSize = m_blockSizeDistribution(m_generator) * 1000;	// *1000 because the m_blockSizeDistribution returns KBytes
-
-    if (m_cryptocurrency == BITCOIN)
-    {
-      // The block size is linearly dependent on the averageBlockGenIntervalSeconds
-      if(m_nextBlockSize < m_maxBlockSize - m_headersSizeBytes)
-        m_nextBlockSize = m_nextBlockSize*m_averageBlockGenIntervalSeconds / m_realAverageBlockGenIntervalSeconds
-                        + m_headersSizeBytes;	
-      else
-        m_nextBlockSize = m_nextBlockSize*m_averageBlockGenIntervalSeconds / m_realAverageBlockGenIntervalSeconds;
-    }
-  }
-
-  if (m_nextBlockSize < m_averageTransactionSize)
-    m_nextBlockSize = m_averageTransactionSize + m_headersSizeBytes;
+  m_nextBlockSize = DrawBlockSize (m_fixedBlockSize, m_blockSizeSampler, m_blockSizeGenerator,
+                                   m_cryptocurrency, m_averageBlockGenIntervalSeconds, m_maxBlockSize);
 
   Block newBlock (height, minerId, parentBlockMinerId, m_nextBlockSize,
                   currentTime, currentTime, Ipv4Address("127.0.0.1"));
   m_attackerTopBlock = newBlock;
   m_blockchain.AddBlock(newBlock);
+  TraceBlock(newBlock);
   
   m_la++;
   
@@ -283,7 +268,7 @@ BitcoinSelfishMiner::MineBlock (void)
     m_lh = 0;
     m_forkType = IRRELEVANT;
     m_honestNetworkTopBlock = m_attackerTopBlock;
-	m_nodeStats->attackSuccess++;
+	m_nodeStats->attackSuccess[m_nodeId]++;
 	
     NS_LOG_INFO("---New State = (" << m_la << ", " << m_lh << ", " << getForkType(m_forkType) << ")");  
 	
@@ -372,7 +357,7 @@ BitcoinSelfishMiner::MineBlock (void)
         m_forkType = IRRELEVANT;
         m_honestNetworkTopBlock = m_attackerTopBlock;
       
-	    m_nodeStats->attackSuccess++;
+	    m_nodeStats->attackSuccess[m_nodeId]++;
         break;
       }
       case ERROR:
@@ -406,6 +391,8 @@ BitcoinSelfishMiner::MineBlock (void)
   m_minerGeneratedBlocks++;
 			   
   ScheduleNextMiningEvent ();
+
+  UpdateNetworkState();
 }
 
 
@@ -428,34 +415,30 @@ BitcoinSelfishMiner::ReceiveBlock(const Block &newBlock)
   NS_LOG_INFO ("BitcoinSelfishMiner ReceiveBlock: At time " << Simulator::Now ().GetSeconds ()
                 << "s bitcoin node " << GetNode ()->GetId () << " received " << newBlock);
 
-  std::ostringstream   stringStream;  
-  std::string          blockHash = stringStream.str();
-				
-  stringStream << newBlock.GetBlockHeight() << "/" << newBlock.GetMinerId();
-  blockHash = stringStream.str();
+  BlockId              blockId = newBlock.GetBlockId();
   
-  if (m_blockchain.HasBlock(newBlock) || m_blockchain.IsOrphan(newBlock) || ReceivedButNotValidated(blockHash))
+  if (m_blockchain.HasBlock(newBlock) || m_blockchain.IsOrphan(newBlock) || ReceivedButNotValidated(blockId))
   {
     NS_LOG_INFO ("BitcoinSelfishMiner ReceiveBlock: Bitcoin node " << GetNode ()->GetId () << " has already added this block in the m_blockchain: " << newBlock);
     
-    if (m_invTimeouts.find(blockHash) != m_invTimeouts.end())
+    if (m_invTimeouts.find(blockId) != m_invTimeouts.end())
     {
-      m_queueInv.erase(blockHash);
-      Simulator::Cancel (m_invTimeouts[blockHash]);
-      m_invTimeouts.erase(blockHash);
+      m_queueInv.erase(blockId);
+      Simulator::Cancel (m_invTimeouts[blockId]);
+      m_invTimeouts.erase(blockId);
     }
   }
   else
   {
     NS_LOG_INFO ("BitcoinSelfishMiner ReceiveBlock: Bitcoin node " << GetNode ()->GetId () << " has NOT added this block in the m_blockchain: " << newBlock);
 
-    m_receivedNotValidated[blockHash] = newBlock;
+    m_receivedNotValidated[blockId] = newBlock;
 	//PrintQueueInv();
 	//PrintInvTimeouts();
 	
-    m_queueInv.erase(blockHash);
-    Simulator::Cancel (m_invTimeouts[blockHash]);
-    m_invTimeouts.erase(blockHash);
+    m_queueInv.erase(blockId);
+    Simulator::Cancel (m_invTimeouts[blockId]);
+    m_invTimeouts.erase(blockId);
 	
     //PrintQueueInv();
 	//PrintInvTimeouts();
@@ -596,11 +579,7 @@ BitcoinSelfishMiner::ReleaseChain(std::vector<Block> blocks)
   		  
         for(auto it = blocks.begin(); it != blocks.end(); it++)
         {
-          std::ostringstream   stringStream;  
-          std::string          blockHash = stringStream.str();
-				
-          stringStream << it->GetBlockHeight() << "/" << it->GetMinerId();
-          blockHash = stringStream.str();
+          std::string          blockHash = it->GetBlockId().ToString();
           value.SetString(blockHash.c_str(), blockHash.size(), inv.GetAllocator());
           array.PushBack(value, inv.GetAllocator());
         }
@@ -696,11 +675,7 @@ BitcoinSelfishMiner::ReleaseChain(std::vector<Block> blocks)
 		  
         for(auto it = blocks.begin(); it != blocks.end(); it++)
         {
-          std::ostringstream   stringStream;  
-          std::string          blockHash = stringStream.str();
-				
-          stringStream << it->GetBlockHeight() << "/" << it->GetMinerId();
-          blockHash = stringStream.str();
+          std::string          blockHash = it->GetBlockId().ToString();
           value.SetString(blockHash.c_str(), blockHash.size(), inv.GetAllocator());
           invArray.PushBack(value, inv.GetAllocator());
         }
@@ -855,57 +830,48 @@ BitcoinSelfishMiner::ReleaseChain(std::vector<Block> blocks)
   }
   
 
-  // Stringify the DOM
-  rapidjson::StringBuffer invInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> invWriter(invInfo);
-  inv.Accept(invWriter);
-  
-  rapidjson::StringBuffer blockInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> blockWriter(blockInfo);
-  block.Accept(blockWriter);
+  std::string invInfo = EncodeMessage(inv, m_messageCodec);
+  std::string blockInfo = EncodeMessage(block, m_messageCodec);
   
   int count = 0;
   
   for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i, ++count)
   {
     
-    const uint8_t delimiter[] = "#";
-
     switch(m_blockBroadcastType)				  
     {
       case STANDARD:
       {
-        m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(invInfo.GetString()), invInfo.GetSize(), 0);
-        m_peersSockets[*i]->Send (delimiter, 1, 0);
+        SendFrame(invInfo, *i);
 		
         if (m_protocolType == STANDARD_PROTOCOL && !m_blockTorrent)
-          m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+          m_nodeStats->invSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
         else if (m_protocolType == SENDHEADERS && !m_blockTorrent)
-          m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+          m_nodeStats->headersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
         else if (m_protocolType == STANDARD_PROTOCOL && m_blockTorrent)
         {
-          m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+          m_nodeStats->extInvSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
           for (int j=0; j<inv["inv"].Size(); j++)
           {
-            m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
+            m_nodeStats->extInvSentBytes[m_nodeId] += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
             if (!inv["inv"][j]["fullBlock"].GetBool())
-              m_nodeStats->extInvSentBytes += inv["inv"][j]["availableChunks"].Size()*1;
+              m_nodeStats->extInvSentBytes[m_nodeId] += inv["inv"][j]["availableChunks"].Size()*1;
           }
         }
         else if (m_protocolType == SENDHEADERS && m_blockTorrent)
         {
-          m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+          m_nodeStats->extHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
           for (int j=0; j<inv["blocks"].Size(); j++)
           {
-            m_nodeStats->extHeadersSentBytes += 1;//fullBlock
+            m_nodeStats->extHeadersSentBytes[m_nodeId] += 1;//fullBlock
             if (!inv["blocks"][j]["fullBlock"].GetBool())
-              m_nodeStats->extHeadersSentBytes += inv["inv"][j]["availableChunks"].Size();
+              m_nodeStats->extHeadersSentBytes[m_nodeId] += inv["inv"][j]["availableChunks"].Size();
           }	
         }
 		
-        NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+        BITCOIN_MESSAGE_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
                      << "s bitcoin miner " << GetNode ()->GetId () 
-                     << " sent a packet " << invInfo.GetString() 
+                     << " sent a packet " << MessageToString(inv) 
 			         << " to " << *i);
         break;
       }
@@ -916,34 +882,18 @@ BitcoinSelfishMiner::ReleaseChain(std::vector<Block> blocks)
         for (int j=0; j<block["blocks"].Size(); j++)
           blockMessageSize += block["blocks"][j]["size"].GetInt();
 
-        m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + blockMessageSize;
+        m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + blockMessageSize;
 
-        double sendTime = blockMessageSize / m_uploadSpeed;
-        double eventTime;	
 				
 /*                 std::cout << "Node " << GetNode()->GetId() << "-" << InetSocketAddress::ConvertFrom(from).GetIpv4 () 
                           << " " << m_peersDownloadSpeeds[InetSocketAddress::ConvertFrom(from).GetIpv4 ()] << " Mbps , time = "
                           << Simulator::Now ().GetSeconds() << "s \n"; */
                 
-        if (m_sendBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendBlockTimes.back())
-        {
-          eventTime = 0; 
-        }
-        else
-        {
-          //std::cout << "m_sendBlockTimes.back() = m_sendBlockTimes.back() = " << m_sendBlockTimes.back() << std::endl;
-          eventTime = m_sendBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-        }
-        m_sendBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
- 
-        /* std::cout << sendTime << " " << eventTime << " " << m_sendBlockTimes.size() << std::endl; */
-        NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the block to " << *i 
-                    << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
+        NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the block for " << *i << "\n");
 
-        std::string packet = blockInfo.GetString();
-        Simulator::Schedule (Seconds(eventTime), &BitcoinSelfishMiner::SendBlock, this, packet, m_peersSockets[*i]);
-        Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinSelfishMiner::RemoveSendTime, this);
+        std::string packet = blockInfo;
+        m_uploadLink.Enqueue (*i, blockMessageSize, 0, std::bind (&BitcoinSelfishMiner::SendUnsolicitedBlock, this, packet, *i),
+                              LinkScheduler::TransferHandler ());
 
         break;
       }
@@ -961,79 +911,58 @@ BitcoinSelfishMiner::ReleaseChain(std::vector<Block> blocks)
             blockMessageSize += blockSize;
           }
 		  
-          double sendTime = blockMessageSize / m_uploadSpeed;
-          double eventTime;
 		  
-          m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + blockMessageSize;
+          m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + blockMessageSize;
 			  
 /* 				std::cout << "Node " << GetNode()->GetId() << "-" << *i 
                             << " " << m_peersDownloadSpeeds[*i] << " Mbps , time = "
                             << Simulator::Now ().GetSeconds() << "s \n"; */
                 
-          if (m_sendCompressedBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendCompressedBlockTimes.back())
-          {
-            eventTime = 0; 
-          }
-          else
-          {
-            //std::cout << "m_sendCompressedBlockTimes.back() = m_sendCompressedBlockTimes.back() = " << m_sendCompressedBlockTimes.back() << std::endl;
-            eventTime = m_sendCompressedBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-          }
-          m_sendCompressedBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
-          //std::cout << sendTime << " " << eventTime << " " << m_sendCompressedBlockTimes.size() << std::endl;
-          NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the block to " << *i
-                      << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
-
-          //sendTime = blockSize / m_uploadSpeed * count;		  
-          //std::cout << sendTime << std::endl;
+          NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the compressed-block for " << *i << "\n");
 
-          std::string packet = blockInfo.GetString();
-          Simulator::Schedule (Seconds(sendTime), &BitcoinSelfishMiner::SendBlock, this, packet, m_peersSockets[*i]);
-          Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinSelfishMiner::RemoveCompressedBlockSendTime, this);
+          std::string packet = blockInfo;
+          m_compressedUploadLink.Enqueue (*i, blockMessageSize, 0, LinkScheduler::TransferHandler (),
+                                          std::bind (&BitcoinSelfishMiner::SendUnsolicitedBlock, this, packet, *i));
 
         }
         else
         {	    
-          m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(invInfo.GetString()), invInfo.GetSize(), 0);
-          m_peersSockets[*i]->Send (delimiter, 1, 0);
+          SendFrame(invInfo, *i);
 	  
           if (m_protocolType == STANDARD_PROTOCOL && !m_blockTorrent)
-            m_nodeStats->invSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+            m_nodeStats->invSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
           else if (m_protocolType == SENDHEADERS && !m_blockTorrent)
-            m_nodeStats->headersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+            m_nodeStats->headersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
           else if (m_protocolType == STANDARD_PROTOCOL && m_blockTorrent)
           {
-            m_nodeStats->extInvSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
+            m_nodeStats->extInvSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["inv"].Size()*m_inventorySizeBytes;
             for (int j=0; j<inv["inv"].Size(); j++)
             {
-              m_nodeStats->extInvSentBytes += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
+              m_nodeStats->extInvSentBytes[m_nodeId] += 5; //1Byte(fullBlock) + 4Bytes(numberOfChunks)
               if (!inv["inv"][j]["fullBlock"].GetBool())
-                m_nodeStats->extInvSentBytes += inv["inv"][j]["availableChunks"].Size()*1;
+                m_nodeStats->extInvSentBytes[m_nodeId] += inv["inv"][j]["availableChunks"].Size()*1;
             }
           }
           else if (m_protocolType == SENDHEADERS && m_blockTorrent)
           {
-            m_nodeStats->extHeadersSentBytes += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
+            m_nodeStats->extHeadersSentBytes[m_nodeId] += m_bitcoinMessageHeader + m_countBytes + inv["blocks"].Size()*m_headersSizeBytes;
             for (int j=0; j<inv["blocks"].Size(); j++)
             {
-            m_nodeStats->extHeadersSentBytes += 1;//fullBlock
+            m_nodeStats->extHeadersSentBytes[m_nodeId] += 1;//fullBlock
             if (!inv["blocks"][j]["fullBlock"].GetBool())
-                m_nodeStats->extHeadersSentBytes += inv["blocks"][j]["availableChunks"].Size()*1;
+                m_nodeStats->extHeadersSentBytes[m_nodeId] += inv["blocks"][j]["availableChunks"].Size()*1;
             }	
           }
 	  
-          NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+          BITCOIN_MESSAGE_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
                        << "s bitcoin miner " << GetNode ()->GetId () 
-                       << " sent a packet " << invInfo.GetString() 
+                       << " sent a packet " << MessageToString(inv) 
                        << " to " << *i);
         }
         break;
       }
       case UNSOLICITED_RELAY_NETWORK:
       {
-        double sendTime;
-        double eventTime;
         std::string packet;
 			  
 /* 				std::cout << "Node " << GetNode()->GetId() << "-" << *i 
@@ -1051,31 +980,14 @@ BitcoinSelfishMiner::ReleaseChain(std::vector<Block> blocks)
             blockMessageSize += blockSize;
           }
 		  
-          sendTime = blockMessageSize / m_uploadSpeed;
 
-          m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + blockMessageSize;
+          m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + blockMessageSize;
 		  
-          if (m_sendCompressedBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendCompressedBlockTimes.back())
-          {
-            eventTime = 0; 
-          }
-          else
-          {
-            //std::cout << "m_sendCompressedBlockTimes.back() = m_sendCompressedBlockTimes.back() = " << m_sendCompressedBlockTimes.back() << std::endl;
-            eventTime = m_sendCompressedBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-          }
-          m_sendCompressedBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
- 
-          //std::cout << sendTime << " " << eventTime << " " << m_sendCompressedBlockTimes.size() << std::endl;
-          NS_LOG_INFO("Node " << GetNode()->GetId() << " will start sending the block to " << *i
-                      << " at " << Simulator::Now ().GetSeconds() + eventTime << "\n");
-
-          //sendTime = blockMessageSize / m_uploadSpeed * count;		  
-          //std::cout << sendTime << std::endl;
+          NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the compressed-block for " << *i << "\n");
 
-          std::string packet = blockInfo.GetString();
-          Simulator::Schedule (Seconds(sendTime), &BitcoinSelfishMiner::SendBlock, this, packet, m_peersSockets[*i]);
-          Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinSelfishMiner::RemoveCompressedBlockSendTime, this);
+          std::string packet = blockInfo;
+          m_compressedUploadLink.Enqueue (*i, blockMessageSize, 0, LinkScheduler::TransferHandler (),
+                                          std::bind (&BitcoinSelfishMiner::SendUnsolicitedBlock, this, packet, *i));
         }
         else
         {
@@ -1084,27 +996,13 @@ BitcoinSelfishMiner::ReleaseChain(std::vector<Block> blocks)
           for (int j=0; j<inv["blocks"].Size(); j++)
             blockMessageSize += inv["blocks"][j]["size"].GetInt();
 
-          sendTime = blockMessageSize / m_uploadSpeed;
-          m_nodeStats->blockSentBytes += m_bitcoinMessageHeader + blockMessageSize;
-		  
-          if (m_sendBlockTimes.size() == 0 || Simulator::Now ().GetSeconds() >  m_sendBlockTimes.back())
-          {
-            eventTime = 0; 
-          }
-          else
-          {
-            //std::cout << "m_sendBlockTimes.back() = m_sendBlockTimes.back() = " << m_sendBlockTimes.back() << std::endl;
-            eventTime = m_sendBlockTimes.back() - Simulator::Now ().GetSeconds(); 
-          }
-          m_sendBlockTimes.push_back(Simulator::Now ().GetSeconds() + eventTime + sendTime);
-          packet = invInfo.GetString();
+          m_nodeStats->blockSentBytes[m_nodeId] += m_bitcoinMessageHeader + blockMessageSize;
 		  
-          /* std::cout << sendTime << " " << eventTime << " " << m_sendBlockTimes.size() << std::endl; */
-          NS_LOG_INFO("Node " << GetNode()->GetId() << " will send the block to " << *i 
-                      << " at " << Simulator::Now ().GetSeconds() + eventTime << ", eventTime = " << eventTime  << "\n");
+          NS_LOG_INFO("Node " << GetNode()->GetId() << " queued the block for " << *i << "\n");
 
-          Simulator::Schedule (Seconds(eventTime), &BitcoinSelfishMiner::SendBlock, this, packet, m_peersSockets[*i]);
-          Simulator::Schedule (Seconds(eventTime + sendTime), &BitcoinSelfishMiner::RemoveSendTime, this);
+          packet = invInfo;
+          m_uploadLink.Enqueue (*i, blockMessageSize, 0, std::bind (&BitcoinSelfishMiner::SendUnsolicitedBlock, this, packet, *i),
+                                LinkScheduler::TransferHandler ());
 
         }
 	   break;
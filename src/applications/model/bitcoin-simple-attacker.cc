@@ -14,6 +14,8 @@
 #include "ns3/tcp-socket-factory.h"
 #include "ns3/uinteger.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/string.h"
 #include "ns3/bitcoin-simple-attacker.h"
 #include "../../rapidjson/document.h"
 #include "../../rapidjson/writer.h"
@@ -77,6 +79,18 @@ BitcoinSimpleAttacker::GetTypeId (void)
                    DoubleValue (-1),
                    MakeDoubleAccessor (&BitcoinSimpleAttacker::m_blockGenParameter),
                    MakeDoubleChecker<double> ())	
+    .AddAttribute ("BlockTimeDistribution",
+                   "The distribution of the block generation times",
+                   EnumValue (BLOCK_TIME_GEOMETRIC),
+                   MakeEnumAccessor (&BitcoinSimpleAttacker::m_blockTimeDistribution),
+                   MakeEnumChecker (BLOCK_TIME_EXPONENTIAL, "Exponential",
+                                    BLOCK_TIME_GEOMETRIC, "Geometric",
+                                    BLOCK_TIME_TRACE, "Trace"))
+    .AddAttribute ("BlockTimeTrace",
+                   "The file of the block intervals replayed by the Trace distribution, one interval per line",
+                   StringValue (""),
+                   MakeStringAccessor (&BitcoinSimpleAttacker::m_blockTimeTrace),
+                   MakeStringChecker ())
     .AddAttribute ("AverageBlockGenIntervalSeconds", 
 				   "The average block generation interval we aim at (in seconds)",
                    DoubleValue (10*60),
@@ -92,6 +106,19 @@ BitcoinSimpleAttacker::GetTypeId (void)
                    UintegerValue (0),
                    MakeUintegerAccessor (&BitcoinSimpleAttacker::m_advertiseBlocks),
                    MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MessageCodec",
+                   "The codec used to encode the messages on the wire",
+                   EnumValue (JSON_CODEC),
+                   MakeEnumAccessor (&BitcoinSimpleAttacker::m_messageCodec),
+                   MakeEnumChecker (JSON_CODEC, "Json",
+                                    BINARY_CODEC, "Binary"))
+    .AddAttribute ("LinkDiscipline",
+                   "The discipline used to share the upload and download links between the peers",
+                   EnumValue (LINK_FIFO),
+                   MakeEnumAccessor (&BitcoinSimpleAttacker::m_linkDiscipline),
+                   MakeEnumChecker (LINK_FIFO, "Fifo",
+                                    LINK_ROUND_ROBIN, "RoundRobin",
+                                    LINK_FAIR_SHARE, "FairShare"))
     .AddTraceSource ("Rx",
                      "A packet has been received",
                      MakeTraceSourceAccessor (&BitcoinSimpleAttacker::m_rxTrace),
@@ -117,6 +144,7 @@ void
 BitcoinSimpleAttacker::StartApplication ()    // Called at time specified by Start
 {
   BitcoinNode::StartApplication ();
+  m_blockSizeGenerator.SetStream (RNG_BLOCK_SIZE, GetNode ()->GetId ());
   NS_LOG_WARN ("Simple Attacker " << GetNode()->GetId() << " m_realAverageBlockGenIntervalSeconds = " << m_realAverageBlockGenIntervalSeconds << "s");
   NS_LOG_WARN ("Simple Attacker " << GetNode()->GetId() << " m_averageBlockGenIntervalSeconds = " << m_averageBlockGenIntervalSeconds << "s");
   NS_LOG_WARN ("Simple Attacker " << GetNode()->GetId() << " m_fixedBlockTimeGeneration = " << m_fixedBlockTimeGeneration << "s");
@@ -133,35 +161,12 @@ BitcoinSimpleAttacker::StartApplication ()    // Called at time specified by Sta
     m_blockGenParameter *= m_hashRate;
 
   if (m_fixedBlockTimeGeneration == 0)
-	m_blockGenTimeDistribution.param(std::geometric_distribution<int>::param_type(m_blockGenParameter)); 
+    ConfigureBlockTimeSampler ();
 
   if (m_fixedBlockSize > 0)
     m_nextBlockSize = m_fixedBlockSize;
   else
-  {
-    std::array<double,201> intervals {0, 5, 10, 15, 20, 25, 30, 35, 40, 45, 50, 55, 60, 65, 70, 75, 80, 85, 90, 95, 100, 105, 110, 115, 120, 125, 
-                                     130, 135, 140, 145, 150, 155, 160, 165, 170, 175, 180, 185, 190, 195, 200, 205, 210, 215, 220, 225, 230, 235, 
-                                     240, 245, 250, 255, 260, 265, 270, 275, 280, 285, 290, 295, 300, 305, 310, 315, 320, 325, 330, 335, 340, 345, 
-                                     350, 355, 360, 365, 370, 375, 380, 385, 390, 395, 400, 405, 410, 415, 420, 425, 430, 435, 440, 445, 450, 455, 
-                                     460, 465, 470, 475, 480, 485, 490, 495, 500, 505, 510, 515, 520, 525, 530, 535, 540, 545, 550, 555, 560, 565, 
-                                     570, 575, 580, 585, 590, 595, 600, 605, 610, 615, 620, 625, 630, 635, 640, 645, 650, 655, 660, 665, 670, 675, 
-                                     680, 685, 690, 695, 700, 705, 710, 715, 720, 725, 730, 735, 740, 745, 750, 755, 760, 765, 770, 775, 780, 785, 
-                                     790, 795, 800, 805, 810, 815, 820, 825, 830, 835, 840, 845, 850, 855, 860, 865, 870, 875, 880, 885, 890, 895, 
-                                     900, 905, 910, 915, 920, 925, 930, 935, 940, 945, 950, 955, 960, 965, 970, 975, 980, 985, 990, 995, 1000};
-    std::array<double,200> weights {3.58, 0.33, 0.35, 0.4, 0.38, 0.4, 0.53, 0.46, 0.43, 0.48, 0.56, 0.69, 0.62, 0.62, 0.63, 0.62, 0.62, 0.63, 0.73, 
-                                    1.96, 0.75, 0.76, 0.73, 0.64, 0.66, 0.66, 0.66, 0.7, 0.66, 0.73, 0.68, 0.66, 0.67, 0.66, 0.72, 0.68, 0.64, 0.61, 
-                                    0.63, 0.58, 0.66, 0.6, 0.7, 0.62, 0.49, 0.59, 0.58, 0.59, 0.63, 1.59, 0.6, 0.58, 0.54, 0.62, 0.55, 0.54, 0.52, 
-                                    0.5, 0.53, 0.55, 0.49, 0.47, 0.51, 0.49, 0.52, 0.49, 0.49, 0.49, 0.56, 0.75, 0.51, 0.42, 0.46, 0.47, 0.43, 0.38, 
-                                    0.39, 0.39, 0.41, 0.43, 0.38, 0.41, 0.36, 0.41, 0.38, 0.42, 0.42, 0.37, 0.41, 0.41, 0.34, 0.32, 0.37, 0.32, 0.34, 
-                                    0.34, 0.34, 0.32, 0.41, 0.62, 0.33, 0.4, 0.32, 0.32, 0.29, 0.35, 0.32, 0.32, 0.28, 0.26, 0.25, 0.29, 0.26, 0.27, 
-                                    0.27, 0.24, 0.28, 0.3, 0.27, 0.23, 0.23, 0.28, 0.25, 0.29, 0.24, 0.21, 0.26, 0.29, 0.23, 0.2, 0.24, 0.25, 0.23, 
-                                    0.21, 0.26, 0.38, 0.24, 0.21, 0.25, 0.23, 0.22, 0.22, 0.24, 0.23, 0.23, 0.26, 0.24, 0.28, 0.64, 9.96, 0.15, 0.11, 
-                                    0.11, 0.1, 0.1, 0.1, 0.11, 0.11, 0.12, 0.13, 0.12, 0.16, 0.12, 0.13, 0.12, 0.1, 0.13, 0.13, 0.13, 0.25, 0.1, 0.14, 
-                                    0.14, 0.12, 0.14, 0.14, 0.17, 0.15, 0.19, 0.38, 0.2, 0.19, 0.24, 0.26, 0.36, 1.58, 1.49, 0.1, 0.2, 1.98, 0.05, 0.08, 
-                                    0.07, 0.07, 0.14, 0.08, 0.08, 0.53, 3.06, 3.31};
-                                
-    m_blockSizeDistribution = std::piecewise_constant_distribution<double> (intervals.begin(), intervals.end(), weights.begin());
-  }
+    m_blockSizeSampler = GetAttackerBlockSizeSampler ();
   
 /*   if (GetNode()->GetId() == 0)
   {
@@ -169,8 +174,8 @@ BitcoinSimpleAttacker::StartApplication ()    // Called at time specified by Sta
     m_blockchain.AddBlock(newBlock); 
   } */
   
-  m_nodeStats->hashRate = m_hashRate;
-  m_nodeStats->miner = 1;
+  m_nodeStats->hashRate[m_nodeId] = m_hashRate;
+  m_nodeStats->miner[m_nodeId] = 1;
 
   ScheduleNextMiningEvent ();
 }
@@ -179,7 +184,7 @@ void
 BitcoinSimpleAttacker::StopApplication ()
 {
   BitcoinNode::StopApplication ();  
-  Simulator::Cancel (m_nextMiningEvent);
+  StopMining ();
   
   NS_LOG_WARN ("The simple attacker " << GetNode ()->GetId () << " with hash rate = " << m_hashRate << " generated " << m_minerGeneratedBlocks 
                 << " blocks "<< "(" << 100. * m_minerGeneratedBlocks / (m_blockchain.GetTotalBlocks() - 1) 
@@ -188,9 +193,9 @@ BitcoinSimpleAttacker::StopApplication ()
                 << m_minerAverageBlockGenInterval - static_cast<int>(m_minerAverageBlockGenInterval) / m_secondsPerMin * m_secondsPerMin << "s"
                 << " and average size " << m_minerAverageBlockSize << " Bytes");
 				
-  m_nodeStats->minerGeneratedBlocks = m_minerGeneratedBlocks;
-  m_nodeStats->minerAverageBlockGenInterval = m_minerAverageBlockGenInterval;
-  m_nodeStats->minerAverageBlockSize = m_minerAverageBlockSize;
+  m_nodeStats->minerGeneratedBlocks[m_nodeId] = m_minerGeneratedBlocks;
+  m_nodeStats->minerAverageBlockGenInterval[m_nodeId] = m_minerAverageBlockGenInterval;
+  m_nodeStats->minerAverageBlockSize[m_nodeId] = m_minerAverageBlockSize;
 }
 
 void 
@@ -205,13 +210,13 @@ void
 BitcoinSimpleAttacker::MineBlock (void)  
 {
   NS_LOG_FUNCTION (this);
+  ProfilerScope profile (m_profiler, PROFILE_MINE_BLOCK);
   rapidjson::Document d; 
   int height =  m_minerGeneratedBlocks + 1;
   int minerId = GetNode ()->GetId ();
   int parentBlockMinerId;
   double currentTime = Simulator::Now ().GetSeconds ();
-  std::ostringstream stringStream;  
-  std::string blockHash = stringStream.str();
+  std::string blockHash = BlockId (height, minerId).ToString();
   
   d.SetObject();
 
@@ -224,7 +229,7 @@ BitcoinSimpleAttacker::MineBlock (void)
   {
     NS_LOG_WARN ("The attack was successful");
     m_attackFinished = true;
-	m_nodeStats->attackSuccess = 1;
+	m_nodeStats->attackSuccess[m_nodeId] = 1;
 	Simulator::Stop (Seconds (0));
   }
 
@@ -236,8 +241,6 @@ BitcoinSimpleAttacker::MineBlock (void)
   value.SetString("block"); //Remove
   d.AddMember("type", value, d.GetAllocator());
   
-  stringStream << height << "/" << minerId;
-  blockHash = stringStream.str();
   value.SetString(blockHash.c_str(), blockHash.size(), d.GetAllocator());
   array.PushBack(value, d.GetAllocator());
  
@@ -255,7 +258,7 @@ BitcoinSimpleAttacker::MineBlock (void)
   if (m_fixedBlockSize > 0)
     m_nextBlockSize = m_fixedBlockSize;
   else
-    m_nextBlockSize = m_blockSizeDistribution(m_generator) * 1000 * // *1000 because the m_blockSizeDistribution returns KBytes
+    m_nextBlockSize = m_blockSizeSampler->Draw (m_blockSizeGenerator) * 1000 * // *1000 because the m_blockSizeSampler returns KBytes
                       m_averageBlockGenIntervalSeconds / m_realAverageBlockGenIntervalSeconds;	// The block size is linearly dependent on the averageBlockGenIntervalSeconds
 
 
@@ -275,20 +278,15 @@ BitcoinSimpleAttacker::MineBlock (void)
                   + (m_nextBlockSize)/static_cast<double>(m_blockchain.GetTotalBlocks());
 				  
   m_blockchain.AddBlock(newBlock);
+  TraceBlock(newBlock);
   
-  // Stringify the DOM
-  rapidjson::StringBuffer packetInfo;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(packetInfo);
-  d.Accept(writer);
+  std::string packetInfo = EncodeMessage(d, m_messageCodec);
   
   if (m_advertiseBlocks == 1)
   {
     for (std::vector<Ipv4Address>::const_iterator i = m_peersAddresses.begin(); i != m_peersAddresses.end(); ++i)
     {
-	  const uint8_t delimiter[] = "#";
-
-      m_peersSockets[*i]->Send (reinterpret_cast<const uint8_t*>(packetInfo.GetString()), packetInfo.GetSize(), 0);
-	  m_peersSockets[*i]->Send (delimiter, 1, 0);
+      SendFrame(packetInfo, *i);
 	
 /* 	  //Send large packet
 	  int k;
@@ -309,9 +307,9 @@ BitcoinSimpleAttacker::MineBlock (void)
   m_previousBlockGenerationTime = Simulator::Now ().GetSeconds ();
   m_minerGeneratedBlocks++;
 
-  NS_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
+  BITCOIN_MESSAGE_LOG_INFO ("At time " << Simulator::Now ().GetSeconds ()
                << "s bitcoin simple attacker " << GetNode ()->GetId () 
-               << " sent a packet " << packetInfo.GetString() 
+               << " sent a packet " << MessageToString(d) 
 	           << " " << m_minerAverageBlockSize);
 	
   if (m_attackFinished == false)	
@@ -319,8 +317,10 @@ BitcoinSimpleAttacker::MineBlock (void)
   else
   {
     NS_LOG_WARN ("Current Blockchain is:\n" << m_blockchain);
-    m_nodeStats->totalBlocks = m_blockchain.GetTotalBlocks();
+    m_nodeStats->totalBlocks[m_nodeId] = m_blockchain.GetTotalBlocks();
   }
+
+  UpdateNetworkState();
 }
 
 void 
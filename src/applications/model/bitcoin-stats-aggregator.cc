@@ -0,0 +1,235 @@
+/**
+ * This file contains the definitions of the functions declared in bitcoin-stats-aggregator.h
+ */
+
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "bitcoin-stats-aggregator.h"
+
+#ifdef NS3_MPI
+#include <mpi.h>
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("StatsAggregator");
+
+StatsAggregator::StatsAggregator (Ptr<NodeStatsRegistry> stats) : m_stats (stats)
+{
+  memset (&m_summary, 0, sizeof(m_summary));
+}
+
+StatsAggregator::~StatsAggregator (void)
+{
+}
+
+void
+StatsAggregator::AddLocalNode (uint32_t nodeId)
+{
+  NS_ASSERT_MSG (nodeId < m_stats->GetNoNodes (), "Node " << nodeId << " does not exist");
+  m_localNodes.push_back(nodeId);
+}
+
+void
+StatsAggregator::Aggregate (uint32_t systemId, uint32_t systemCount, bool gatherNodeStats)
+{
+  NS_LOG_FUNCTION (this);
+
+  memset (&m_summary, 0, sizeof(m_summary));
+  for (auto &nodeId : m_localNodes)
+    AddNodeStats (m_summary, *m_stats, nodeId);
+
+  if (systemCount > 1)
+  {
+    ReduceSummaries (systemId);
+    if (gatherNodeStats)
+      GatherNodeStats (systemId, systemCount);
+  }
+
+  NS_LOG_INFO ("Aggregate: systemId " << systemId << " summarized " << m_localNodes.size() << " local nodes");
+}
+
+const statsSummary&
+StatsAggregator::GetSummary (void) const
+{
+  return m_summary;
+}
+
+void
+StatsAggregator::AddNodeStats (statsSummary &summary, const NodeStatsRegistry &stats, uint32_t nodeId)
+{
+  double receivedBytes = stats.invReceivedBytes[nodeId] + stats.getHeadersReceivedBytes[nodeId] + stats.headersReceivedBytes[nodeId]
+                       + stats.getDataReceivedBytes[nodeId] + stats.blockReceivedBytes[nodeId]
+                       + stats.extInvReceivedBytes[nodeId] + stats.extGetHeadersReceivedBytes[nodeId] + stats.extHeadersReceivedBytes[nodeId]
+                       + stats.extGetDataReceivedBytes[nodeId] + stats.chunkReceivedBytes[nodeId];
+  double sentBytes = stats.invSentBytes[nodeId] + stats.getHeadersSentBytes[nodeId] + stats.headersSentBytes[nodeId]
+                   + stats.getDataSentBytes[nodeId] + stats.blockSentBytes[nodeId]
+                   + stats.extInvSentBytes[nodeId] + stats.extGetHeadersSentBytes[nodeId] + stats.extHeadersSentBytes[nodeId]
+                   + stats.extGetDataSentBytes[nodeId] + stats.chunkSentBytes[nodeId];
+
+  summary.totalBlocks += stats.totalBlocks[nodeId];
+  summary.staleBlocks += stats.staleBlocks[nodeId];
+  summary.blockReceiveTimes += stats.meanBlockReceiveTime[nodeId] * stats.totalBlocks[nodeId];
+  summary.blockPropagationTimes += stats.meanBlockPropagationTime[nodeId] * stats.totalBlocks[nodeId];
+  summary.blockSizes += stats.meanBlockSize[nodeId] * stats.totalBlocks[nodeId];
+  summary.longestForks += stats.longestFork[nodeId];
+  summary.blocksInForks += stats.blocksInForks[nodeId];
+  summary.invReceivedBytes += stats.invReceivedBytes[nodeId];
+  summary.invSentBytes += stats.invSentBytes[nodeId];
+  summary.getHeadersReceivedBytes += stats.getHeadersReceivedBytes[nodeId];
+  summary.getHeadersSentBytes += stats.getHeadersSentBytes[nodeId];
+  summary.headersReceivedBytes += stats.headersReceivedBytes[nodeId];
+  summary.headersSentBytes += stats.headersSentBytes[nodeId];
+  summary.getDataReceivedBytes += stats.getDataReceivedBytes[nodeId];
+  summary.getDataSentBytes += stats.getDataSentBytes[nodeId];
+  summary.blockReceivedBytes += stats.blockReceivedBytes[nodeId];
+  summary.blockSentBytes += stats.blockSentBytes[nodeId];
+  summary.extInvReceivedBytes += stats.extInvReceivedBytes[nodeId];
+  summary.extInvSentBytes += stats.extInvSentBytes[nodeId];
+  summary.extGetHeadersReceivedBytes += stats.extGetHeadersReceivedBytes[nodeId];
+  summary.extGetHeadersSentBytes += stats.extGetHeadersSentBytes[nodeId];
+  summary.extHeadersReceivedBytes += stats.extHeadersReceivedBytes[nodeId];
+  summary.extHeadersSentBytes += stats.extHeadersSentBytes[nodeId];
+  summary.extGetDataReceivedBytes += stats.extGetDataReceivedBytes[nodeId];
+  summary.extGetDataSentBytes += stats.extGetDataSentBytes[nodeId];
+  summary.chunkReceivedBytes += stats.chunkReceivedBytes[nodeId];
+  summary.chunkSentBytes += stats.chunkSentBytes[nodeId];
+  AddToSketch (summary.downloadBytesPerBlock, receivedBytes / (stats.totalBlocks[nodeId] - 1));
+  AddToSketch (summary.uploadBytesPerBlock, sentBytes / (stats.totalBlocks[nodeId] - 1));
+  AddToSketch (summary.totalBytesPerBlock, (receivedBytes + sentBytes) / (stats.totalBlocks[nodeId] - 1));
+  AddToSketch (summary.blockTimeouts, stats.blockTimeouts[nodeId]);
+  AddToSketch (summary.chunkTimeouts, stats.chunkTimeouts[nodeId]);
+  AddToSketch (summary.propagationTimes, stats.meanBlockPropagationTime[nodeId]);
+
+  if (stats.miner[nodeId] == 0)
+  {
+    summary.nodes++;
+    summary.nodesConnections += stats.connections[nodeId];
+  }
+  else
+  {
+    summary.miners++;
+    summary.minersConnections += stats.connections[nodeId];
+    AddToSketch (summary.minersPropagationTimes, stats.meanBlockPropagationTime[nodeId]);
+  }
+}
+
+void
+StatsAggregator::AddToSketch (quantileSketch &sketch, double value)
+{
+  sketch.count++;
+  sketch.sum += value;
+  sketch.bins[GetSketchBin (value)]++;
+}
+
+double
+StatsAggregator::GetPercentile (const quantileSketch &sketch, double percentile)
+{
+  /**
+   * Like the percentiles of a sorted vector, the percentile is the value with index floor(count * percentile).
+   * Bin i > 0 spans [lo, hi) = [STATS_SKETCH_MIN * g^(i-1), STATS_SKETCH_MIN * g^i) with g = 10^(1/STATS_SKETCH_BINS_PER_DECADE),
+   * and is represented by 2 * lo * hi / (lo + hi), which is within (g - 1) / (g + 1) of every value in the bin.
+   */
+  double index = std::floor(sketch.count * percentile);
+  double cumulative = 0;
+
+  for (int i = 0; i < STATS_SKETCH_BINS; i++)
+  {
+    cumulative += sketch.bins[i];
+    if (cumulative > index)
+    {
+      if (i == 0)
+        return 0;
+
+      double lo = STATS_SKETCH_MIN * std::pow(10, (i - 1.0) / STATS_SKETCH_BINS_PER_DECADE);
+      double hi = STATS_SKETCH_MIN * std::pow(10, static_cast<double>(i) / STATS_SKETCH_BINS_PER_DECADE);
+      return 2 * lo * hi / (lo + hi);
+    }
+  }
+
+  return 0;
+}
+
+double
+StatsAggregator::GetMean (const quantileSketch &sketch)
+{
+  return sketch.sum / sketch.count;
+}
+
+int
+StatsAggregator::GetSketchBin (double value)
+{
+  if (!(value >= STATS_SKETCH_MIN))
+    return 0;
+
+  int bin = 1 + static_cast<int>(std::log10(value / STATS_SKETCH_MIN) * STATS_SKETCH_BINS_PER_DECADE);
+  return std::min(bin, STATS_SKETCH_BINS - 1);
+}
+
+void
+StatsAggregator::ReduceSummaries (uint32_t systemId)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  statsSummary total;
+
+  static_assert(sizeof(statsSummary) % sizeof(double) == 0, "The statsSummary must consist of doubles");
+  MPI_Reduce (&m_summary, &total, sizeof(statsSummary) / sizeof(double), MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  if (systemId == 0)
+    m_summary = total;
+#else
+  NS_FATAL_ERROR ("Can't merge the statistics of multiple processes without MPI compiled in");
+#endif
+}
+
+void
+StatsAggregator::GatherNodeStats (uint32_t systemId, uint32_t systemCount)
+{
+  NS_LOG_FUNCTION (this);
+
+#ifdef NS3_MPI
+  std::vector<char>  localRecords;
+  std::vector<int>   counts;
+  std::vector<int>   displacements;
+  std::vector<char>  gatheredRecords;
+
+  localRecords.reserve(m_localNodes.size() * m_stats->GetRecordSize ());
+  for (auto &nodeId : m_localNodes)
+    m_stats->Pack (nodeId, localRecords);
+
+  int localBytes = localRecords.size();
+
+  if (systemId == 0)
+    counts.resize(systemCount);
+
+  MPI_Gather (&localBytes, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+
+  if (systemId == 0)
+  {
+    int totalBytes = 0;
+
+    displacements.resize(systemCount);
+    for (uint32_t i = 0; i < systemCount; i++)
+    {
+      displacements[i] = totalBytes;
+      totalBytes += counts[i];
+    }
+    gatheredRecords.resize(totalBytes);
+  }
+
+  MPI_Gatherv (localRecords.data(), localBytes, MPI_BYTE, gatheredRecords.data(), counts.data(),
+               displacements.data(), MPI_BYTE, 0, MPI_COMM_WORLD);
+
+  for (const char *record = gatheredRecords.data(); record < gatheredRecords.data() + gatheredRecords.size(); )
+    record = m_stats->Unpack (record);
+#else
+  NS_FATAL_ERROR ("Can't gather the statistics of multiple processes without MPI compiled in");
+#endif
+}
+
+} // namespace ns3
@@ -0,0 +1,90 @@
+/**
+ * This file contains the declaration of the StatsAggregator, which collects the statistics of the nodes
+ * simulated by all the MPI processes to the process with systemId 0.
+ */
+
+#ifndef BITCOIN_STATS_AGGREGATOR_H
+#define BITCOIN_STATS_AGGREGATOR_H
+
+#include <vector>
+#include "ns3/ptr.h"
+#include "bitcoin.h"
+#include "bitcoin-node-stats.h"
+
+namespace ns3 {
+
+/**
+ * Every process reduces the statistics of the nodes it simulates to a statsSummary, whose distributions are kept in
+ * fixed-size quantile sketches, and the summaries are merged
+ * on the process with systemId 0 with a single MPI_Reduce. Optionally, the records of every node (see NodeStatsRegistry::Pack)
+ * are also packed contiguously by each process and collected with a single MPI_Gatherv, for the outputs which need the individual nodes.
+ * Without MPI, or with a single process, the statistics are only summarized.
+ */
+class StatsAggregator
+{
+public:
+  /**
+   * \param stats the registry of the statistics of all the nodes
+   */
+  StatsAggregator (Ptr<NodeStatsRegistry> stats);
+  ~StatsAggregator (void);
+
+  /**
+   * \brief Registers a node simulated by this process
+   * \param nodeId the id of the node
+   */
+  void AddLocalNode (uint32_t nodeId);
+
+  /**
+   * \brief Summarizes the statistics of the local nodes and merges the summaries on the process with systemId 0.
+   * It must be called by all the processes.
+   * \param systemId the systemId of this process
+   * \param systemCount the number of processes
+   * \param gatherNodeStats whether the statistics of the individual nodes are gathered in the registry of systemId 0 as well
+   */
+  void Aggregate (uint32_t systemId, uint32_t systemCount, bool gatherNodeStats);
+
+  /**
+   * \return the summary of all the nodes in the process with systemId 0 and of the local nodes in the rest
+   */
+  const statsSummary& GetSummary (void) const;
+
+  /**
+   * \brief Adds the statistics of a node to a summary
+   */
+  static void AddNodeStats (statsSummary &summary, const NodeStatsRegistry &stats, uint32_t nodeId);
+
+  /**
+   * \brief Adds a value to a quantile sketch
+   */
+  static void AddToSketch (quantileSketch &sketch, double value);
+
+  /**
+   * \param sketch a quantile sketch
+   * \param percentile the percentile in [0, 1)
+   * \return the estimated value with index floor(count * percentile) among the sorted values of the sketch, 0 if the sketch is empty
+   */
+  static double GetPercentile (const quantileSketch &sketch, double percentile);
+
+  /**
+   * \return the mean of the values of a quantile sketch, which is exact
+   */
+  static double GetMean (const quantileSketch &sketch);
+
+private:
+  /**
+   * \return the bin of a value in a quantile sketch
+   */
+  static int GetSketchBin (double value);
+
+  void ReduceSummaries (uint32_t systemId);
+  void GatherNodeStats (uint32_t systemId, uint32_t systemCount);
+
+  Ptr<NodeStatsRegistry>  m_stats;
+  std::vector<uint32_t>   m_localNodes;     // the ids of the nodes simulated by this process
+  statsSummary            m_summary;
+};
+
+} // namespace ns3
+
+#endif /* BITCOIN_STATS_AGGREGATOR_H */
@@ -10,10 +10,186 @@
 #include "ns3/address.h"
 #include "ns3/log.h"
 #include "bitcoin.h"
+#include "bitcoin-memory-accountant.h"
+#include <cstdlib>
+#include <functional>
+#include <sstream>
 
 namespace ns3 {
 
 
+/**
+ *
+ * Class BlockId functions
+ *
+ */
+
+BlockId::BlockId(int blockHeight, int minerId)
+{
+  m_value = (static_cast<uint64_t>(static_cast<uint32_t>(blockHeight)) << 32) | static_cast<uint32_t>(minerId);
+}
+
+BlockId::BlockId()
+{
+  m_value = 0;
+}
+
+BlockId::BlockId(const std::string &blockHash)
+{
+  const char *begin = blockHash.c_str();
+  char       *end;
+  int         blockHeight = strtol(begin, &end, 10);
+  int         minerId = (*end == '/') ? strtol(end + 1, NULL, 10) : 0;
+  
+  *this = BlockId(blockHeight, minerId);
+}
+
+int
+BlockId::GetBlockHeight (void) const
+{
+  return static_cast<int32_t>(m_value >> 32);
+}
+
+int
+BlockId::GetMinerId (void) const
+{
+  return static_cast<int32_t>(m_value & 0xFFFFFFFF);
+}
+
+uint64_t
+BlockId::GetValue (void) const
+{
+  return m_value;
+}
+
+std::string
+BlockId::ToString (void) const
+{
+  std::ostringstream stringStream;
+  stringStream << *this;
+  return stringStream.str();
+}
+
+size_t
+BlockIdHash::operator() (const BlockId &id) const
+{
+  return std::hash<uint64_t>()(id.GetValue());
+}
+
+
+/**
+ *
+ * Class ChunkId functions
+ *
+ */
+
+ChunkId::ChunkId(const BlockId &blockId, int chunkId)
+{
+  m_blockId = blockId;
+  m_chunkId = chunkId;
+}
+
+ChunkId::ChunkId()
+{
+  m_chunkId = 0;
+}
+
+ChunkId::ChunkId(const std::string &chunkHash)
+{
+  size_t delimiter = chunkHash.rfind("/");
+  
+  m_blockId = BlockId(chunkHash.substr(0, delimiter));
+  m_chunkId = (delimiter != std::string::npos) ? atoi(chunkHash.c_str() + delimiter + 1) : 0;
+}
+
+BlockId
+ChunkId::GetBlockId (void) const
+{
+  return m_blockId;
+}
+
+int
+ChunkId::GetChunkId (void) const
+{
+  return m_chunkId;
+}
+
+std::string
+ChunkId::ToString (void) const
+{
+  std::ostringstream stringStream;
+  stringStream << *this;
+  return stringStream.str();
+}
+
+size_t
+ChunkIdHash::operator() (const ChunkId &id) const
+{
+  return std::hash<uint64_t>()(id.GetBlockId().GetValue() * 31 + static_cast<uint32_t>(id.GetChunkId()));
+}
+
+
+
+/**
+ *
+ * Class BlockStore functions
+ *
+ */
+
+const uint32_t BlockStore::EMPTY_HEADER = 0;
+
+BlockStore::BlockStore (void)
+{
+  blockHeader empty = {0, 0, 0, 0, 0};
+
+  m_headers.push_back(empty);
+  m_index.insert(std::make_pair(BlockId(0, 0), EMPTY_HEADER));
+}
+
+BlockStore&
+BlockStore::GetInstance (void)
+{
+  static BlockStore store;
+  return store;
+}
+
+uint32_t
+BlockStore::Intern (const blockHeader &header)
+{
+  BlockId blockId (header.blockHeight, header.minerId);
+  auto    range = m_index.equal_range(blockId);
+
+  /**
+   * The blocks are identified by their BlockId, so there is normally a single header per id.
+   * Headers which only share the id (e.g. the placeholders built with the default arguments) are stored separately.
+   */
+  for (auto it = range.first; it != range.second; it++)
+  {
+    const blockHeader &stored = m_headers[it->second];
+    if (stored.parentBlockMinerId == header.parentBlockMinerId && stored.blockSizeBytes == header.blockSizeBytes 
+        && stored.timeCreated == header.timeCreated)
+      return it->second;
+  }
+
+  uint32_t handle = m_headers.size();
+  m_headers.push_back(header);
+  m_index.insert(std::make_pair(blockId, handle));
+  return handle;
+}
+
+const blockHeader&
+BlockStore::GetHeader (uint32_t handle) const
+{
+  return m_headers[handle];
+}
+
+size_t
+BlockStore::GetSize (void) const
+{
+  return m_headers.size();
+}
+
+
 /**
  *
  * Class Block functions
@@ -23,11 +199,9 @@ namespace ns3 {
 Block::Block(int blockHeight, int minerId, int parentBlockMinerId, int blockSizeBytes, 
              double timeCreated, double timeReceived, Ipv4Address receivedFromIpv4)
 {  
-  m_blockHeight = blockHeight;
-  m_minerId = minerId;
-  m_parentBlockMinerId = parentBlockMinerId;
-  m_blockSizeBytes = blockSizeBytes;
-  m_timeCreated = timeCreated;
+  blockHeader header = {blockHeight, minerId, parentBlockMinerId, blockSizeBytes, timeCreated};
+
+  m_header = BlockStore::GetInstance().Intern(header);
   m_timeReceived = timeReceived;
   m_receivedFromIpv4 = receivedFromIpv4;
 
@@ -35,17 +209,14 @@ Block::Block(int blockHeight, int minerId, int parentBlockMinerId, int blockSize
 
 Block::Block()
 {  
-  Block(0, 0, 0, 0, 0, 0, Ipv4Address("0.0.0.0"));
-
+  m_header = BlockStore::EMPTY_HEADER;
+  m_timeReceived = 0;
+  m_receivedFromIpv4 = Ipv4Address("0.0.0.0");
 }
 
 Block::Block (const Block &blockSource)
 {  
-  m_blockHeight = blockSource.m_blockHeight;
-  m_minerId = blockSource.m_minerId;
-  m_parentBlockMinerId = blockSource.m_parentBlockMinerId;
-  m_blockSizeBytes = blockSource.m_blockSizeBytes;
-  m_timeCreated = blockSource.m_timeCreated;
+  m_header = blockSource.m_header;
   m_timeReceived = blockSource.m_timeReceived;
   m_receivedFromIpv4 = blockSource.m_receivedFromIpv4;
 
@@ -55,58 +226,78 @@ Block::~Block (void)
 {
 }
 
+const blockHeader&
+Block::GetHeader (void) const
+{
+  return BlockStore::GetInstance().GetHeader(m_header);
+}
+
+void
+Block::SetHeader (const blockHeader &header)
+{
+  m_header = BlockStore::GetInstance().Intern(header);
+}
+
 int 
 Block::GetBlockHeight (void) const
 {
-  return m_blockHeight;
+  return GetHeader().blockHeight;
 }
 
 void
 Block::SetBlockHeight (int blockHeight)
 {
-  m_blockHeight = blockHeight;
+  blockHeader header = GetHeader();
+  header.blockHeight = blockHeight;
+  SetHeader(header);
 }
 
 int 
 Block::GetMinerId (void) const
 {
-  return m_minerId;
+  return GetHeader().minerId;
 }
 
 void 
 Block::SetMinerId (int minerId)
 {
-  m_minerId = minerId;
+  blockHeader header = GetHeader();
+  header.minerId = minerId;
+  SetHeader(header);
 }
 
 int 
 Block::GetParentBlockMinerId (void) const
 {
-  return m_parentBlockMinerId;
+  return GetHeader().parentBlockMinerId;
 }
 
 void 
 Block::SetParentBlockMinerId (int parentBlockMinerId)
 {
-  m_parentBlockMinerId = parentBlockMinerId;
+  blockHeader header = GetHeader();
+  header.parentBlockMinerId = parentBlockMinerId;
+  SetHeader(header);
 }
 
 int 
 Block::GetBlockSizeBytes (void) const
 {
-  return m_blockSizeBytes;
+  return GetHeader().blockSizeBytes;
 }
 
 void 
 Block::SetBlockSizeBytes (int blockSizeBytes)
 {
-  m_blockSizeBytes = blockSizeBytes;
+  blockHeader header = GetHeader();
+  header.blockSizeBytes = blockSizeBytes;
+  SetHeader(header);
 }
 
 double 
 Block::GetTimeCreated (void) const
 {
-  return m_timeCreated;
+  return GetHeader().timeCreated;
 }
   
 double 
@@ -114,6 +305,20 @@ Block::GetTimeReceived (void) const
 {
   return m_timeReceived;
 }
+
+BlockId
+Block::GetBlockId (void) const
+{
+  const blockHeader &header = GetHeader();
+  return BlockId(header.blockHeight, header.minerId);
+}
+
+BlockId
+Block::GetParentBlockId (void) const
+{
+  const blockHeader &header = GetHeader();
+  return BlockId(header.blockHeight - 1, header.parentBlockMinerId);
+}
   
 
 Ipv4Address 
@@ -150,11 +355,7 @@ Block::IsChild(const Block &block) const
 Block& 
 Block::operator= (const Block &blockSource)
 {  
-  m_blockHeight = blockSource.m_blockHeight;
-  m_minerId = blockSource.m_minerId;
-  m_parentBlockMinerId = blockSource.m_parentBlockMinerId;
-  m_blockSizeBytes = blockSource.m_blockSizeBytes;
-  m_timeCreated = blockSource.m_timeCreated;
+  m_header = blockSource.m_header;
   m_timeReceived = blockSource.m_timeReceived;
   m_receivedFromIpv4 = blockSource.m_receivedFromIpv4;
 
@@ -175,22 +376,13 @@ BitcoinChunk::BitcoinChunk(int blockHeight, int minerId, int chunkId, int parent
   m_chunkId = chunkId;
 }
 
-BitcoinChunk::BitcoinChunk()
+BitcoinChunk::BitcoinChunk() : BitcoinChunk(0, 0, 0, 0, 0, 0, 0, Ipv4Address("0.0.0.0"))
 {  
-  BitcoinChunk(0, 0, 0, 0, 0, 0, 0, Ipv4Address("0.0.0.0"));
 }
 
-BitcoinChunk::BitcoinChunk (const BitcoinChunk &chunkSource)
+BitcoinChunk::BitcoinChunk (const BitcoinChunk &chunkSource) : Block (chunkSource)
 {  
-  m_blockHeight = chunkSource.m_blockHeight;
-  m_minerId = chunkSource.m_minerId;
   m_chunkId = chunkSource.m_chunkId;
-  m_parentBlockMinerId = chunkSource.m_parentBlockMinerId;
-  m_blockSizeBytes = chunkSource.m_blockSizeBytes;
-  m_timeCreated = chunkSource.m_timeCreated;
-  m_timeReceived = chunkSource.m_timeReceived;
-  m_receivedFromIpv4 = chunkSource.m_receivedFromIpv4;
-
 }
 
 BitcoinChunk::~BitcoinChunk (void)
@@ -212,14 +404,8 @@ BitcoinChunk::SetChunkId (int chunkId)
 BitcoinChunk& 
 BitcoinChunk::operator= (const BitcoinChunk &chunkSource)
 {  
-  m_blockHeight = chunkSource.m_blockHeight;
-  m_minerId = chunkSource.m_minerId;
+  Block::operator= (chunkSource);
   m_chunkId = chunkSource.m_chunkId;
-  m_parentBlockMinerId = chunkSource.m_parentBlockMinerId;
-  m_blockSizeBytes = chunkSource.m_blockSizeBytes;
-  m_timeCreated = chunkSource.m_timeCreated;
-  m_timeReceived = chunkSource.m_timeReceived;
-  m_receivedFromIpv4 = chunkSource.m_receivedFromIpv4;
 
   return *this;
 }
@@ -235,6 +421,10 @@ Blockchain::Blockchain(void)
 {
   m_noStaleBlocks = 0;
   m_totalBlocks = 0;
+  m_blocksInForks = 0;
+  m_forkedHeights = 0;
+  m_longestFork = 0;
+  m_forkHistogram.resize(2, 0);
   Block genesisBlock(0, -1, -2, 0, 0, 0, Ipv4Address("0.0.0.0"));
   AddBlock(genesisBlock); 
 }
@@ -272,73 +462,28 @@ Blockchain::GetBlockchainHeight (void) const
 bool 
 Blockchain::HasBlock (const Block &newBlock) const
 {
-  
-  if (newBlock.GetBlockHeight() > GetCurrentTopBlock()->GetBlockHeight())
-  {
-    /* The new block has a new blockHeight, so we haven't received it previously. */
-	
-	return false;
-  }
-  else														
-  {															
-    /*  The new block doesn't have a new blockHeight, so we have to check it is new or if we have already received it. */
-	
-    for (auto const &block: m_blocks[newBlock.GetBlockHeight()]) 
-    {
-      if (block == newBlock)
-	  {
-	    return true;
-	  }
-    }
-  }
-  return false;
+  return m_blockIndex.find(newBlock.GetBlockId()) != m_blockIndex.end();
 }
 
 bool 
 Blockchain::HasBlock (int height, int minerId) const
 {
-  
-  if (height > GetCurrentTopBlock()->GetBlockHeight())		
-  {
-    /* The new block has a new blockHeight, so we haven't received it previously. */
-	
-	return false;
-  }
-  else														
-  {															
-    /*  The new block doesn't have a new blockHeight, so we have to check it is new or if we have already received it. */
-	
-    for (auto const &block: m_blocks[height]) 
-    {
-      if (block.GetBlockHeight() == height && block.GetMinerId() == minerId)
-	  {
-	    return true;
-	  }
-    }
-  }
-  return false;
+  return m_blockIndex.find(BlockId(height, minerId)) != m_blockIndex.end();
 }
 
 
 Block 
 Blockchain::ReturnBlock(int height, int minerId)
 {
-  std::vector<Block>::iterator  block_it;
-
-  if (height <= GetBlockchainHeight() && height >= 0)
-  {
-    for (block_it = m_blocks[height].begin();  block_it < m_blocks[height].end(); block_it++)
-    {
-      if (block_it->GetBlockHeight() == height && block_it->GetMinerId() == minerId)
-        return *block_it;
-    }
-  }
+  const Block *block = GetBlockPointer(BlockId(height, minerId));
   
-  for (block_it = m_orphans.begin();  block_it < m_orphans.end(); block_it++)
-  {
-    if (block_it->GetBlockHeight() == height && block_it->GetMinerId() == minerId)
-      return *block_it;
-  }
+  if (block != nullptr)
+    return *block;
+  
+  auto orphan_it = m_orphans.find(BlockId(height, minerId));
+  
+  if (orphan_it != m_orphans.end())
+    return orphan_it->second;
   
   return Block(-1, -1, -1, -1, -1, -1, Ipv4Address("0.0.0.0"));
 }
@@ -347,43 +492,33 @@ Blockchain::ReturnBlock(int height, int minerId)
 bool 
 Blockchain::IsOrphan (const Block &newBlock) const
 {													
-  for (auto const &block: m_orphans) 
-  {
-    if (block == newBlock)
-    {
-      return true;
-    }
-  }
-  return false;
+  return m_orphans.find(newBlock.GetBlockId()) != m_orphans.end();
 }
 
 
 bool 
 Blockchain::IsOrphan (int height, int minerId) const
 {													
-  for (auto const &block: m_orphans) 
-  {
-    if (block.GetBlockHeight() == height && block.GetMinerId() == minerId)
-    {
-      return true;
-    }
-  }
-  return false;
+  return m_orphans.find(BlockId(height, minerId)) != m_orphans.end();
 }
 
 
 const Block* 
 Blockchain::GetBlockPointer (const Block &newBlock) const
 {
+  return GetBlockPointer(newBlock.GetBlockId());
+}
+
+
+const Block* 
+Blockchain::GetBlockPointer (const BlockId &blockId) const
+{
+  auto index_it = m_blockIndex.find(blockId);
   
-  for (auto const &block: m_blocks[newBlock.GetBlockHeight()]) 
-  {
-    if (block == newBlock)
-    {
-      return &block;
-    }
-  }
-  return nullptr;
+  if (index_it == m_blockIndex.end())
+    return nullptr;
+  
+  return &m_blocks[blockId.GetBlockHeight()][index_it->second];
 }
  
 const std::vector<const Block *> 
@@ -411,14 +546,14 @@ const std::vector<const Block *>
 Blockchain::GetOrphanChildrenPointers (const Block &newBlock)
 {
   std::vector<const Block *> children;
-  std::vector<Block>::iterator  block_it;
+  auto children_it = m_orphanChildren.find(newBlock.GetBlockId());
+
+  if (children_it == m_orphanChildren.end())
+    return children;
 
-  for (block_it = m_orphans.begin();  block_it < m_orphans.end(); block_it++)
+  for (auto const &childId : children_it->second)
   {
-    if (newBlock.IsParent(*block_it))
-    {
-      children.push_back(&(*block_it));
-    }
+    children.push_back(&m_orphans[childId]);
   }
   return children;
 }
@@ -427,20 +562,10 @@ Blockchain::GetOrphanChildrenPointers (const Block &newBlock)
 const Block* 
 Blockchain::GetParent (const Block &block) 
 {
-  std::vector<Block>::iterator  block_it;
-  int parentHeight = block.GetBlockHeight() - 1;
-
-  if (parentHeight > GetBlockchainHeight() || parentHeight < 0)
+  if (block.GetBlockHeight() < 1)
     return nullptr;
   
-  for (block_it = m_blocks[parentHeight].begin();  block_it < m_blocks[parentHeight].end(); block_it++)  {
-    if (block.IsChild(*block_it))
-    {
-      return &(*block_it);
-    }
-  }
-
-  return nullptr;
+  return GetBlockPointer(block.GetParentBlockId());
 }
 
 
@@ -459,6 +584,8 @@ Blockchain::AddBlock (const Block& newBlock)
   {
     std::vector<Block> newHeight(1, newBlock);
 	m_blocks.push_back(newHeight);
+    m_blockIndex[newBlock.GetBlockId()] = 0;
+    m_forkHistogram[0]++;
   }	
   else if (newBlock.GetBlockHeight() > GetCurrentTopBlock()->GetBlockHeight())   		
   {
@@ -473,9 +600,11 @@ Blockchain::AddBlock (const Block& newBlock)
       std::vector<Block> newHeight; 
       m_blocks.push_back(newHeight);
     }
+    m_forkHistogram[0] += dummyRows + 1;
 	
     std::vector<Block> newHeight(1, newBlock);
     m_blocks.push_back(newHeight);
+    m_blockIndex[newBlock.GetBlockId()] = 0;
   }
   else
   {
@@ -485,52 +614,117 @@ Blockchain::AddBlock (const Block& newBlock)
       m_noStaleBlocks++;									
 
     m_blocks[newBlock.GetBlockHeight()].push_back(newBlock);   
+    m_blockIndex[newBlock.GetBlockId()] = m_blocks[newBlock.GetBlockHeight()].size() - 1;
   }
   
   m_totalBlocks++;
+  UpdateForkStatistics(newBlock);
+}
+
+
+void
+Blockchain::UpdateForkStatistics (const Block &newBlock)
+{
+  const std::vector<Block> &siblings = m_blocks[newBlock.GetBlockHeight()];
+  int rowSize = siblings.size();
+
+  if (rowSize >= static_cast<int>(m_forkHistogram.size()))
+    m_forkHistogram.resize(rowSize + 1, 0);
+  m_forkHistogram[rowSize - 1]--;   // new rows are counted as empty heights when they are created
+  m_forkHistogram[rowSize]++;
+
+  if (rowSize < 2)
+    return;
+
+  if (rowSize == 2)
+  {
+    /**
+     * The height has just been forked, so its first block joins the fork too
+     */
+    m_forkedHeights++;
+    m_blocksInForks += 2;
+    ExtendFork(siblings[0]);
+  }
+  else
+    m_blocksInForks++;
+
+  ExtendFork(newBlock);
+}
+
+
+void
+Blockchain::ExtendFork (const Block &forkedBlock)
+{
+  std::vector<const Block *> pending(1, &forkedBlock);
+
+  /**
+   * The fork length of a block is the fork length of its parent plus one. When a height is forked after
+   * its descendants have been added, the descendants in forked heights have to be updated as well.
+   */
+  while (!pending.empty())
+  {
+    const Block *block = pending.back();
+    pending.pop_back();
+
+    auto parent_it = m_forkLengths.find(block->GetParentBlockId());
+    int forkLength = (parent_it != m_forkLengths.end() ? parent_it->second : 0) + 1;
+
+    m_forkLengths[block->GetBlockId()] = forkLength;
+    if (forkLength > m_longestFork)
+      m_longestFork = forkLength;
+
+    for (auto const &child : GetChildrenPointers(*block))
+    {
+      if (m_blocks[child->GetBlockHeight()].size() > 1)
+        pending.push_back(child);
+    }
+  }
 }
 
 
 void 
 Blockchain::AddOrphan (const Block& newBlock)
 {
-  m_orphans.push_back(newBlock);
+  BlockId blockId = newBlock.GetBlockId();
+  
+  if (m_orphans.find(blockId) != m_orphans.end())
+    return;
+  
+  m_orphans[blockId] = newBlock;
+  m_orphanChildren[newBlock.GetParentBlockId()].push_back(blockId);
 }
 
 
 void 
 Blockchain::RemoveOrphan (const Block& newBlock)
 {
-  std::vector<Block>::iterator  block_it;
-
-  for (block_it = m_orphans.begin();  block_it < m_orphans.end(); block_it++)
-  {
-    if (newBlock == *block_it)
-      break;
-  }
+  auto orphan_it = m_orphans.find(newBlock.GetBlockId());
   
-  if (block_it == m_orphans.end())
+  if (orphan_it == m_orphans.end())
   {
-    // name not in vector
+    // name not in orphans
     return;
   } 
-  else
-  {
-    m_orphans.erase(block_it);
-  }
+
+  auto children_it = m_orphanChildren.find(orphan_it->second.GetParentBlockId());
+  std::vector<BlockId> &siblings = children_it->second;
+  
+  siblings.erase(std::find(siblings.begin(), siblings.end(), orphan_it->first));
+  if (siblings.empty())
+    m_orphanChildren.erase(children_it);
+  
+  m_orphans.erase(orphan_it);
 }
 
 
 void
 Blockchain::PrintOrphans (void)
 {
-  std::vector<Block>::iterator  block_it;
-  
   std::cout << "The orphans are:\n";
   
-  for (block_it = m_orphans.begin();  block_it < m_orphans.end(); block_it++)
+  for (auto const &orphan : m_orphans)
   {
-    std::cout << *block_it << "\n";
+    std::cout << orphan.second << "\n";
   }
   
   std::cout << "\n";
@@ -538,92 +732,99 @@ Blockchain::PrintOrphans (void)
 
 
 int 
-Blockchain::GetBlocksInForks (void)
+Blockchain::GetBlocksInForks (void) const
 {
-  std::vector< std::vector<Block>>::iterator blockHeight_it;
-  int count = 0;
-  
-  for (blockHeight_it = m_blocks.begin(); blockHeight_it < m_blocks.end(); blockHeight_it++) 
-  {
-    if (blockHeight_it->size() > 1)
-      count += blockHeight_it->size();
-  }
-  
-  return count;
+  return m_blocksInForks;
 }
 
 
 int 
-Blockchain::GetLongestForkSize (void)
+Blockchain::GetLongestForkSize (void) const
 {
-  std::vector< std::vector<Block>>::iterator   blockHeight_it;
-  std::vector<Block>::iterator                 block_it;
-  std::map<int, int>                           forkedBlocksParentId;
-  std::vector<int>                             newForks; 
-  int maxSize = 0;
-  
-  for (blockHeight_it = m_blocks.begin(); blockHeight_it < m_blocks.end(); blockHeight_it++) 
-  {
-	
-    if (blockHeight_it->size() > 1 && forkedBlocksParentId.size() == 0)
-    {
-      for (block_it = blockHeight_it->begin();  block_it < blockHeight_it->end(); block_it++)
-      {
-        forkedBlocksParentId[block_it->GetMinerId()] = 1;
-      }
-    }
-    else if (blockHeight_it->size() > 1)
-    {
-      for (block_it = blockHeight_it->begin();  block_it < blockHeight_it->end(); block_it++)
-      {
-        std::map<int, int>::iterator mapIndex = forkedBlocksParentId.find(block_it->GetParentBlockMinerId());
-        
-        if(mapIndex != forkedBlocksParentId.end())
-        {
-          forkedBlocksParentId[block_it->GetMinerId()] = mapIndex->second + 1;
-          if(block_it->GetMinerId() != mapIndex->first)
-            forkedBlocksParentId.erase(mapIndex);	
-          newForks.push_back(block_it->GetMinerId());		  
-        }
-        else
-        {
-          forkedBlocksParentId[block_it->GetMinerId()] = 1;
-        }		  
-      }
-	  
-      for (auto &block : forkedBlocksParentId)
-      {
-       if (std::find(newForks.begin(), newForks.end(), block.first) == newForks.end() )
-       {
-         if(block.second > maxSize)
-           maxSize = block.second;
-         forkedBlocksParentId.erase(block.first);
-       }
-	  }
-    }
-    else if (blockHeight_it->size() == 1 && forkedBlocksParentId.size() > 0)
-    {
+  return m_longestFork;
+}
 
-      for (auto &block : forkedBlocksParentId)
-      {
-        if(block.second > maxSize)
-          maxSize = block.second;
-      }
-	
-      forkedBlocksParentId.clear();
-    }
-  }
-  
-  for (auto &block : forkedBlocksParentId)
-  {
-    if(block.second > maxSize)
-      maxSize = block.second;
-  }
-   
-  return maxSize;
+
+int 
+Blockchain::GetForkedHeights (void) const
+{
+  return m_forkedHeights;
+}
+
+
+forkStatistics
+Blockchain::GetForkStatistics (void) const
+{
+  forkStatistics stats;
+
+  stats.totalBlocks = m_totalBlocks;
+  stats.staleBlocks = m_noStaleBlocks;
+  stats.blocksInForks = m_blocksInForks;
+  stats.forkedHeights = m_forkedHeights;
+  stats.longestFork = m_longestFork;
+
+  return stats;
+}
+
+
+const std::vector<int>&
+Blockchain::GetForkHistogram (void) const
+{
+  return m_forkHistogram;
+}
+
+uint64_t
+Blockchain::GetBlocksMemory (void) const
+{
+  uint64_t bytes = VectorMemory(m_blocks) + HashMapMemory(m_blockIndex) + HashMapMemory(m_forkLengths) + VectorMemory(m_forkHistogram);
+
+  for (auto const &height : m_blocks)
+    bytes += VectorMemory(height);
+  return bytes;
+}
+
+uint64_t
+Blockchain::GetOrphansMemory (void) const
+{
+  uint64_t bytes = HashMapMemory(m_orphans) + HashMapMemory(m_orphanChildren);
+
+  for (auto const &children : m_orphanChildren)
+    bytes += VectorMemory(children.second);
+  return bytes;
 }
 
 
+bool operator== (const BlockId &id1, const BlockId &id2)
+{
+  return id1.m_value == id2.m_value;
+}
+
+bool operator!= (const BlockId &id1, const BlockId &id2)
+{
+  return id1.m_value != id2.m_value;
+}
+
+bool operator< (const BlockId &id1, const BlockId &id2)
+{
+  if (id1.GetBlockHeight() != id2.GetBlockHeight())
+    return id1.GetBlockHeight() < id2.GetBlockHeight();
+  else
+    return id1.GetMinerId() < id2.GetMinerId();
+}
+
+bool operator== (const ChunkId &id1, const ChunkId &id2)
+{
+  return id1.m_blockId == id2.m_blockId && id1.m_chunkId == id2.m_chunkId;
+}
+
+bool operator< (const ChunkId &id1, const ChunkId &id2)
+{
+  if (id1.m_blockId != id2.m_blockId)
+    return id1.m_blockId < id2.m_blockId;
+  else
+    return id1.m_chunkId < id2.m_chunkId;
+}
+
 bool operator== (const Block &block1, const Block &block2)
 {
   if (block1.GetBlockHeight() == block2.GetBlockHeight() && block1.GetMinerId() == block2.GetMinerId())
@@ -652,6 +853,18 @@ bool operator< (const BitcoinChunk &chunk1, const BitcoinChunk &chunk2)
     return false;
 }
 
+std::ostream& operator<< (std::ostream &out, const BlockId &id)
+{
+  out << id.GetBlockHeight() << "/" << id.GetMinerId();
+  return out;
+}
+
+std::ostream& operator<< (std::ostream &out, const ChunkId &id)
+{
+  out << id.GetBlockId() << "/" << id.GetChunkId();
+  return out;
+}
+
 std::ostream& operator<< (std::ostream &out, const Block &block)
 {
 
@@ -751,6 +964,90 @@ const char* getProtocolType(enum ProtocolType m)
   }
 }
 
+const char* getMessageCodec(enum MessageCodec m)
+{
+  switch (m) 
+  {
+    case JSON_CODEC: return "JSON_CODEC";
+    case BINARY_CODEC: return "BINARY_CODEC";
+  }
+  return "UNKNOWN";
+}
+
+const char* getLinkDiscipline(enum LinkDiscipline m)
+{
+  switch (m) 
+  {
+    case LINK_FIFO: return "LINK_FIFO";
+    case LINK_ROUND_ROBIN: return "LINK_ROUND_ROBIN";
+    case LINK_FAIR_SHARE: return "LINK_FAIR_SHARE";
+  }
+  return "UNKNOWN";
+}
+
+const char* getBlockTimeDistribution(enum BlockTimeDistribution m)
+{
+  switch (m) 
+  {
+    case BLOCK_TIME_EXPONENTIAL: return "BLOCK_TIME_EXPONENTIAL";
+    case BLOCK_TIME_GEOMETRIC: return "BLOCK_TIME_GEOMETRIC";
+    case BLOCK_TIME_TRACE: return "BLOCK_TIME_TRACE";
+  }
+  return "UNKNOWN";
+}
+
+const char* getRngPurpose(enum RngPurpose m)
+{
+  switch (m) 
+  {
+    case RNG_TOPOLOGY_MINERS: return "RNG_TOPOLOGY_MINERS";
+    case RNG_TOPOLOGY_REGIONS: return "RNG_TOPOLOGY_REGIONS";
+    case RNG_TOPOLOGY_BANDWIDTHS: return "RNG_TOPOLOGY_BANDWIDTHS";
+    case RNG_TOPOLOGY_CONNECTIONS: return "RNG_TOPOLOGY_CONNECTIONS";
+    case RNG_TOPOLOGY_LATENCIES: return "RNG_TOPOLOGY_LATENCIES";
+    case RNG_PEER_SELECTION: return "RNG_PEER_SELECTION";
+    case RNG_BLOCK_GENERATION: return "RNG_BLOCK_GENERATION";
+    case RNG_BLOCK_SIZE: return "RNG_BLOCK_SIZE";
+    case RNG_MINING_ORACLE: return "RNG_MINING_ORACLE";
+    case RNG_BLOCK_INJECTOR: return "RNG_BLOCK_INJECTOR";
+  }
+  return "UNKNOWN";
+}
+
+const char* getProfiledEvent(enum ProfiledEvent m)
+{
+  switch (m) 
+  {
+    case PROFILE_HANDLE_MESSAGE: return "HANDLE_MESSAGE";
+    case PROFILE_SEND_MESSAGE: return "SEND_MESSAGE";
+    case PROFILE_VALIDATE_BLOCK: return "VALIDATE_BLOCK";
+    case PROFILE_AFTER_BLOCK_VALIDATION: return "AFTER_BLOCK_VALIDATION";
+    case PROFILE_INV_TIMEOUT: return "INV_TIMEOUT";
+    case PROFILE_CHUNK_TIMEOUT: return "CHUNK_TIMEOUT";
+    case PROFILE_MINE_BLOCK: return "MINE_BLOCK";
+  }
+  return "UNKNOWN";
+}
+
+const char* getMemorySubsystem(enum MemorySubsystem m)
+{
+  switch (m) 
+  {
+    case MEMORY_BLOCKCHAIN_BLOCKS: return "BLOCKCHAIN_BLOCKS";
+    case MEMORY_BLOCKCHAIN_ORPHANS: return "BLOCKCHAIN_ORPHANS";
+    case MEMORY_QUEUED_INVS: return "QUEUED_INVS";
+    case MEMORY_CHUNKS: return "CHUNKS";
+    case MEMORY_PENDING_BLOCKS: return "PENDING_BLOCKS";
+    case MEMORY_TIMEOUTS: return "TIMEOUTS";
+    case MEMORY_RECEIVE_BUFFERS: return "RECEIVE_BUFFERS";
+    case MEMORY_LINKS: return "LINKS";
+    case MEMORY_PEERS: return "PEERS";
+    case MEMORY_SOCKETS: return "SOCKETS";
+    case MEMORY_DEVICES: return "DEVICES";
+  }
+  return "UNKNOWN";
+}
+
 const char* getCryptocurrency(enum Cryptocurrency m)
 {
   switch (m) 
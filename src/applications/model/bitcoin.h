@@ -1,6 +1,8 @@
 /**
  * This file contains all the necessary enumerations and structs used throughout the simulation.
  * It also defines 3 very important classed; the Block, Chunk and Blockchain.
+ * The BlockId and ChunkId identify blocks and chunks inside the nodes, instead of their "height/minerId" string hashes.
+ * The immutable fields of the blocks are interned in the process-wide BlockStore, which is shared by all the nodes.
  */
 
 
@@ -8,7 +10,11 @@
 #define BITCOIN_H
 
 #include <vector>
+#include <deque>
 #include <map>
+#include <unordered_map>
+#include <string>
+#include <stdint.h>
 #include "ns3/address.h"
 #include <algorithm>
 
@@ -70,6 +76,91 @@ enum ProtocolType
 };
 
 
+/**
+ * The codec that the nodes use to encode their messages on the wire. JSON_CODEC is kept for debugging,
+ * whereas BINARY_CODEC uses a compact length-prefixed encoding. All the nodes of a simulation must use the same codec.
+ */
+enum MessageCodec
+{
+  JSON_CODEC,                  //DEFAULT
+  BINARY_CODEC
+};
+
+
+/**
+ * The disciplines that the nodes use to share their upload and download links between their peers.
+ */
+enum LinkDiscipline
+{
+  LINK_FIFO,                   //DEFAULT
+  LINK_ROUND_ROBIN,
+  LINK_FAIR_SHARE
+};
+
+
+/**
+ * The distributions of the block generation times of the miners.
+ */
+enum BlockTimeDistribution
+{
+  BLOCK_TIME_EXPONENTIAL,
+  BLOCK_TIME_GEOMETRIC,        //DEFAULT
+  BLOCK_TIME_TRACE
+};
+
+
+/**
+ * The purposes of the random streams. Each node has its own stream for each purpose.
+ */
+enum RngPurpose
+{
+  RNG_TOPOLOGY_MINERS,
+  RNG_TOPOLOGY_REGIONS,
+  RNG_TOPOLOGY_BANDWIDTHS,
+  RNG_TOPOLOGY_CONNECTIONS,
+  RNG_TOPOLOGY_LATENCIES,
+  RNG_PEER_SELECTION,
+  RNG_BLOCK_GENERATION,
+  RNG_BLOCK_SIZE,
+  RNG_MINING_ORACLE,
+  RNG_BLOCK_INJECTOR
+};
+
+
+/**
+ * The kinds of events measured by the SimulationProfiler.
+ */
+enum ProfiledEvent
+{
+  PROFILE_HANDLE_MESSAGE,           //0: the dispatch of a received message
+  PROFILE_SEND_MESSAGE,             //1
+  PROFILE_VALIDATE_BLOCK,           //2
+  PROFILE_AFTER_BLOCK_VALIDATION,   //3: the validation timer
+  PROFILE_INV_TIMEOUT,              //4
+  PROFILE_CHUNK_TIMEOUT,            //5
+  PROFILE_MINE_BLOCK                //6: the mining timer
+};
+
+
+/**
+ * The subsystems whose memory is estimated by the MemoryAccountant.
+ */
+enum MemorySubsystem
+{
+  MEMORY_BLOCKCHAIN_BLOCKS,         //0: the blocks of the chain, their index and the fork lengths
+  MEMORY_BLOCKCHAIN_ORPHANS,        //1: the orphans and their missing parents
+  MEMORY_QUEUED_INVS,               //2: m_queueInv
+  MEMORY_CHUNKS,                    //3: m_queueChunks, m_queueChunkPeers and m_receivedChunks
+  MEMORY_PENDING_BLOCKS,            //4: m_receivedNotValidated and m_onlyHeadersReceived
+  MEMORY_TIMEOUTS,                  //5: m_invTimeouts and m_chunkTimeouts
+  MEMORY_RECEIVE_BUFFERS,           //6: m_receiveBuffers, the data of the incomplete frames
+  MEMORY_LINKS,                     //7: the transfers queued in the link schedulers
+  MEMORY_PEERS,                     //8: the addresses, the speeds and the sockets maps of the peers
+  MEMORY_SOCKETS,                   //9: the ns-3 sockets, with the data buffered for sending
+  MEMORY_DEVICES                    //10: the ns-3 net devices
+};
+
+
 /** 
  * The different cryptocurrency networks that the simulation supports.
  */
@@ -97,48 +188,93 @@ enum BitcoinRegion
 
 
 /**
- * The struct used for collecting node statistics.
+ * The quantile sketches of the statsSummary are logarithmic histograms with STATS_SKETCH_BINS_PER_DECADE bins per decade,
+ * starting from STATS_SKETCH_MIN. The first bin counts the values below STATS_SKETCH_MIN (including 0) and the last one
+ * also counts the values above the end of the range, which is 10^12 times STATS_SKETCH_MIN.
+ */
+const int    STATS_SKETCH_BINS_PER_DECADE = 100;
+const int    STATS_SKETCH_BINS = 1 + 12 * STATS_SKETCH_BINS_PER_DECADE;
+const double STATS_SKETCH_MIN = 0.001;
+
+
+/**
+ * The constants of the generated blocks, shared by the miners and the BlockInjector. The Bitcoin block sizes of the
+ * distributions were measured with a block every BITCOIN_BLOCK_GEN_INTERVAL_SECONDS, up to MAX_BLOCK_SIZE_BYTES.
+ */
+const double BITCOIN_BLOCK_GEN_INTERVAL_SECONDS = 10 * 60;
+const int    MAX_BLOCK_SIZE_BYTES = 1000000;
+const int    HEADERS_SIZE_BYTES = 81;
+const double AVERAGE_TRANSACTION_SIZE_BYTES = 522.4;
+
+
+/**
+ * A mergeable quantile sketch of the values of a statistic over a set of nodes. Within its range, every percentile
+ * is estimated with a relative error below 1.2%, using a fixed amount of memory regardless of the number of values.
+ * Two sketches are merged by adding their fields.
+ */
+typedef struct {
+  double   count;
+  double   sum;
+  double   bins[STATS_SKETCH_BINS];
+} quantileSketch;
+
+
+/**
+ * The partial sums of the statistics of a set of nodes, from the NodeStatsRegistry. The summaries of two sets of nodes are merged by adding their fields,
+ * and all the fields are doubles so that the summaries of the MPI processes can be merged with a single MPI_Reduce.
+ */
+typedef struct {
+  double   nodes;
+  double   miners;
+  double   totalBlocks;
+  double   staleBlocks;
+  double   blockReceiveTimes;                //sum of meanBlockReceiveTime weighted by totalBlocks
+  double   blockPropagationTimes;            //sum of meanBlockPropagationTime weighted by totalBlocks
+  double   blockSizes;                       //sum of meanBlockSize weighted by totalBlocks
+  double   nodesConnections;
+  double   minersConnections;
+  double   longestForks;
+  double   blocksInForks;
+  double   invReceivedBytes;
+  double   invSentBytes;
+  double   getHeadersReceivedBytes;
+  double   getHeadersSentBytes;
+  double   headersReceivedBytes;
+  double   headersSentBytes;
+  double   getDataReceivedBytes;
+  double   getDataSentBytes;
+  double   blockReceivedBytes;
+  double   blockSentBytes;
+  double   extInvReceivedBytes;
+  double   extInvSentBytes;
+  double   extGetHeadersReceivedBytes;
+  double   extGetHeadersSentBytes;
+  double   extHeadersReceivedBytes;
+  double   extHeadersSentBytes;
+  double   extGetDataReceivedBytes;
+  double   extGetDataSentBytes;
+  double   chunkReceivedBytes;
+  double   chunkSentBytes;
+  quantileSketch   propagationTimes;         //the meanBlockPropagationTime of the nodes
+  quantileSketch   minersPropagationTimes;   //the meanBlockPropagationTime of the miners
+  quantileSketch   downloadBytesPerBlock;    //the received Bytes of each node divided by its totalBlocks - 1
+  quantileSketch   uploadBytesPerBlock;      //the sent Bytes of each node divided by its totalBlocks - 1
+  quantileSketch   totalBytesPerBlock;       //the received and sent Bytes of each node divided by its totalBlocks - 1
+  quantileSketch   blockTimeouts;
+  quantileSketch   chunkTimeouts;
+} statsSummary;
+
+
+/**
+ * The fork statistics of a blockchain, which are maintained incrementally as blocks are added.
  */
 typedef struct {
-  int      nodeId;
-  double   meanBlockReceiveTime;
-  double   meanBlockPropagationTime;
-  double   meanBlockSize;
-  int      totalBlocks;
-  int      staleBlocks;
-  int      miner;	                         //0->node, 1->miner
-  int      minerGeneratedBlocks;
-  double   minerAverageBlockGenInterval;
-  double   minerAverageBlockSize;
-  double   hashRate;
-  int      attackSuccess;                    //0->fail, 1->success
-  long     invReceivedBytes;
-  long     invSentBytes;
-  long     getHeadersReceivedBytes;
-  long     getHeadersSentBytes;
-  long     headersReceivedBytes;
-  long     headersSentBytes;
-  long     getDataReceivedBytes;
-  long     getDataSentBytes;
-  long     blockReceivedBytes;
-  long     blockSentBytes;
-  long     extInvReceivedBytes;
-  long     extInvSentBytes;
-  long     extGetHeadersReceivedBytes;
-  long     extGetHeadersSentBytes;
-  long     extHeadersReceivedBytes;
-  long     extHeadersSentBytes;
-  long     extGetDataReceivedBytes;
-  long     extGetDataSentBytes;
-  long     chunkReceivedBytes;
-  long     chunkSentBytes;
-  int      longestFork;
-  int      blocksInForks;
-  int      connections;
-  long     blockTimeouts;
-  long     chunkTimeouts;
-  int      minedBlocksInMainChain;
-} nodeStatistics;
+  int      totalBlocks;       //total number of blocks including the genesis block
+  int      staleBlocks;       //blocks added to a height which already had a block
+  int      blocksInForks;     //blocks in heights with more than one block
+  int      forkedHeights;     //heights with more than one block
+  int      longestFork;       //the longest chain of blocks in consecutive forked heights
+} forkStatistics;
 
 
 typedef struct {
@@ -154,10 +290,162 @@ const char* getMessageName(enum Messages m);
 const char* getMinerType(enum MinerType m);
 const char* getBlockBroadcastType(enum BlockBroadcastType m);
 const char* getProtocolType(enum ProtocolType m);
+const char* getMessageCodec(enum MessageCodec m);
+const char* getLinkDiscipline(enum LinkDiscipline m);
+const char* getBlockTimeDistribution(enum BlockTimeDistribution m);
+const char* getRngPurpose(enum RngPurpose m);
+const char* getProfiledEvent(enum ProfiledEvent m);
+const char* getMemorySubsystem(enum MemorySubsystem m);
 const char* getBitcoinRegion(enum BitcoinRegion m);
 const char* getCryptocurrency(enum Cryptocurrency m);
 enum BitcoinRegion getBitcoinEnum(uint32_t n);
 
+
+/**
+ * The identifier of a block, packed in 64 bits: the block height in the upper 32 bits and the miner id in the lower 32 bits.
+ * Its string form, "height/minerId", is the block hash used in the messages.
+ */
+class BlockId
+{
+public:
+  BlockId (int blockHeight, int minerId);
+  BlockId ();
+  
+  /**
+   * \brief Parses a block hash
+   * \param blockHash the block hash in the form "height/minerId"
+   */
+  explicit BlockId (const std::string &blockHash);
+  
+  int GetBlockHeight (void) const;
+  int GetMinerId (void) const;
+  
+  /**
+   * \return the packed 64-bit value of the identifier
+   */
+  uint64_t GetValue (void) const;
+  
+  /**
+   * \return the block hash, "height/minerId", as it is sent in the messages
+   */
+  std::string ToString (void) const;
+  
+  friend bool operator== (const BlockId &id1, const BlockId &id2);
+  friend bool operator!= (const BlockId &id1, const BlockId &id2);
+  friend bool operator< (const BlockId &id1, const BlockId &id2);
+  friend std::ostream& operator<< (std::ostream &out, const BlockId &id);
+  
+private:
+  uint64_t      m_value;                      // (height << 32) | minerId
+};
+
+/**
+ * The hash functor used for the unordered containers keyed by BlockId
+ */
+struct BlockIdHash
+{
+  size_t operator() (const BlockId &id) const;
+};
+
+/**
+ * The identifier of a chunk. Its string form, "height/minerId/chunkId", is the chunk hash used in the messages.
+ */
+class ChunkId
+{
+public:
+  ChunkId (const BlockId &blockId, int chunkId);
+  ChunkId ();
+  
+  /**
+   * \brief Parses a chunk hash
+   * \param chunkHash the chunk hash in the form "height/minerId/chunkId"
+   */
+  explicit ChunkId (const std::string &chunkHash);
+  
+  BlockId GetBlockId (void) const;
+  int GetChunkId (void) const;
+  
+  /**
+   * \return the chunk hash, "height/minerId/chunkId", as it is sent in the messages
+   */
+  std::string ToString (void) const;
+  
+  friend bool operator== (const ChunkId &id1, const ChunkId &id2);
+  friend bool operator< (const ChunkId &id1, const ChunkId &id2);
+  friend std::ostream& operator<< (std::ostream &out, const ChunkId &id);
+  
+private:
+  BlockId       m_blockId;                    // The id of the block which the chunk belongs to
+  int           m_chunkId;                    // The index of the chunk in the block
+};
+
+/**
+ * The hash functor used for the unordered containers keyed by ChunkId
+ */
+struct ChunkIdHash
+{
+  size_t operator() (const ChunkId &id) const;
+};
+
+
+/**
+ * The immutable fields of a block, which are the same in every node that receives it.
+ */
+typedef struct {
+  int      blockHeight;
+  int      minerId;
+  int      parentBlockMinerId;
+  int      blockSizeBytes;
+  double   timeCreated;
+} blockHeader;
+
+
+/**
+ * The process-wide store of the block headers. Each distinct header is stored once and the Blocks held by the nodes
+ * refer to it with a 32-bit handle, so every node only keeps its own receive metadata of a block.
+ * The headers are never removed, so the handles remain valid until the end of the simulation. The headers are interned
+ * by BlockId, so the Blocks which are built again from a received message or copied share the stored header, and the
+ * empty header of the default Blocks is reserved, so they don't look up the store.
+ */
+class BlockStore
+{
+public:
+  static const uint32_t EMPTY_HEADER;       //!< the handle of the header of the default Blocks, all 0
+
+
+  /**
+   * \return the store shared by all the nodes of the process
+   */
+  static BlockStore& GetInstance (void);
+
+  /**
+   * \brief Interns a block header
+   * \param header the header
+   * \return the handle of the stored header. Equal headers get the same handle
+   */
+  uint32_t Intern (const blockHeader &header);
+
+  /**
+   * \param handle a handle returned by Intern
+   * \return the stored header. The headers are never moved, so the reference remains valid until the end of the simulation
+   */
+  const blockHeader& GetHeader (uint32_t handle) const;
+
+  /**
+   * \return the number of stored headers
+   */
+  size_t GetSize (void) const;
+
+private:
+  BlockStore (void);
+  BlockStore (const BlockStore &);
+  BlockStore& operator= (const BlockStore &);
+
+  std::deque<blockHeader>                                 m_headers;   // the interned headers, indexed by their handle
+  std::unordered_multimap<BlockId, uint32_t, BlockIdHash> m_index;     // the handles of the headers with each BlockId
+};
+
+
 class Block
 {
 public:
@@ -165,7 +453,7 @@ public:
          double timeCreated = 0, double timeReceived = 0, Ipv4Address receivedFromIpv4 = Ipv4Address("0.0.0.0"));
   Block ();
   Block (const Block &blockSource);  // Copy constructor
-  virtual ~Block (void);
+  ~Block (void);
  
   int GetBlockHeight (void) const;
   void SetBlockHeight (int blockHeight);
@@ -182,6 +470,9 @@ public:
   double GetTimeCreated (void) const;
   double GetTimeReceived (void) const;
 
+  BlockId GetBlockId (void) const;
+  BlockId GetParentBlockId (void) const;
+
   Ipv4Address GetReceivedFromIpv4 (void) const;
   void SetReceivedFromIpv4 (Ipv4Address receivedFromIpv4);
     
@@ -201,13 +492,19 @@ public:
   friend std::ostream& operator<< (std::ostream &out, const Block &block);
   
 protected:	
-  int           m_blockHeight;                // The height of the block
-  int           m_minerId;                    // The id of the miner which mined this block
-  int           m_parentBlockMinerId;         // The id of the miner which mined the parent of this block
-  int           m_blockSizeBytes;             // The size of the block in bytes
-  double        m_timeCreated;                // The time the block was created
-  double        m_timeReceived;               // The time the block was received from the node
+  /**
+   * Returns the interned immutable fields of the block
+   */
+  const blockHeader& GetHeader (void) const;
+  
+  /**
+   * Replaces the immutable fields of the block, by interning the modified header
+   */
+  void SetHeader (const blockHeader &header);
+
+  uint32_t      m_header;                     // The handle of the block header in the BlockStore
   Ipv4Address   m_receivedFromIpv4;           // The Ipv4 of the node which sent the block to the receiving node
+  double        m_timeReceived;               // The time the block was received from the node
 };
 
 class BitcoinChunk : public Block
@@ -217,7 +514,7 @@ public:
                 double timeCreated = 0, double timeReceived = 0, Ipv4Address receivedFromIpv4 = Ipv4Address("0.0.0.0"));
   BitcoinChunk ();
   BitcoinChunk (const BitcoinChunk &chunkSource);  // Copy constructor
-  virtual ~BitcoinChunk (void);
+  ~BitcoinChunk (void);
  
   int GetChunkId (void) const;
   void SetChunkId (int minerId);
@@ -267,9 +564,10 @@ public:
   bool IsOrphan (int height, int minerId) const;
 
   /**
-   * Gets a pointer to the block.
+   * Gets a pointer to the block. Returns nullptr if the block has not been included in the blockchain.
    */
   const Block* GetBlockPointer (const Block &newBlock) const;
+  const Block* GetBlockPointer (const BlockId &blockId) const;
 
   /**
    * Gets the children of a block that are not orphans.
@@ -314,20 +612,63 @@ public:
   /**
    * Gets the total number of blocks in forks.
    */
-  int GetBlocksInForks (void);
+  int GetBlocksInForks (void) const;
 
   /**
    * Gets the longest fork size
    */
-  int GetLongestForkSize (void);
+  int GetLongestForkSize (void) const;
+
+  /**
+   * Gets the number of heights with more than one block.
+   */
+  int GetForkedHeights (void) const;
+
+  /**
+   * Gets all the fork statistics at once. They are kept up to date by AddBlock, so it can be sampled at any time.
+   */
+  forkStatistics GetForkStatistics (void) const;
+
+  /**
+   * Gets the fork histogram: the element i is the number of heights which contain i blocks.
+   * The element 0 counts the heights skipped by orphans, whose blocks have not been added yet.
+   */
+  const std::vector<int>& GetForkHistogram (void) const;
+
+  /**
+   * Gets the estimated Bytes held by the blocks, their index and the fork lengths.
+   */
+  uint64_t GetBlocksMemory (void) const;
+
+  /**
+   * Gets the estimated Bytes held by the orphans and the index of their missing parents.
+   */
+  uint64_t GetOrphansMemory (void) const;
 
   friend std::ostream& operator<< (std::ostream &out, Blockchain &blockchain);
 
 private:
+  /**
+   * Updates the fork statistics after a block has been added to the height row.
+   */
+  void UpdateForkStatistics (const Block &newBlock);
+
+  /**
+   * Sets the fork length of a block in a forked height, and updates its descendants in forked heights.
+   */
+  void ExtendFork (const Block &forkedBlock);
+
   int                                m_noStaleBlocks;     //total number of stale blocks
   int                                m_totalBlocks;       //total number of blocks including the genesis block
+  int                                m_blocksInForks;     //total number of blocks in heights with more than one block
+  int                                m_forkedHeights;     //number of heights with more than one block
+  int                                m_longestFork;       //the longest chain of blocks in consecutive forked heights
+  std::vector<int>                   m_forkHistogram;     //the number of heights for each number of blocks per height
+  std::unordered_map<BlockId, int, BlockIdHash>                   m_forkLengths;     //the fork length of each block in a forked height
   std::vector<std::vector<Block>>    m_blocks;            //2d vector containing all the blocks of the blockchain. (row->blockHeight, col->sibling blocks)
-  std::vector<Block>                 m_orphans;           //vector containing the orphans
+  std::unordered_map<BlockId, int, BlockIdHash>                   m_blockIndex;      //the column of each block of m_blocks in its row. The row is the block height
+  std::unordered_map<BlockId, Block, BlockIdHash>                 m_orphans;         //map containing the orphans
+  std::unordered_map<BlockId, std::vector<BlockId>, BlockIdHash>  m_orphanChildren;  //the orphans waiting for each missing parent, in the order they were added
 
 
 };